@@ -0,0 +1,137 @@
+/*This file is part of LTCNM (Linux Traffic Control Network Manager).
+
+    LTCNM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LTCNM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LTCNM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**	@file TC_Log.h
+*	@brief Logging function prototypes
+*
+*	This file contains the prototypes of the logging functions. Log messages are filtered by a runtime level per module,
+*	formatted by the caller into a lock-free ring buffer and written to stdout (stderr for errors and warnings) by a background
+*	writer thread, so that the callers never block on terminal or pipe writes. While the logger is not running messages are written
+*	synchronously. Messages are dropped (and counted) if the ring buffer is full
+*
+*	@bug No known bugs
+*/
+
+#ifndef TCLOG_H
+#define TCLOG_H
+
+/**
+* A definition of the log levels
+*/
+typedef enum {
+LOG_ERROR = 0,	/**< Errors */
+LOG_WARN,	/**< Warnings */
+LOG_INFO,	/**< Control events (binds, reservations, topic updates) */
+LOG_DEBUG,	/**< Per request traces and database dumps */
+}LOG_LEVEL;
+
+/**
+* A definition of the log modules
+*/
+typedef enum {
+LOG_ALL = -1,			/**< All modules (tc_log_set_level only) */
+LOG_CLIENT = 0,			/**< Client top module */
+LOG_CLIENT_DB,			/**< Client database module */
+LOG_CLIENT_MANAGEMENT,		/**< Client management module */
+LOG_CLIENT_MONIT,		/**< Client monitoring module */
+LOG_CLIENT_RESERV,		/**< Client reservation module */
+LOG_SERVER,			/**< Server top module */
+LOG_SERVER_DB,			/**< Server database module */
+LOG_SERVER_AC,			/**< Server admission control module */
+LOG_SERVER_MANAGEMENT,		/**< Server management module */
+LOG_SERVER_MONIT,		/**< Server monitoring module */
+N_LOG_MODULES,			/**< Number of log modules (not a module -- keep last) */
+}LOG_MODULE;
+
+/**	@def TC_LOG(MODULE,LEVEL,...)
+*	@brief Logs a message if enabled for the module. Arguments are not evaluated if the message is filtered out
+*/
+#define TC_LOG(MODULE,LEVEL,...) do{ if ( tc_log_enabled( MODULE, LEVEL ) ) tc_log( MODULE, LEVEL, __VA_ARGS__ ); }while(0)
+
+/**
+*	@brief Starts the logger
+*
+*	Creates the writer thread. The logger is reference counted (client and server may run in the same process) and is only
+*	started on the first call
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*/
+int tc_log_init( void );
+
+/**
+*	@brief Closes the logger
+*
+*	Stops the writer thread (on the last reference) and writes the pending messages
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*/
+int tc_log_close( void );
+
+/**
+*	@brief Sets the log level of a module
+*
+*	@param[in] module	The module (LOG_ALL for all modules)
+*	@param[in] level	The highest level logged for the module
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*/
+int tc_log_set_level( int module, int level );
+
+/**
+*	@brief Checks if a message is logged
+*
+*	@param[in] module	The message module
+*	@param[in] level	The message level
+*
+*	@pre			None
+*
+*	@return			Message logged : 1
+*	@return			Message filtered out : 0
+*/
+int tc_log_enabled( int module, int level );
+
+/**
+*	@brief Logs a message
+*
+*	Formats the message (printf format) into the ring buffer. Use the TC_LOG macro to skip the call for filtered out messages
+*
+*	@param[in] module	The message module
+*	@param[in] level	The message level
+*	@param[in] format	The message format
+*
+*	@pre			None
+*/
+void tc_log( int module, int level, const char *format, ... ) __attribute__((format(printf,3,4)));
+
+/**
+*	@brief Returns the number of messages dropped because the ring buffer was full
+*
+*	@pre			None
+*
+*	@return			The number of dropped messages
+*/
+unsigned long long tc_log_get_dropped( void );
+
+#endif
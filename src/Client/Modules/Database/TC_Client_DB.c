@@ -33,11 +33,14 @@
 #include <pthread.h>
 #include <assert.h>
 #include <errno.h>
+#include <time.h>
+#include <sys/eventfd.h>
 
 #include "TC_Client_DB.h"
 #include "TC_Config.h"
 #include "TC_Error_Types.h"
 #include "Sockets.h"
+#include "TC_Utils.h"
 
 /** 	@def DEBUG_MSG_CLIENT_DB
 *	@brief If "ENABLE_DEBUG_CLIENT_DB" is defined debug messages related to this module are printed
@@ -48,8 +51,15 @@
 #define DEBUG_MSG_CLIENT_DB(...)
 #endif
 
+/**	@def TOPIC_HASH
+*	@brief Hash index bucket of a topic ID (multiplicative hash so sequential IDs spread over all buckets)
+*/
+#define TOPIC_HASH(ID) ( ((ID) * 2654435761u) >> (32 - CLIENT_DB_HASH_BITS) )
+
 static TOPIC_C_ENTRY *topic_db;
+static TOPIC_C_ENTRY *topic_index[1 << CLIENT_DB_HASH_BITS];
 static pthread_mutex_t db_mutex;
+static pthread_cond_t db_bind_cond;
 static char init = 0;
 
 int tc_client_db_init( void )
@@ -67,7 +77,16 @@ int tc_client_db_init( void )
 	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
 	pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
 	pthread_mutex_init( &db_mutex, &attr );
+
+	//Bind waiters use absolute deadlines of tc_time_get_us() (monotonic clock)
+	pthread_condattr_t cond_attr;
+	pthread_condattr_init(&cond_attr);
+	pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+	pthread_cond_init( &db_bind_cond, &cond_attr );
+	pthread_condattr_destroy(&cond_attr);
+
 	topic_db = NULL;
+	memset( topic_index, 0, sizeof(topic_index) );
 
 	init = 1;
 
@@ -104,6 +123,7 @@ int tc_client_db_close( void )
 
 	pthread_mutex_unlock(&db_mutex);
 	pthread_mutex_destroy(&db_mutex);
+	pthread_cond_destroy(&db_bind_cond);
 
 	DEBUG_MSG_CLIENT_DB("tc_client_db_close() Topic database module closed\n");
 
@@ -196,6 +216,49 @@ int tc_client_db_unlock( void )
 	return ERR_OK;
 }
 
+int tc_client_db_bind_wait( unsigned long long deadline )
+{
+	DEBUG_MSG_CLIENT_DB("tc_client_db_bind_wait() ...\n");
+
+	struct timespec abs_time;
+	int ret;
+
+	if ( !deadline ){
+		ret = pthread_cond_wait( &db_bind_cond, &db_mutex );
+	}else{
+		tc_time_to_timespec( deadline, &abs_time );
+		ret = pthread_cond_timedwait( &db_bind_cond, &db_mutex, &abs_time );
+	}
+
+	if ( ret == EOWNERDEAD ){
+		fprintf(stderr,"tc_client_db_bind_wait() : PREVIOUS HOLDING THREAD TERMINATED WHILE HOLDING MUTEX LUCK");
+		pthread_mutex_consistent(&db_mutex);
+	}else if ( ret == ETIMEDOUT ){
+		DEBUG_MSG_CLIENT_DB("tc_client_db_bind_wait() Deadline expired\n");
+		return ERR_DATA_TIMEOUT;
+	}
+
+	return ERR_OK;
+}
+
+int tc_client_db_bind_signal( TOPIC_C_ENTRY *topic )
+{
+	DEBUG_MSG_CLIENT_DB("tc_client_db_bind_signal() ...\n");
+
+	uint64_t event = 1;
+
+	assert( topic );
+
+	//Wake the blocking bind/unbind calls (they recheck their own topic)
+	pthread_cond_broadcast( &db_bind_cond );
+
+	//Wake the event loops waiting on a completion handle of this topic
+	if ( topic->bind_event_fd > 0 && write( topic->bind_event_fd, &event, sizeof(event) ) != sizeof(event) )
+		DEBUG_MSG_CLIENT_DB("tc_client_db_bind_signal() Topic Id %u completion handles not signaled\n",topic->topic_id);
+
+	return ERR_OK;
+}
+
 TOPIC_C_ENTRY* tc_client_db_topic_search( unsigned int topic_id )
 {
 	DEBUG_MSG_CLIENT_DB("tc_client_db_topic_search () Topic Id %u\n",topic_id);
@@ -204,8 +267,8 @@ TOPIC_C_ENTRY* tc_client_db_topic_search( unsigned int topic_id )
 
 	assert( topic_id );
 
-	//Search channel entry
-	for( db_ptr = topic_db ; db_ptr != NULL ; db_ptr = db_ptr->next ){
+	//Search channel entry in its hash bucket
+	for( db_ptr = topic_index[TOPIC_HASH(topic_id)] ; db_ptr != NULL ; db_ptr = db_ptr->hash_next ){
 		if ( db_ptr->topic_id == topic_id ){
 			DEBUG_MSG_CLIENT_DB("tc_client_db_topic_search() : Returning with Topic Id %u entry address\n",topic_id);
 			return db_ptr;
@@ -217,23 +280,124 @@ TOPIC_C_ENTRY* tc_client_db_topic_search( unsigned int topic_id )
 	return NULL;
 }
 
+TOPIC_C_ENTRY* tc_client_db_topic_get( unsigned int topic_id )
+{
+	DEBUG_MSG_CLIENT_DB("tc_client_db_topic_get () Topic Id %u\n",topic_id);
+
+	TOPIC_C_ENTRY *topic = NULL;
+
+	assert( topic_id );
+
+	if ( tc_client_db_lock() )
+		return NULL;
+
+	//The database reference can only be dropped with the database locked -> the entry can't be freed before we take ours
+	if ( (topic = tc_client_db_topic_search( topic_id )) )
+		__atomic_add_fetch( &topic->refs, 1, __ATOMIC_RELAXED );
+
+	tc_client_db_unlock();
+
+	return topic;
+}
+
+int tc_client_db_topic_get_reliable( TOPIC_C_ENTRY **ret_topics, unsigned int max_topics, unsigned int *ret_n_topics )
+{
+	DEBUG_MSG_CLIENT_DB("tc_client_db_topic_get_reliable() ...\n");
+
+	TOPIC_C_ENTRY *db_ptr;
+	int ret;
+
+	assert( ret_topics );
+	assert( ret_n_topics );
+
+	*ret_n_topics = 0;
+
+	if ( (ret = tc_client_db_lock()) )
+		return ret;
+
+	for( db_ptr = topic_db; db_ptr && *ret_n_topics < max_topics; db_ptr = db_ptr->next ){
+		if ( db_ptr->is_producer && db_ptr->tx_nack_sock.fd > 0 ){
+			__atomic_add_fetch( &db_ptr->refs, 1, __ATOMIC_RELAXED );
+			ret_topics[(*ret_n_topics)++] = db_ptr;
+		}
+	}
+
+	tc_client_db_unlock();
+
+	return ERR_OK;
+}
+
+int tc_client_db_topic_put( TOPIC_C_ENTRY *topic )
+{
+	int i;
+
+	DEBUG_MSG_CLIENT_DB("tc_client_db_topic_put() ...\n");
+
+	assert( topic );
+
+	if ( __atomic_sub_fetch( &topic->refs, 1, __ATOMIC_ACQ_REL ) )
+		return ERR_OK;
+
+	//Last reference -> entry was already removed from the database
+	DEBUG_MSG_CLIENT_DB("tc_client_db_topic_put() Freeing Topic Id %u entry\n",topic->topic_id);
+
+	pthread_mutex_destroy( &(topic->topic_rx_lock) );	
+	pthread_mutex_destroy( &(topic->topic_tx_lock) );
+
+	if ( topic->topic_sock.fd > 0 )
+		sock_close( &topic->topic_sock );
+	if ( topic->unblock_rx_sock.fd > 0 )
+		sock_close( &topic->unblock_rx_sock );
+	if ( topic->tx_nack_sock.fd > 0 )
+		sock_close( &topic->tx_nack_sock );
+
+	for ( i = 0; i < RX_REASM_CONTEXTS; i++ )
+		free(topic->rx_reasm[i].buff);
+	free(topic->rx_buff);
+	free(topic->tx_fec_buff);
+	if ( topic->tx_retx ){
+		for ( i = 0; i < RETX_WINDOW; i++ )
+			free(topic->tx_retx[i].data);
+		free(topic->tx_retx);
+	}
+	free(topic);
+
+	return ERR_OK;
+}
+
 int tc_client_db_topic_delete( TOPIC_C_ENTRY *topic )
 {
 	DEBUG_MSG_CLIENT_DB("tc_client_db_topic_delete() ... \n");
 
+	TOPIC_C_ENTRY **link;
+
 	assert( topic );
 
-	//Failsafe
-	if ( topic->topic_sock.fd > 0 ){
-		topic->is_consumer = 0;
-		topic->is_producer = 0;
-		topic->is_closing = 1;
+	//References still held outside the database see the topic as closed
+	topic->is_consumer = 0;
+	topic->is_producer = 0;
+	topic->is_closing = 1;
 
-		if ( topic->unblock_rx_sock.fd > 0 ){
-			sock_send( &topic->unblock_rx_sock, &topic->unblock_rx_sock.host, "0", 5);
-			sock_close( &topic->unblock_rx_sock );
-		}
-		sock_close( &topic->topic_sock );
+	//Failsafe -> wake up a receiver blocked on the topic socket
+	//The sockets are only closed with the last reference so a send/receive still in progress can't use an fd reused by another topic
+	if ( (topic->topic_sock.fd > 0) && (topic->unblock_rx_sock.fd > 0) )
+		sock_send( &topic->unblock_rx_sock, &topic->unblock_rx_sock.host, "0", 5);
+
+	//Release the unblock socket name now so the topic can be registered again while this entry is still referenced
+	if ( topic->unblock_rx_sock.fd > 0 ){
+		unlink( topic->unblock_rx_sock.host.name_ip );
+		topic->unblock_rx_sock.host.name_ip[0] = '\0';
+	}
+
+	//Waiters on this topic find it gone
+	topic->is_tx_bound = 0;
+	topic->is_rx_bound = 0;
+	tc_client_db_bind_signal( topic );
+
+	//Completion handles returned to the application are duplicates -> they stay valid
+	if ( topic->bind_event_fd > 0 ){
+		close( topic->bind_event_fd );
+		topic->bind_event_fd = -1;
 	}
 
 	if ( topic->previous )
@@ -244,10 +408,16 @@ int tc_client_db_topic_delete( TOPIC_C_ENTRY *topic )
 	if( topic->next )
 		(topic->next)->previous = topic->previous;
 
-	pthread_mutex_destroy( &(topic->topic_rx_lock) );	
-	pthread_mutex_destroy( &(topic->topic_tx_lock) );
+	//Remove from the hash index
+	for( link = &topic_index[TOPIC_HASH(topic->topic_id)] ; *link ; link = &(*link)->hash_next ){
+		if ( *link == topic ){
+			*link = topic->hash_next;
+			break;
+		}
+	}
 
-	free(topic);		
+	//Drop the database reference (freed now or by the last send/receive call or handle using it)
+	tc_client_db_topic_put( topic );
 
 	DEBUG_MSG_CLIENT_DB("tc_client_db_topic_delete() Returning 0\n");
 
@@ -259,7 +429,7 @@ TOPIC_C_ENTRY* tc_client_db_topic_create( unsigned int topic_id )
 	DEBUG_MSG_CLIENT_DB("tc_client_db_topic_create() Topic Id %u\n",topic_id);
 
 	TOPIC_C_ENTRY *db_ptr = NULL;
-	TOPIC_C_ENTRY *prev_ptr = NULL;
+	unsigned int bucket;
 
 	assert( topic_id );
 
@@ -269,13 +439,8 @@ TOPIC_C_ENTRY* tc_client_db_topic_create( unsigned int topic_id )
 		return db_ptr;
 	}
 
-	//There is no entry for this topic -> Find last element of list
-	for( db_ptr = topic_db ; db_ptr != NULL ; db_ptr = db_ptr->next ){
-		prev_ptr = db_ptr;
-	}
-	
-	//Create new list entry
-	if( (db_ptr = (TOPIC_C_ENTRY *) malloc(sizeof(TOPIC_C_ENTRY))) == NULL ){
+	//Create new list entry (aligned so the statistics blocks sit on their own cache lines)
+	if( posix_memalign( (void **)&db_ptr, TOPIC_STATS_ALIGN, sizeof(TOPIC_C_ENTRY) ) ){
 		fprintf(stderr,"tc_client_db_topic_create() : NOT ENOUGH MEMORY TO REGISTER NEW ENTRY FOR TOPIC ID %u\n",topic_id);
 		return NULL;
   	}
@@ -289,16 +454,34 @@ TOPIC_C_ENTRY* tc_client_db_topic_create( unsigned int topic_id )
 	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ERRORCHECK);
 	pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
 
+	//Bind state changes counter (non-blocking so a signal never stalls the management module)
+	if ( (db_ptr->bind_event_fd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC )) < 0 ){
+		fprintf(stderr,"tc_client_db_topic_create() : ERROR CREATING BIND EVENT FOR TOPIC ID %u\n",topic_id);
+		free(db_ptr);
+		return NULL;
+	}
+
 	pthread_mutex_init( &(db_ptr->topic_rx_lock), &attr );
 	pthread_mutex_init( &(db_ptr->topic_tx_lock), &attr );
 
-	//First element of list created?
-	if ( !prev_ptr )
-		topic_db = db_ptr;
-	else{
-		db_ptr->previous = prev_ptr;
-		prev_ptr->next = db_ptr;
-	}
+	db_ptr->topic_id = topic_id;
+
+	//Database reference
+	db_ptr->refs = 1;
+
+	db_ptr->tx_pacing = TX_PACING_DEFAULT;
+	db_ptr->tx_segment_size = UDP_SEGMENT_SIZE;
+	db_ptr->rx_delivery = RX_DELIVERY_DEFAULT;
+
+	//Insert at the head of the list and of the hash bucket
+	if ( topic_db )
+		topic_db->previous = db_ptr;
+	db_ptr->next = topic_db;
+	topic_db = db_ptr;
+
+	bucket = TOPIC_HASH(topic_id);
+	db_ptr->hash_next = topic_index[bucket];
+	topic_index[bucket] = db_ptr;
 
 	DEBUG_MSG_CLIENT_DB("tc_client_db_topic_create() Returning with created entry of Topic Id %u\n",topic_id);
 
@@ -320,6 +503,7 @@ int tc_client_db_topic_print( void )
 		printf("period %u\n",db_ptr->channel_period);
 		printf("next #%p\n",db_ptr->next);
 		printf("previous #%p\n",db_ptr->previous);
+		printf("references %u\n",__atomic_load_n( &db_ptr->refs, __ATOMIC_RELAXED ));
 		printf("\n");
 	}
 
@@ -328,39 +512,17 @@ int tc_client_db_topic_print( void )
 	return ERR_OK;
 }
 
-int tc_client_lock_topic_tx( TOPIC_C_ENTRY *topic, unsigned int timeout )
+int tc_client_lock_topic_tx( TOPIC_C_ENTRY *topic, unsigned long long deadline )
 {
 	DEBUG_MSG_CLIENT_DB("tc_client_lock_topic_tx() ...\n");
 
 	int ret;
-	unsigned int tries;
 
 	assert( topic );
 
-	if ( timeout > 0 ){
-		for ( tries = 0; tries < timeout && (ret = pthread_mutex_trylock( &(topic->topic_tx_lock) )); tries++ ){
-			usleep(1000);
-			if ( ret < 0 )
-				printf("lock_topic_tx got error\n");
-
-			if ( ret == EOWNERDEAD ){
-				fprintf(stderr,"tc_client_lock_topic_tx() : PREVIOUS HOLDING THREAD TERMINATED WHILE HOLDING MUTEX LUCK");
-				pthread_mutex_consistent(&topic->topic_tx_lock);
-				return ERR_OK;
-			}
-		}
-	
-		if ( tries == timeout )
-			return -2;
-	}else{
-		ret = pthread_mutex_lock( &(topic->topic_tx_lock) );
-		if ( ret < 0 )
-			printf("unlock_topic_tx got error\n");
-
-		if ( ret == EOWNERDEAD ){
-				fprintf(stderr,"tc_client_lock_topic_tx() : PREVIOUS HOLDING THREAD TERMINATED WHILE HOLDING MUTEX LUCK");
-				pthread_mutex_consistent(&topic->topic_tx_lock);
-		}
+	if ( (ret = tc_mutex_lock_until( &(topic->topic_tx_lock), deadline )) ){
+		DEBUG_MSG_CLIENT_DB("tc_client_lock_topic_tx() Deadline expired waiting for topic id %u lock\n",topic->topic_id);
+		return ret;
 	}
 
 	DEBUG_MSG_CLIENT_DB("tc_client_lock_topic_tx() Got lock on topic id %u\n",topic->topic_id);
@@ -398,34 +560,17 @@ int tc_client_unlock_topic_tx( TOPIC_C_ENTRY *topic )
 	return ERR_OK;
 }
 
-int tc_client_lock_topic_rx( TOPIC_C_ENTRY *topic, unsigned int timeout )
+int tc_client_lock_topic_rx( TOPIC_C_ENTRY *topic, unsigned long long deadline )
 {
 	DEBUG_MSG_CLIENT_DB("tc_client_lock_topic_rx() ...\n");
 
 	int ret;
 
-	unsigned int tries;
-
 	assert( topic );
 
-	if ( timeout > 0 ){
-		for ( tries = 0; tries < timeout && (ret = pthread_mutex_trylock( &(topic->topic_rx_lock) )); tries++ ){
-			usleep(1000);
-			if ( ret == EOWNERDEAD ){
-				fprintf(stderr,"tc_client_lock_topic_rx() : PREVIOUS HOLDING THREAD TERMINATED WHILE HOLDING MUTEX LUCK");
-				pthread_mutex_consistent(&topic->topic_rx_lock);
-				return ERR_OK;
-			}
-		}
-	
-		if ( tries == timeout )
-			return -2;
-	}else{
-		ret = pthread_mutex_lock( &(topic->topic_rx_lock) );
-		if ( ret == EOWNERDEAD ){
-			fprintf(stderr,"tc_client_lock_topic_rx() : PREVIOUS HOLDING THREAD TERMINATED WHILE HOLDING MUTEX LUCK");
-			pthread_mutex_consistent(&topic->topic_rx_lock);
-		}
+	if ( (ret = tc_mutex_lock_until( &(topic->topic_rx_lock), deadline )) ){
+		DEBUG_MSG_CLIENT_DB("tc_client_lock_topic_rx() Deadline expired waiting for topic id %u lock\n",topic->topic_id);
+		return ret;
 	}
 
 	DEBUG_MSG_CLIENT_DB("tc_client_lock_topic_rx() Got lock on topic id %u\n",topic->topic_id);
@@ -30,8 +30,114 @@
 
 #include "TC_Data_Types.h"
 
+/**	@def TOPIC_STATS_ALIGN
+*	@brief Alignment (in bytes) of the topic statistics counters blocks. One cache line so producer and consumer threads don't false share
+*/
+#define TOPIC_STATS_ALIGN 64
+
+/**	@def TOPIC_STATS_ADD
+*	@brief Adds N to a topic statistics counter (relaxed atomic -- counters are only read for statistics)
+*/
+#define TOPIC_STATS_ADD(X,N) __atomic_fetch_add( &(X), (N), __ATOMIC_RELAXED )
+
+/**	@def TOPIC_STATS_GET
+*	@brief Reads a topic statistics counter (relaxed atomic)
+*/
+#define TOPIC_STATS_GET(X) __atomic_load_n( &(X), __ATOMIC_RELAXED )
+
+/**
+* The data path transmission counters of a topic (updated by tc_client_topic_send only)
+*/
+typedef struct{
+	unsigned long long msgs;		/**< Number of messages sent */
+	unsigned long long bytes;		/**< Number of payload bytes sent */
+	unsigned long long frags;		/**< Number of fragments sent */
+	unsigned long long errors;		/**< Number of failed send calls */
+	unsigned long long lock_wait;		/**< Total time (in ns) spent waiting for the topic transmission mutex */
+	unsigned long long combined;		/**< Number of messages sent by the send call of another thread */
+	unsigned long long pacing_wait;		/**< Total time (in ns) messages waited for the producer pacing */
+	unsigned long long pacing_drops;	/**< Number of messages dropped or superseded by the producer pacing */
+	unsigned long long fec_parity;		/**< Number of FEC parity fragments sent */
+	unsigned long long retx_frags;		/**< Number of NACKed fragments retransmitted */
+	unsigned long long retx_drops;		/**< Number of NACKed fragments not retransmitted (message out of the window or retransmissions share exceeded) */
+}__attribute__((aligned(TOPIC_STATS_ALIGN))) TOPIC_C_TX_STATS;
+
+/**
+* A message kept by the producer of a reliable topic to retransmit its lost fragments (slot msg_seq % RETX_WINDOW of the retransmit window)
+*/
+typedef struct{
+	FRAG_HEADER header;			/**< The message fragments header (msg_size 0 -> empty slot) */
+	char *data;				/**< The message data (allocated on first use, channel_size bytes) */
+	unsigned long long *retx_time;		/**< The last retransmission time of each data fragment (in us, tc_time_get_us() clock -- same allocation as data) */
+	unsigned int buff_size;			/**< The message data buffer size (in bytes) */
+}TX_RETX;
+
+/**
+* A message submitted to a topic transmission queue. Lives in the stack of the sending thread until it is sent by the transmission mutex holder
+*/
+typedef struct tx_req{
+	char *data;			/**< The message data */
+	int data_size;			/**< The message size (in bytes) */
+	int ret;			/**< The send result (number of bytes sent or error code). Read by its thread once it gets the transmission mutex */
+	struct tx_req *next;		/**< The next (older) queued message */
+}TX_REQ;
+
+/**
+* The data path reception counters of a topic (updated by tc_client_topic_receive only)
+*/
+typedef struct{
+	unsigned long long msgs;		/**< Number of messages received */
+	unsigned long long bytes;		/**< Number of payload bytes received */
+	unsigned long long frags;		/**< Number of fragments received */
+	unsigned long long stale_frags;		/**< Number of old fragments discarded (fragments from previous messages) */
+	unsigned long long timeouts;		/**< Number of receive calls that timed out waiting for a message */
+	unsigned long long reasm_timeouts;	/**< Number of incomplete messages discarded (fragment lost or past FRAG_TIMEOUT, or reassembly table full) */
+	unsigned long long errors;		/**< Number of failed receive calls (other than timeouts) */
+	unsigned long long lock_wait;		/**< Total time (in ns) spent waiting for the topic reception mutex */
+	unsigned long long conflated;		/**< Number of complete messages discarded for a newer one (latest value delivery) */
+	unsigned long long fec_recovered;	/**< Number of lost fragments rebuilt from the FEC parity fragments */
+	unsigned long long nacks_sent;		/**< Number of NACKs sent to the producers of reliable topics */
+}__attribute__((aligned(TOPIC_STATS_ALIGN))) TOPIC_C_RX_STATS;
+
+#if ENABLE_MSG_TRACING
+/**
+* The end-to-end message tracing state of a topic consumer (updated by tc_client_topic_receive only)
+*/
+typedef struct{
+	TC_HIST latency;					/**< One-way message latency (in us, send timestamp to message reassembled) */
+	unsigned long long lost;				/**< Number of messages missing in the producers sequence numbers */
+	unsigned long long reordered;				/**< Number of messages received after a newer one from the same producer */
+	unsigned int n_producers;				/**< Number of tracked producers */
+	unsigned int producer_ids[MAX_TRACED_PRODUCERS];	/**< The tracked producers node IDs */
+	unsigned int last_seq[MAX_TRACED_PRODUCERS];		/**< The last message sequence number received from each tracked producer */
+}__attribute__((aligned(TOPIC_STATS_ALIGN))) TOPIC_C_RX_TRACE;
+#endif
+
+/**
+* A fragmented message being reassembled by a topic consumer. Identified by the producer address and message sequence number, so fragments
+* of messages sent at the same time by different producers don't mix
+*/
+typedef struct{
+	char in_use;			/**< Flag to signal if the context holds an incomplete message */
+					/**<	\li Value = 2 -> FEC protected or reliable message delivered (its remaining fragments are dropped) */
+	NET_ADDR sender;		/**< The producer address */
+	FRAG_HEADER header;		/**< The message first fragment header */
+	int len;			/**< Number of message bytes received */
+	int next_seq;			/**< The next expected fragment sequence number (a producer sends its fragments in order) */
+	int fec_blocks;			/**< Number of FEC blocks not rebuilt yet (FEC protected and reliable messages) */
+	int highest_seq;		/**< The highest fragment sequence number received (reliable messages -- the lower missing ones were lost) */
+	char nack_gap;			/**< Flag to signal if the pending NACK follows a gap in the fragment sequence numbers (else a silent producer) */
+	unsigned long long nack_time;	/**< Time of the next NACK (in us, tc_time_get_us() clock -- 0 -> none. Reliable messages only) */
+	unsigned long long nack_sent;	/**< Time of the last NACK sent (in us, tc_time_get_us() clock) */
+	unsigned long long last;	/**< Last fragment arrival time (in us, tc_time_get_us() clock) */
+	char *buff;			/**< The reassembly buffer (allocated on first use). FEC protected messages : data and parity fragments then one received flag per fragment */
+	unsigned int buff_size;		/**< The reassembly buffer size (in bytes) */
+}RX_REASM;
+
 /**
-* A client side database linked list entry to store information related to a network topic
+* A client side database linked list entry to store information related to a network topic. Entries are also indexed by topic ID in a hash table
+* and reference counted : the database holds one reference while the entry is linked and each user of the entry outside the database lock
+* (send/receive calls, topic handles) holds another one, so a deleted entry is only freed when the last user releases it
 */
 typedef struct topic_c_entry{
 
@@ -41,6 +147,9 @@ typedef struct topic_c_entry{
 	unsigned int topic_id;			/**< The ID of the topic */
 	unsigned int channel_size;		/**< The topic messages maximum size in bytes */
 	unsigned int channel_period;		/**< The topic messages minimum period in ms */
+	unsigned int fec_k;			/**< The topic FEC block data fragments (0 -> no FEC) */
+	unsigned int fec_m;			/**< The topic FEC block parity fragments */
+	unsigned int retx_share;		/**< The topic load share (in %) reserved for retransmissions (0 -> not reliable) */
 /*@}*/
 	
 /*@}*//**
@@ -83,14 +192,45 @@ typedef struct topic_c_entry{
 *//*@{*/
 	pthread_mutex_t topic_rx_lock;		/**< Mutex to avoid different threads receiving data at the same time */
 	pthread_mutex_t topic_tx_lock;		/**< Mutex to avoid different threads sending data at the same time */
+	TX_REQ *tx_queue;			/**< Messages waiting to be sent (lock-free LIFO pushed by the send calls, drained by the transmission mutex holder) */
+	TX_PACING tx_pacing;			/**< The producer pacing policy */
+	unsigned long long tx_tat;		/**< Producer pacing theoretical arrival time (in us, tc_time_get_us() clock) -- the token bucket is full from then on */
+	unsigned int tx_segment_size;		/**< Size of the fragments sent with UDP segmentation offload (0 -> D_MTU fragments) */
+	char *tx_fec_buff;			/**< The FEC parity fragments of the block being sent (allocated on first use) */
+	SOCK_ENTITY tx_nack_sock;		/**< The socket receiving the consumers NACKs (reliable topic producers only) */
+	TX_RETX *tx_retx;			/**< The retransmit window (RETX_WINDOW last messages sent -- allocated on first use) */
+	unsigned long long tx_retx_tat;		/**< Retransmissions share theoretical arrival time (in us, tc_time_get_us() clock) */
+	unsigned long long tx_retx_last;	/**< Send time of the last message kept in the retransmit window (in us, 0 once its first fragment was sent again) */
+	RX_DELIVERY rx_delivery;		/**< The consumer delivery mode */
+	char *rx_buff;				/**< The topic reception buffer (allocated on first receive) holding the last received datagram */
+	int rx_next;				/**< Offset of the next fragment to handle in the reception buffer */
+	int rx_left;				/**< Number of bytes left to handle in the reception buffer (several fragments with UDP GRO) */
+	int rx_segment_size;			/**< Size of each fragment in the reception buffer */
+	NET_ADDR rx_sender;			/**< The sender address of the datagram in the reception buffer */
+	RX_REASM rx_reasm[RX_REASM_CONTEXTS];	/**< The fragmented messages being reassembled (accessed with the reception mutex locked) */
+	unsigned int rx_nack_seed;		/**< The NACKs random delay generator state */
 	SOCK_ENTITY unblock_rx_sock;		/**< Auxiliary socket to unblock blocked receive calls when an unbind/unregister operation is being issued */
+	int bind_event_fd;			/**< Eventfd incremented on every bind state change (duplicated as the non-blocking bind completion handles) */
+/*@}*/	
+
+/*@}*//**
+* @name Topic Statistics
+*//*@{*/
+	TOPIC_C_TX_STATS tx_stats;		/**< The topic transmission counters */
+	TOPIC_C_RX_STATS rx_stats;		/**< The topic reception counters */
+	unsigned int tx_msg_seq;		/**< The next message sequence number sent to this topic */
+#if ENABLE_MSG_TRACING
+	TOPIC_C_RX_TRACE rx_trace;		/**< The topic end-to-end message tracing state */
+#endif
 /*@}*/	
 
 /*@}*//**
 * @name Linked List Control
 *//*@{*/
+	unsigned int refs;			/**< Number of references to the entry (atomic -- the database holds one while the entry is linked) */
 	struct topic_c_entry *next;		/**< The next linked list topic entry address */
 	struct topic_c_entry *previous;		/**< The previous linked list topic entry address */
+	struct topic_c_entry *hash_next;	/**< The next topic entry address in the same hash index bucket */
 /*@}*/
 
 }TOPIC_C_ENTRY;
@@ -150,9 +290,41 @@ int tc_client_db_lock( void );
 */
 int tc_client_db_unlock( void );
 
+/**
+*	@brief Waits for a topic bind state change
+*
+*	Waits until a bind state change is signaled (tc_client_db_bind_signal) on any topic or until the deadline expires. 
+*	Must be called with the database locked. The lock is released while waiting and held again on return, so the topic entry must be searched again
+*
+*	@param[in] deadline	The absolute time (in us, tc_time_get_us() clock) until which to wait. If 0 blocks indefinitely
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : ERR_DATA_TIMEOUT if the deadline expired
+*/
+int tc_client_db_bind_wait( unsigned long long deadline );
+
+/**
+*	@brief Signals a topic bind state change
+*
+*	Wakes all the threads waiting in tc_client_db_bind_wait and increments the topic bind event counter (read by the completion handles).
+*	Must be called with the database locked, after changing the topic is_tx_bound/is_rx_bound flags
+*
+*	@param[in] topic	The address of the topic entry. Must not be a NULL pointer
+*
+*	@pre			assert( topic );
+*
+*	@return			Upon successful return : ERR_OK (0)
+*/
+int tc_client_db_bind_signal( TOPIC_C_ENTRY *topic );
+
 /**
 *	@brief Searches the database for the topic entry
 *
+*	Looks up the topic ID in the database hash index. Must be called with the database locked. The returned address is only valid while
+*	the database stays locked (use tc_client_db_topic_get to keep using the entry after unlocking)
+*
 *	@param[in] topic_id	The ID of the topic to search for. Must be greater than 0
 *
 *	@pre			assert( topic_id );
@@ -162,10 +334,58 @@ int tc_client_db_unlock( void );
 */
 TOPIC_C_ENTRY* tc_client_db_topic_search( unsigned int topic_id );
 
+/**
+*	@brief Gets a reference to the topic entry
+*
+*	Locks the database, searches the topic entry and takes a reference to it. The entry stays valid (even if it is deleted from the database
+*	meanwhile) until the reference is released with tc_client_db_topic_put. Must be called with the database unlocked
+*
+*	@param[in] topic_id	The ID of the topic to search for. Must be greater than 0
+*
+*	@pre			assert( topic_id );
+*
+*	@return			Upon successful return : The topic entry address
+*	@return			Upon output error : A NULL pointer
+*/
+TOPIC_C_ENTRY* tc_client_db_topic_get( unsigned int topic_id );
+
+/**
+*	@brief Releases a reference to the topic entry
+*
+*	Drops a reference taken with tc_client_db_topic_get. If it was the last one (the entry was already deleted from the database) the entry
+*	mutexes and memory are freed. Doesn't need the database lock
+*
+*	@param[in] topic	The address of the topic entry. Must not be a NULL pointer
+*
+*	@pre			assert( topic );
+*
+*	@return			Upon successful return : ERR_OK (0)
+*/
+int tc_client_db_topic_put( TOPIC_C_ENTRY *topic );
+
+/**
+*	@brief Gets a reference to the entries of the reliable topics produced by this node
+*
+*	Locks the database and takes a reference to each topic entry with an open NACK socket (up to max_topics). The references are released
+*	with tc_client_db_topic_put. Must be called with the database unlocked
+*
+*	@param[out] ret_topics	The array where the topic entries addresses are returned. Must not be a NULL pointer
+*	@param[in] max_topics	The size of the ret_topics array
+*	@param[out] ret_n_topics	The number of topic entries returned. Must not be a NULL pointer
+*
+*	@pre			assert( ret_topics );
+*	@pre			assert( ret_n_topics );
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : Error code (<0) if the database couldn't be locked
+*/
+int tc_client_db_topic_get_reliable( TOPIC_C_ENTRY **ret_topics, unsigned int max_topics, unsigned int *ret_n_topics );
+
 /**
 *	@brief Deletes the topic entry
 *
-*	Removes the topic entry from the linked list and frees the memory. Closes topic sockets (if active) and unblocks blocked receiving calls 
+*	Removes the topic entry from the linked list and hash index and drops the database reference (the memory is freed once no send/receive call
+*	or topic handle still references it). Closes topic sockets (if active) and unblocks blocked receiving calls. Must be called with the database locked
 *
 *	@param[in] topic	The address of the topic entry to be removed. Must not be a NULL pointer
 *
@@ -205,20 +425,18 @@ int tc_client_db_topic_print( void );
 /**
 *	@brief Gets access to the topic transmission mutex
 *
-*	Tries to lock the topic transmission mutex. This is used in the tc_client_topic_send( unsigned int topic_id , char *data, int data_size ) call
+*	Blocks on the topic transmission mutex until it is acquired or the deadline expires. This is used in the tc_client_topic_send( unsigned int topic_id , char *data, int data_size ) call
 *	to prevent several threads to send data at the same time
 *
 *	@param[in] topic	The address of the topic entry (topic through where we want to send data). Must not be a NULL pointer
-*	@param[in] timeout	Maximum time interval (in ms) to wait for lock on the mutex. If 0 blocks indefinitely. Must be equal or greater than 0
+*	@param[in] deadline	The absolute time (in us, tc_time_get_us() clock) until which to wait for lock on the mutex. If 0 blocks indefinitely
 *
 *	@pre			assert( topic );
 *
 *	@return			Upon successful return : ERR_OK (0)
-*	@return			Upon output error : An error code (<0)
-*
-*	@todo			Implement missing error codes
+*	@return			Upon output error : ERR_LOCK_TIMEOUT if the deadline expired or other error code (<0)
 */
-int tc_client_lock_topic_tx( TOPIC_C_ENTRY *topic, unsigned int timeout );
+int tc_client_lock_topic_tx( TOPIC_C_ENTRY *topic, unsigned long long deadline );
 
 /**
 *	@brief Releases access to the topic transmission mutex
@@ -240,20 +458,18 @@ int tc_client_unlock_topic_tx( TOPIC_C_ENTRY *topic );
 /**
 *	@brief Gets access to the topic reception mutex
 *
-*	Tries to lock the topic reception mutex. This is used in the tc_client_topic_receive( unsigned int topic_id, unsigned int timeout, char *ret_data ) call
+*	Blocks on the topic reception mutex until it is acquired or the deadline expires. This is used in the tc_client_topic_receive( unsigned int topic_id, unsigned int timeout, char *ret_data ) call
 *	to prevent several threads from receiving data at the same time
 *
 *	@param[in] topic	The address of the topic entry (topic from where we want to receive data). Must not be a NULL pointer
-*	@param[in] timeout	Maximum time interval (in ms) to wait for lock on the mutex. If 0 blocks indefinitely. Must be equal or greater than 0
+*	@param[in] deadline	The absolute time (in us, tc_time_get_us() clock) until which to wait for lock on the mutex. If 0 blocks indefinitely
 *
 *	@pre			assert( topic );
 *
 *	@return			Upon successful return : ERR_OK (0)
-*	@return			Upon output error : An error code (<0)
-*
-*	@todo			Implement missing error codes
+*	@return			Upon output error : ERR_LOCK_TIMEOUT if the deadline expired or other error code (<0)
 */
-int tc_client_lock_topic_rx( TOPIC_C_ENTRY *topic, unsigned int timeout );
+int tc_client_lock_topic_rx( TOPIC_C_ENTRY *topic, unsigned long long deadline );
 
 /**
 *	@brief Releases access to the topic reception mutex
@@ -39,6 +39,8 @@
 #include "Sockets.h"
 #include "TC_Data_Types.h"
 #include "TC_Utils.h"
+#include "TC_Probes.h"
+#include "TC_Log.h"
 #include "TC_Config.h"
 
 /** 	@def DEBUG_MSG_CLIENT_MANAGEMENT
@@ -188,7 +190,7 @@ static void management_handler( void )
 
 		if ( i >= msg.n_nodes ){
 			//No request for this node
-			printf("management_handler() : Going to discard request( not for this node )\n");
+			TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_DEBUG, "management_handler() : Going to discard request( not for this node )\n" );
 			continue;
 		}
  
@@ -204,6 +206,8 @@ static void management_handler( void )
 		ans.node_ids[0] = manag_node_id;
 		ans.n_nodes = 1;
 		ans.topic_id = msg.topic_id;
+
+		TC_PROBE4( client_mng_req_start, msg.op, manag_node_id, msg.topic_id, msg.topic_load );
 	
 		//Lock topic database
 		tc_client_db_lock();
@@ -224,8 +228,9 @@ static void management_handler( void )
 
 				//Bind to topic as producer
 				topic->is_tx_bound = 1;
+				tc_client_db_bind_signal( topic );
 
-				printf("management_handler() : Bound as producer of topic id %u\n",topic->topic_id);
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Bound as producer of topic id %u\n",topic->topic_id );
 				break;
 
 			case BIND_RX :
@@ -242,8 +247,9 @@ static void management_handler( void )
 
 				//Bind to topic as consumer
 				topic->is_rx_bound = 1;
+				tc_client_db_bind_signal( topic );
 
-				printf("management_handler() : Bound as consumer of topic id %u\n",topic->topic_id);
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Bound as consumer of topic id %u\n",topic->topic_id );
 				break;
 
 			case DEL_TOPIC :
@@ -284,6 +290,10 @@ static void management_handler( void )
 					 }
 				}
 
+				//Remove ingress policer
+				if ( topic->is_consumer )
+					tc_client_reserv_police( msg.topic_id, &msg.topic_addr, 0, 0 );
+
 				//Close topic socket
 				if ( sock_close( &topic->topic_sock ) ){
 					fprintf(stderr,"management_handler() : ERROR CLOSING TOPIC ID %u SOCKET\n",msg.topic_id);
@@ -297,7 +307,7 @@ static void management_handler( void )
 
 				tc_client_db_topic_delete( topic );
 				
-				printf("management_handler() : Topic id %u destroyed\n",msg.topic_id);
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Topic id %u destroyed\n",msg.topic_id );
 				break;
 
 			case SET_TOPIC_PROP :
@@ -312,7 +322,7 @@ static void management_handler( void )
 				
 				//Update reservation
 				if ( topic->is_producer ){
-					if ( tc_client_reserv_set( msg.topic_id, &msg.topic_addr, msg.topic_load ) ){
+					if ( tc_client_reserv_set( msg.topic_id, &msg.topic_addr, msg.topic_load, msg.topic_burst ) ){
 						fprintf(stderr,"management_handler() : ERROR UPDATING RESERVATION\n");
 						ans.op = REQ_REFUSED;
 						ans.error = ERR_RESERV_SET;
@@ -324,7 +334,7 @@ static void management_handler( void )
 				topic->channel_size = msg.channel_size;
 				topic->channel_period = msg.channel_period;
 				
-				printf("management_handler() : Updated topic id %u properties\n",msg.topic_id);
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Updated topic id %u properties\n",msg.topic_id );
 				break;
 
 			case UNBIND_TX :
@@ -341,8 +351,9 @@ static void management_handler( void )
 
 				//Unbind node from topic as producer
 				topic->is_tx_bound = 0;
+				tc_client_db_bind_signal( topic );
 	
-				printf("management_handler() : Unbound as producer from topic id %u\n",msg.topic_id);
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Unbound as producer from topic id %u\n",msg.topic_id );
 				break;
 
 			case UNBIND_RX :
@@ -359,35 +370,36 @@ static void management_handler( void )
 
 				//Unbind node from topic as consumer
 				topic->is_rx_bound = 0;
+				tc_client_db_bind_signal( topic );
 
 				//Flag as not bound as rx and unblock receive call
 				sock_send( &topic->unblock_rx_sock, &topic->unblock_rx_sock.host, "0", 5);
 
-				printf("management_handler() : Unbound as consumer from topic id %u\n",msg.topic_id);
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Unbound as consumer from topic id %u\n",msg.topic_id );
 				break;
 
 			case TC_RESERV :
 
-				if ( tc_client_reserv_add( msg.topic_id, &msg.topic_addr, msg.topic_load ) ){
+				if ( tc_client_reserv_add( msg.topic_id, &msg.topic_addr, msg.topic_load, msg.topic_burst ) ){
 					fprintf(stderr,"management_handler() : ERROR CREATING NEW RESERVATION\n");
 					ans.op = REQ_REFUSED;
 					ans.error = ERR_RESERV_ADD;
 					break;
 				}
 				
-				printf("management_handler() : Reservation ( load %u ) for topic id %u created\n",msg.topic_load,msg.topic_id);
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Reservation ( load %u burst %u ) for topic id %u created\n",msg.topic_load,msg.topic_burst,msg.topic_id );
 				break;
 
 			case TC_MODIFY :
 
-				if ( tc_client_reserv_set( msg.topic_id, &msg.topic_addr, msg.topic_load ) ){
+				if ( tc_client_reserv_set( msg.topic_id, &msg.topic_addr, msg.topic_load, msg.topic_burst ) ){
 					fprintf(stderr,"management_handler() : ERROR MODIFYING RESERVATION\n");
 					ans.op = REQ_REFUSED;
 					ans.error = ERR_RESERV_SET;
 					break;
 				}
 
-				printf("management_handler() : Reservation topic id %u updated ( new load %u )\n",msg.topic_id,msg.topic_load);
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Reservation topic id %u updated ( new load %u )\n",msg.topic_id,msg.topic_load );
 				break;
 
 			case TC_FREE :
@@ -399,7 +411,19 @@ static void management_handler( void )
 					break;
 				}
 
-				printf("management_handler() : Reservation (load %u ) of topic id %u rfreed \n",msg.topic_load,msg.topic_id);
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Reservation (load %u ) of topic id %u rfreed \n",msg.topic_load,msg.topic_id );
+				break;
+
+			case TC_POLICE :
+
+				if ( tc_client_reserv_police( msg.topic_id, &msg.topic_addr, msg.topic_load, msg.topic_burst ) ){
+					fprintf(stderr,"management_handler() : ERROR SETTING INGRESS POLICER\n");
+					ans.op = REQ_REFUSED;
+					ans.error = ERR_RESERV_SET;
+					break;
+				}
+
+				TC_LOG( LOG_CLIENT_MANAGEMENT, LOG_INFO, "management_handler() : Ingress policer ( load %u burst %u ) for topic id %u set\n",msg.topic_load,msg.topic_burst,msg.topic_id );
 				break;
 
 			default :
@@ -413,6 +437,8 @@ static void management_handler( void )
 
 		tc_network_send_msg( &ans_sock, &ans, NULL );
 
+		TC_PROBE4( client_mng_req_end, msg.op, manag_node_id, msg.topic_id, ans.error );
+
 		//Unlock topic database
 		tc_client_db_unlock();
 	}
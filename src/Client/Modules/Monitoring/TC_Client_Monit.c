@@ -39,8 +39,10 @@
 #include "TC_Error_Types.h"
 #include "Sockets.h"
 #include "TC_Utils.h"
+#include "TC_Probes.h"
 #include "TC_Config.h"
 #include "TC_Client_Discovery.h"
+#include "TC_Client_Reserv.h"
 
 /** 	@def DEBUG_MSG_CLIENT_MONIT
 *	@brief If "ENABLE_DEBUG_CLIENT_MONIT" is defined debug messages related to this module are printed
@@ -67,6 +69,9 @@ static SOCK_ENTITY sock;
 
 static void monitor( void );
 static int monitor_tick( unsigned int node_id );
+#if ENABLE_ADAPTIVE_RESERV
+static int monitor_usage( unsigned int node_id );
+#endif
 static void monitor_server( void );
 
 int tc_client_monit_init( char *ifface, unsigned int node_id, NET_ADDR *server )
@@ -206,11 +211,22 @@ static void monitor( void )
 {
 	DEBUG_MSG_CLIENT_MONIT("monitor() ...\n");
 
+#if ENABLE_ADAPTIVE_RESERV
+	unsigned int n_ticks = 0;
+#endif
+
 	pthread_mutex_lock( &monit_lock );
 
 	while ( quit == THREAD_RUN ){
 		DEBUG_MSG_CLIENT_MONIT("monitor() Sending tick of Node Id %u\n",monit_node_id);
 		monitor_tick( monit_node_id );
+#if ENABLE_ADAPTIVE_RESERV
+		//Report reservations measured load every USAGE_REPORT_PERIOD
+		if ( ++n_ticks >= USAGE_REPORT_PERIOD/HEARTBEAT_GEN_PERIOD ){
+			n_ticks = 0;
+			monitor_usage( monit_node_id );
+		}
+#endif
 		usleep(HEARTBEAT_GEN_PERIOD);
 	}
 
@@ -269,7 +285,49 @@ static int monitor_tick( unsigned int node_id )
 
 	tc_network_send_msg( &sock, &msg, NULL );
 
+	TC_PROBE1( client_heartbeat_tick, monit_node_id );
+
 	DEBUG_MSG_CLIENT_MONIT("monitor_tick() Sent node id %u heartbeat tick to server\n",node_id);
 
 	return ERR_OK;
 }
+
+#if ENABLE_ADAPTIVE_RESERV
+static int monitor_usage( unsigned int node_id )
+{
+	DEBUG_MSG_CLIENT_MONIT("monitor_usage() ...\n");
+
+	NET_MSG msg;
+	unsigned int i, n_entries;
+	unsigned int topic_ids[MAX_RESERV_ENTRIES], loads[MAX_RESERV_ENTRIES];
+
+	if ( !init ){
+		fprintf(stderr,"monitor_usage() : MODULE ISNT RUNNING\n");
+		return ERR_C_NOT_INIT;
+	}
+
+	//Sample reservations
+	if ( tc_client_reserv_get_usage( MAX_RESERV_ENTRIES, topic_ids, loads, &n_entries ) ){
+		DEBUG_MSG_CLIENT_MONIT("monitor_usage() Couldn't sample reservations usage\n");
+		return ERR_RESERV_GET;
+	}
+
+	//Send one report per reservation
+	for ( i = 0; i < n_entries; i++ ){
+		memset(&msg,0,sizeof(NET_MSG));
+
+		msg.type = REQ_MSG;
+		msg.op = TOPIC_USAGE;
+		msg.node_ids[0] = node_id;
+		msg.n_nodes = 1;
+		msg.topic_id = topic_ids[i];
+		msg.topic_load = loads[i];
+
+		tc_network_send_msg( &sock, &msg, NULL );
+
+		DEBUG_MSG_CLIENT_MONIT("monitor_usage() Sent topic id %u measured load %u [bps] to server\n",topic_ids[i],loads[i]);
+	}
+
+	return ERR_OK;
+}
+#endif
@@ -32,12 +32,17 @@
 #include <unistd.h>
 #include <pthread.h>
 #include <assert.h>
+#include <time.h>
+#include <math.h>
+#include <sys/wait.h>
 
 #include "TC_Client_Reserv.h"
 #include "TC_Error_Types.h"
 #include "Sockets.h"
 #include "TC_Data_Types.h"
 #include "TC_Utils.h"
+#include "TC_Probes.h"
+#include "TC_Log.h"
 #include "TC_Config.h"
 
 /** 	@def DEBUG_MSG_CLIENT_RESERV
@@ -52,18 +57,68 @@
 static char init = 0;
 
 static char nic_ifface[20];
+static unsigned int nic_link_bw = 0;
 static NET_ADDR server;
 
 static unsigned int reserv_node_id = 0;
 
+/**	@struct RESERV_ENTRY
+*	@brief Structure to store an active reservation usage sample and verification state
+*/
+typedef struct{
+	unsigned int topic_id;			/**< The ID of the topic. 0 if the entry is free */
+	unsigned long long sent_bytes;		/**< The class sent bytes counter on the last sample */
+	struct timespec sample_time;		/**< The time of the last sample. Zero if not sampled yet */
+
+	unsigned int rate;			/**< The reserved load (in bps) expected on the class */
+	unsigned int gen;			/**< The table generation of the last add/set of the reservation */
+	unsigned char state;			/**< The verification state (RESERV_STATE) */
+	unsigned long long drops;		/**< The class dropped packets counter on the last verification */
+	unsigned long long overlimits;		/**< The class overlimits counter on the last verification */
+	unsigned int backlog;			/**< The class queued bytes on the last verification */
+}RESERV_ENTRY;
+
+static RESERV_ENTRY reserv_table[MAX_RESERV_ENTRIES];
+static pthread_mutex_t reserv_table_lock = PTHREAD_MUTEX_INITIALIZER;
+//Incremented on every add/set/del so a verification pass ignores the changes made while it was dumping the tree
+static unsigned int reserv_table_gen = 0;
+
+#if ENABLE_RESERV_VERIFY
+/**	@struct RESERV_CLASS_DUMP
+*	@brief Structure to store a reservation class read back from the kernel tree
+*/
+typedef struct{
+	unsigned int minor;			/**< The class minor handle (1:<minor>) */
+	double rate;				/**< The class rate (in bps) */
+	unsigned long long drops;		/**< The class dropped packets counter */
+	unsigned long long overlimits;		/**< The class overlimits counter */
+	unsigned int backlog;			/**< The class queued bytes */
+}RESERV_CLASS_DUMP;
+
+static char verify_quit = 0;
+static pthread_t verify_thread_id;
+static pthread_mutex_t verify_lock;
+
+static unsigned int verify_n_unexpected = 0;
+static unsigned int verify_missing_base = 0;
+static char verify_dump_failed = 0;
+
+static void reserv_verify( void );
+static void reserv_verify_tree( void );
+static int reserv_verify_classes( RESERV_CLASS_DUMP *ret_classes, unsigned int max_classes, unsigned int *ret_n_classes );
+static int reserv_verify_filters( unsigned int *ret_handles, unsigned int max_handles, unsigned int *ret_n_handles );
+#endif
+
 static int reserv_startup( void );
 static int reserv_closeup( void );
 
 static int tc_client_reserv_qdisc( TC_CONFIG *request );
 static int tc_client_reserv_class( TC_CONFIG *request );
 static int tc_client_reserv_filter( TC_CONFIG *request );
+static int tc_client_reserv_exec( char object, char operation, char *command );
+static int tc_client_reserv_classes_sent( unsigned int *ret_minors, unsigned long long *ret_sent_bytes, unsigned int max_classes, unsigned int *ret_n_classes );
 
-int tc_client_reserv_init( char *ifface, unsigned int node_id, NET_ADDR *server_addr )
+int tc_client_reserv_init( char *ifface, unsigned int link_bw, unsigned int node_id, NET_ADDR *server_addr )
 {
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_init() ...\n");
 
@@ -73,11 +128,13 @@ int tc_client_reserv_init( char *ifface, unsigned int node_id, NET_ADDR *server_
 	}
 
 	assert( ifface );
+	assert( link_bw );
 	assert( node_id );
 	assert( server_addr );
 
-	//Store NIC interface and server address	
+	//Store NIC interface, NIC bandwidth and server address	
 	strcpy(nic_ifface, ifface);
+	nic_link_bw = link_bw;
 	strcpy(server.name_ip,server_addr->name_ip);
 	server.port = server_addr->port;
 
@@ -87,6 +144,21 @@ int tc_client_reserv_init( char *ifface, unsigned int node_id, NET_ADDR *server_
 		return ERR_TC_INIT;
 	}
 
+	memset(reserv_table,0,sizeof(reserv_table));
+
+#if ENABLE_RESERV_VERIFY
+	verify_n_unexpected = 0;
+	verify_missing_base = 0;
+	verify_dump_failed = 0;
+
+	//Start kernel tree verification thread
+	if ( tc_thread_create( reserv_verify, &verify_thread_id, &verify_quit, &verify_lock, 100 ) ){
+		fprintf(stderr,"tc_client_reserv_init() : ERROR CREATING VERIFICATION THREAD\n");
+		reserv_closeup();
+		return ERR_THREAD_CREATE;
+	}
+#endif
+
 	reserv_node_id = node_id;
 	init = 1;
 	
@@ -104,6 +176,14 @@ int tc_client_reserv_close( void )
 		return ERR_C_NOT_INIT;
 	}
 
+#if ENABLE_RESERV_VERIFY
+	//Stop kernel tree verification thread
+	if ( tc_thread_destroy( &verify_thread_id, &verify_quit, &verify_lock, 100 ) ){
+		fprintf(stderr,"tc_client_reserv_close() : ERROR DESTROYING VERIFICATION THREAD\n");
+		return ERR_THREAD_DESTROY;
+	}
+#endif
+
 	//Free all reservations
 	if ( reserv_closeup() ){
 		fprintf(stderr,"tc_client_reserv_close() : ERROR FREEIN ALL RESERVATIONS\n");
@@ -112,16 +192,18 @@ int tc_client_reserv_close( void )
 
 	init = 0;
 	reserv_node_id = 0;
+	nic_link_bw = 0;
 
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_close() Reservation module closed\n");
 
 	return ERR_OK;
 }
 
-int tc_client_reserv_add( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load )
+int tc_client_reserv_add( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load, unsigned int req_burst )
 {
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_add() Topic ID %u ...\n",topic_id);
 
+	int i;
 	TC_CONFIG tc_reserv;
 
 	if ( !init ){
@@ -140,6 +222,8 @@ int tc_client_reserv_add( unsigned int topic_id, NET_ADDR *topic_addr, unsigned
 	strcpy(tc_reserv.parent_handle,"1:997");
 	sprintf(tc_reserv.class_id,"1:%d",topic_id); 
 	tc_reserv.ceil = tc_reserv.rate = req_load;//Ceil = rate -> This disables borrowing bandwidth from other classes 
+	//Burst = cburst = one full size message -> Messages within contract leave at line rate instead of being throttled
+	tc_reserv.cburst = tc_reserv.burst = ( req_burst > MIN_RESERV_BURST ) ? req_burst : MIN_RESERV_BURST;
 	tc_reserv.prio = 2;
 
 	if ( tc_client_reserv_class( &tc_reserv ) ){
@@ -178,16 +262,34 @@ int tc_client_reserv_add( unsigned int topic_id, NET_ADDR *topic_addr, unsigned
 		fprintf(stderr,"tc_client_reserv_add() : ERROR CREATING NEW TC FILTER FOR TOPIC ID %u\n",topic_id);
 		return ERR_RESERV_ADD;
 	}
+
+	//Track reservation usage
+	pthread_mutex_lock( &reserv_table_lock );
+	for ( i = 0; i < MAX_RESERV_ENTRIES; i++ ){
+		if ( !reserv_table[i].topic_id ){
+			memset(&reserv_table[i],0,sizeof(RESERV_ENTRY));
+			reserv_table[i].topic_id = topic_id;
+			reserv_table[i].rate = req_load;
+			reserv_table[i].gen = ++reserv_table_gen;
+			reserv_table[i].state = TC_RESERV_UNVERIFIED;
+			break;
+		}
+	}
+	pthread_mutex_unlock( &reserv_table_lock );
+
+	if ( i == MAX_RESERV_ENTRIES )
+		DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_add() Reservation table full -- Topic ID %u usage will not be reported or verified\n",topic_id);
 	
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_add() New reservation for Topic ID %u created\n",topic_id);
 			
 	return ERR_OK;
 }
 
-int tc_client_reserv_set( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load )
+int tc_client_reserv_set( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load, unsigned int req_burst )
 {
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_set() Topic ID %u...\n",topic_id);
 
+	int i;
 	TC_CONFIG tc_reserv;
 
 	if ( !init ){
@@ -206,12 +308,23 @@ int tc_client_reserv_set( unsigned int topic_id, NET_ADDR *topic_addr, unsigned
 	strcpy(tc_reserv.parent_handle,"1:997");
 	sprintf(tc_reserv.class_id,"1:%d",topic_id);  
 	tc_reserv.ceil = tc_reserv.rate = req_load; 
+	tc_reserv.cburst = tc_reserv.burst = ( req_burst > MIN_RESERV_BURST ) ? req_burst : MIN_RESERV_BURST;
 	tc_reserv.prio = 2;
 
 	if ( tc_client_reserv_class( &tc_reserv ) ){
 		fprintf(stderr,"tc_client_reserv_set() : ERROR UPDATING TC CLASS OF TOPIC ID %u\n",topic_id);
 		return ERR_RESERV_SET;
 	}
+
+	//Update the rate expected by the verification
+	pthread_mutex_lock( &reserv_table_lock );
+	for ( i = 0; i < MAX_RESERV_ENTRIES; i++ ){
+		if ( reserv_table[i].topic_id == topic_id ){
+			reserv_table[i].rate = req_load;
+			reserv_table[i].gen = ++reserv_table_gen;
+		}
+	}
+	pthread_mutex_unlock( &reserv_table_lock );
 	
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_set() Reservation of Topic ID %u modified\n",topic_id);
 			
@@ -222,6 +335,7 @@ int tc_client_reserv_del( unsigned int topic_id, NET_ADDR *topic_addr, unsigned
 {
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_del() ...\n");
 
+	int i;
 	TC_CONFIG tc_reserv;
 
 	if ( !init ){
@@ -233,6 +347,15 @@ int tc_client_reserv_del( unsigned int topic_id, NET_ADDR *topic_addr, unsigned
 	assert( topic_addr );
 	assert( req_load );
 
+	//Stop tracking reservation usage
+	pthread_mutex_lock( &reserv_table_lock );
+	for ( i = 0; i < MAX_RESERV_ENTRIES; i++ ){
+		if ( reserv_table[i].topic_id == topic_id )
+			reserv_table[i].topic_id = 0;
+	}
+	reserv_table_gen++;
+	pthread_mutex_unlock( &reserv_table_lock );
+
 	//Set TC parameters for filter
 	memset(&tc_reserv,0,sizeof(tc_reserv));
 
@@ -270,6 +393,210 @@ int tc_client_reserv_del( unsigned int topic_id, NET_ADDR *topic_addr, unsigned
 	return ERR_OK;
 }
 
+int tc_client_reserv_police( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load, unsigned int req_burst )
+{
+	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_police() Topic ID %u ...\n",topic_id);
+
+	TC_CONFIG tc_reserv;
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_reserv_police() : MODULE ISNT RUNNING\n");
+		return ERR_C_NOT_INIT;
+	} 
+	
+	assert( topic_id );
+	assert( topic_addr );
+
+#if ENABLE_INGRESS_POLICING
+	//Set TC parameters for ingress filter
+	memset(&tc_reserv,0,sizeof(tc_reserv));
+
+	strcpy(tc_reserv.parent_handle,"ffff:");
+	//All ingress filters are created under root handle 800:: of the ingress qdisc
+	sprintf(tc_reserv.handle,"800::%d",topic_id); 
+	sprintf(tc_reserv.flow_id,":1"); 
+	strcpy(tc_reserv.protocol,"ip");
+	strcpy(tc_reserv.dst_ip,topic_addr->name_ip);
+	tc_reserv.port = topic_addr->port;
+	tc_reserv.prio = 1;
+
+	if ( req_load ){
+		//Replace creates the policer if it doesn't exist yet
+		tc_reserv.operation = 'R';
+		tc_reserv.police_rate = req_load;
+		tc_reserv.police_burst = ( req_burst > MIN_RESERV_BURST ) ? req_burst : MIN_RESERV_BURST;
+	}else{
+		tc_reserv.operation = 'D';
+	}
+
+	if ( tc_client_reserv_filter( &tc_reserv ) ){
+		fprintf(stderr,"tc_client_reserv_police() : ERROR CONFIGURING INGRESS POLICER OF TOPIC ID %u\n",topic_id);
+		return ERR_RESERV_SET;
+	}
+
+	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_police() Policer of Topic ID %u set to %u bps\n",topic_id,req_load);
+#else
+	(void)tc_reserv; (void)req_load; (void)req_burst;
+#endif
+			
+	return ERR_OK;
+}
+
+int tc_client_reserv_get_usage( unsigned int max_entries, unsigned int *ret_topic_ids, unsigned int *ret_loads, unsigned int *ret_n_entries )
+{
+	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_get_usage() ...\n");
+
+	unsigned int minors[2*MAX_RESERV_ENTRIES];
+	unsigned long long sent_bytes[2*MAX_RESERV_ENTRIES];
+	int i, j;
+	unsigned int n = 0, n_classes = 0;
+	double elapsed;
+	struct timespec now;
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_reserv_get_usage() : MODULE ISNT RUNNING\n");
+		return ERR_C_NOT_INIT;
+	} 
+
+	assert( ret_topic_ids );
+	assert( ret_loads );
+	assert( ret_n_entries );
+
+	//Sample all the reservation classes with a single dump (instead of one tc execution per topic)
+	if ( tc_client_reserv_classes_sent( minors, sent_bytes, 2*MAX_RESERV_ENTRIES, &n_classes ) ){
+		*ret_n_entries = 0;
+		return ERR_RESERV_GET;
+	}
+
+	clock_gettime( CLOCK_MONOTONIC, &now );
+
+	pthread_mutex_lock( &reserv_table_lock );
+
+	for ( i = 0; (i < MAX_RESERV_ENTRIES) && (n < max_entries); i++ ){
+
+		if ( !reserv_table[i].topic_id )
+			continue;
+
+		for ( j = 0; j < n_classes; j++ ){
+			if ( minors[j] == reserv_table[i].topic_id )
+				break;
+		}
+
+		if ( j == n_classes ){
+			DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_get_usage(): No statistics for Topic ID %u class\n",reserv_table[i].topic_id);
+			continue;
+		}
+
+		//First sample only sets the reference
+		if ( reserv_table[i].sample_time.tv_sec || reserv_table[i].sample_time.tv_nsec ){
+
+			elapsed = (now.tv_sec - reserv_table[i].sample_time.tv_sec) + (now.tv_nsec - reserv_table[i].sample_time.tv_nsec) / 1e9;
+
+			if ( (elapsed > 0) && (sent_bytes[j] >= reserv_table[i].sent_bytes) ){
+				ret_topic_ids[n] = reserv_table[i].topic_id;
+				ret_loads[n] = ((sent_bytes[j] - reserv_table[i].sent_bytes) * 8) / elapsed;
+				n++;
+			}
+		}
+
+		reserv_table[i].sent_bytes = sent_bytes[j];
+		reserv_table[i].sample_time = now;
+	}
+
+	pthread_mutex_unlock( &reserv_table_lock );
+
+	*ret_n_entries = n;
+
+	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_get_usage() Sampled %u reservations\n",n);
+
+	return ERR_OK;
+}
+
+int tc_client_reserv_get_status( unsigned int topic_id, unsigned char *ret_state, unsigned long long *ret_drops, unsigned long long *ret_overlimits, unsigned int *ret_backlog )
+{
+	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_get_status() Topic ID %u ...\n",topic_id);
+
+	int i;
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_reserv_get_status() : MODULE ISNT RUNNING\n");
+		return ERR_C_NOT_INIT;
+	} 
+
+	assert( topic_id );
+	assert( ret_state );
+	assert( ret_drops );
+	assert( ret_overlimits );
+	assert( ret_backlog );
+
+	pthread_mutex_lock( &reserv_table_lock );
+
+	for ( i = 0; i < MAX_RESERV_ENTRIES; i++ ){
+		if ( reserv_table[i].topic_id == topic_id ){
+			*ret_state = reserv_table[i].state;
+			*ret_drops = reserv_table[i].drops;
+			*ret_overlimits = reserv_table[i].overlimits;
+			*ret_backlog = reserv_table[i].backlog;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock( &reserv_table_lock );
+
+	if ( i == MAX_RESERV_ENTRIES ){
+		DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_get_status() No reservation of Topic ID %u in this node\n",topic_id);
+		return ERR_RESERV_GET;
+	}
+
+	return ERR_OK;
+}
+
+static int tc_client_reserv_classes_sent( unsigned int *ret_minors, unsigned long long *ret_sent_bytes, unsigned int max_classes, unsigned int *ret_n_classes )
+{
+	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_classes_sent() ...\n");
+
+	FILE *fp;
+	char command[200];
+	char line[512];
+	unsigned int minor, parent;
+	char pending = 0;
+
+	assert( ret_minors );
+	assert( ret_sent_bytes );
+	assert( ret_n_classes );
+
+	*ret_n_classes = 0;
+
+	sprintf(command,"tc -s class show dev %s 2>/dev/null",nic_ifface);
+
+	if ( !(fp = popen(command,"r")) ){
+		fprintf(stderr,"tc_client_reserv_classes_sent(): ERROR EXECUTING TC\n");
+		return ERR_RESERV_GET;
+	}
+
+	//Each class is printed as "class htb 1:<minor> parent 1:997 ..." followed by " Sent <bytes> bytes <pkts> pkt ..."
+	while ( fgets(line, sizeof(line), fp) ){
+
+		if ( sscanf(line,"class htb 1:%u parent 1:%u",&minor,&parent) == 2 ){
+			pending = (parent == 997) && (*ret_n_classes < max_classes);
+			if ( pending )
+				ret_minors[*ret_n_classes] = minor;
+
+		}else if ( pending && (sscanf(line," Sent %llu bytes",&ret_sent_bytes[*ret_n_classes]) == 1) ){
+			(*ret_n_classes)++;
+			pending = 0;
+		}
+	}
+
+	//tc fails if the device or the root qdisc are gone
+	if ( pclose(fp) ){
+		DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_classes_sent(): TC class dump failed\n");
+		return ERR_RESERV_GET;
+	}
+
+	return ERR_OK;
+}
+
 static int reserv_startup( void )
 {
 	DEBUG_MSG_CLIENT_RESERV("reserv_startup() ... \n");
@@ -280,55 +607,63 @@ static int reserv_startup( void )
 	//Create root qdisc attached to NIC -> redirects non-classified traffic to class 1:999
 	sprintf(aux, "tc qdisc add dev %s root handle 1: htb default 999", nic_ifface);
 
-	DEBUG_MSG_CLIENT_RESERV("reserv_startup() : Going to execute %s\n",aux);
-
-	if( system(aux) < 0 ){
+	//Fails if a root qdisc is already attached (E.g. a tree left behind by a crashed client)
+	if( tc_client_reserv_exec( 'q', 'A', aux ) ){
 		fprintf(stderr,"reserv_startup() : ERROR CREATING ROOT QDISC !\n");
 		return -1;
 	}
 
-	//Add root class -> required so that each children class can borrow bandwith (if desired)
-	sprintf(aux, "tc class add dev %s parent 1: classid 1:997 htb rate %dMbit ceil %dMbit prio 0", nic_ifface,ROOT_BW,ROOT_BW);
+	//From here on a failure removes the partial tree so the next initialization can create it again
 
-	DEBUG_MSG_CLIENT_RESERV("reserv_startup() : Going to execute %s\n",aux);
+	//Add root class -> required so that each children class can borrow bandwith (if desired)
+	sprintf(aux, "tc class add dev %s parent 1: classid 1:997 htb rate %uMbit ceil %uMbit prio 0", nic_ifface,nic_link_bw,nic_link_bw);
 
-	if( system(aux) < 0 ){
+	if( tc_client_reserv_exec( 'c', 'A', aux ) ){
 		fprintf(stderr,"reserv_startup() : ERROR ADDING ROOT CLASS !\n");
+		reserv_closeup();
 		return -2;
 	}
 
-	//Create class for background traffic
-	sprintf(aux, "tc class add dev %s parent 1:997 classid 1:999 htb rate %dMbit ceil %dMbit prio 7", nic_ifface,BACKGROUND_BW,BACKGROUND_BW);
-
-	DEBUG_MSG_CLIENT_RESERV("reserv_startup() : Going to execute %s\n",aux);
+	//Create class for background traffic ( shares are set in kbit so small shares of slow NICs aren't rounded to 0 )
+	sprintf(aux, "tc class add dev %s parent 1:997 classid 1:999 htb rate %ukbit ceil %ukbit prio 7", nic_ifface,nic_link_bw*10*BACKGROUND_BW_SHARE,nic_link_bw*10*BACKGROUND_BW_SHARE);
 
-	if( system(aux) < 0 ){
+	if( tc_client_reserv_exec( 'c', 'A', aux ) ){
 		fprintf(stderr,"reserv_startup() : ERROR CREATING BACKGROUND TC CLASS !\n");
+		reserv_closeup();
 		return -3;
 	}
 
 	//Create class and filter for server control traffic only if server is remote (port != 0)
 	if ( server.port ){
 		//Create class for control traffic
-		sprintf(aux, "tc class add dev %s parent 1:997 classid 1:998 htb rate %dMbit ceil %dMbit prio 1", nic_ifface,CONTROL_BW,CONTROL_BW);
+		sprintf(aux, "tc class add dev %s parent 1:997 classid 1:998 htb rate %ukbit ceil %ukbit prio 1", nic_ifface,nic_link_bw*10*CONTROL_BW_SHARE,nic_link_bw*10*CONTROL_BW_SHARE);
 
-		DEBUG_MSG_CLIENT_RESERV("reserv_startup() : Going to execute %s\n",aux);
-
-		if( system(aux) < 0 ){
+		if( tc_client_reserv_exec( 'c', 'A', aux ) ){
 			fprintf(stderr,"reserv_startup() : ERROR CREATING CONTROL CLASS !\n");
+			reserv_closeup();
 			return -4;
 		}
 	
 		//Create filter for control traffic
 		sprintf(aux, "tc filter add dev %s protocol ip parent 1:0 prio 1 u32 match ip dst %s flowid 1:998", nic_ifface, server.name_ip);
 
-		DEBUG_MSG_CLIENT_RESERV("reserv_startup() : Going to execute %s\n",aux);
+		if( tc_client_reserv_exec( 'f', 'A', aux ) ){
+			fprintf(stderr,"reserv_startup() : ERROR CREATING CONTROL FILTER !\n");
+			reserv_closeup();
+			return -5;
+		}
 	}
 
-	if( system(aux) < 0 ){
-		fprintf(stderr,"reserv_startup() : ERROR CREATING CONTROL FILTER !\n");
-		return -5;
+#if ENABLE_INGRESS_POLICING
+	//Create ingress qdisc -> holds the topics policers (consumer side)
+	sprintf(aux, "tc qdisc add dev %s handle ffff: ingress", nic_ifface);
+
+	if( tc_client_reserv_exec( 'q', 'A', aux ) ){
+		fprintf(stderr,"reserv_startup() : ERROR CREATING INGRESS QDISC !\n");
+		reserv_closeup();
+		return -6;
 	}
+#endif
 
 	DEBUG_MSG_CLIENT_RESERV("reserv_startup() Traffic Control tree configured\n");
 
@@ -344,13 +679,21 @@ static int reserv_closeup( void )
 	//Delete root qdisc (should delete all the leafs and branches too)
 	sprintf(aux, "tc qdisc del dev %s root handle 1: htb", nic_ifface);
 
-	DEBUG_MSG_CLIENT_RESERV("reserv_closeup() : Going to execute %s\n",aux);
-
-	if( system(aux) < 0 ){
+	if( tc_client_reserv_exec( 'q', 'D', aux ) ){
 		fprintf(stderr,"reserv_closeup() : ERROR DELETING ROOT QDISC !\n");
 		return -1;
 	}
 
+#if ENABLE_INGRESS_POLICING
+	//Delete ingress qdisc (and all the policers)
+	sprintf(aux, "tc qdisc del dev %s ingress", nic_ifface);
+
+	if( tc_client_reserv_exec( 'q', 'D', aux ) ){
+		fprintf(stderr,"reserv_closeup() : ERROR DELETING INGRESS QDISC !\n");
+		return -2;
+	}
+#endif
+
 	DEBUG_MSG_CLIENT_RESERV("reserv_closeup() : Traffic Control tree deleted\n");
 
 	return ERR_OK;
@@ -425,7 +768,7 @@ static int tc_client_reserv_qdisc( TC_CONFIG *request )
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_qdisc(): Going to execute \"%s\" \n",command); 
 
 	//Execute command 
-	if( system(command) < 0 ){
+	if( tc_client_reserv_exec( 'q', request->operation, command ) ){
 		fprintf(stderr,"tc_client_reserv_qdisc(): ERROR CONFIGURING TC\n");
 		return -3;
 	}
@@ -487,16 +830,16 @@ static int tc_client_reserv_class( TC_CONFIG *request )
 	}
 
 	//Add rate parameter
-	if( request->rate <= 0 ){
+	if( !request->rate ){
 		fprintf(stderr,"tc_client_reserv_class(): INVALID RATE\n");
 		return -3;
 	}
-	sprintf(aux, " htb rate %dbit", request->rate);
+	sprintf(aux, " htb rate %ubit", request->rate);
 	strcat(command, aux);
 
 	//Add ceil parameter -> optional
-	if( request->ceil > 0){
-		sprintf(aux, " ceil %dbit", request->ceil);
+	if( request->ceil ){
+		sprintf(aux, " ceil %ubit", request->ceil);
 		strcat(command, aux);
 	}
 
@@ -521,7 +864,7 @@ static int tc_client_reserv_class( TC_CONFIG *request )
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_class(): Going to execute \"%s\" \n",command); 
 
 	//Execute command 
-	if( system(command) < 0 ){
+	if( tc_client_reserv_exec( 'c', request->operation, command ) ){
 		fprintf(stderr,"tc_client_reserv_class(): ERROR CONFIGURING TC\n");
 		return -4;
 	}
@@ -610,6 +953,12 @@ static int tc_client_reserv_filter( TC_CONFIG *request )
 		sprintf(aux, " match ip dst %s", request->dst_ip);
 		strcat(command, aux);
 
+		//Add policer parameters -> optional
+		if( request->police_rate ){
+			sprintf(aux, " police rate %ubit burst %d drop", request->police_rate, request->police_burst);
+			strcat(command, aux);
+		}
+
 		//Add flow id parameter
 		if( !strcmp(request->flow_id, "\0") ){
 			fprintf(stderr,"tc_client_reserv_filter(): INVALID FLOW ID\n");
@@ -622,7 +971,7 @@ static int tc_client_reserv_filter( TC_CONFIG *request )
 	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_filter(): Going to execute \"%s\" \n",command); 
 
 	//Execute command 
-	if( system(command) < 0 ){
+	if( tc_client_reserv_exec( 'f', request->operation, command ) ){
 		fprintf(stderr,"tc_client_reserv_filter(): ERROR CONFIGURING TC\n");
 		return -7;
 	}
@@ -631,3 +980,321 @@ static int tc_client_reserv_filter( TC_CONFIG *request )
 
 	return ERR_OK;
 }
+
+static int tc_client_reserv_exec( char object, char operation, char *command )
+{
+	DEBUG_MSG_CLIENT_RESERV("tc_client_reserv_exec(): Going to execute \"%s\" \n",command);
+
+	int ret;
+
+	assert( command );
+
+	TC_PROBE3( client_tc_cmd_start, object, operation, command );
+	ret = system(command);
+	TC_PROBE3( client_tc_cmd_end, object, operation, ret );
+
+	if( ret < 0 || !WIFEXITED(ret) ){
+		fprintf(stderr,"tc_client_reserv_exec(): ERROR EXECUTING TC\n");
+		return -1;
+	}
+
+	//system() only fails if the shell can't run -> tc errors are reported in the exit status
+	if( WEXITSTATUS(ret) ){
+		if ( operation != 'D' ){
+			fprintf(stderr,"tc_client_reserv_exec(): \"%s\" FAILED WITH EXIT STATUS %d\n",command,WEXITSTATUS(ret));
+			return -2;
+		}
+		//Deleting an object which is already gone leaves the tree as wanted
+		TC_LOG( LOG_CLIENT_RESERV, LOG_WARN, "tc_client_reserv_exec(): \"%s\" exited with status %d\n",command,WEXITSTATUS(ret) );
+	}
+
+	return ERR_OK;
+}
+
+#if ENABLE_RESERV_VERIFY
+static void reserv_verify( void )
+{
+	DEBUG_MSG_CLIENT_RESERV("reserv_verify() ...\n");
+
+	unsigned int n_ticks = 0;
+	int old_state;
+
+	pthread_mutex_lock( &verify_lock );
+
+	while ( verify_quit == THREAD_RUN ){
+
+		usleep(HEARTBEAT_GEN_PERIOD);
+
+		if ( ++n_ticks < RESERV_VERIFY_PERIOD/HEARTBEAT_GEN_PERIOD )
+			continue;
+		n_ticks = 0;
+
+		//Don't let the thread be canceled with the pipes open or the table locked
+		pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, &old_state );
+		reserv_verify_tree();
+		pthread_setcancelstate( old_state, NULL );
+	}
+
+	pthread_mutex_unlock( &verify_lock );
+
+	DEBUG_MSG_CLIENT_RESERV("reserv_verify() Verification thread ending\n");
+
+	pthread_exit(NULL);
+}
+
+static void reserv_verify_tree( void )
+{
+	DEBUG_MSG_CLIENT_RESERV("reserv_verify_tree() ...\n");
+
+	//Root, control and background classes (bit i of the missing mask)
+	static const unsigned int base_classes[] = { 997, 998, 999 };
+	static RESERV_CLASS_DUMP classes[2*MAX_RESERV_ENTRIES];
+	static unsigned int handles[2*MAX_RESERV_ENTRIES];
+	unsigned int n_classes = 0, n_handles = 0, n_unexpected = 0, unexpected_minor = 0, missing = 0;
+	unsigned int gen;
+	unsigned char state;
+	RESERV_CLASS_DUMP *class;
+	int i, j;
+
+	//Changes made after this point are only verified on the next pass
+	pthread_mutex_lock( &reserv_table_lock );
+	gen = reserv_table_gen;
+	pthread_mutex_unlock( &reserv_table_lock );
+
+	if ( reserv_verify_classes( classes, 2*MAX_RESERV_ENTRIES, &n_classes ) || reserv_verify_filters( handles, 2*MAX_RESERV_ENTRIES, &n_handles ) ){
+		if ( !verify_dump_failed )
+			TC_LOG( LOG_CLIENT_RESERV, LOG_WARN, "reserv_verify_tree() : Unable to read the traffic control tree of %s\n",nic_ifface );
+		verify_dump_failed = 1;
+		return;
+	}
+	verify_dump_failed = 0;
+
+	//The control class only exists if the server is remote
+	for ( i = 0; i < sizeof(base_classes)/sizeof(base_classes[0]); i++ ){
+
+		if ( (base_classes[i] == 998) && !server.port )
+			continue;
+
+		for ( j = 0; j < n_classes; j++ ){
+			if ( classes[j].minor == base_classes[i] )
+				break;
+		}
+
+		if ( j == n_classes )
+			missing |= 1 << i;
+	}
+
+	//Report only state changes
+	for ( i = 0; i < sizeof(base_classes)/sizeof(base_classes[0]); i++ ){
+		if ( (missing & ~verify_missing_base) & (1 << i) )
+			TC_LOG( LOG_CLIENT_RESERV, LOG_WARN, "reserv_verify_tree() : Class 1:%u missing from %s\n",base_classes[i],nic_ifface );
+		else if ( (verify_missing_base & ~missing) & (1 << i) )
+			TC_LOG( LOG_CLIENT_RESERV, LOG_INFO, "reserv_verify_tree() : Class 1:%u is back on %s\n",base_classes[i],nic_ifface );
+	}
+	verify_missing_base = missing;
+
+	pthread_mutex_lock( &reserv_table_lock );
+
+	for ( i = 0; i < MAX_RESERV_ENTRIES; i++ ){
+
+		if ( !reserv_table[i].topic_id || reserv_table[i].gen > gen )
+			continue;
+
+		for ( j = 0, class = NULL; j < n_classes; j++ ){
+			if ( classes[j].minor == reserv_table[i].topic_id ){
+				class = &classes[j];
+				break;
+			}
+		}
+
+		for ( j = 0; j < n_handles; j++ ){
+			if ( handles[j] == reserv_table[i].topic_id )
+				break;
+		}
+
+		if ( !class ){
+			state = TC_RESERV_NO_CLASS;
+		}else{
+			reserv_table[i].drops = class->drops;
+			reserv_table[i].overlimits = class->overlimits;
+			reserv_table[i].backlog = class->backlog;
+
+			if ( j == n_handles )
+				state = TC_RESERV_NO_FILTER;
+			else if ( fabs( class->rate - reserv_table[i].rate ) > RESERV_VERIFY_RATE_TOLERANCE * reserv_table[i].rate )
+				state = TC_RESERV_RATE_MISMATCH;
+			else
+				state = TC_RESERV_OK;
+		}
+
+		if ( state == reserv_table[i].state )
+			continue;
+
+		//Report only state changes
+		switch ( state ){
+			case TC_RESERV_NO_CLASS:
+				TC_LOG( LOG_CLIENT_RESERV, LOG_WARN, "reserv_verify_tree() : Class 1:%u of Topic ID %u missing from %s\n",reserv_table[i].topic_id,reserv_table[i].topic_id,nic_ifface );
+				break;
+			case TC_RESERV_NO_FILTER:
+				TC_LOG( LOG_CLIENT_RESERV, LOG_WARN, "reserv_verify_tree() : Filter 800::%u of Topic ID %u missing from %s\n",reserv_table[i].topic_id,reserv_table[i].topic_id,nic_ifface );
+				break;
+			case TC_RESERV_RATE_MISMATCH:
+				TC_LOG( LOG_CLIENT_RESERV, LOG_WARN, "reserv_verify_tree() : Class 1:%u of Topic ID %u rate is %.0f bps instead of %u bps\n",reserv_table[i].topic_id,reserv_table[i].topic_id,class->rate,reserv_table[i].rate );
+				break;
+			default:
+				if ( reserv_table[i].state != TC_RESERV_UNVERIFIED )
+					TC_LOG( LOG_CLIENT_RESERV, LOG_INFO, "reserv_verify_tree() : Reservation of Topic ID %u matches the kernel tree again\n",reserv_table[i].topic_id );
+				break;
+		}
+
+		reserv_table[i].state = state;
+	}
+
+	//Classes under the root class that aren't the background, control or an active reservation class
+	//(skipped if the table changed during the dump -> a just deleted reservation would be reported)
+	if ( gen == reserv_table_gen ){
+		for ( j = 0; j < n_classes; j++ ){
+
+			if ( classes[j].minor == 997 || classes[j].minor == 998 || classes[j].minor == 999 )
+				continue;
+
+			for ( i = 0; i < MAX_RESERV_ENTRIES; i++ ){
+				if ( reserv_table[i].topic_id == classes[j].minor )
+					break;
+			}
+
+			if ( i == MAX_RESERV_ENTRIES ){
+				n_unexpected++;
+				unexpected_minor = classes[j].minor;
+			}
+		}
+
+		if ( n_unexpected != verify_n_unexpected ){
+			if ( n_unexpected )
+				TC_LOG( LOG_CLIENT_RESERV, LOG_WARN, "reserv_verify_tree() : %u unexpected classes under 1:997 of %s (E.g. 1:%u)\n",n_unexpected,nic_ifface,unexpected_minor );
+			verify_n_unexpected = n_unexpected;
+		}
+	}
+
+	pthread_mutex_unlock( &reserv_table_lock );
+
+	DEBUG_MSG_CLIENT_RESERV("reserv_verify_tree() Verified %u classes and %u filters\n",n_classes,n_handles);
+}
+
+static int reserv_verify_classes( RESERV_CLASS_DUMP *ret_classes, unsigned int max_classes, unsigned int *ret_n_classes )
+{
+	DEBUG_MSG_CLIENT_RESERV("reserv_verify_classes() ...\n");
+
+	FILE *fp;
+	char command[200];
+	char line[512];
+	char unit[16];
+	char *aux;
+	double value;
+	unsigned int minor, parent;
+	RESERV_CLASS_DUMP *class = NULL;
+
+	assert( ret_classes );
+	assert( ret_n_classes );
+
+	*ret_n_classes = 0;
+
+	sprintf(command,"tc -s class show dev %s 2>/dev/null",nic_ifface);
+
+	if ( !(fp = popen(command,"r")) ){
+		fprintf(stderr,"reserv_verify_classes(): ERROR EXECUTING TC\n");
+		return ERR_RESERV_GET;
+	}
+
+	//Each class is printed as :
+	//"class htb 1:<minor> parent 1:997 leaf <handle> prio <prio> rate <rate><unit> ceil ..." (root class : "class htb 1:997 root rate ...")
+	//" Sent <bytes> bytes <pkts> pkt (dropped <drops>, overlimits <overlimits> requeues <requeues>)"
+	//" backlog <bytes><unit> <pkts>p requeues <requeues>"
+	while ( fgets(line, sizeof(line), fp) ){
+
+		if ( sscanf(line,"class htb 1:%u",&minor) == 1 ){
+
+			class = NULL;
+
+			//The root class itself is kept with the classes under it (checked as a base class)
+			if ( strstr(line," root ") )
+				parent = ( minor == 997 ) ? 997 : 0;
+			else if ( !(aux = strstr(line," parent 1:")) || (sscanf(aux," parent 1:%u",&parent) != 1) )
+				continue;
+
+			if ( (parent != 997) || (*ret_n_classes == max_classes) )
+				continue;
+
+			class = &ret_classes[(*ret_n_classes)++];
+			memset(class,0,sizeof(RESERV_CLASS_DUMP));
+			class->minor = minor;
+
+			//Rates are printed in decimal units (Kbit = 1000 bit)
+			if ( (aux = strstr(line," rate ")) && (sscanf(aux," rate %lf%15s",&value,unit) == 2) ){
+				switch ( unit[0] ){
+					case 'K': value *= 1e3; break;
+					case 'M': value *= 1e6; break;
+					case 'G': value *= 1e9; break;
+				}
+				class->rate = value;
+			}
+
+		}else if ( class && (aux = strstr(line,"(dropped ")) ){
+			sscanf(aux,"(dropped %llu, overlimits %llu",&class->drops,&class->overlimits);
+
+		}else if ( class && (sscanf(line," backlog %lf%15s",&value,unit) == 2) ){
+			//Sizes are printed in binary units (Kb = 1024 bytes)
+			switch ( unit[0] ){
+				case 'K': value *= 1024; break;
+				case 'M': value *= 1024*1024; break;
+			}
+			class->backlog = value;
+			class = NULL;
+		}
+	}
+
+	//tc fails if the device or the root qdisc are gone
+	if ( pclose(fp) ){
+		DEBUG_MSG_CLIENT_RESERV("reserv_verify_classes(): TC class dump failed\n");
+		return ERR_RESERV_GET;
+	}
+
+	return ERR_OK;
+}
+
+static int reserv_verify_filters( unsigned int *ret_handles, unsigned int max_handles, unsigned int *ret_n_handles )
+{
+	DEBUG_MSG_CLIENT_RESERV("reserv_verify_filters() ...\n");
+
+	FILE *fp;
+	char command[200];
+	char line[512];
+	char *aux;
+	unsigned int handle;
+
+	assert( ret_handles );
+	assert( ret_n_handles );
+
+	*ret_n_handles = 0;
+
+	sprintf(command,"tc filter show dev %s parent 1: 2>/dev/null",nic_ifface);
+
+	if ( !(fp = popen(command,"r")) ){
+		fprintf(stderr,"reserv_verify_filters(): ERROR EXECUTING TC\n");
+		return ERR_RESERV_GET;
+	}
+
+	//Reservation filters are printed as "filter parent 1: protocol ip pref 1 u32 ... fh 800::<topic_id> order ... flowid 1:<topic_id>"
+	while ( fgets(line, sizeof(line), fp) ){
+		if ( (*ret_n_handles < max_handles) && (aux = strstr(line," fh 800::")) && (sscanf(aux," fh 800::%u",&handle) == 1) )
+			ret_handles[(*ret_n_handles)++] = handle;
+	}
+
+	if ( pclose(fp) ){
+		DEBUG_MSG_CLIENT_RESERV("reserv_verify_filters(): TC filter dump failed\n");
+		return ERR_RESERV_GET;
+	}
+
+	return ERR_OK;
+}
+#endif
@@ -34,20 +34,23 @@
 /**	
 *	@brief Starts the client reservation module
 *
-*	Initializes the module and creates the reservations necessary to the comunication with the server
+*	Initializes the module and creates the reservations necessary to the comunication with the server.
+*	The root, background and control classes are sized from the NIC bandwidth and the configured shares
 *
 *	@param[in] ifface	The NIC to use for networking. Must not be a NULL pointer
+*	@param[in] link_bw	The NIC bandwidth (in mbps). Must be greater than 0
 *	@param[in] node_id	The assigned node ID. Must be greater than 0
 *	@param[in] server_addr	The server address. Must not be a NULL pointer
 *
 *	@pre			assert( ifface );
+*	@pre			assert( link_bw );
 *	@pre			assert( node_id );
 *	@pre			assert( server_addr );
 *
 *	@return			Upon successful return : ERR_OK (0)
 *	@return			Upon output error : An error code (<0)
 */
-int tc_client_reserv_init( char *ifface, unsigned int node_id, NET_ADDR *server_addr );
+int tc_client_reserv_init( char *ifface, unsigned int link_bw, unsigned int node_id, NET_ADDR *server_addr );
 
 /**
 *	@brief Closes the client reservation module
@@ -65,11 +68,13 @@ int tc_client_reserv_close( void );
 *	@brief Creates a network reservation
 *
 *	Creates a network reservation for the topic messages by creating a linux traffic control qdisc (with limited bandwidth) and filter.
-*	This filter will assign all the messages with the topic destination address to the configured qdisc
+*	This filter will assign all the messages with the topic destination address to the configured qdisc.
+*	The class burst and cburst are set to the topic burst so that one full size message leaves at line rate
 *
 *	@param[in] topic_id	The ID of the topic. Must be greater than 0
 *	@param[in] topic_addr	The topic network address. Must not be a NULL pointer
 *	@param[in] req_load	The reservation bandwidth ammount. Must be greater than 0
+*	@param[in] req_burst	The reservation burst size (in bytes). If lower than MIN_RESERV_BURST, MIN_RESERV_BURST is used
 *
 *	@pre			assert( topic_id );
 *	@pre			assert( topic_addr );
@@ -80,16 +85,17 @@ int tc_client_reserv_close( void );
 *
 *	@todo			Create missing error codes
 */
-int tc_client_reserv_add( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load );
+int tc_client_reserv_add( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load, unsigned int req_burst );
 
 /**	
 *	@brief Updates a network reservation
 *
-*	Updates an existing network reservation bandwidth
+*	Updates an existing network reservation bandwidth and burst
 *
 *	@param[in] topic_id	The ID of the topic. Must be greater than 0
 *	@param[in] topic_addr	The topic network address. Must not be a NULL pointer
 *	@param[in] req_load	The new reservation bandwidth ammount. Must be greater than 0
+*	@param[in] req_burst	The new reservation burst size (in bytes). If lower than MIN_RESERV_BURST, MIN_RESERV_BURST is used
 *
 *	@pre			assert( topic_id );
 *	@pre			assert( topic_addr );
@@ -100,7 +106,7 @@ int tc_client_reserv_add( unsigned int topic_id, NET_ADDR *topic_addr, unsigned
 *
 *	@todo			Create missing error codes
 */
-int tc_client_reserv_set( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load );
+int tc_client_reserv_set( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load, unsigned int req_burst );
 
 /**	
 *	@brief Frees a network reservation
@@ -122,4 +128,66 @@ int tc_client_reserv_set( unsigned int topic_id, NET_ADDR *topic_addr, unsigned
 */
 int tc_client_reserv_del( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load );
 
+/**	
+*	@brief Sets the ingress policer of a topic
+*
+*	Creates (or updates) a filter on the ingress qdisc that polices the incoming topic messages to the requested rate. Messages above the
+*	contract are dropped. A load of 0 removes the policer. Does nothing if ingress policing is disabled (ENABLE_INGRESS_POLICING)
+*
+*	@param[in] topic_id	The ID of the topic. Must be greater than 0
+*	@param[in] topic_addr	The topic network address. Must not be a NULL pointer
+*	@param[in] req_load	The policer rate (in bps). 0 removes the policer
+*	@param[in] req_burst	The policer burst size (in bytes). If lower than MIN_RESERV_BURST, MIN_RESERV_BURST is used
+*
+*	@pre			assert( topic_id );
+*	@pre			assert( topic_addr );
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*/
+int tc_client_reserv_police( unsigned int topic_id, NET_ADDR *topic_addr, unsigned int req_load, unsigned int req_burst );
+
+/**	
+*	@brief Gets the measured load of the active network reservations
+*
+*	Samples the sent bytes counter of each active reservation class (from "tc -s class show") and returns the load measured since the previous sample.
+*	Reservations sampled for the first time are not returned
+*
+*	@param[in] max_entries		The maximum number of entries to return
+*	@param[out] ret_topic_ids	The IDs of the sampled topics. Must not be a NULL pointer
+*	@param[out] ret_loads		The measured loads (in bps). Must not be a NULL pointer
+*	@param[out] ret_n_entries	The number of returned entries. Must not be a NULL pointer
+*
+*	@pre				assert( ret_topic_ids );
+*	@pre				assert( ret_loads );
+*	@pre				assert( ret_n_entries );
+*
+*	@return				Upon successful return : ERR_OK (0)
+*	@return				Upon output error : An error code (<0)
+*/
+int tc_client_reserv_get_usage( unsigned int max_entries, unsigned int *ret_topic_ids, unsigned int *ret_loads, unsigned int *ret_n_entries );
+
+/**	
+*	@brief Gets the verification state of a network reservation
+*
+*	Returns the result of the last comparison of the reservation with the kernel traffic control tree (see ENABLE_RESERV_VERIFY) together with
+*	the class drops, overlimits and backlog read on that comparison. No command is executed
+*
+*	@param[in] topic_id		The ID of the topic. Must be greater than 0
+*	@param[out] ret_state		The verification state (RESERV_STATE). Must not be a NULL pointer
+*	@param[out] ret_drops		The class dropped packets counter. Must not be a NULL pointer
+*	@param[out] ret_overlimits	The class overlimits counter. Must not be a NULL pointer
+*	@param[out] ret_backlog		The class queued bytes. Must not be a NULL pointer
+*
+*	@pre				assert( topic_id );
+*	@pre				assert( ret_state );
+*	@pre				assert( ret_drops );
+*	@pre				assert( ret_overlimits );
+*	@pre				assert( ret_backlog );
+*
+*	@return				Upon successful return : ERR_OK (0)
+*	@return				Upon output error : An error code (<0)
+*/
+int tc_client_reserv_get_status( unsigned int topic_id, unsigned char *ret_state, unsigned long long *ret_drops, unsigned long long *ret_overlimits, unsigned int *ret_backlog );
+
 #endif
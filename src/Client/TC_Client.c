@@ -31,11 +31,16 @@
 #include <unistd.h>
 #include <semaphore.h>
 #include <pthread.h>
+#include <assert.h>
 #include <errno.h>
+#include <time.h>
+#include <poll.h>
 
 #include "Sockets.h"
 #include "TC_Data_Types.h"
 #include "TC_Utils.h"
+#include "TC_Probes.h"
+#include "TC_Log.h"
 #include "TC_Error_Types.h"
 #include "TC_Config.h"
 
@@ -60,6 +65,7 @@ static char init = 0;
 static unsigned int tc_node_id = 0;
 static char nic_ip[50];
 static char nic_ifface[50];
+static unsigned int nic_link_bw = 0;
 
 static NET_ADDR server;
 static SOCK_ENTITY server_sock;
@@ -69,12 +75,113 @@ static pthread_mutex_t server_lock;
 
 static int tc_client_get_server_access( void );
 static int tc_client_release_server_access( void );
+
+//Control operations latency histograms (request -> answer and bind completion)
+static TC_HIST client_op_hist[N_OP_TYPES];
+static TC_HIST client_bind_hist[N_OP_TYPES];
+
+//Current server request (requests are serialized by the server access mutex)
+static OP_TYPE req_op;
+static unsigned long long req_start;
+
+static void tc_client_req_start( NET_MSG *msg );
+static void tc_client_req_end( void );
+
+#if LATENCY_SNAPSHOT_PERIOD
+static char latency_quit = 0;
+static pthread_t latency_thread_id;
+static pthread_mutex_t latency_lock;
+
+//Periodically prints the latency histograms
+static void tc_client_latency_thread( void );
+#endif
+
+static char repair_quit = THREAD_STOP;
+static pthread_t repair_thread_id;
+static pthread_mutex_t repair_lock;
+static pthread_mutex_t repair_wait_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t repair_cond = PTHREAD_COND_INITIALIZER;
+static char repair_wake = 0;
+
+//Serves the NACKs of the reliable topics produced by this node and announces their last message once idle (independently of the application sends)
+//Sleeps on repair_cond while there is no reliable producer topic
+static void tc_client_repair_thread( void );
+
+//Wakes up the repair thread (a reliable producer topic was registered or the thread must end)
+static void tc_client_repair_wake( void );
+
+//Monotonic time in ns (for the topics lock wait statistics)
+static unsigned long long tc_client_time_ns( void );
+
+#if ENABLE_MSG_TRACING
+//Message tracing clock time in ns (for the messages send timestamps)
+static unsigned long long tc_client_trace_time_ns( void );
+
+//Updates the topic one-way latency histogram and lost/reordered messages counters with a received message header
+static void tc_client_trace_msg( TOPIC_C_ENTRY *topic, FRAG_HEADER *header );
+#endif
+
 static int tc_client_comm_init( void );
 static int tc_client_comm_close( void );
 static int tc_client_modules_init( void );
 static int tc_client_modules_close( void );
 static int tc_client_node_reg ( unsigned int node_id, unsigned int *ret_node_id );
 static int tc_client_node_unreg ( void );
+static int tc_client_bind( unsigned int topic_id, unsigned char op, unsigned int timeout, int *ret_handle );
+
+//GET_TOPIC_PROP round trip shared by the topic properties and delay bound calls (NULL outputs are ignored)
+static int tc_client_topic_req_prop( unsigned int topic_id, unsigned int *ret_size, unsigned int *ret_period, unsigned int *ret_delay_bound );
+
+//Data path of the send/receive calls on a referenced topic entry (by topic ID or by handle)
+static int tc_client_send( TOPIC_C_ENTRY *topic, char *data, int data_size );
+
+//Sends one message fragments (called with the topic transmission mutex locked, temp is the fragment buffer allocated on first use)
+static int tc_client_send_msg( TOPIC_C_ENTRY *topic, char *data, int data_size, char **temp, char newer );
+
+//Sends as many message fragments as fit in one UDP segmentation offload call (called with the topic transmission mutex locked). Returns the
+//number of message bytes sent (ERR_SOCK_OPTION if the offload is not available) and advances the header fragment sequence number
+static int tc_client_send_segments( TOPIC_C_ENTRY *topic, SOCK_ENTITY *sock, FRAG_HEADER *header, char *data, int len, char *temp );
+
+//Sends a whole message in equal size fragments, FEC blocks of data and parity fragments (called with the topic transmission mutex locked)
+static int tc_client_send_fec( TOPIC_C_ENTRY *topic, SOCK_ENTITY *sock, FRAG_HEADER *header, char *data, int data_size, char *temp );
+
+//Keeps a message sent to a reliable topic in the retransmit window / multicasts the fragments NACKed by the consumers within the topic
+//retransmissions share / multicasts the first fragment of the last message again once the producer is idle (called with the topic transmission mutex locked)
+static void tc_client_retx_store( TOPIC_C_ENTRY *topic, FRAG_HEADER *header, char *data, int data_size );
+static void tc_client_retransmit( TOPIC_C_ENTRY *topic, char **temp );
+static void tc_client_retx_tail( TOPIC_C_ENTRY *topic, char **temp );
+
+//Multicasts a data fragment of a message of the retransmit window if not just retransmitted and within the retransmissions share.
+//Returns 1 if sent, 0 if just retransmitted, ERR_DATA_PACED if over the retransmissions share or the send error (<0)
+static int tc_client_retx_frag( TOPIC_C_ENTRY *topic, TX_RETX *slot, int idx, unsigned long long now, char **temp );
+
+//Applies the topic producer pacing policy to a message (called with the topic transmission mutex locked)
+static int tc_client_pace( TOPIC_C_ENTRY *topic, int data_size, char newer );
+static int tc_client_receive( TOPIC_C_ENTRY *topic, unsigned int timeout, char *ret_data );
+
+//Receives fragments until a message is complete, until the deadline or (drain set) until no data is queued -> returns 0 (called with the topic
+//reception mutex locked). Messages are reassembled per producer, so several producers can send fragmented messages at the same time
+static int tc_client_receive_msg( TOPIC_C_ENTRY *topic, unsigned long long deadline, char drain, char *ret_data );
+
+//Returns the next fragment in the topic reception buffer, receiving a datagram if needed (same deadline/drain behaviour). Returns its size
+static int tc_client_receive_frag( TOPIC_C_ENTRY *topic, unsigned long long deadline, char drain, char **ret_frag );
+
+//Returns the reassembly context of a fragment sender (a new one for a first fragment) or NULL if the fragment doesn't continue a message
+static RX_REASM* tc_client_reasm_find( TOPIC_C_ENTRY *topic, NET_ADDR *sender, FRAG_HEADER *header );
+
+//Returns a context for a new message : a free one, else the least recently delivered one, else (evict set) the least recently updated incomplete one
+static RX_REASM* tc_client_reasm_alloc( TOPIC_C_ENTRY *topic, char evict );
+static int tc_client_receive_fec( TOPIC_C_ENTRY *topic, FRAG_HEADER *header, char *frag, int frag_size, char *ret_data );
+
+//Discards the incomplete messages past FRAG_TIMEOUT (reliable ones : at least RETX_WINDOW topic periods) since their last fragment and sends the due NACKs. Returns the next expiry/NACK time (in us) or 0 if none
+static unsigned long long tc_client_reasm_expire( TOPIC_C_ENTRY *topic, unsigned long long now );
+
+//Schedules the NACK of an incomplete reliable message (\a delay us plus a random delay) / sends it to the producer with the missing fragments
+static void tc_client_nack_schedule( TOPIC_C_ENTRY *topic, RX_REASM *reasm, unsigned long long delay, char gap, unsigned long long now );
+static void tc_client_nack_send( TOPIC_C_ENTRY *topic, RX_REASM *reasm, unsigned long long now );
+
+//Handles a failed fragment receive (unblock signals, timeouts, errors). Returns the receive call error or 0 if the receive should go on
+static int tc_client_receive_fail( TOPIC_C_ENTRY *topic, int ret );
 
 int tc_client_init( char *ifface, unsigned int node_id )
 {
@@ -100,12 +207,25 @@ int tc_client_init( char *ifface, unsigned int node_id )
 		return ERR_INVALID_NIC;
 	}
 
+	//Get nic link speed ( fallback to the default root bandwidth if the nic doesn't report it )
+	if ( tc_network_get_nic_speed( ifface, &nic_link_bw ) ){
+		fprintf(stderr,"tc_client_init() : Unknown NIC %s link speed -- Assuming %u mbps\n",ifface,ROOT_BW);
+		nic_link_bw = ROOT_BW;
+	}
+
 	//Save requested node_id ( if 0 server will assign a random id )
 	tc_node_id = node_id;
 
+	//Start logger
+	if ( tc_log_init() ){
+		fprintf(stderr,"tc_client_init() : ERROR STARTING LOGGER\n");
+		return ERR_LOG_INIT;
+	}
+
 	//Start client modules
 	if ( (ret = tc_client_modules_init()) ){
 		fprintf(stderr,"tc_client_init() : ERROR INITIALIZING CLIENT INTERNAL MODULES\n");
+		tc_log_close();
 		return ret;
 	}
  
@@ -117,6 +237,12 @@ int tc_client_init( char *ifface, unsigned int node_id )
 
 	init = 1;
 
+#if LATENCY_SNAPSHOT_PERIOD
+	//Start latency snapshot thread ( not critical -- client keeps running without it )
+	if ( tc_thread_create( tc_client_latency_thread, &latency_thread_id, &latency_quit, &latency_lock, 100 ) )
+		fprintf(stderr,"tc_client_init() : ERROR STARTING LATENCY SNAPSHOT THREAD\n");
+#endif
+
 	DEBUG_MSG_TC_CLIENT("tc_client_init() Client initialized\n");
 
 	//Return assigned node_id
@@ -139,11 +265,20 @@ int tc_client_close( void )
 		return ret;
 	}
 
+#if LATENCY_SNAPSHOT_PERIOD
+	if ( latency_quit == THREAD_RUN )
+		tc_thread_destroy( &latency_thread_id, &latency_quit, &latency_lock, 200 );
+#endif
+
+	//Stop logger (writes pending messages)
+	tc_log_close();
+
 	init = 0;
 	tc_node_id = 0;
 	pthread_mutex_destroy( &server_lock );
 	strcpy( nic_ip, "" );
 	strcpy( nic_ifface, "" );			
+	nic_link_bw = 0;
 	memset(&server_sock,0,sizeof(SOCK_ENTITY));
 
 	DEBUG_MSG_TC_CLIENT("tc_client_close() Client closed\n");
@@ -186,6 +321,16 @@ int tc_client_get_node_event( unsigned int timeout, unsigned char *ret_event, un
 }
 
 int tc_client_topic_create( unsigned int topic_id, unsigned int size, unsigned int period )
+{
+	return tc_client_topic_create_fec( topic_id, size, period, 0, 0 );
+}
+
+int tc_client_topic_create_fec( unsigned int topic_id, unsigned int size, unsigned int period, unsigned int fec_k, unsigned int fec_m )
+{
+	return tc_client_topic_create_reliable( topic_id, size, period, fec_k, fec_m, 0 );
+}
+
+int tc_client_topic_create_reliable( unsigned int topic_id, unsigned int size, unsigned int period, unsigned int fec_k, unsigned int fec_m, unsigned int retx_share )
 {
 	DEBUG_MSG_TC_CLIENT("tc_client_topic_create() TOPIC ID %u ...\n",topic_id);
 
@@ -197,7 +342,7 @@ int tc_client_topic_create( unsigned int topic_id, unsigned int size, unsigned i
 	}	
 
 	//Validate parameters
-	if ( !topic_id || !size || !period ){
+	if ( !topic_id || !size || !period || (fec_k && (!fec_m || fec_k + fec_m > FEC_MAX_BLOCK)) || retx_share > 100 ){
 		fprintf(stderr,"tc_client_topic_create() : INVALID PARAMETERS\n");
 		return ERR_INVALID_PARAM;
 	}
@@ -212,11 +357,15 @@ int tc_client_topic_create( unsigned int topic_id, unsigned int size, unsigned i
 	msg.topic_id = topic_id;
 	msg.channel_size = size;
 	msg.channel_period = period;
+	msg.topic_fec_k = fec_k;
+	msg.topic_fec_m = fec_k ? fec_m : 0;
+	msg.topic_retx_share = retx_share;
 	
 	//Get in requests queue
 	tc_client_get_server_access();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"tc_client_topic_create() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
@@ -234,6 +383,8 @@ int tc_client_topic_create( unsigned int topic_id, unsigned int size, unsigned i
 		return ERR_GET_ANSWER;
 	}
 
+	tc_client_req_end();
+
 	//Leave requests queue
 	tc_client_release_server_access();
 
@@ -278,6 +429,7 @@ int tc_client_topic_destroy( unsigned int topic_id )
 	tc_client_get_server_access();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"tc_client_topic_destroy() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
@@ -295,6 +447,8 @@ int tc_client_topic_destroy( unsigned int topic_id )
 		return ERR_GET_ANSWER;
 	}
 
+	tc_client_req_end();
+
 	//Leave requests queue
 	tc_client_release_server_access();
 
@@ -313,8 +467,6 @@ int tc_client_topic_get_prop( unsigned int topic_id , unsigned int *ret_size, un
 {
 	DEBUG_MSG_TC_CLIENT(" tc_client_topic_get_prop() TOPIC ID %u ...\n",topic_id);
 
-	NET_MSG msg;
-
 	if ( !init ){
 		fprintf(stderr," tc_client_topic_get_prop() : MODULE IS NOT INITIALIZED\n");
 		return ERR_C_NOT_INIT;
@@ -326,52 +478,26 @@ int tc_client_topic_get_prop( unsigned int topic_id , unsigned int *ret_size, un
 		return ERR_INVALID_PARAM;
 	}
 
-	//Get topic channel properties
-	//Prepare request
-	memset(&msg,0,sizeof(NET_MSG));
-
-	msg.type = REQ_MSG;
-	msg.op = GET_TOPIC_PROP;
-	msg.node_ids[0] = tc_node_id;
-	msg.n_nodes = 1;
-	msg.topic_id  = topic_id;
-
-	//Get in requests queue
-	tc_client_get_server_access();
-
-	//Send request
-	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
-		fprintf(stderr,"tc_client_topic_get_prop() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return ERR_SEND_REQUEST;
-	}
-	
-	DEBUG_MSG_TC_CLIENT(" tc_client_topic_get_prop() : Waiting for topic id %u request response\n",topic_id);
+	return tc_client_topic_req_prop( topic_id, ret_size, ret_period, NULL );
+}
 
-	//Get answer
-	memset(&msg,0,sizeof(NET_MSG));
+int tc_client_topic_get_delay_bound( unsigned int topic_id , unsigned int *ret_delay_bound )
+{
+	DEBUG_MSG_TC_CLIENT(" tc_client_topic_get_delay_bound() TOPIC ID %u ...\n",topic_id);
 
-	if ( tc_network_get_msg( &server_sock, C_REQUESTS_TIMEOUT, &msg, NULL ) ){
-		fprintf(stderr,"tc_client_topic_get_prop() : ERROR RECEIVING REQUEST ANSWER FOR TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return ERR_GET_ANSWER;
-	}
+	if ( !init ){
+		fprintf(stderr," tc_client_topic_get_delay_bound() : MODULE IS NOT INITIALIZED\n");
+		return ERR_C_NOT_INIT;
+	}	
 
-	//Check if request was successfull
-	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
-		fprintf(stderr," tc_client_topic_get_prop() : SERVER DECLINED REQUEST FOR TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return msg.error;
+	//Validate parameters
+	if ( !topic_id || !ret_delay_bound ){
+		fprintf(stderr,"tc_client_topic_get_delay_bound() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
 	}
 
-	if ( ret_size ) *ret_size = msg.channel_size;
-	if ( ret_period ) *ret_period = msg.channel_period;
-			
-	tc_client_release_server_access();
-
-	DEBUG_MSG_TC_CLIENT(" tc_client_topic_get_prop() Got topic id %u details\n",topic_id);
-
-	return ERR_OK;
+	//The delay bound is sent along the topic properties
+	return tc_client_topic_req_prop( topic_id, NULL, NULL, ret_delay_bound );
 }
 
 int tc_client_topic_set_prop( unsigned int topic_id , unsigned int new_size, unsigned int new_period )
@@ -406,6 +532,7 @@ int tc_client_topic_set_prop( unsigned int topic_id , unsigned int new_size, uns
 	tc_client_get_server_access();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"ttc_client_topic_set_prop() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
@@ -423,6 +550,8 @@ int tc_client_topic_set_prop( unsigned int topic_id , unsigned int new_size, uns
 		return ERR_GET_ANSWER;
 	}
 
+	tc_client_req_end();
+
 	//Check if request was successfull
 	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
 		fprintf(stderr," tc_client_topic_set_prop() : SERVER DECLINED REQUEST FOR TOPIC ID %u\n",topic_id);
@@ -443,6 +572,7 @@ int tc_client_register_tx( unsigned int topic_id )
 
 	NET_MSG msg;
 	TOPIC_C_ENTRY *topic = NULL;
+	char topic_retx;
 
 	if ( !init ){
 		fprintf(stderr,"tc_client_register_tx() : MODULE IS NOT INITIALIZED\n");
@@ -482,6 +612,7 @@ int tc_client_register_tx( unsigned int topic_id )
 	tc_client_db_unlock();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"tc_client_register_tx() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
@@ -499,6 +630,8 @@ int tc_client_register_tx( unsigned int topic_id )
 		return ERR_GET_ANSWER;
 	}
 
+	tc_client_req_end();
+
 	//Check if registration was successfull
 	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
 		fprintf(stderr,"tc_client_register_tx() : SERVER DENIED REGISTRATION AS PRODUCER OF TOPIC ID %u\n",topic_id);
@@ -518,7 +651,7 @@ int tc_client_register_tx( unsigned int topic_id )
 	strcpy(peer.name_ip, msg.topic_addr.name_ip);
 	peer.port = msg.topic_addr.port;
  
-	printf("tc_client_register_tx() : Topic Id %u going to join group %s:%u\n",topic_id,peer.name_ip,peer.port);
+	TC_LOG( LOG_CLIENT, LOG_INFO, "tc_client_register_tx() : Topic Id %u going to join group %s:%u\n",topic_id,peer.name_ip,peer.port );
 
 	//Lock topic database
 	tc_client_db_lock();
@@ -569,11 +702,34 @@ int tc_client_register_tx( unsigned int topic_id )
 	topic->topic_addr = msg.topic_addr;
 	topic->channel_size = msg.channel_size;
 	topic->channel_period = msg.channel_period;
+	topic->fec_k = msg.topic_fec_k;
+	topic->fec_m = msg.topic_fec_m;
+	topic->retx_share = msg.topic_retx_share;
+
+	//Reliable topic -> the consumers NACKs are received on an unicast socket (port chosen by the kernel, sent in the fragments header)
+	if ( topic->retx_share && topic->tx_nack_sock.fd <= 0 ){
+		memset(&host,0,sizeof(NET_ADDR));
+		strcpy(host.name_ip,nic_ip);
+
+		if ( sock_open( &topic->tx_nack_sock, REMOTE_UDP ) || sock_bind( &topic->tx_nack_sock, &host ) ){
+			fprintf(stderr,"tc_client_register_tx() : ERROR CREATING NACK SOCKET FOR TOPIC ID %u\n",topic_id);
+			tc_client_db_topic_delete( topic );
+			tc_client_db_unlock();
+			tc_client_release_server_access();
+			return ERR_SOCK_CREATE;
+		}
+	}
+
 	topic->is_producer = 1;	
+	topic_retx = topic->retx_share > 0;
 	
 	//Unlock topic database
 	tc_client_db_unlock();
 
+	//Reliable topic -> its NACKs are also served while the application doesn't send
+	if ( topic_retx )
+		tc_client_repair_wake();
+
 	//Leave requests queue
 	tc_client_release_server_access();
 
@@ -627,6 +783,7 @@ int tc_client_unregister_tx( unsigned int topic_id )
 	tc_client_db_unlock();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"tc_client_unregister_tx() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
@@ -644,6 +801,8 @@ int tc_client_unregister_tx( unsigned int topic_id )
 		return ERR_GET_ANSWER;
 	}
 
+	tc_client_req_end();
+
 	//Check if unregistration request was accepted
 	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
 		fprintf(stderr,"tc_client_unregister_tx() : SERVER DENIED UNREGISTRATION AS PRODUCER OF TOPIC ID %u\n",topic_id);
@@ -668,8 +827,11 @@ int tc_client_unregister_tx( unsigned int topic_id )
 	//Unbind as producer and signal topic as updating
 	topic->is_tx_bound = 0;
 	topic->is_updating = 1;
+	tc_client_db_bind_signal( topic );
 	sock_close( &topic->topic_sock );
 	topic->topic_sock.fd = 0;
+	if ( topic->tx_nack_sock.fd > 0 )
+		sock_close( &topic->tx_nack_sock );
 	topic->is_producer = 0;
 
 	//If we are registered as consumer we need to create a new socket and rejoin group as consumer only
@@ -721,6 +883,9 @@ int tc_client_unregister_tx( unsigned int topic_id )
 			topic->is_updating = 0;
 			return ERR_TOPIC_JOIN_RX;
 		}
+
+		//Coalesced reception of segmented messages (best effort -- without UDP GRO the fragments are received one by one)
+		sock_set_gro( &topic->topic_sock, 1 );
 	}
 	
 	//Update done
@@ -784,6 +949,7 @@ int tc_client_register_rx( unsigned int topic_id )
 	tc_client_db_unlock();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"tc_client_register_rx() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
@@ -800,6 +966,8 @@ int tc_client_register_rx( unsigned int topic_id )
 		tc_client_release_server_access();
 		return ERR_GET_ANSWER;
 	}
+
+	tc_client_req_end();
 	
 	//Check if registration was successfull
 	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
@@ -820,7 +988,7 @@ int tc_client_register_rx( unsigned int topic_id )
 	strcpy(peer.name_ip, msg.topic_addr.name_ip);
 	peer.port = msg.topic_addr.port;
  
-	printf("tc_client_register_rx() : Topic Id %u going to join group %s:%u\n",topic_id,peer.name_ip,peer.port);
+	TC_LOG( LOG_CLIENT, LOG_INFO, "tc_client_register_rx() : Topic Id %u going to join group %s:%u\n",topic_id,peer.name_ip,peer.port );
 
 	//Lock topic database
 	tc_client_db_lock();
@@ -836,7 +1004,7 @@ int tc_client_register_rx( unsigned int topic_id )
 	}
 
 	if ( topic->topic_sock.fd <= 0 ){
-		printf("tc_client_register_rx() : CREATING SOCKET FOR TOPIC ID %u\n",topic_id);
+		TC_LOG( LOG_CLIENT, LOG_DEBUG, "tc_client_register_rx() : CREATING SOCKET FOR TOPIC ID %u\n",topic_id );
 		//No socket exists for this topic -> create one
 		if ( sock_open(&topic->topic_sock, REMOTE_UDP_GROUP ) ){
 			fprintf(stderr,"tc_client_register_rx() : ERROR CREATING SOCKET FOR TOPIC ID %u\n",topic_id);
@@ -888,6 +1056,9 @@ int tc_client_register_rx( unsigned int topic_id )
 			tc_client_release_server_access();
 			return ERR_TOPIC_JOIN_RX;
 		}
+
+		//Coalesced reception of segmented messages (best effort -- without UDP GRO the fragments are received one by one)
+		sock_set_gro( &topic->topic_sock, 1 );
 	}
 
 	//Update topic entry
@@ -895,6 +1066,11 @@ int tc_client_register_rx( unsigned int topic_id )
 	topic->topic_addr = msg.topic_addr;
 	topic->channel_size = msg.channel_size;
 	topic->channel_period = msg.channel_period;
+	topic->fec_k = msg.topic_fec_k;
+	topic->fec_m = msg.topic_fec_m;
+	topic->retx_share = msg.topic_retx_share;
+	//Consumers of the same reliable topic draw different NACK delays
+	topic->rx_nack_seed = tc_node_id ^ (unsigned int) tc_time_get_us();
 	topic->is_consumer = 1;
 
 	//Unlock topic database
@@ -953,6 +1129,7 @@ int tc_client_unregister_rx( unsigned int topic_id )
 	tc_client_db_unlock();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"tc_client_unregister_rx() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
@@ -968,6 +1145,8 @@ int tc_client_unregister_rx( unsigned int topic_id )
 		return ERR_GET_ANSWER;
 	}
 
+	tc_client_req_end();
+
 	//Check if unregistration request was accepted
 	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
 		fprintf(stderr,"tc_client_unregister_rx() : SERVER DENIED UNREGISTRATION AS CONSUMER OF TOPIC ID %u\n",topic_id);
@@ -990,6 +1169,7 @@ int tc_client_unregister_rx( unsigned int topic_id )
 	//Unbind and signal topic as updating
 	topic->is_rx_bound = 0;
 	topic->is_updating = 1;
+	tc_client_db_bind_signal( topic );
 
 	//Send message to unblock socket
 	sock_send( &topic->unblock_rx_sock, &topic->unblock_rx_sock.host, "0", 5 );
@@ -1063,129 +1243,20 @@ int tc_client_bind_tx( unsigned int topic_id, unsigned int timeout )
 {
 	DEBUG_MSG_TC_CLIENT("tc_client_bind_tx() TOPIC ID %u ...\n",topic_id);
 
-	NET_MSG msg;
-	int tries = 0;
-	TOPIC_C_ENTRY *topic = NULL;
-
-	if ( !init ){
-		fprintf(stderr,"tc_client_bind_tx() : MODULE IS NOT INITIALIZED\n");
-		return ERR_C_NOT_INIT;
-	}	
-
-	//Validate parameters
-	if ( !topic_id ){
-		fprintf(stderr,"tc_client_bind_tx() : INVALID PARAMETERS\n");
-		return ERR_INVALID_PARAM;
-	}
-
-	//Get in requests queue
-	tc_client_get_server_access();
-
-	//Lock topic database
-	tc_client_db_lock();
-
-	//Check if node is registered as producer of this topic 
-	if ( !(topic = tc_client_db_topic_search(topic_id)) || !topic->is_producer ){
-		fprintf(stderr,"tc_client_bind_tx() : NOT REGISTERED AS PRODUCER OF TOPIC ID %u\n",topic_id);
-		tc_client_db_unlock();
-		tc_client_release_server_access();
-		return ERR_NODE_NOT_REG_TX;
-	}
-
-	//Check if its already bound
-	if ( topic->is_tx_bound ){
-		DEBUG_MSG_TC_CLIENT("tc_client_bind_tx() : Already bound to topic id %u as producer\n",topic_id);
-		tc_client_db_unlock();
-		tc_client_release_server_access();
-		return ERR_OK;	
-	}
-
-	//Prepare request
-	memset(&msg,0,sizeof(NET_MSG));
-
-	msg.type = REQ_MSG;
-	msg.op = BIND_TX;
-	msg.node_ids[0] = tc_node_id;
-	msg.n_nodes = 1;
-	msg.topic_id  = topic_id;
-
-	//Unlock topic database
-	tc_client_db_unlock();
-
-	//Send request
-	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
-		fprintf(stderr,"tc_client_bind_tx() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return ERR_SEND_REQUEST;
-	}
-	
-	DEBUG_MSG_TC_CLIENT("tc_client_bind_tx() : Waiting for topic id %u bind request response\n",topic_id);
-
-	//Get answer
-	memset(&msg,0,sizeof(NET_MSG));
-
-	if ( tc_network_get_msg( &server_sock, C_REQUESTS_TIMEOUT, &msg, NULL ) ){
-		fprintf(stderr,"tc_client_bind_tx() : ERROR RECEIVING REQUEST ANSWER FOR TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return ERR_GET_ANSWER;
-	}
-
-	//Check if bind request was successfull
-	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
-		fprintf(stderr,"tc_client_bind_tx() : SERVER DENIED BIND PROCEDURE REQUEST FOR TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return msg.error;
-	}
-
-	//Request was sent and accepted. It will wait for a notification from server to finalize the bind
-	//However server will only reply when a least 1 consumer and 1 producer for the same topic are registered and bound (or in bind process)
-	//So we could be waiting here for a long time and block other threads from doing requests to server
-	//The bind request answer will be sent to the management module to avoid this issue and we will wait on the bind flag here
-
-	//Leave requests queue
-	tc_client_release_server_access();
-
-	//Wait for bind procedure to be completed
-	//Get entry for topic
-	if ( !(topic = tc_client_db_topic_search(topic_id)) ){
-		fprintf(stderr,"tc_client_bind_tx(): TOPIC ID %u HAS BEEN DESTROYED WHILE WAITING FOR BIND\n",topic_id);
-		return ERR_TOPIC_NOT_REG;
-	}
-
-	if ( timeout > 0 ){
-
-		//Bind with timeout
-		for ( tries = 0; tries < timeout && !topic->is_tx_bound; tries++ ){
-
-			usleep(1000);
+	return tc_client_bind( topic_id, BIND_TX, timeout, NULL );
+}
 
-			if ( !(topic = tc_client_db_topic_search(topic_id)) ){
-				fprintf(stderr,"tc_client_bind_tx(): TOPIC ID %u HAS BEEN DESTROYED WHILE WAITING FOR BIND\n",topic_id);
-				return ERR_TOPIC_NOT_REG;
-			}
-		}
-	
-	}else{
-		//Bind without timeout
-		while ( !topic->is_tx_bound ){
-
-			usleep(1000);
-			//Get entry for topic
-			if ( !(topic = tc_client_db_topic_search(topic_id)) ){
-				fprintf(stderr,"tc_client_bind_tx(): TOPIC ID %u HAS BEEN DESTROYED WHILE WAITING FOR BIND\n",topic_id);
-				return ERR_TOPIC_NOT_REG;
-			}
-		}
-	}
+int tc_client_bind_tx_async( unsigned int topic_id )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_bind_tx_async() TOPIC ID %u ...\n",topic_id);
 
-	if ( !topic->is_tx_bound ){
-		fprintf(stderr,"tc_client_bind_tx() : TIMED-OUT WAITING TO BIND TO TOPIC ID %u\n",topic_id);
-		return ERR_BIND_TX_TIMEDOUT;
-	}
+	int handle = -1;
+	int ret;
 
-	DEBUG_MSG_TC_CLIENT("tc_client_bind_tx() : Bound to topic ID %u as producer\n",topic_id);
+	if ( (ret = tc_client_bind( topic_id, BIND_TX, 0, &handle )) )
+		return ret;
 
-	return ERR_OK;
+	return handle;
 }
 
 int tc_client_unbind_tx( unsigned int topic_id )
@@ -1194,7 +1265,8 @@ int tc_client_unbind_tx( unsigned int topic_id )
 
 	NET_MSG msg;
 	TOPIC_C_ENTRY *topic = NULL;
-	int tries = UNBIND_TIMEOUT;
+	unsigned long long deadline;
+	int expired = 0;
 
 	if ( !init ){
 		fprintf(stderr,"tc_client_unbind_tx() : MODULE IS NOT INITIALIZED\n");
@@ -1242,6 +1314,7 @@ int tc_client_unbind_tx( unsigned int topic_id )
 	tc_client_db_unlock();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"tc_client_unbind_tx() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
@@ -1259,6 +1332,8 @@ int tc_client_unbind_tx( unsigned int topic_id )
 		return ERR_GET_ANSWER;
 	}
 
+	tc_client_req_end();
+
 	//Check if unbind was successfull
 	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
 		fprintf(stderr,"tc_client_unbind_tx() : SERVER DENIED UNBIND AS PRODUCER FROM TOPIC ID %u\n",topic_id);
@@ -1277,19 +1352,22 @@ int tc_client_unbind_tx( unsigned int topic_id )
 		return ERR_NODE_NOT_REG_TX;
 	}
 
-	//Unlock DB (required for management module)
-	tc_client_db_unlock();
+	//Wait for unbind -- Management module will receive a request from the server and signal the unbind
+	//(the database lock is released while waiting)
+	deadline = tc_time_get_us() + UNBIND_TIMEOUT*1000ULL;
 
-	//Wait for unbind -- Management module will receive a request from the server
-	while( topic->is_tx_bound && tries-- )
-		usleep(1000);
+	while ( (topic = tc_client_db_topic_search( topic_id )) && topic->is_tx_bound && !expired )
+		expired = tc_client_db_bind_wait( deadline );
 
-	if ( tries <= 0 ){
+	if ( topic && topic->is_tx_bound ){
 		fprintf(stderr,"tc_client_unbind_tx() : TIMEDOUT WHILE WAITING FOR UNBIND ON TOPIC ID %u\n",topic_id);
+		tc_client_db_unlock();
 		tc_client_release_server_access();
 		return ERR_UNBIND_TX_TIMEDOUT;
 	}
 
+	tc_client_db_unlock();
+
 	tc_client_release_server_access();
 
 	DEBUG_MSG_TC_CLIENT("tc_client_unbind_tx() Unbound as a producer from topic id %u\n",topic_id);
@@ -1301,18 +1379,72 @@ int tc_client_bind_rx( unsigned int topic_id, unsigned int timeout )
 {
 	DEBUG_MSG_TC_CLIENT("tc_client_bind_rx() TOPIC ID %u ...\n",topic_id);
 
-	NET_MSG msg;
-	int tries = 0;
+	return tc_client_bind( topic_id, BIND_RX, timeout, NULL );
+}
+
+int tc_client_bind_rx_async( unsigned int topic_id )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_bind_rx_async() TOPIC ID %u ...\n",topic_id);
+
+	int handle = -1;
+	int ret;
+
+	if ( (ret = tc_client_bind( topic_id, BIND_RX, 0, &handle )) )
+		return ret;
+
+	return handle;
+}
+
+int tc_client_bind_get_state( unsigned int topic_id, unsigned char *ret_tx_bound, unsigned char *ret_rx_bound )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_bind_get_state() TOPIC ID %u ...\n",topic_id);
+
 	TOPIC_C_ENTRY *topic = NULL;
 
 	if ( !init ){
-		fprintf(stderr,"tc_client_bind_rx() : MODULE IS NOT INITIALIZED\n");
+		fprintf(stderr,"tc_client_bind_get_state() : MODULE IS NOT INITIALIZED\n");
 		return ERR_C_NOT_INIT;
 	}	
 
 	//Validate parameters
+	if ( !topic_id || !ret_tx_bound || !ret_rx_bound ){
+		fprintf(stderr,"tc_client_bind_get_state() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
+	}
+
+	tc_client_db_lock();
+
+	if ( !(topic = tc_client_db_topic_search(topic_id)) ){
+		DEBUG_MSG_TC_CLIENT("tc_client_bind_get_state() : Topic ID %u not registered in this node\n",topic_id);
+		tc_client_db_unlock();
+		return ERR_TOPIC_NOT_REG;
+	}
+
+	*ret_tx_bound = topic->is_tx_bound;
+	*ret_rx_bound = topic->is_rx_bound;
+
+	tc_client_db_unlock();
+
+	return ERR_OK;
+}
+
+int tc_client_unbind_rx( unsigned int topic_id )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_unbind_rx() TOPIC ID %u ...\n",topic_id);
+
+	NET_MSG msg;
+	TOPIC_C_ENTRY *topic = NULL;
+	unsigned long long deadline;
+	int expired = 0;
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_unbind_rx() : MODULE IS NOT INITIALIZED\n");
+		return ERR_C_NOT_INIT;
+	}	
+
+	//Validate paremeters
 	if ( !topic_id ){
-		fprintf(stderr,"tc_client_bind_rx() : INVALID PARAMETERS\n");
+		fprintf(stderr,"tc_client_unbind_rx() : INVALID PARAMETERS\n");
 		return ERR_INVALID_PARAM;
 	}
 
@@ -1322,17 +1454,17 @@ int tc_client_bind_rx( unsigned int topic_id, unsigned int timeout )
 	//Lock topic database
 	tc_client_db_lock();
 
-	//Check if node is registered as consumer of this topic 
-	if ( !(topic = tc_client_db_topic_search(topic_id)) || !topic->is_consumer ){
-		fprintf(stderr,"tc_client_bind_rx() : NOT REGISTERED AS CONSUMER OF TOPIC ID %u\n",topic_id);
+	//Check if its registered as consumer of this topic 
+	if ( !(topic = tc_client_db_topic_search( topic_id )) || !topic->is_consumer ){
+		fprintf(stderr,"tc_client_unbind_rx() : NOT REGISTERED AS CONSUMER OF TOPIC ID %u\n",topic_id);
 		tc_client_db_unlock();
 		tc_client_release_server_access();
 		return ERR_NODE_NOT_REG_RX;
 	}
 
-	//Check if its already bound
-	if ( topic->is_rx_bound ){
-		DEBUG_MSG_TC_CLIENT("tc_client_bind_rx() : Already bound to topic id %u as consumer\n",topic_id);
+	//Check if node is bound to topic as consumer
+	if ( !topic->is_rx_bound ){
+		DEBUG_MSG_TC_CLIENT("tc_client_unbind_rx() : Node not bound to topic ID %u as consumer\n",topic_id);
 		tc_client_db_unlock();
 		tc_client_release_server_access();
 		return ERR_OK;	
@@ -1342,259 +1474,270 @@ int tc_client_bind_rx( unsigned int topic_id, unsigned int timeout )
 	memset(&msg,0,sizeof(NET_MSG));
 
 	msg.type = REQ_MSG;
-	msg.op = BIND_RX;
+	msg.op = UNBIND_RX;
 	msg.node_ids[0] = tc_node_id;
 	msg.n_nodes = 1;
-	msg.topic_id  = topic_id;
+	msg.topic_id = topic_id;
 
 	//Unlock topic database
 	tc_client_db_unlock();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
-		fprintf(stderr,"tc_client_bind_rx() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
+		fprintf(stderr,"tc_client_unbind_rx() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
 		return ERR_SEND_REQUEST;
 	}
 	
-	DEBUG_MSG_TC_CLIENT("tc_client_bind_rx() : Waiting for topic id %u bind request response\n",topic_id);
+	DEBUG_MSG_TC_CLIENT("tc_client_unbind_rx() : Waiting for topic id %u request response\n",topic_id);
 
 	//Get answer
 	memset(&msg,0,sizeof(NET_MSG));
 
 	if ( tc_network_get_msg( &server_sock, C_REQUESTS_TIMEOUT, &msg, NULL ) ){
-		fprintf(stderr,"tc_client_bind_rx() : ERROR RECEIVING REQUEST ANSWER FOR TOPIC ID %u\n",topic_id);
+		fprintf(stderr,"tc_client_unbind_rx() : ERROR RECEIVING REQUEST ANSWER FOR TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
 		return ERR_GET_ANSWER;
 	}
 
-	//Check if bind request was successfull
-	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
-		fprintf(stderr,"tc_client_bind_rx() : SERVER DENIED BIND PROCEDURE REQUEST FOR TOPIC ID %u\n",topic_id);
+	tc_client_req_end();
+
+	//Check if unbind was successfull
+	if ( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
+		fprintf(stderr,"tc_client_unbind_rx() : SERVER DENIED UNBIND AS CONSUMER FROM TOPIC ID %u\n",topic_id);
 		tc_client_release_server_access();
 		return msg.error;
 	}
 
-	//Request was sent and accepted. It will wait for a notification from server to finalize the bind
-	//However server will only reply when a least 1 consumer and 1 producer for the same topic are registered and bound (or in bind process)
-	//So we could be waiting here for a long time and block other threads from doing requests to server
-	//The bind request answer will be sent to the management module to avoid this issue and we will wait on the bind flag
-
-	//Leave requests queue
-	tc_client_release_server_access();
+	//Lock topic database
+	tc_client_db_lock();
 
-	//Wait for bind procedure to be completed
-	//Get entry for topic
-	if ( !(topic = tc_client_db_topic_search(topic_id)) ){
-		fprintf(stderr,"tc_client_bind_rx(): TOPIC ID %u HAS BEEN DESTROYED WHILE WAITING FOR BIND\n",topic_id);
-		return ERR_TOPIC_NOT_REG;
+	//Check if its registered as producer of this topic 
+	if ( !(topic = tc_client_db_topic_search( topic_id )) || !topic->is_consumer ){
+		fprintf(stderr,"tc_client_unbind_rx() : NOT REGISTERED AS PRODUCER OF TOPIC ID %u\n",topic_id);
+		tc_client_db_unlock();
+		tc_client_release_server_access();
+		return ERR_NODE_NOT_REG_RX;
 	}
 
-	if ( timeout > 0 ){
-
-		//Bind with timeout
-		for ( tries = 0; tries < timeout && !topic->is_rx_bound; tries++ ){
-
-			usleep(1000);
-
-			if ( !(topic = tc_client_db_topic_search(topic_id)) ){
-				fprintf(stderr,"tc_client_bind_rx(): TOPIC ID %u HAS BEEN DESTROYED WHILE WAITING FOR BIND\n",topic_id);
-				return ERR_TOPIC_NOT_REG;
-			}
-		}
-	
-	}else{
-		//Bind without timeout
-		while ( !topic->is_rx_bound ){
+	//Wait for unbind -- Management module will receive a request from the server and signal the unbind
+	//(the database lock is released while waiting)
+	deadline = tc_time_get_us() + UNBIND_TIMEOUT*1000ULL;
 
-			usleep(1000);
+	while ( (topic = tc_client_db_topic_search( topic_id )) && topic->is_rx_bound && !expired )
+		expired = tc_client_db_bind_wait( deadline );
 
-			if ( !(topic = tc_client_db_topic_search(topic_id)) ){
-				fprintf(stderr,"tc_client_bind_rx(): TOPIC ID %u HAS BEEN DESTROYED WHILE WAITING FOR BIND\n",topic_id);
-				return ERR_TOPIC_NOT_REG;
-			}
-		}
+	if ( topic && topic->is_rx_bound ){
+		fprintf(stderr,"tc_client_unbind_rx() : TIMEDOUT WHILE WAITING FOR UNBIND ON TOPIC ID %u\n",topic_id);
+		tc_client_db_unlock();
+		tc_client_release_server_access();
+		return ERR_UNBIND_RX_TIMEDOUT;
 	}
 
-	if ( !topic->is_rx_bound ){
-		fprintf(stderr,"tc_client_bind_rx() : TIMED-OUT WAITING TO BIND TO TOPIC ID %u\n",topic_id);
-		return ERR_BIND_RX_TIMEDOUT;
-	}
+	tc_client_db_unlock();
+
+	tc_client_release_server_access();
 
-	DEBUG_MSG_TC_CLIENT("tc_client_bind_rx() : Bound to topic ID %u as consumer\n",topic_id);
+	DEBUG_MSG_TC_CLIENT("tc_client_unbind_rx() Unbound as consumer from topic id %u\n",topic_id);
 
 	return ERR_OK;
 }
 
-int tc_client_unbind_rx( unsigned int topic_id )
+int tc_client_topic_open( unsigned int topic_id, TC_TOPIC_HANDLE **ret_handle )
 {
-	DEBUG_MSG_TC_CLIENT("tc_client_unbind_rx() TOPIC ID %u ...\n",topic_id);
-
-	NET_MSG msg;
-	TOPIC_C_ENTRY *topic = NULL;
-	int tries = UNBIND_TIMEOUT;
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_open() TOPIC ID %u ...\n",topic_id);
 
 	if ( !init ){
-		fprintf(stderr,"tc_client_unbind_rx() : MODULE IS NOT INITIALIZED\n");
+		fprintf(stderr,"tc_client_topic_open() : MODULE IS NOT INITIALIZED\n");
 		return ERR_C_NOT_INIT;
 	}	
 
-	//Validate paremeters
-	if ( !topic_id ){
-		fprintf(stderr,"tc_client_unbind_rx() : INVALID PARAMETERS\n");
+	//Validate parameters
+	if ( !topic_id || !ret_handle ){
+		fprintf(stderr,"tc_client_topic_open() : INVALID PARAMETERS\n");
 		return ERR_INVALID_PARAM;
 	}
 
-	//Get in requests queue
-	tc_client_get_server_access();
-
-	//Lock topic database
-	tc_client_db_lock();
-
-	//Check if its registered as consumer of this topic 
-	if ( !(topic = tc_client_db_topic_search( topic_id )) || !topic->is_consumer ){
-		fprintf(stderr,"tc_client_unbind_rx() : NOT REGISTERED AS CONSUMER OF TOPIC ID %u\n",topic_id);
-		tc_client_db_unlock();
-		tc_client_release_server_access();
-		return ERR_NODE_NOT_REG_RX;
-	}
-
-	//Check if node is bound to topic as consumer
-	if ( !topic->is_rx_bound ){
-		DEBUG_MSG_TC_CLIENT("tc_client_unbind_rx() : Node not bound to topic ID %u as consumer\n",topic_id);
-		tc_client_db_unlock();
-		tc_client_release_server_access();
-		return ERR_OK;	
+	//The handle is a reference to the topic entry (kept until tc_client_topic_close)
+	if ( !(*ret_handle = tc_client_db_topic_get(topic_id)) ){
+		fprintf(stderr,"tc_client_topic_open() : TOPIC ID %u NOT REGISTERED IN THIS NODE\n",topic_id);
+		return ERR_TOPIC_NOT_REG;
 	}
 
-	//Prepare request
-	memset(&msg,0,sizeof(NET_MSG));
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_open() Opened handle of topic Id %u\n",topic_id);
 
-	msg.type = REQ_MSG;
-	msg.op = UNBIND_RX;
-	msg.node_ids[0] = tc_node_id;
-	msg.n_nodes = 1;
-	msg.topic_id = topic_id;
+	return ERR_OK;
+}
 
-	//Unlock topic database
-	tc_client_db_unlock();
+int tc_client_topic_close( TC_TOPIC_HANDLE *handle )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_close() ...\n");
 
-	//Send request
-	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
-		fprintf(stderr,"tc_client_unbind_rx() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return ERR_SEND_REQUEST;
+	//Validate parameters
+	if ( !handle ){
+		fprintf(stderr,"tc_client_topic_close() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
 	}
-	
-	DEBUG_MSG_TC_CLIENT("tc_client_unbind_rx() : Waiting for topic id %u request response\n",topic_id);
 
-	//Get answer
-	memset(&msg,0,sizeof(NET_MSG));
+	//No module check -- handles can be closed after tc_client_close()
+	return tc_client_db_topic_put( handle );
+}
 
-	if ( tc_network_get_msg( &server_sock, C_REQUESTS_TIMEOUT, &msg, NULL ) ){
-		fprintf(stderr,"tc_client_unbind_rx() : ERROR RECEIVING REQUEST ANSWER FOR TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return ERR_GET_ANSWER;
-	}
+int tc_client_topic_send( unsigned int topic_id , char *data, int data_size )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_send() TOPIC ID %u ...\n",topic_id);
 
-	//Check if unbind was successfull
-	if ( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
-		fprintf(stderr,"tc_client_unbind_rx() : SERVER DENIED UNBIND AS CONSUMER FROM TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return msg.error;
-	}
+	int ret;
+	TOPIC_C_ENTRY *topic = NULL;
 
-	//Lock topic database
-	tc_client_db_lock();
+	if ( !init ){
+		fprintf(stderr,"tc_client_topic_send() : MODULE IS NOT INITIALIZED\n");
+		return ERR_C_NOT_INIT;
+	}	
 
-	//Check if its registered as producer of this topic 
-	if ( !(topic = tc_client_db_topic_search( topic_id )) || !topic->is_consumer ){
-		fprintf(stderr,"tc_client_unbind_rx() : NOT REGISTERED AS PRODUCER OF TOPIC ID %u\n",topic_id);
-		tc_client_db_unlock();
-		tc_client_release_server_access();
-		return ERR_NODE_NOT_REG_RX;
+	//Validate parameters
+	if ( !topic_id || !data || !data_size ){
+		fprintf(stderr,"tc_client_topic_send() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
 	}
 
-	//Unlock DB (required for management module)
-	tc_client_db_unlock();
-
-	//Wait for unbind -- Management module will receive a request from the server
-	while( topic->is_rx_bound && tries-- )
-		usleep(1000);
-
-	if ( tries <= 0 ){
-		fprintf(stderr,"tc_client_unbind_rx() : TIMEDOUT WHILE WAITING FOR UNBIND ON TOPIC ID %u\n",topic_id);
-		tc_client_release_server_access();
-		return ERR_UNBIND_RX_TIMEDOUT;
+	//Get topic entry (referenced so it isn't freed if the topic is destroyed while sending)
+	if ( !(topic = tc_client_db_topic_get(topic_id)) ){
+		fprintf(stderr,"tc_client_topic_send() : NOT REGISTERED AS PRODUCER OF TOPIC ID %u\n",topic_id);
+		return ERR_NODE_NOT_REG_TX;
 	}
 
-	tc_client_release_server_access();
+	ret = tc_client_send( topic, data, data_size );
 
-	DEBUG_MSG_TC_CLIENT("tc_client_unbind_rx() Unbound as consumer from topic id %u\n",topic_id);
+	tc_client_db_topic_put( topic );
 
-	return ERR_OK;
+	return ret;
 }
 
-int tc_client_topic_send( unsigned int topic_id , char *data, int data_size )
+int tc_client_handle_send( TC_TOPIC_HANDLE *handle, char *data, int data_size )
 {
-	DEBUG_MSG_TC_CLIENT("tc_client_topic_send() TOPIC ID %u ...\n",topic_id);
-
-	SOCK_ENTITY sock;
-	char *temp = NULL;
-	int len = 0, total = 0;
-	int ret = -1, seq_n = 0;
-	TOPIC_C_ENTRY *topic = NULL;
+	DEBUG_MSG_TC_CLIENT("tc_client_handle_send() ...\n");
 
 	if ( !init ){
-		fprintf(stderr,"tc_client_topic_send() : MODULE IS NOT INITIALIZED\n");
+		fprintf(stderr,"tc_client_handle_send() : MODULE IS NOT INITIALIZED\n");
 		return ERR_C_NOT_INIT;
 	}	
 
 	//Validate parameters
-	if ( !topic_id || !data || !data_size ){
-		fprintf(stderr,"tc_client_topic_send() : INVALID PARAMETERS\n");
+	if ( !handle || !data || !data_size ){
+		fprintf(stderr,"tc_client_handle_send() : INVALID PARAMETERS\n");
 		return ERR_INVALID_PARAM;
 	}
 
-	//Get topic entry
-	tc_client_db_lock();
+	return tc_client_send( handle, data, data_size );
+}
 
-	if ( !(topic = tc_client_db_topic_search(topic_id) ) || !topic->is_producer ){
+static int tc_client_send( TOPIC_C_ENTRY *topic, char *data, int data_size )
+{
+	TX_REQ req, *list, *next, *fifo = NULL;
+	char *temp = NULL;
+	int ret;
+	unsigned int n_sent = 0;
+	unsigned long long t_lock;
+	unsigned int topic_id = topic->topic_id;
+
+	//Check if node is registered as producer (the entry may have been deleted while referenced)
+	if ( !topic->is_producer ){
 		fprintf(stderr,"tc_client_topic_send() : NOT REGISTERED AS PRODUCER OF TOPIC ID %u\n",topic_id);
-		tc_client_db_unlock();
 		return ERR_NODE_NOT_REG_TX;
 	}
 
-	tc_client_db_unlock();
-
 	//Check if node is bound to topic as producer
 	if ( !topic->is_tx_bound ){
 		fprintf(stderr,"tc_client_topic_send() : NODE NOT BOUND TO TOPIC ID %u AS PRODUCER\n",topic_id);
 		return ERR_NODE_NOT_BOUND_TX;	
 	}
 
-	//Lock send mutex
-	tc_client_lock_topic_tx( topic, 0 );
+	//Queue the message (never blocks)
+	req.data = data;
+	req.data_size = data_size;
+	req.ret = ERR_OK;
+	req.next = __atomic_load_n( &topic->tx_queue, __ATOMIC_RELAXED );
 
-	//Note : We could got blocked on mutex while channel was being destroyed or unbound by the management module
-	//Check if channel being destroyed
-	if ( topic->is_closing ){
-		fprintf(stderr,"tc_client_topic_send() : TOPIC ID %u IS BEING CLOSED\n",topic_id);
-		tc_client_unlock_topic_tx( topic );
-		return ERR_TOPIC_CLOSING;
+	while ( !__atomic_compare_exchange_n( &topic->tx_queue, &req.next, &req, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) );
+
+	//Lock send mutex (the previous holder may send our message meanwhile)
+	//Without a deadline it only fails when misused (E.g. already held by this thread) -> the queued request can't be left behind
+	t_lock = tc_client_time_ns();
+	ret = tc_client_lock_topic_tx( topic, 0 );
+	assert( ret == ERR_OK );
+	(void)ret;
+	TOPIC_STATS_ADD( topic->tx_stats.lock_wait, tc_client_time_ns() - t_lock );
+
+	//Reliable topic -> repair the messages NACKed since the last send first
+	if ( topic->tx_nack_sock.fd > 0 )
+		tc_client_retransmit( topic, &temp );
+
+	//Send the queued messages of all threads. Our message is either already sent or in the first batch (no other thread holds a detached batch).
+	//Messages are sent one at a time so fragments of different messages never interleave
+	while ( n_sent < TX_COMBINING_MAX_BATCH && (list = __atomic_exchange_n( &topic->tx_queue, NULL, __ATOMIC_ACQUIRE )) ){
+
+		//Queue is LIFO -> reverse to send in submission order
+		for( fifo = NULL ; list ; list = next ){
+			next = list->next;
+			list->next = fifo;
+			fifo = list;
+		}
+
+		for( ; fifo ; fifo = next ){
+
+			next = fifo->next;
+
+			//Newer messages queued -> this one can be superseded (coalescing pacing)
+			fifo->ret = tc_client_send_msg( topic, fifo->data, fifo->data_size, &temp, next || __atomic_load_n( &topic->tx_queue, __ATOMIC_RELAXED ) );
+
+			if ( fifo != &req )
+				TOPIC_STATS_ADD( topic->tx_stats.combined, 1 );
+
+			n_sent++;
+		}
 	}
 
+	free(temp);
+
+	tc_client_unlock_topic_tx( topic );
+
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_send() Sent %u queued messages to topic Id %u\n",n_sent,topic_id);
+
+	return req.ret;
+}
+
+static int tc_client_send_msg( TOPIC_C_ENTRY *topic, char *data, int data_size, char **temp, char newer )
+{
+	SOCK_ENTITY sock;
+	int len = 0, total = 0;
+	int ret = -1, frag_size;
+	unsigned int topic_id = topic->topic_id;
+	FRAG_HEADER header;
+
 	//Check if message fits in topic
 	if ( data_size > topic->channel_size ){
 		fprintf(stderr,"tc_client_topic_send() : MESSAGE SIZE (%d) TOO BIG FOR TOPIC ID %d (SIZE %d)\n",data_size,topic->topic_id,topic->channel_size);
-		tc_client_unlock_topic_tx( topic );
 		return ERR_DATA_SIZE;
 	}
 
-	//Alloc temp mem (8 extra char for order stamps and data size)
-	if ( !(temp = (char *) malloc(D_MTU+8)) ){
+	//Keep the producer inside the topic reservation (may wait)
+	if ( (ret = tc_client_pace( topic, data_size, newer )) ){
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_send() : Message dropped by topic ID %u pacing\n",topic_id);
+		return ret;
+	}
+
+	//Note : We could got blocked on mutex (or pacing) while channel was being destroyed or unbound by the management module
+	//Check if channel being destroyed
+	if ( topic->is_closing ){
+		fprintf(stderr,"tc_client_topic_send() : TOPIC ID %u IS BEING CLOSED\n",topic_id);
+		return ERR_TOPIC_CLOSING;
+	}
+
+	//Alloc temp mem once per batch (extra space for the fragment header)
+	if ( !*temp && !(*temp = (char *) malloc(FRAG_PAYLOAD+sizeof(FRAG_HEADER))) ){
 		fprintf(stderr,"tc_client_topic_send() : NOT ENOUGH MEMORY TO SEND DATA TO TOPIC %u\n",topic_id);
-		tc_client_unlock_topic_tx( topic );
 		return ERR_MEM_MALLOC;			
 	}
 
@@ -1602,41 +1745,47 @@ int tc_client_topic_send( unsigned int topic_id , char *data, int data_size )
 
 	len = data_size;//Remaining number of bytes to send
 
-	//Split and send data according to MTU 
-	while( len > D_MTU ){
-	
-		*((int *)temp) = seq_n;
-		*(((int *)temp)+1) = data_size;
-		memcpy( temp+8, data + (data_size - len), D_MTU );
+	//Message header (same on all fragments except the fragment sequence number)
+	memset(&header,0,sizeof(FRAG_HEADER));
+	header.msg_size = data_size;
+	header.msg_seq = topic->tx_msg_seq++;
+	header.nack_port = ( topic->tx_nack_sock.fd > 0 ) ? topic->tx_nack_sock.host.port : 0;
+#if ENABLE_MSG_TRACING
+	header.producer_id = tc_node_id;
+	header.send_time = tc_client_trace_time_ns();
+#endif
 
-		if ( (ret = sock_send( &sock, NULL, temp, D_MTU+8 )) <= 0 ){
-			fprintf(stderr,"tc_client_topic_send() : ERROR SENDING DATA TO TOPIC %u\n",topic_id);
-			perror("tc_client_topic_send() : ");
+	//Split and send data : path MTU sized fragments sent several per call with UDP segmentation offload, else D_MTU sized fragments
+	while( len > 0 ){
 
-			if ( topic->is_updating ){
-				//Topic updating ( probably its both consumer and producer and is being unregistered as consumer )
-				//This data is invalid now (wont receive the remaining)
-				ret = ERR_TOPIC_IN_UPDATE;
+		if ( topic->fec_k || header.nack_port ){
+			//FEC protected or reliable topic -> whole message (data and parity fragments)
+			ret = tc_client_send_fec( topic, &sock, &header, data, data_size, *temp );
+
+		}else if ( topic->tx_segment_size && len > topic->tx_segment_size - (int)sizeof(FRAG_HEADER) ){
+
+			if ( (ret = tc_client_send_segments( topic, &sock, &header, data + (data_size - len), len, *temp )) == ERR_SOCK_OPTION ){
+				//Not available -> D_MTU fragments from now on
+				fprintf(stderr,"tc_client_topic_send() : UDP SEGMENTATION NOT AVAILABLE ON TOPIC %u -- USING %d BYTES FRAGMENTS\n",topic_id,D_MTU);
+				topic->tx_segment_size = 0;
+				continue;
 			}
 
-			free(temp);
-			tc_client_unlock_topic_tx( topic );
-			return ret;
-		}
+		}else{
 
-		len = len - D_MTU;
-		total = total + D_MTU;
-		seq_n++;
-	}
+			frag_size = ( len > FRAG_PAYLOAD ) ? FRAG_PAYLOAD : len;
+			memcpy( *temp, &header, sizeof(FRAG_HEADER) );
+			memcpy( *temp+sizeof(FRAG_HEADER), data + (data_size - len), frag_size );
 
-	//Send remaining data ( last fragment with size < MTU )
-	if ( len > 0 ){
+			if ( (ret = sock_send( &sock, NULL, *temp, frag_size+sizeof(FRAG_HEADER) )) > 0 ){
+				TC_PROBE5( frag_send, topic_id, tc_node_id, header.frag_seq, frag_size, data_size );
+				TOPIC_STATS_ADD( topic->tx_stats.frags, 1 );
+				header.frag_seq++;
+				ret = frag_size;
+			}
+		}
 
-		*((char *)temp) = seq_n;
-		*(((int *)temp)+1) = data_size;
-		memcpy( temp+8, data + (data_size - len), len );
-		
-		if ( (ret = sock_send( &sock, NULL, temp, len+8 )) <= 0 ){
+		if ( ret <= 0 ){
 			fprintf(stderr,"tc_client_topic_send() : ERROR SENDING DATA TO TOPIC %u\n",topic_id);
 			perror("tc_client_topic_send() : ");
 
@@ -1646,156 +1795,1251 @@ int tc_client_topic_send( unsigned int topic_id , char *data, int data_size )
 				ret = ERR_TOPIC_IN_UPDATE;
 			}
 
-			free(temp);
-			tc_client_unlock_topic_tx( topic );
+			TOPIC_STATS_ADD( topic->tx_stats.errors, 1 );
 			return ret;
 		}
 
-		total = total + len;
+		len = len - ret;
+		total = total + ret;
 	}
 	
-	free(temp);
-	
-	tc_client_unlock_topic_tx( topic );
+	//Kept until the window wraps for the consumers NACKs
+	if ( header.nack_port )
+		tc_client_retx_store( topic, &header, data, data_size );
+
+	TOPIC_STATS_ADD( topic->tx_stats.msgs, 1 );
+	TOPIC_STATS_ADD( topic->tx_stats.bytes, total );
 
 	DEBUG_MSG_TC_CLIENT("tc_client_topic_send() Sent %u bytes to topic Id %u\n",total,topic_id);
 
 	return total;	
 }
 
-int tc_client_topic_receive( unsigned int topic_id, unsigned int timeout, char *ret_data )
+static int tc_client_send_segments( TOPIC_C_ENTRY *topic, SOCK_ENTITY *sock, FRAG_HEADER *header, char *data, int len, char *temp )
 {
-	DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() TOPIC ID %u ...\n",topic_id);
+	int ret, n_frags = 0, size = 0, buff_size = 0, frag_size;
+	int segment = topic->tx_segment_size, max_frags;
+	int first_seq = header->frag_seq;
 
-	int ret = -1;
-	TOPIC_C_ENTRY *topic = NULL;
-	int len = 0, data_size = 0;
-	unsigned int wait = timeout;
-	SOCK_ENTITY sock, unblock_sock;
-	char *temp = NULL, seq_n = 0, got_first = 0;
+	//As many fragments as fit in one datagram worth of data
+	max_frags = (FRAG_PAYLOAD + sizeof(FRAG_HEADER)) / segment;
+	if ( max_frags > UDP_SEGMENT_MAX )
+		max_frags = UDP_SEGMENT_MAX;
 
-	if ( !init ){
-		fprintf(stderr,"tc_client_topic_receive() : MODULE IS NOT INITIALIZED\n");
-		return ERR_C_NOT_INIT;
-	}	
+	//Fragments laid back to back, each one a complete datagram (header and payload) -- only the last one may be shorter
+	while ( n_frags < max_frags && size < len ){
+		frag_size = len - size;
+		if ( frag_size > segment - (int)sizeof(FRAG_HEADER) )
+			frag_size = segment - sizeof(FRAG_HEADER);
 
-	//Validate parameters
-	if ( !topic_id || !ret_data ){
-		fprintf(stderr,"tc_client_topic_receive() : INVALID PARAMETERS\n");
-		return ERR_INVALID_PARAM;
-	}
+		memcpy( temp+buff_size, header, sizeof(FRAG_HEADER) );
+		memcpy( temp+buff_size+sizeof(FRAG_HEADER), data + size, frag_size );
+		TC_PROBE5( frag_send, topic->topic_id, tc_node_id, header->frag_seq, frag_size, header->msg_size );
+		header->frag_seq++;
 
-	//Get topic entry
-	tc_client_db_lock();
+		buff_size = buff_size + sizeof(FRAG_HEADER) + frag_size;
+		size = size + frag_size;
+		n_frags++;
+	}
 
-	if ( !(topic = tc_client_db_topic_search(topic_id) ) || !topic->is_consumer ){
-		fprintf(stderr,"tc_client_topic_receive() : NOT REGISTERED AS CONSUMER OF TOPIC ID %u\n",topic_id);
-		tc_client_db_unlock();
-		return ERR_NODE_NOT_REG_RX;
+	if ( (ret = sock_send_segmented( sock, NULL, temp, buff_size, segment )) <= 0 ){
+		//Restore the header for a retry without segmentation
+		header->frag_seq = first_seq;
+		return ret ? ret : ERR_DATA_SEND;
 	}
 
-	tc_client_db_unlock();
+	TOPIC_STATS_ADD( topic->tx_stats.frags, n_frags );
 
-	//Check if node is bound to topic as consumer
-	if ( !topic->is_rx_bound ){
-		fprintf(stderr,"tc_client_topic_receive() : NODE NOT BOUND TO TOPIC ID %u AS CONSUMER\n",topic_id);
-		return ERR_NODE_NOT_BOUND_RX;	
+	return size;
+}
+
+static int tc_client_send_fec( TOPIC_C_ENTRY *topic, SOCK_ENTITY *sock, FRAG_HEADER *header, char *data, int data_size, char *temp )
+{
+	int ret, i, n_batch = 0, buff_size = 0, max_frags;
+	int payload, segment, n_frags, n_total, offset, size;
+	int block, pos, block_frags, block_parity;
+	int k = topic->fec_k, m = topic->fec_m;
+
+	//Reliable topic without FEC -> blocks of data fragments only
+	if ( !k ){
+		k = FEC_MAX_BLOCK;
+		m = 0;
 	}
 
-	//Lock receive mutex
-	tc_client_lock_topic_rx( topic, wait );
-		
-	//Note : We could got blocked on mutex while channel was being destroyed by the management module
-	//Check if channel being destroyed
-	if ( topic->is_closing ){
-		fprintf(stderr,"tc_client_topic_receive(): TOPIC ID %u IS BEING CLOSED\n",topic_id);
+	//Parity fragments of one block
+	if ( m && !topic->tx_fec_buff && !(topic->tx_fec_buff = (char *) malloc(m * FEC_FRAG_PAYLOAD)) ){
+		fprintf(stderr,"tc_client_topic_send() : NOT ENOUGH MEMORY TO SEND DATA TO TOPIC %u\n",topic->topic_id);
+		return ERR_MEM_MALLOC;
+	}
+
+	//Equal size fragments (the last data fragment is padded) sent block by block : k data fragments then their parity fragments
+	payload = ( data_size < FEC_FRAG_PAYLOAD ) ? data_size : FEC_FRAG_PAYLOAD;
+	segment = payload + sizeof(FRAG_HEADER);
+	n_frags = ( data_size + payload - 1 ) / payload;
+	n_total = tc_fec_wire_size( data_size, k, m ) / payload;
+
+	max_frags = (FRAG_PAYLOAD + sizeof(FRAG_HEADER)) / segment;
+	if ( max_frags > UDP_SEGMENT_MAX )
+		max_frags = UDP_SEGMENT_MAX;
+
+	header->fec_k = k;
+	header->fec_m = m;
+	header->frag_payload = payload;
+
+	for ( header->frag_seq = 0; header->frag_seq < n_total; header->frag_seq++ ){
+
+		block = header->frag_seq / (k + m);
+		pos = header->frag_seq - block * (k + m);
+		block_frags = ( n_frags - block * k < k ) ? n_frags - block * k : k;
+
+		//Block parity computed before its first fragment is sent
+		if ( !pos && m ){
+			offset = block * k * payload;
+			size = ( data_size - offset < block_frags * payload ) ? data_size - offset : block_frags * payload;
+			block_parity = ( block_frags < m ) ? block_frags : m;
+			tc_fec_encode( block_frags, block_parity, payload, (unsigned char *) data + offset, size, (unsigned char *) topic->tx_fec_buff );
+		}
+
+		memcpy( temp+buff_size, header, sizeof(FRAG_HEADER) );
+		if ( pos < block_frags ){
+			offset = (block * k + pos) * payload;
+			size = ( data_size - offset < payload ) ? data_size - offset : payload;
+			memcpy( temp+buff_size+sizeof(FRAG_HEADER), data + offset, size );
+			memset( temp+buff_size+sizeof(FRAG_HEADER)+size, 0, payload - size );
+		}else{
+			memcpy( temp+buff_size+sizeof(FRAG_HEADER), topic->tx_fec_buff + (pos - block_frags) * payload, payload );
+		}
+		TC_PROBE5( frag_send, topic->topic_id, tc_node_id, header->frag_seq, payload, data_size );
+
+		buff_size = buff_size + segment;
+		n_batch++;
+
+		if ( n_batch < max_frags && header->frag_seq + 1 < n_total )
+			continue;
+
+		//Batch full -> one call with UDP segmentation offload, else one call per fragment
+		ret = ERR_DATA_SEND;
+		if ( topic->tx_segment_size && n_batch > 1 && (ret = sock_send_segmented( sock, NULL, temp, buff_size, segment )) == ERR_SOCK_OPTION ){
+			fprintf(stderr,"tc_client_topic_send() : UDP SEGMENTATION NOT AVAILABLE ON TOPIC %u\n",topic->topic_id);
+			topic->tx_segment_size = 0;
+		}
+		if ( !topic->tx_segment_size || n_batch == 1 ){
+			for ( i = 0, ret = 1; i < n_batch && ret > 0; i++ )
+				ret = sock_send( sock, NULL, temp + i * segment, segment );
+		}
+		if ( ret <= 0 )
+			return ret ? ret : ERR_DATA_SEND;
+
+		n_batch = 0;
+		buff_size = 0;
+	}
+
+	TOPIC_STATS_ADD( topic->tx_stats.frags, n_total );
+	TOPIC_STATS_ADD( topic->tx_stats.fec_parity, n_total - n_frags );
+
+	return data_size;
+}
+
+static void tc_client_retx_store( TOPIC_C_ENTRY *topic, FRAG_HEADER *header, char *data, int data_size )
+{
+	TX_RETX *slot;
+	unsigned int data_space, n_frags, payload;
+
+	if ( !topic->tx_retx && !(topic->tx_retx = (TX_RETX *) calloc(RETX_WINDOW, sizeof(TX_RETX))) ){
+		fprintf(stderr,"tc_client_topic_send() : NOT ENOUGH MEMORY FOR THE RETRANSMIT WINDOW OF TOPIC %u\n",topic->topic_id);
+		return;
+	}
+
+	//The message replaces the one sent RETX_WINDOW messages ago
+	slot = &(topic->tx_retx[header->msg_seq % RETX_WINDOW]);
+	slot->header.msg_size = 0;
+
+	//Topic sized buffer : data then the retransmission time of each data fragment (kept between messages)
+	if ( slot->buff_size < topic->channel_size ){
+		data_space = (topic->channel_size + 7) & ~7U;
+		n_frags = (topic->channel_size + FEC_FRAG_PAYLOAD - 1) / FEC_FRAG_PAYLOAD;
+
+		free( slot->data );
+		slot->buff_size = 0;
+		if ( !(slot->data = (char *) malloc(data_space + n_frags * sizeof(unsigned long long))) ){
+			fprintf(stderr,"tc_client_topic_send() : NOT ENOUGH MEMORY FOR THE RETRANSMIT WINDOW OF TOPIC %u\n",topic->topic_id);
+			return;
+		}
+		slot->retx_time = (unsigned long long *)(slot->data + data_space);
+		slot->buff_size = topic->channel_size;
+	}
+
+	payload = header->frag_payload;
+	memcpy( slot->data, data, data_size );
+	memset( slot->retx_time, 0, (data_size + payload - 1) / payload * sizeof(unsigned long long) );
+	slot->header = *header;
+	slot->header.frag_seq = 0;
+
+	topic->tx_retx_last = tc_time_get_us();
+}
+
+static void tc_client_retransmit( TOPIC_C_ENTRY *topic, char **temp )
+{
+	int nack[(sizeof(FRAG_HEADER) + NACK_MAX_FRAGS * sizeof(int)) / sizeof(int)];
+	int ret, i, n_req, seq, idx, k, m, payload, n_frags;
+	unsigned long long now;
+	FRAG_HEADER header;
+	TX_RETX *slot;
+
+	while ( sock_pending( &topic->tx_nack_sock ) > 0 ){
+
+		if ( (ret = sock_receive( &topic->tx_nack_sock, NULL, 1, (char *) nack, sizeof(nack), NULL )) < 0 )
+			break;
+
+		//NACK : message header followed by the lost fragments (none -> the whole message was lost)
+		if ( ret < (int)sizeof(FRAG_HEADER) )
+			continue;
+		memcpy( &header, nack, sizeof(FRAG_HEADER) );
+		n_req = (ret - sizeof(FRAG_HEADER)) / sizeof(int);
+
+		slot = topic->tx_retx ? &(topic->tx_retx[header.msg_seq % RETX_WINDOW]) : NULL;
+
+		if ( header.frag_seq != FRAG_NACK || !slot || !slot->header.msg_size || slot->header.msg_seq != header.msg_seq ){
+			DEBUG_MSG_TC_CLIENT("tc_client_topic_send() : NACK of message %u out of the retransmit window of topic_id %u\n",header.msg_seq,topic->topic_id);
+			TOPIC_STATS_ADD( topic->tx_stats.retx_drops, n_req ? n_req : 1 );
+			continue;
+		}
+
+		k = slot->header.fec_k;
+		m = slot->header.fec_m;
+		payload = slot->header.frag_payload;
+		n_frags = ( slot->header.msg_size + payload - 1 ) / payload;
+		now = tc_time_get_us();
+
+		//Only data fragments are retransmitted (FEC parity isn't kept)
+		for ( i = 0; i < (n_req ? n_req : n_frags); i++ ){
+
+			if ( n_req ){
+				memcpy( &seq, (char *) nack + sizeof(FRAG_HEADER) + i * sizeof(int), sizeof(int) );
+				if ( seq < 0 || seq % (k + m) >= k || (idx = seq / (k + m) * k + seq % (k + m)) >= n_frags )
+					continue;
+			}else{
+				idx = i;
+			}
+
+			if ( (ret = tc_client_retx_frag( topic, slot, idx, now, temp )) == ERR_DATA_PACED )
+				TOPIC_STATS_ADD( topic->tx_stats.retx_drops, 1 );
+			else if ( ret < 0 )
+				return;
+		}
+
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_send() Served NACK of message %u (%d fragments) on topic_id %u\n",header.msg_seq,n_req,topic->topic_id);
+	}
+}
+
+static void tc_client_retx_tail( TOPIC_C_ENTRY *topic, char **temp )
+{
+	TX_RETX *slot;
+	int ret;
+	unsigned int msg_seq = topic->tx_msg_seq - 1;
+	unsigned long long now = tc_time_get_us();
+
+	if ( !topic->tx_retx_last || now < topic->tx_retx_last + RETX_TAIL_DELAY*1000ULL )
+		return;
+
+	slot = &(topic->tx_retx[msg_seq % RETX_WINDOW]);
+	if ( !slot->header.msg_size || slot->header.msg_seq != msg_seq ){
+		topic->tx_retx_last = 0;
+		return;
+	}
+
+	//A lost message is only noticed by the consumers on the next one -> the ones that lost the last message get its first fragment (and NACK the rest)
+	//Tried again on the next pass if the retransmissions share is used up
+	if ( (ret = tc_client_retx_frag( topic, slot, 0, now, temp )) == ERR_DATA_PACED )
+		return;
+
+	topic->tx_retx_last = 0;
+
+	if ( ret > 0 )
+		DEBUG_MSG_TC_CLIENT("tc_client_retx_tail() Announced last message %u of topic_id %u\n",msg_seq,topic->topic_id);
+}
+
+static int tc_client_retx_frag( TOPIC_C_ENTRY *topic, TX_RETX *slot, int idx, unsigned long long now, char **temp )
+{
+	int k = slot->header.fec_k, m = slot->header.fec_m, payload = slot->header.frag_payload;
+	int segment = payload + sizeof(FRAG_HEADER), offset, size;
+	unsigned long long period, cost, start;
+
+	//Already retransmitted for another consumer
+	if ( slot->retx_time[idx] && now < slot->retx_time[idx] + RETX_HOLDOFF*1000ULL )
+		return 0;
+
+	//Retransmissions share of the topic reservation : token bucket one period deep (see tc_client_pace)
+	period = topic->channel_period * 1000ULL;
+	cost = (unsigned long long)segment * period * 100 / ((unsigned long long)tc_fec_wire_size( topic->channel_size, topic->fec_k, topic->fec_m ) * topic->retx_share);
+	start = ( topic->tx_retx_tat > now ) ? topic->tx_retx_tat : now;
+
+	if ( start + cost > now + period )
+		return ERR_DATA_PACED;
+
+	if ( !*temp && !(*temp = (char *) malloc(FRAG_PAYLOAD+sizeof(FRAG_HEADER))) ){
+		fprintf(stderr,"tc_client_topic_send() : NOT ENOUGH MEMORY TO RETRANSMIT DATA TO TOPIC %u\n",topic->topic_id);
+		return ERR_MEM_MALLOC;
+	}
+
+	offset = idx * payload;
+	size = ( slot->header.msg_size - offset < payload ) ? slot->header.msg_size - offset : payload;
+
+	slot->header.frag_seq = idx / k * (k + m) + idx % k;
+	memcpy( *temp, &(slot->header), sizeof(FRAG_HEADER) );
+	memcpy( *temp+sizeof(FRAG_HEADER), slot->data + offset, size );
+	memset( *temp+sizeof(FRAG_HEADER)+size, 0, payload - size );
+
+	if ( sock_send( &topic->topic_sock, NULL, *temp, segment ) <= 0 ){
+		TOPIC_STATS_ADD( topic->tx_stats.errors, 1 );
+		return ERR_DATA_SEND;
+	}
+	TC_PROBE5( frag_send, topic->topic_id, tc_node_id, slot->header.frag_seq, payload, slot->header.msg_size );
+
+	topic->tx_retx_tat = start + cost;
+	slot->retx_time[idx] = now;
+	TOPIC_STATS_ADD( topic->tx_stats.retx_frags, 1 );
+
+	return 1;
+}
+
+static int tc_client_pace( TOPIC_C_ENTRY *topic, int data_size, char newer )
+{
+	unsigned long long now, start, period, cost, depth, t_wait;
+	struct timespec departure;
+
+	if ( topic->tx_pacing == TC_PACING_OFF || !topic->channel_size || !topic->channel_period )
+		return ERR_OK;
+
+	//Token bucket as a virtual clock : a message costs its share of the topic period and the bucket depth is the reserved burst
+	//(channel_size * RESERV_SLACK_MULTIPLIER bytes). The bucket is full once tx_tat is reached. FEC parity fragments are part of the reservation
+	period = topic->channel_period * 1000ULL;
+	cost = (unsigned long long)tc_fec_wire_size( data_size, topic->fec_k, topic->fec_m ) * period / tc_fec_wire_size( topic->channel_size, topic->fec_k, topic->fec_m );
+	depth = period * RESERV_SLACK_MULTIPLIER;
+
+	now = tc_time_get_us();
+	start = ( topic->tx_tat > now ) ? topic->tx_tat : now;
+
+	//Not enough tokens -> earliest departure time is start + cost - depth
+	if ( start + cost > now + depth ){
+
+		if ( topic->tx_pacing == TC_PACING_DROP || (topic->tx_pacing == TC_PACING_COALESCE && newer) ){
+			TOPIC_STATS_ADD( topic->tx_stats.pacing_drops, 1 );
+			return ( topic->tx_pacing == TC_PACING_DROP ) ? ERR_DATA_PACED : ERR_DATA_COALESCED;
+		}
+
+		t_wait = tc_client_time_ns();
+		tc_time_to_timespec( start + cost - depth, &departure );
+		while ( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &departure, NULL ) == EINTR );
+		TOPIC_STATS_ADD( topic->tx_stats.pacing_wait, tc_client_time_ns() - t_wait );
+	}
+
+	topic->tx_tat = start + cost;
+
+	return ERR_OK;
+}
+
+int tc_client_topic_set_pacing( unsigned int topic_id, unsigned char policy )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_set_pacing() TOPIC ID %u ...\n",topic_id);
+
+	TOPIC_C_ENTRY *topic = NULL;
+	TX_PACING pacing;
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_topic_set_pacing() : MODULE IS NOT INITIALIZED\n");
+		return ERR_C_NOT_INIT;
+	}	
+
+	//Validate parameters (public policy codes -> internal)
+	switch ( policy ){
+		case PACING_OFF : pacing = TC_PACING_OFF; break;
+		case PACING_BLOCK : pacing = TC_PACING_BLOCK; break;
+		case PACING_DROP : pacing = TC_PACING_DROP; break;
+		case PACING_COALESCE : pacing = TC_PACING_COALESCE; break;
+		default :
+			fprintf(stderr,"tc_client_topic_set_pacing() : INVALID PARAMETERS\n");
+			return ERR_INVALID_PARAM;
+	}
+
+	if ( !topic_id ){
+		fprintf(stderr,"tc_client_topic_set_pacing() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
+	}
+
+	if ( !(topic = tc_client_db_topic_get(topic_id)) ){
+		fprintf(stderr,"tc_client_topic_set_pacing() : TOPIC ID %u NOT REGISTERED IN THIS NODE\n",topic_id);
+		return ERR_TOPIC_NOT_REG;
+	}
+
+	//Pacing state belongs to the transmission mutex holder (starts with a full bucket)
+	tc_client_lock_topic_tx( topic, 0 );
+	topic->tx_pacing = pacing;
+	topic->tx_tat = 0;
+	tc_client_unlock_topic_tx( topic );
+
+	tc_client_db_topic_put( topic );
+
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_set_pacing() Topic Id %u pacing policy %u\n",topic_id,policy);
+
+	return ERR_OK;
+}
+
+int tc_client_topic_set_delivery( unsigned int topic_id, unsigned char mode )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_set_delivery() TOPIC ID %u ...\n",topic_id);
+
+	TOPIC_C_ENTRY *topic = NULL;
+	RX_DELIVERY delivery;
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_topic_set_delivery() : MODULE IS NOT INITIALIZED\n");
+		return ERR_C_NOT_INIT;
+	}	
+
+	//Validate parameters (public delivery codes -> internal)
+	switch ( mode ){
+		case DELIVERY_ALL : delivery = TC_DELIVERY_ALL; break;
+		case DELIVERY_LATEST : delivery = TC_DELIVERY_LATEST; break;
+		default :
+			fprintf(stderr,"tc_client_topic_set_delivery() : INVALID PARAMETERS\n");
+			return ERR_INVALID_PARAM;
+	}
+
+	if ( !topic_id ){
+		fprintf(stderr,"tc_client_topic_set_delivery() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
+	}
+
+	if ( !(topic = tc_client_db_topic_get(topic_id)) ){
+		fprintf(stderr,"tc_client_topic_set_delivery() : TOPIC ID %u NOT REGISTERED IN THIS NODE\n",topic_id);
+		return ERR_TOPIC_NOT_REG;
+	}
+
+	//Delivery mode belongs to the reception mutex holder
+	tc_client_lock_topic_rx( topic, 0 );
+	topic->rx_delivery = delivery;
+	tc_client_unlock_topic_rx( topic );
+
+	tc_client_db_topic_put( topic );
+
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_set_delivery() Topic Id %u delivery mode %u\n",topic_id,mode);
+
+	return ERR_OK;
+}
+
+int tc_client_topic_receive( unsigned int topic_id, unsigned int timeout, char *ret_data )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() TOPIC ID %u ...\n",topic_id);
+
+	int ret;
+	TOPIC_C_ENTRY *topic = NULL;
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_topic_receive() : MODULE IS NOT INITIALIZED\n");
+		return ERR_C_NOT_INIT;
+	}	
+
+	//Validate parameters
+	if ( !topic_id || !ret_data ){
+		fprintf(stderr,"tc_client_topic_receive() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
+	}
+
+	//Get topic entry (referenced so it isn't freed if the topic is destroyed while receiving)
+	if ( !(topic = tc_client_db_topic_get(topic_id)) ){
+		fprintf(stderr,"tc_client_topic_receive() : NOT REGISTERED AS CONSUMER OF TOPIC ID %u\n",topic_id);
+		return ERR_NODE_NOT_REG_RX;
+	}
+
+	ret = tc_client_receive( topic, timeout, ret_data );
+
+	tc_client_db_topic_put( topic );
+
+	return ret;
+}
+
+int tc_client_handle_receive( TC_TOPIC_HANDLE *handle, unsigned int timeout, char *ret_data )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_handle_receive() ...\n");
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_handle_receive() : MODULE IS NOT INITIALIZED\n");
+		return ERR_C_NOT_INIT;
+	}	
+
+	//Validate parameters
+	if ( !handle || !ret_data ){
+		fprintf(stderr,"tc_client_handle_receive() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
+	}
+
+	return tc_client_receive( handle, timeout, ret_data );
+}
+
+static int tc_client_receive( TOPIC_C_ENTRY *topic, unsigned int timeout, char *ret_data )
+{
+	int ret = -1, len;
+	unsigned int topic_id = topic->topic_id;
+	unsigned long long t_lock, deadline;
+
+	//Check if node is registered as consumer (the entry may have been deleted while referenced)
+	if ( !topic->is_consumer ){
+		fprintf(stderr,"tc_client_topic_receive() : NOT REGISTERED AS CONSUMER OF TOPIC ID %u\n",topic_id);
+		return ERR_NODE_NOT_REG_RX;
+	}
+
+	//Check if node is bound to topic as consumer
+	if ( !topic->is_rx_bound ){
+		fprintf(stderr,"tc_client_topic_receive() : NODE NOT BOUND TO TOPIC ID %u AS CONSUMER\n",topic_id);
+		return ERR_NODE_NOT_BOUND_RX;	
+	}
+
+	//The timeout covers both the wait for the receive mutex and for the message
+	deadline = tc_time_deadline( timeout );
+
+	//Lock receive mutex
+	t_lock = tc_client_time_ns();
+	if ( tc_client_lock_topic_rx( topic, deadline ) ){
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Timed-out waiting for topic ID %u reception lock\n",topic_id);
+		TOPIC_STATS_ADD( topic->rx_stats.lock_wait, tc_client_time_ns() - t_lock );
+		TOPIC_STATS_ADD( topic->rx_stats.timeouts, 1 );
+		return ERR_DATA_TIMEOUT;
+	}
+	TOPIC_STATS_ADD( topic->rx_stats.lock_wait, tc_client_time_ns() - t_lock );
+
+	//Note : We could got blocked on mutex while channel was being destroyed by the management module
+	//Check if channel being destroyed
+	if ( topic->is_closing ){
+		fprintf(stderr,"tc_client_topic_receive(): TOPIC ID %u IS BEING CLOSED\n",topic_id);
+		tc_client_unlock_topic_rx( topic );
+		return ERR_TOPIC_CLOSING;
+	}
+
+	//Several MTU fragments can be received so we need to collect all of them and restore original data
+	//Alloc the topic reception buffer on first use (one datagram -- several fragments with UDP GRO)
+	if ( !topic->rx_buff && !(topic->rx_buff = (char *) malloc(FRAG_PAYLOAD+sizeof(FRAG_HEADER))) ){
+		fprintf(stderr,"tc_client_topic_receive() : NOT ENOUGH MEMORY TO RECEIVE DATA FROM TOPIC %u\n",topic_id);
 		tc_client_unlock_topic_rx( topic );
+		return ERR_MEM_MALLOC;			
+	}
+
+	//Wait for a message. With latest value delivery then keep reading while there is queued data, holding the newest complete message
+	if ( (ret = tc_client_receive_msg( topic, deadline, 0, ret_data )) > 0 && topic->rx_delivery == TC_DELIVERY_LATEST ){
+		while ( (len = tc_client_receive_msg( topic, 0, 1, ret_data )) > 0 ){
+			TOPIC_STATS_ADD( topic->rx_stats.conflated, 1 );
+			ret = len;
+		}
+	}
+
+	tc_client_unlock_topic_rx( topic );
+
+	if ( ret > 0 ){
+		TOPIC_STATS_ADD( topic->rx_stats.msgs, 1 );
+		TOPIC_STATS_ADD( topic->rx_stats.bytes, ret );
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() Received %d bytes from topic Id %u\n",ret,topic_id);
+	}
+
+	return ret;
+}
+
+static int tc_client_receive_fail( TOPIC_C_ENTRY *topic, int ret )
+{
+	unsigned int topic_id = topic->topic_id;
+
+	//Received unblock signal -- Check if node was unbound/unregistered from topic
+	if ( (ret == ERR_DATA_UNBLOCK) && topic->is_closing ){
+		fprintf(stderr,"tc_client_topic_receive() : UNBLOCK -- TOPIC ID %u IS BEING CLOSED\n",topic_id);
 		return ERR_TOPIC_CLOSING;
+
+	}else	if ( (ret == ERR_DATA_UNBLOCK) && !topic->is_rx_bound ){
+		fprintf(stderr,"tc_client_topic_receive() : UNBLOCK -- NODE NOT BOUND TO TOPIC ID %u AS CONSUMER\n",topic_id);
+		return ERR_NODE_NOT_BOUND_RX;
+
+	}else	if ( (ret == ERR_DATA_UNBLOCK) && !topic->is_consumer ){
+		fprintf(stderr,"tc_client_topic_receive() : UNBLOCK -- NOT REGISTERED AS CONSUMER OF TOPIC ID %u\n",topic_id);
+		return ERR_NODE_NOT_REG_RX;
+
+	}else if ( ret == ERR_DATA_UNBLOCK ){
+		//Probably an unread unlock message from other threads? Ignore it
+		return ERR_OK;
+	}
+
+	if ( topic->is_updating ){
+		//Topic updating ( probably its both consumer and producer and is being unregistered as producer )
+		//This data is invalid now (wont receive the remaining)
+		fprintf(stderr,"tc_client_topic_receive() : UNBLOCK -- TOPIC ID %u UPDATING\n",topic_id);
+		ret = ERR_TOPIC_IN_UPDATE;
+	}
+
+	if ( ret == ERR_DATA_TIMEOUT )
+		TOPIC_STATS_ADD( topic->rx_stats.timeouts, 1 );
+	else
+		TOPIC_STATS_ADD( topic->rx_stats.errors, 1 );
+
+	//Other error during receive
+	fprintf(stderr,"tc_client_topic_receive() : ERROR RECEIVING DATA FROM TOPIC %u\n",topic_id);
+
+	return ret;
+}
+
+static int tc_client_receive_msg( TOPIC_C_ENTRY *topic, unsigned long long deadline, char drain, char *ret_data )
+{
+	int frag_size, seq_n, ret;
+	unsigned int topic_id = topic->topic_id;
+	char *frag;
+	FRAG_HEADER header;
+	RX_REASM *reasm;
+
+	for(;;){
+		if ( (frag_size = tc_client_receive_frag( topic, deadline, drain, &frag )) <= 0 )
+			return frag_size;
+
+		memcpy( &header, frag, sizeof(FRAG_HEADER) );
+		seq_n = header.frag_seq;
+		frag_size = frag_size - sizeof(FRAG_HEADER);
+
+		TC_PROBE5( frag_receive, topic_id, tc_node_id, seq_n, frag_size, header.msg_size );
+		TOPIC_STATS_ADD( topic->rx_stats.frags, 1 );
+
+		//Discard fragments that don't fit in the topic messages
+		if ( frag_size <= 0 || seq_n < 0 || header.msg_size <= 0 || (unsigned int) header.msg_size > topic->channel_size || frag_size > header.msg_size ){
+			DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Received invalid fragment (%d) on topic_id %u\n",seq_n,topic_id);
+			TC_PROBE3( frag_stale, topic_id, tc_node_id, seq_n );
+			TOPIC_STATS_ADD( topic->rx_stats.stale_frags, 1 );
+			continue;
+		}
+
+		//FEC protected message -> fragments are collected per FEC block (any order, lost ones rebuilt)
+		if ( header.fec_k ){
+			if ( (ret = tc_client_receive_fec( topic, &header, frag+sizeof(FRAG_HEADER), frag_size, ret_data )) )
+				return ret;
+			continue;
+		}
+
+		//Single fragment message -> straight to the application buffer
+		if ( !seq_n && frag_size == header.msg_size ){
+			memcpy( ret_data, frag+sizeof(FRAG_HEADER), frag_size );
+#if ENABLE_MSG_TRACING
+			tc_client_trace_msg( topic, &header );
+#endif
+			return frag_size;
+		}
+
+		//Its possible to receive old fragments from other messages when a producer tries to send at a rate faster than the negotiated
+		//In this case some fragments got queued at the producer and the consumers timed-out while receiving
+		//Discard this fragments and wait for the first of the new message
+		if ( !(reasm = tc_client_reasm_find( topic, &(topic->rx_sender), &header )) ){
+			DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Received old fragment (%d) on topic_id %u\n",seq_n,topic_id);
+			TC_PROBE3( frag_stale, topic_id, tc_node_id, seq_n );
+			TOPIC_STATS_ADD( topic->rx_stats.stale_frags, 1 );
+			continue;
+		}
+
+		//Fragments arrive in order -> each one follows the previous ones (their size depends on the producer segmentation)
+		if ( reasm->len + frag_size > reasm->header.msg_size ){
+			DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Received invalid fragment (%d) on topic_id %u\n",seq_n,topic_id);
+			TC_PROBE3( frag_stale, topic_id, tc_node_id, seq_n );
+			TOPIC_STATS_ADD( topic->rx_stats.stale_frags, 1 );
+			TOPIC_STATS_ADD( topic->rx_stats.reasm_timeouts, 1 );
+			reasm->in_use = 0;
+			continue;
+		}
+
+		//Reassembly buffer sized for the topic messages (kept between receive calls)
+		if ( reasm->buff_size < header.msg_size ){
+			free( reasm->buff );
+			reasm->buff_size = 0;
+			if ( !(reasm->buff = (char *) malloc(topic->channel_size)) ){
+				fprintf(stderr,"tc_client_topic_receive() : NOT ENOUGH MEMORY TO RECEIVE DATA FROM TOPIC %u\n",topic_id);
+				reasm->in_use = 0;
+				TOPIC_STATS_ADD( topic->rx_stats.errors, 1 );
+				return ERR_MEM_MALLOC;
+			}
+			reasm->buff_size = topic->channel_size;
+		}
+
+		//Copy data from the reception buffer to the producer context
+		memcpy( reasm->buff+reasm->len, frag+sizeof(FRAG_HEADER), frag_size );
+		reasm->len = reasm->len + frag_size;
+		reasm->next_seq++;
+		reasm->last = tc_time_get_us();
+
+		if ( reasm->len < reasm->header.msg_size )
+			continue;
+
+		//Message complete
+		reasm->in_use = 0;
+		memcpy( ret_data, reasm->buff, reasm->len );
+#if ENABLE_MSG_TRACING
+		tc_client_trace_msg( topic, &(reasm->header) );
+#endif
+		return reasm->len;
+	}
+}
+
+static int tc_client_receive_fec( TOPIC_C_ENTRY *topic, FRAG_HEADER *header, char *frag, int frag_size, char *ret_data )
+{
+	int k = header->fec_k, m = header->fec_m, payload = header->frag_payload, seq_n = header->frag_seq;
+	int n_frags, n_total, size, i, n_have, n_data;
+	int block, pos, block_frags, block_parity;
+	unsigned long long have_data = 0, have_parity = 0;
+	unsigned int topic_id = topic->topic_id;
+	char *received, *block_data, *block_fec;
+	RX_REASM *reasm;
+
+	//Equal size fragments : data fragments followed by the parity fragments of each block (no parity fragments if only reliable)
+	if ( (!m && !header->nack_port) || k + m > FEC_MAX_BLOCK || frag_size != payload || payload != ((header->msg_size < FEC_FRAG_PAYLOAD) ? header->msg_size : FEC_FRAG_PAYLOAD) ||
+	     seq_n >= (int)(tc_fec_wire_size( header->msg_size, k, m ) / payload) ){
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Received invalid FEC fragment (%d) on topic_id %u\n",seq_n,topic_id);
+		TC_PROBE3( frag_stale, topic_id, tc_node_id, seq_n );
+		TOPIC_STATS_ADD( topic->rx_stats.stale_frags, 1 );
+		return 0;
+	}
+
+	n_frags = ( header->msg_size + payload - 1 ) / payload;
+	n_total = tc_fec_wire_size( header->msg_size, k, m ) / payload;
+
+	reasm = tc_client_reasm_find( topic, &(topic->rx_sender), header );
+
+	//Lost message of a reliable producer -> known from now on
+	if ( reasm && !reasm->header.msg_size )
+		reasm->header = *header;
+
+	if ( !reasm || reasm->header.msg_size != header->msg_size || reasm->header.fec_k != k || reasm->header.fec_m != m ){
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Received invalid FEC fragment (%d) on topic_id %u\n",seq_n,topic_id);
+		TC_PROBE3( frag_stale, topic_id, tc_node_id, seq_n );
+		TOPIC_STATS_ADD( topic->rx_stats.stale_frags, 1 );
+		return 0;
+	}
+
+	//Parity fragments left of a delivered message
+	if ( reasm->in_use == 2 )
+		return 0;
+
+	//New message : fragments then one received flag per fragment
+	if ( !reasm->fec_blocks ){
+		size = n_total * payload + n_total;
+		if ( reasm->buff_size < size ){
+			free( reasm->buff );
+			reasm->buff_size = 0;
+			if ( !(reasm->buff = (char *) malloc(size)) ){
+				fprintf(stderr,"tc_client_topic_receive() : NOT ENOUGH MEMORY TO RECEIVE DATA FROM TOPIC %u\n",topic_id);
+				reasm->in_use = 0;
+				TOPIC_STATS_ADD( topic->rx_stats.errors, 1 );
+				return ERR_MEM_MALLOC;
+			}
+			reasm->buff_size = size;
+		}
+		memset( reasm->buff + n_total * payload, 0, n_total );
+		reasm->fec_blocks = ( n_frags + k - 1 ) / k;
+	}
+
+	received = reasm->buff + n_total * payload;
+	reasm->last = tc_time_get_us();
+
+	if ( received[seq_n] )
+		return 0;
+
+	block = seq_n / (k + m);
+	pos = seq_n - block * (k + m);
+	block_frags = ( n_frags - block * k < k ) ? n_frags - block * k : k;
+	block_parity = ( block_frags < m ) ? block_frags : m;
+	block_data = reasm->buff + block * k * payload;
+	block_fec = reasm->buff + n_frags * payload + block * m * payload;
+
+	memcpy( (pos < block_frags) ? block_data + pos * payload : block_fec + (pos - block_frags) * payload, frag, payload );
+	received[seq_n] = 1;
+
+	//Reliable message -> NACK the missing fragments (sent in order : the ones skipped were lost, else the last ones if the producer goes silent)
+	if ( header->nack_port ){
+		if ( seq_n > reasm->highest_seq + 1 )
+			tc_client_nack_schedule( topic, reasm, 0, 1, reasm->last );
+		else
+			tc_client_nack_schedule( topic, reasm, NACK_DELAY*1000ULL, 0, reasm->last );
+		if ( seq_n > reasm->highest_seq )
+			reasm->highest_seq = seq_n;
+	}
+
+	//Any block_frags fragments of the block rebuild its data (the following ones are ignored)
+	for ( i = 0, n_have = 0, n_data = 0; i < block_frags + block_parity; i++ ){
+		if ( !received[block * (k + m) + i] )
+			continue;
+		n_have++;
+		if ( i < block_frags ){
+			have_data |= 1ULL << i;
+			n_data++;
+		}else{
+			have_parity |= 1ULL << (i - block_frags);
+		}
+	}
+
+	if ( n_have != block_frags )
+		return 0;
+
+	if ( n_data < block_frags ){
+		tc_fec_decode( block_frags, block_parity, payload, (unsigned char *) block_data, have_data, (unsigned char *) block_fec, have_parity );
+		TOPIC_STATS_ADD( topic->rx_stats.fec_recovered, block_frags - n_data );
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Rebuilt %d fragments of message block %d on topic_id %u\n",block_frags - n_data,block,topic_id);
+	}
+
+	if ( --reasm->fec_blocks )
+		return 0;
+
+	//Message complete -> the remaining parity fragments are dropped
+	reasm->in_use = 2;
+	memcpy( ret_data, reasm->buff, header->msg_size );
+#if ENABLE_MSG_TRACING
+	tc_client_trace_msg( topic, &(reasm->header) );
+#endif
+	return header->msg_size;
+}
+
+static int tc_client_receive_frag( TOPIC_C_ENTRY *topic, unsigned long long deadline, char drain, char **ret_frag )
+{
+	int ret = -1;
+	unsigned int wait, segment_size;
+	unsigned long long now, expiry;
+	SOCK_ENTITY sock, unblock_sock;
+
+	//Next fragment of the last received datagram (several coalesced fragments with UDP GRO)
+	while ( topic->rx_left <= 0 ){
+		sock = topic->topic_sock;
+		unblock_sock = topic->unblock_rx_sock;
+
+		//Discard the incomplete messages whose next fragment didn't arrive in time
+		now = tc_time_get_us();
+		expiry = tc_client_reasm_expire( topic, now );
+
+		if ( drain ){
+			//Only queued data is read
+			if ( sock_pending( &sock ) <= 0 )
+				return 0;
+			wait = 1;
+		}else{
+			//Time left until the deadline (at least 1 ms so an expired deadline isn't taken as "block indefinitely"), waking up for the next expiry
+			if ( deadline && !(wait = tc_time_left_ms( deadline )) )
+				wait = 1;
+			else if ( !deadline )
+				wait = 0;
+
+			if ( expiry && (!wait || (expiry - now + 999)/1000 < wait) )
+				wait = (expiry - now + 999)/1000;
+		}
+
+		if ( (ret = sock_receive_segmented( &sock, &unblock_sock, wait, topic->rx_buff, FRAG_PAYLOAD+sizeof(FRAG_HEADER), &(topic->rx_sender), &segment_size )) < 0){
+
+			//Woke up for an incomplete message expiry before the deadline
+			if ( (ret == ERR_DATA_TIMEOUT) && !drain && (!deadline || tc_time_get_us() < deadline) )
+				continue;
+
+			if ( !(ret = tc_client_receive_fail( topic, ret )) )
+				continue;
+
+			return ret;
+		}
+
+		topic->rx_next = 0;
+		topic->rx_left = ret;
+		topic->rx_segment_size = segment_size ? segment_size : ret;
+	}
+
+	*ret_frag = topic->rx_buff + topic->rx_next;
+	ret = ( topic->rx_left > topic->rx_segment_size ) ? topic->rx_segment_size : topic->rx_left;
+	topic->rx_next = topic->rx_next + ret;
+	topic->rx_left = topic->rx_left - ret;
+
+	return ret;
+}
+
+static RX_REASM* tc_client_reasm_find( TOPIC_C_ENTRY *topic, NET_ADDR *sender, FRAG_HEADER *header )
+{
+	int i, gap = 0;
+	char newest = 0, *buff;
+	unsigned int newest_seq = 0, buff_size;
+	unsigned long long now;
+	RX_REASM *reasm, *lost;
+
+	for ( i = 0; i < RX_REASM_CONTEXTS; i++ ){
+		reasm = &(topic->rx_reasm[i]);
+
+		if ( !reasm->in_use || reasm->sender.port != sender->port || strcmp( reasm->sender.name_ip, sender->name_ip ) )
+			continue;
+
+		//Next fragment of the message being reassembled (any fragment of a FEC protected or reliable message, or of a delivered one)
+		if ( reasm->header.msg_seq == header->msg_seq && (header->fec_k || reasm->next_seq == header->frag_seq) )
+			return reasm;
+
+		//Reliable producer -> its previous messages are kept until repaired (delivered ones drop their late fragments)
+		if ( header->nack_port ){
+			if ( !newest || (int)(reasm->header.msg_seq - newest_seq) > 0 )
+				newest_seq = reasm->header.msg_seq;
+			newest = 1;
+			continue;
+		}
+
+		//A producer sends one message at a time -> at most one context per sender
+		//Delivered FEC protected message -> the producer moved on
+		if ( reasm->in_use == 2 ){
+			reasm->in_use = 0;
+			break;
+		}
+
+		//The producer moved on to another message (or a fragment was lost) -> this one can't be completed
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Discarding incomplete message from %s:%u on topic_id %u\n",sender->name_ip,sender->port,topic->topic_id);
+		TOPIC_STATS_ADD( topic->rx_stats.reasm_timeouts, 1 );
+		reasm->in_use = 0;
+		break;
+	}
+
+	//Only the first fragment starts a message (any fragment if FEC protected or reliable, the first ones may be lost)
+	if ( header->frag_seq && !header->fec_k )
+		return NULL;
+
+	now = tc_time_get_us();
+
+	if ( newest ){
+		//Older message of a reliable producer -> already delivered or given up (far older -> the producer restarted)
+		gap = header->msg_seq - newest_seq;
+		if ( gap <= 0 && gap > -RETX_WINDOW )
+			return NULL;
+
+		//The producer moved on -> the missing fragments of its previous messages were lost
+		for ( i = 0; i < RX_REASM_CONTEXTS; i++ ){
+			reasm = &(topic->rx_reasm[i]);
+			if ( reasm->in_use == 1 && reasm->sender.port == sender->port && !strcmp( reasm->sender.name_ip, sender->name_ip ) )
+				tc_client_nack_schedule( topic, reasm, 0, 0, now );
+		}
+	}
+
+	reasm = tc_client_reasm_alloc( topic, 1 );
+	reasm->in_use = 1;
+	reasm->sender = *sender;
+	reasm->header = *header;
+	reasm->len = 0;
+	reasm->next_seq = 0;
+	reasm->fec_blocks = 0;
+	reasm->highest_seq = -1;
+	reasm->nack_time = reasm->nack_sent = 0;
+	reasm->nack_gap = 0;
+	reasm->last = now;
+
+	//Messages of a reliable producer lost in between -> NACKed as a whole (as many as free or delivered contexts)
+	for ( i = 1; i < gap && gap <= RETX_WINDOW && (lost = tc_client_reasm_alloc( topic, 0 )); i++ ){
+		buff = lost->buff;
+		buff_size = lost->buff_size;
+		*lost = *reasm;
+		lost->buff = buff;
+		lost->buff_size = buff_size;
+		lost->header.msg_seq = newest_seq + i;
+		lost->header.msg_size = 0;
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Lost message %u from %s:%u on topic_id %u\n",lost->header.msg_seq,sender->name_ip,sender->port,topic->topic_id);
+		tc_client_nack_schedule( topic, lost, 0, 1, now );
+	}
+
+	return reasm;
+}
+
+static RX_REASM* tc_client_reasm_alloc( TOPIC_C_ENTRY *topic, char evict )
+{
+	int i;
+	RX_REASM *reasm, *done = NULL, *oldest = NULL;
+
+	for ( i = 0; i < RX_REASM_CONTEXTS; i++ ){
+		reasm = &(topic->rx_reasm[i]);
+
+		if ( !reasm->in_use )
+			return reasm;
+
+		if ( reasm->in_use == 2 && (!done || reasm->last < done->last) )
+			done = reasm;
+		else if ( reasm->in_use == 1 && (!oldest || reasm->last < oldest->last) )
+			oldest = reasm;
+	}
+
+	//All contexts in use -> reuse the least recently delivered message, else discard the least recently updated incomplete message
+	if ( done || !evict )
+		return done;
+
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Discarding incomplete message from %s:%u on topic_id %u (too many producers)\n",oldest->sender.name_ip,oldest->sender.port,topic->topic_id);
+	TOPIC_STATS_ADD( topic->rx_stats.reasm_timeouts, 1 );
+
+	return oldest;
+}
+
+static unsigned long long tc_client_reasm_expire( TOPIC_C_ENTRY *topic, unsigned long long now )
+{
+	int i;
+	unsigned long long expiry, timeout, next = 0;
+	RX_REASM *reasm;
+
+	for ( i = 0; i < RX_REASM_CONTEXTS; i++ ){
+		reasm = &(topic->rx_reasm[i]);
+
+		if ( reasm->in_use != 1 )
+			continue;
+
+		//Reliable message -> kept as long as the producer may retransmit it (RETX_WINDOW messages at the topic rate)
+		timeout = FRAG_TIMEOUT;
+		if ( reasm->header.nack_port && topic->channel_period * RETX_WINDOW > timeout )
+			timeout = topic->channel_period * RETX_WINDOW;
+
+		expiry = reasm->last + timeout*1000ULL;
+
+		if ( expiry <= now ){
+			DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : Fragment timeout on message from %s:%u on topic_id %u\n",reasm->sender.name_ip,reasm->sender.port,topic->topic_id);
+			TOPIC_STATS_ADD( topic->rx_stats.reasm_timeouts, 1 );
+			reasm->in_use = 0;
+			continue;
+		}
+
+		//Reliable message -> ask the producer for the missing fragments
+		if ( reasm->nack_time && reasm->nack_time <= now )
+			tc_client_nack_send( topic, reasm, now );
+
+		if ( reasm->nack_time && reasm->nack_time < expiry )
+			expiry = reasm->nack_time;
+
+		if ( !next || expiry < next )
+			next = expiry;
+	}
+
+	return next;
+}
+
+static void tc_client_nack_schedule( TOPIC_C_ENTRY *topic, RX_REASM *reasm, unsigned long long delay, char gap, unsigned long long now )
+{
+	unsigned long long time;
+
+	//Random delay -> the consumers that lost the same fragments mostly get them retransmitted (multicast) before their own NACK is due
+	time = now + delay + rand_r( &topic->rx_nack_seed ) % (NACK_DELAY*1000);
+
+	if ( reasm->nack_sent && time < reasm->nack_sent + NACK_INTERVAL*1000ULL )
+		time = reasm->nack_sent + NACK_INTERVAL*1000ULL;
+
+	//A pending NACK of lost fragments isn't postponed by the following ones
+	if ( reasm->nack_gap && reasm->nack_time && reasm->nack_time <= time )
+		return;
+
+	reasm->nack_time = time;
+	reasm->nack_gap = gap;
+}
+
+static void tc_client_nack_send( TOPIC_C_ENTRY *topic, RX_REASM *reasm, unsigned long long now )
+{
+	char nack[sizeof(FRAG_HEADER) + NACK_MAX_FRAGS * sizeof(int)];
+	int k, m, payload, n_frags, n_total, limit, block, first, block_frags, block_parity, need, seq, i, n = 0;
+	char *received;
+	FRAG_HEADER header;
+	NET_ADDR producer;
+
+	//Lost fragments of a known message : data fragments of the blocks that can't be rebuilt (after a gap, not counting the fragments still to come)
+	if ( reasm->header.msg_size && reasm->fec_blocks ){
+		k = reasm->header.fec_k;
+		m = reasm->header.fec_m;
+		payload = reasm->header.frag_payload;
+		n_frags = ( reasm->header.msg_size + payload - 1 ) / payload;
+		n_total = tc_fec_wire_size( reasm->header.msg_size, k, m ) / payload;
+		received = reasm->buff + n_total * payload;
+		limit = reasm->nack_gap ? reasm->highest_seq : n_total;
+
+		for ( block = 0; block * k < n_frags && n < NACK_MAX_FRAGS; block++ ){
+			first = block * (k + m);
+			block_frags = ( n_frags - block * k < k ) ? n_frags - block * k : k;
+			block_parity = ( block_frags < m ) ? block_frags : m;
+
+			for ( i = 0, need = block_frags; i < block_frags + block_parity; i++ ){
+				if ( received[first + i] || first + i > limit )
+					need--;
+			}
+			for ( i = 0; i < block_frags && need > 0 && n < NACK_MAX_FRAGS; i++ ){
+				if ( !received[first + i] ){
+					seq = first + i;
+					memcpy( nack + sizeof(FRAG_HEADER) + n * sizeof(int), &seq, sizeof(int) );
+					n++;
+					need--;
+				}
+			}
+		}
+
+		//Nothing lost yet -> wait for the producer to go silent
+		if ( !n ){
+			reasm->nack_gap = 0;
+			reasm->nack_time = 0;
+			tc_client_nack_schedule( topic, reasm, NACK_DELAY*1000ULL, 0, now );
+			return;
+		}
+	}
+
+	memset( &header, 0, sizeof(FRAG_HEADER) );
+	header.frag_seq = FRAG_NACK;
+	header.msg_seq = reasm->header.msg_seq;
+	header.msg_size = reasm->header.msg_size;
+	memcpy( nack, &header, sizeof(FRAG_HEADER) );
+
+	memset( &producer, 0, sizeof(NET_ADDR) );
+	strcpy( producer.name_ip, reasm->sender.name_ip );
+	producer.port = reasm->header.nack_port;
+
+	if ( sock_send( &topic->topic_sock, &producer, nack, sizeof(FRAG_HEADER) + n * sizeof(int) ) > 0 ){
+		DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() : NACK of message %u (%d fragments) sent to %s:%u on topic_id %u\n",header.msg_seq,n,producer.name_ip,producer.port,topic->topic_id);
+		TOPIC_STATS_ADD( topic->rx_stats.nacks_sent, 1 );
+	}
+
+	//Asked again if not repaired
+	reasm->nack_sent = now;
+	reasm->nack_gap = 0;
+	reasm->nack_time = now + NACK_INTERVAL*1000ULL;
+}
+
+int tc_client_topic_get_stats( unsigned int topic_id, TC_TOPIC_STATS *ret_stats )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_get_stats() TOPIC ID %u ...\n",topic_id);
+
+	TOPIC_C_ENTRY *topic = NULL;
+	unsigned char reserv_state;
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_topic_get_stats() : MODULE IS NOT INITIALIZED\n");
+		return ERR_C_NOT_INIT;
+	}	
+
+	//Validate parameters
+	if ( !topic_id || !ret_stats ){
+		fprintf(stderr,"tc_client_topic_get_stats() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
 	}
 
-	//Several MTU fragments can be received so we need to collect all of them and restore original data
-	//Alloc temp mem (8 extra char for order stamps and data size)
-	if ( (temp = (char *) malloc(D_MTU+8)) == NULL ){
-		fprintf(stderr,"tc_client_topic_receive() : NOT ENOUGH MEMORY TO RECEIVE DATA FROM TOPIC %u\n",topic_id);
-		tc_client_unlock_topic_rx( topic );
-		return ERR_MEM_MALLOC;			
+	//Get topic entry (keep database locked so the entry isn't destroyed while reading)
+	tc_client_db_lock();
+
+	if ( !(topic = tc_client_db_topic_search(topic_id)) ){
+		fprintf(stderr,"tc_client_topic_get_stats() : TOPIC ID %u NOT REGISTERED IN THIS NODE\n",topic_id);
+		tc_client_db_unlock();
+		return ERR_TOPIC_NOT_REG;
 	}
 
-	sock = topic->topic_sock;
-	unblock_sock = topic->unblock_rx_sock;
-
-	do{
-		//Get first message fragment and get total message size
-		if ( (ret = sock_receive( &sock, &unblock_sock, wait, temp, 0, NULL )) < 0){
-
-			//Received unblock signal -- Check if node was unbound/unregistered from topic
-			if ( (ret == ERR_DATA_UNBLOCK) && topic->is_closing ){
-				fprintf(stderr,"tc_client_topic_receive() : UNBLOCK -- TOPIC ID %u IS BEING CLOSED\n",topic_id);
-				tc_client_unlock_topic_rx( topic );
-				return ERR_TOPIC_CLOSING;
-
-			}else	if ( (ret == ERR_DATA_UNBLOCK) && !topic->is_rx_bound ){
-				fprintf(stderr,"tc_client_topic_receive() : UNBLOCK -- NODE NOT BOUND TO TOPIC ID %u AS CONSUMER\n",topic_id);
-				tc_client_unlock_topic_rx( topic );
-				return ERR_NODE_NOT_BOUND_RX;
-
-			}else	if ( (ret == ERR_DATA_UNBLOCK) && !topic->is_consumer ){
-				fprintf(stderr,"tc_client_topic_receive() : UNBLOCK -- NOT REGISTERED AS CONSUMER OF TOPIC ID %u\n",topic_id);
-				tc_client_unlock_topic_rx( topic );
-				return ERR_NODE_NOT_REG_RX;
-
-			}else if ( ret == ERR_DATA_UNBLOCK ){
-				//Probably an unread unlock message from other threads? Ignore it
-				continue;
-			}
+	ret_stats->msgs_sent = TOPIC_STATS_GET( topic->tx_stats.msgs );
+	ret_stats->bytes_sent = TOPIC_STATS_GET( topic->tx_stats.bytes );
+	ret_stats->frags_sent = TOPIC_STATS_GET( topic->tx_stats.frags );
+	ret_stats->send_errors = TOPIC_STATS_GET( topic->tx_stats.errors );
+	ret_stats->tx_lock_wait = TOPIC_STATS_GET( topic->tx_stats.lock_wait );
+	ret_stats->msgs_combined = TOPIC_STATS_GET( topic->tx_stats.combined );
+	ret_stats->tx_pacing_wait = TOPIC_STATS_GET( topic->tx_stats.pacing_wait );
+	ret_stats->pacing_drops = TOPIC_STATS_GET( topic->tx_stats.pacing_drops );
+	ret_stats->fec_parity_sent = TOPIC_STATS_GET( topic->tx_stats.fec_parity );
+	ret_stats->retx_frags = TOPIC_STATS_GET( topic->tx_stats.retx_frags );
+	ret_stats->retx_drops = TOPIC_STATS_GET( topic->tx_stats.retx_drops );
+
+	ret_stats->msgs_received = TOPIC_STATS_GET( topic->rx_stats.msgs );
+	ret_stats->bytes_received = TOPIC_STATS_GET( topic->rx_stats.bytes );
+	ret_stats->frags_received = TOPIC_STATS_GET( topic->rx_stats.frags );
+	ret_stats->stale_frags = TOPIC_STATS_GET( topic->rx_stats.stale_frags );
+	ret_stats->rx_timeouts = TOPIC_STATS_GET( topic->rx_stats.timeouts );
+	ret_stats->reasm_timeouts = TOPIC_STATS_GET( topic->rx_stats.reasm_timeouts );
+	ret_stats->receive_errors = TOPIC_STATS_GET( topic->rx_stats.errors );
+	ret_stats->rx_lock_wait = TOPIC_STATS_GET( topic->rx_stats.lock_wait );
+	ret_stats->msgs_conflated = TOPIC_STATS_GET( topic->rx_stats.conflated );
+	ret_stats->fec_recovered = TOPIC_STATS_GET( topic->rx_stats.fec_recovered );
+	ret_stats->nacks_sent = TOPIC_STATS_GET( topic->rx_stats.nacks_sent );
+
+#if ENABLE_MSG_TRACING
+	ret_stats->msgs_lost = TOPIC_STATS_GET( topic->rx_trace.lost );
+	ret_stats->msgs_reordered = TOPIC_STATS_GET( topic->rx_trace.reordered );
+	ret_stats->latency_samples = TOPIC_STATS_GET( topic->rx_trace.latency.count );
+	ret_stats->latency_mean = ret_stats->latency_samples ? TOPIC_STATS_GET( topic->rx_trace.latency.sum ) / ret_stats->latency_samples : 0;
+	ret_stats->latency_p50 = tc_hist_get_percentile( &topic->rx_trace.latency, 50 );
+	ret_stats->latency_p99 = tc_hist_get_percentile( &topic->rx_trace.latency, 99 );
+	ret_stats->latency_p999 = tc_hist_get_percentile( &topic->rx_trace.latency, 99.9 );
+	ret_stats->latency_max = TOPIC_STATS_GET( topic->rx_trace.latency.max );
+#else
+	ret_stats->msgs_lost = ret_stats->msgs_reordered = ret_stats->latency_samples = 0;
+	ret_stats->latency_mean = ret_stats->latency_p50 = ret_stats->latency_p99 = ret_stats->latency_p999 = ret_stats->latency_max = 0;
+#endif
 
-			if ( topic->is_updating ){
-				//Topic updating ( probably its both consumer and producer and is being unregistered as producer )
-				//This data is invalid now (wont receive the remaining)
-				fprintf(stderr,"tc_client_topic_receive() : UNBLOCK -- TOPIC ID %u UPDATING\n",topic_id);
-				ret = ERR_TOPIC_IN_UPDATE;
-			}
+	tc_client_db_unlock();
 
-			//Other error during receive
-			fprintf(stderr,"tc_client_topic_receive() : ERROR RECEIVING DATA FROM TOPIC %u\n",topic_id);
-			free(temp);
-			tc_client_unlock_topic_rx( topic );
-			return ret;
+	//Reservation counters are only available on the topic producers (last kernel tree verification)
+	ret_stats->reserv_state = RESERV_STATE_NONE;
+	ret_stats->reserv_drops = ret_stats->reserv_overlimits = ret_stats->reserv_backlog = 0;
+
+	if ( !tc_client_reserv_get_status( topic_id, &reserv_state, &ret_stats->reserv_drops, &ret_stats->reserv_overlimits, &ret_stats->reserv_backlog ) ){
+		switch ( reserv_state ){
+			case TC_RESERV_UNVERIFIED:
+				ret_stats->reserv_state = RESERV_STATE_UNVERIFIED;
+				break;
+			case TC_RESERV_OK:
+				ret_stats->reserv_state = RESERV_STATE_OK;
+				break;
+			case TC_RESERV_NO_CLASS:
+			case TC_RESERV_NO_FILTER:
+				ret_stats->reserv_state = RESERV_STATE_MISSING;
+				break;
+			case TC_RESERV_RATE_MISMATCH:
+				ret_stats->reserv_state = RESERV_STATE_MISMATCH;
+				break;
 		}
- 
-		seq_n = *((int *)temp);
+	}
 
-		//Its possible to receive old fragments from other messages when a producer tries to send at a rate faster than the negotiated
-		//In this case some fragments got queued at the producer and the consumers timed-out while receiving
-		//Discard this fragments and wait for the first of the new message
-		if ( seq_n && !got_first){
-			printf("tc_client_topic_receive() : Received old fragment (%d) on topic_id %u\n",seq_n,topic_id);
-			continue;
-		}
+	DEBUG_MSG_TC_CLIENT("tc_client_topic_get_stats() Got topic id %u statistics\n",topic_id);
 
-		if ( !seq_n && !got_first ){
-			got_first = 1;
-			data_size = *(((int *)temp)+1);
-		}
+	return ERR_OK;
+}
 
-		//Copy data from temp buffer to app buffer and align
-		memcpy( ret_data+(seq_n*D_MTU), temp+8, ret-8 );
-		
-		len = len + ret-8;
+static unsigned long long tc_client_time_ns( void )
+{
+	struct timespec now;
 
-		//Timeout to receive further fragments (ms)
-   		wait = FRAG_TIMEOUT;
+	clock_gettime( CLOCK_MONOTONIC, &now );
 
-	}while( (data_size - len) > 0 );
-		
-	free(temp);
+	return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
 
-	tc_client_unlock_topic_rx( topic );
+#if ENABLE_MSG_TRACING
+static unsigned long long tc_client_trace_time_ns( void )
+{
+	struct timespec now;
+
+	clock_gettime( MSG_TRACING_CLOCK, &now );
+
+	return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
 
-	DEBUG_MSG_TC_CLIENT("tc_client_topic_receive() Received %u bytes from topic Id %u\n",len,topic_id);
+static void tc_client_trace_msg( TOPIC_C_ENTRY *topic, FRAG_HEADER *header )
+{
+	TOPIC_C_RX_TRACE *trace = &topic->rx_trace;
+	unsigned long long now = tc_client_trace_time_ns();
+	unsigned int i;
+
+	//One-way latency ( clocks not synchronized -> negative latency recorded as 0 )
+	tc_hist_add( &trace->latency, (now > header->send_time) ? (now - header->send_time)/1000 : 0 );
+
+	//Find producer
+	for ( i = 0; i < trace->n_producers; i++ ){
+		if ( trace->producer_ids[i] == header->producer_id )
+			break;
+	}
 
-	return len;
+	if ( i == trace->n_producers ){
+		//New producer ( start tracking it if there is room )
+		if ( trace->n_producers < MAX_TRACED_PRODUCERS ){
+			trace->producer_ids[i] = header->producer_id;
+			trace->last_seq[i] = header->msg_seq;
+			trace->n_producers++;
+		}
+		return;
+	}
+
+	if ( (int)(header->msg_seq - trace->last_seq[i]) > 0 ){
+		//Newer message ( any skipped sequence numbers were lost )
+		TOPIC_STATS_ADD( trace->lost, header->msg_seq - trace->last_seq[i] - 1 );
+		trace->last_seq[i] = header->msg_seq;
+	}else{
+		//Older or duplicated message
+		TOPIC_STATS_ADD( trace->reordered, 1 );
+	}
 }
+#endif
 
 static int tc_client_comm_init( void )
 {
@@ -1896,8 +3140,12 @@ static int tc_client_node_reg ( unsigned int node_id, unsigned int *ret_node_id
 	msg.op = REG_NODE;
 	msg.node_ids[0] = tc_node_id;
 	msg.n_nodes = 1;
+	msg.link_bw = nic_link_bw;
+	msg.link_background_share = BACKGROUND_BW_SHARE;
+	msg.link_control_share = CONTROL_BW_SHARE;
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"tc_client_node_reg() : ERROR SENDING REQUEST FOR NODE ID %u\n",node_id);
 		return ERR_SEND_REQUEST;
@@ -1911,6 +3159,8 @@ static int tc_client_node_reg ( unsigned int node_id, unsigned int *ret_node_id
 		return ERR_GET_ANSWER;
 	}
 
+	tc_client_req_end();
+
 	//Check if operation was successfull
 	if( msg.type != ANS_MSG || msg.error ){
 		fprintf(stderr,"tc_client_node_reg() : SERVER DENIED REGISTRATION OF NODE ID %u\n",node_id);
@@ -1947,6 +3197,7 @@ static int tc_client_node_unreg ( void )
 	tc_client_get_server_access();
 
 	//Send request
+	tc_client_req_start( &msg );
 	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
 		fprintf(stderr,"tc_client_node_unreg() : ERROR SENDING REQUEST FOR NODE ID %u\n",tc_node_id);
 		tc_client_release_server_access();
@@ -1964,6 +3215,8 @@ static int tc_client_node_unreg ( void )
 		return ERR_GET_ANSWER;
 	}
 
+	tc_client_req_end();
+
 	//Check if operation was successfull
 	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
 		fprintf(stderr,"tc_client_node_unreg() : SERVER DENIED REGISTRATION OF NODE ID %u\n",tc_node_id);
@@ -1994,7 +3247,7 @@ static int tc_client_modules_init( void )
 		return ERR_DISCOVERY_SERVER;
 	}
 
-	printf("tc_client_modules_init() : DISCOVERED SERVER %s:%u\n",server.name_ip,server.port);
+	TC_LOG( LOG_CLIENT, LOG_INFO, "tc_client_modules_init() : DISCOVERED SERVER %s:%u\n",server.name_ip,server.port );
 
 	//Create comunication link and connect to server
 	if ( tc_client_comm_init() < 0 ){
@@ -2010,6 +3263,13 @@ static int tc_client_modules_init( void )
 		return ERR_DB_INIT;
 	}
 	
+	//Start repair thread (reliable topics are repaired even while the application doesn't send)
+	if ( tc_thread_create( tc_client_repair_thread, &repair_thread_id, &repair_quit, &repair_lock, 100 ) ){
+		fprintf(stderr,"tc_client_modules_init() : ERROR STARTING REPAIR THREAD\n");
+		tc_client_modules_close();
+		return ERR_THREAD_CREATE;
+	}
+
 	//Register node in server
 	if ( tc_client_node_reg( tc_node_id, &tc_node_id ) ){
 		fprintf(stderr,"tc_client_modules_init() : ERROR REGISTERING NODE ID %u IN SERVER\n",tc_node_id);
@@ -2025,7 +3285,7 @@ static int tc_client_modules_init( void )
 	}
 
 	//Start reservation module
-	if ( tc_client_reserv_init( nic_ifface, tc_node_id, &server ) ){
+	if ( tc_client_reserv_init( nic_ifface, nic_link_bw, tc_node_id, &server ) ){
 		fprintf(stderr,"tc_client_modules_init() : ERROR STARTING RESERVATION MODULE\n");
 		tc_client_modules_close();
 		return ERR_RESERV_INIT;
@@ -2076,6 +3336,13 @@ static int tc_client_modules_close( void )
 		return ERR_UNREG_NODE;
 	}
 
+	if ( repair_quit == THREAD_RUN ){
+		//Wake the thread up if it is waiting for a reliable topic
+		repair_quit = THREAD_STOP;
+		tc_client_repair_wake();
+		tc_thread_destroy( &repair_thread_id, &repair_quit, &repair_lock, 200 );
+	}
+
 	if ( (ret = tc_client_db_close()) && ret != ERR_C_NOT_INIT ){
 		fprintf(stderr,"tc_client_modules_close() : ERROR CLOSING CLIENT DATABASE MODULE\n");
 		return ERR_DB_CLOSE;
@@ -2101,6 +3368,213 @@ static int tc_client_modules_close( void )
 	return ERR_OK;
 }
 
+static int tc_client_topic_req_prop( unsigned int topic_id, unsigned int *ret_size, unsigned int *ret_period, unsigned int *ret_delay_bound )
+{
+	DEBUG_MSG_TC_CLIENT(" tc_client_topic_req_prop() TOPIC ID %u ...\n",topic_id);
+
+	NET_MSG msg;
+
+	assert( topic_id );
+
+	//Get topic channel properties
+	//Prepare request
+	memset(&msg,0,sizeof(NET_MSG));
+
+	msg.type = REQ_MSG;
+	msg.op = GET_TOPIC_PROP;
+	msg.node_ids[0] = tc_node_id;
+	msg.n_nodes = 1;
+	msg.topic_id  = topic_id;
+
+	//Get in requests queue
+	tc_client_get_server_access();
+
+	//Send request
+	tc_client_req_start( &msg );
+	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
+		fprintf(stderr,"tc_client_topic_req_prop() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
+		tc_client_release_server_access();
+		return ERR_SEND_REQUEST;
+	}
+	
+	DEBUG_MSG_TC_CLIENT(" tc_client_topic_req_prop() : Waiting for topic id %u request response\n",topic_id);
+
+	//Get answer
+	memset(&msg,0,sizeof(NET_MSG));
+
+	if ( tc_network_get_msg( &server_sock, C_REQUESTS_TIMEOUT, &msg, NULL ) ){
+		fprintf(stderr,"tc_client_topic_req_prop() : ERROR RECEIVING REQUEST ANSWER FOR TOPIC ID %u\n",topic_id);
+		tc_client_release_server_access();
+		return ERR_GET_ANSWER;
+	}
+
+	tc_client_req_end();
+
+	//Check if request was successfull
+	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
+		fprintf(stderr," tc_client_topic_req_prop() : SERVER DECLINED REQUEST FOR TOPIC ID %u\n",topic_id);
+		tc_client_release_server_access();
+		return msg.error;
+	}
+
+	if ( ret_size ) *ret_size = msg.channel_size;
+	if ( ret_period ) *ret_period = msg.channel_period;
+	if ( ret_delay_bound ) *ret_delay_bound = msg.topic_delay_bound;
+			
+	tc_client_release_server_access();
+
+	DEBUG_MSG_TC_CLIENT(" tc_client_topic_req_prop() Got topic id %u details\n",topic_id);
+
+	return ERR_OK;
+}
+
+static int tc_client_bind( unsigned int topic_id, unsigned char op, unsigned int timeout, int *ret_handle )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_bind() TOPIC ID %u ...\n",topic_id);
+
+	NET_MSG msg;
+	int expired = 0;
+	char bound = 0;
+	unsigned long long t_bind, deadline = 0;
+	TOPIC_C_ENTRY *topic = NULL;
+	char *role = ( op == BIND_TX ) ? "PRODUCER" : "CONSUMER";
+
+	if ( !init ){
+		fprintf(stderr,"tc_client_bind() : MODULE IS NOT INITIALIZED\n");
+		return ERR_C_NOT_INIT;
+	}	
+
+	//Validate parameters
+	if ( !topic_id ){
+		fprintf(stderr,"tc_client_bind() : INVALID PARAMETERS\n");
+		return ERR_INVALID_PARAM;
+	}
+
+	t_bind = tc_time_get_us();
+
+	//Get in requests queue
+	tc_client_get_server_access();
+
+	//Lock topic database
+	tc_client_db_lock();
+
+	//Check if node is registered as producer/consumer of this topic 
+	if ( !(topic = tc_client_db_topic_search(topic_id)) || !(( op == BIND_TX ) ? topic->is_producer : topic->is_consumer) ){
+		fprintf(stderr,"tc_client_bind() : NOT REGISTERED AS %s OF TOPIC ID %u\n",role,topic_id);
+		tc_client_db_unlock();
+		tc_client_release_server_access();
+		return ( op == BIND_TX ) ? ERR_NODE_NOT_REG_TX : ERR_NODE_NOT_REG_RX;
+	}
+
+	//The completion handle shares the topic bind event counter -> it stays valid (and is signaled) if the topic is destroyed
+	if ( ret_handle && (*ret_handle = dup( topic->bind_event_fd )) < 0 ){
+		fprintf(stderr,"tc_client_bind() : ERROR CREATING BIND COMPLETION HANDLE FOR TOPIC ID %u\n",topic_id);
+		tc_client_db_unlock();
+		tc_client_release_server_access();
+		return ERR_BIND_HANDLE;
+	}
+
+	//Check if its already bound
+	if ( ( op == BIND_TX ) ? topic->is_tx_bound : topic->is_rx_bound ){
+		DEBUG_MSG_TC_CLIENT("tc_client_bind() : Already bound to topic id %u as %s\n",topic_id,role);
+		//Completion handle is readable right away
+		if ( ret_handle )
+			tc_client_db_bind_signal( topic );
+		tc_client_db_unlock();
+		tc_client_release_server_access();
+		return ERR_OK;	
+	}
+
+	//Prepare request
+	memset(&msg,0,sizeof(NET_MSG));
+
+	msg.type = REQ_MSG;
+	msg.op = op;
+	msg.node_ids[0] = tc_node_id;
+	msg.n_nodes = 1;
+	msg.topic_id  = topic_id;
+
+	//Unlock topic database
+	tc_client_db_unlock();
+
+	//Send request
+	tc_client_req_start( &msg );
+	if ( tc_network_send_msg( &server_sock, &msg, NULL ) ){
+		fprintf(stderr,"tc_client_bind() : ERROR SENDING REQUEST FOR TOPIC ID %u\n",topic_id);
+		tc_client_release_server_access();
+		if ( ret_handle )
+			close( *ret_handle );
+		return ERR_SEND_REQUEST;
+	}
+	
+	DEBUG_MSG_TC_CLIENT("tc_client_bind() : Waiting for topic id %u bind request response\n",topic_id);
+
+	//Get answer
+	memset(&msg,0,sizeof(NET_MSG));
+
+	if ( tc_network_get_msg( &server_sock, C_REQUESTS_TIMEOUT, &msg, NULL ) ){
+		fprintf(stderr,"tc_client_bind() : ERROR RECEIVING REQUEST ANSWER FOR TOPIC ID %u\n",topic_id);
+		tc_client_release_server_access();
+		if ( ret_handle )
+			close( *ret_handle );
+		return ERR_GET_ANSWER;
+	}
+
+	tc_client_req_end();
+
+	//Check if bind request was successfull
+	if( msg.type != ANS_MSG || msg.error || msg.node_ids[0] != tc_node_id ){
+		fprintf(stderr,"tc_client_bind() : SERVER DENIED BIND AS %s REQUEST FOR TOPIC ID %u\n",role,topic_id);
+		tc_client_release_server_access();
+		if ( ret_handle )
+			close( *ret_handle );
+		return msg.error;
+	}
+
+	//Request was sent and accepted. It will wait for a notification from server to finalize the bind
+	//However server will only reply when a least 1 consumer and 1 producer for the same topic are registered and bound (or in bind process)
+	//So we could be waiting here for a long time and block other threads from doing requests to server
+	//The bind request answer will be sent to the management module to avoid this issue and we will wait on the bind flag here
+
+	//Leave requests queue
+	tc_client_release_server_access();
+
+	//Non-blocking bind -> the application waits on the completion handle
+	if ( ret_handle ){
+		DEBUG_MSG_TC_CLIENT("tc_client_bind() : Bind to topic ID %u as %s in progress\n",topic_id,role);
+		return ERR_OK;
+	}
+
+	//Wait for bind procedure to be completed -- The management module signals every bind state change
+	//(the database lock is released while waiting)
+	if ( timeout > 0 )
+		deadline = tc_time_get_us() + timeout*1000ULL;
+
+	tc_client_db_lock();
+
+	while ( (topic = tc_client_db_topic_search(topic_id)) && !(bound = ( op == BIND_TX ) ? topic->is_tx_bound : topic->is_rx_bound) && !expired )
+		expired = tc_client_db_bind_wait( deadline );
+
+	tc_client_db_unlock();
+
+	if ( !topic ){
+		fprintf(stderr,"tc_client_bind(): TOPIC ID %u HAS BEEN DESTROYED WHILE WAITING FOR BIND\n",topic_id);
+		return ERR_TOPIC_NOT_REG;
+	}
+
+	if ( !bound ){
+		fprintf(stderr,"tc_client_bind() : TIMED-OUT WAITING TO BIND TO TOPIC ID %u AS %s\n",topic_id,role);
+		return ( op == BIND_TX ) ? ERR_BIND_TX_TIMEDOUT : ERR_BIND_RX_TIMEDOUT;
+	}
+
+	//Bind completion latency (request until the bind notification from the server)
+	tc_hist_add( &client_bind_hist[op], tc_time_get_us() - t_bind );
+
+	DEBUG_MSG_TC_CLIENT("tc_client_bind() : Bound to topic ID %u as %s\n",topic_id,role);
+
+	return ERR_OK;
+}
+
 static int tc_client_get_server_access( void )
 {
 	DEBUG_MSG_TC_CLIENT("tc_client_get_server_access() ...\n");
@@ -2186,3 +3660,124 @@ static int tc_client_release_server_access( void )
 
 	return ERR_OK; 
 }
+
+int tc_client_latency_print( void )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_latency_print() ...\n");
+
+	tc_hist_op_print( "tc_client_latency_print() : Server requests latency (request -> answer)", client_op_hist );
+	tc_hist_op_print( "tc_client_latency_print() : Bind completion latency (request -> bound)", client_bind_hist );
+
+	return ERR_OK;
+}
+
+static void tc_client_req_start( NET_MSG *msg )
+{
+	req_op = msg->op;
+	req_start = tc_time_get_us();
+}
+
+static void tc_client_req_end( void )
+{
+	if ( req_op > 0 && req_op < N_OP_TYPES )
+		tc_hist_add( &client_op_hist[req_op], tc_time_get_us() - req_start );
+}
+
+static void tc_client_repair_thread( void )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_repair_thread() ...\n");
+
+	TOPIC_C_ENTRY *topics[RETX_MAX_TOPICS];
+	struct pollfd fds[RETX_MAX_TOPICS];
+	unsigned int i, n_topics;
+	char *temp = NULL;
+
+	pthread_mutex_lock( &repair_lock );
+
+	//Never canceled while holding a topic lock, topic references or the fragment buffer -- every pass is bounded and checks the quit flag instead
+	pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, NULL );
+
+	while ( repair_quit == THREAD_RUN ){
+
+		//Topics registered meanwhile are served from the next pass
+		if ( tc_client_db_topic_get_reliable( topics, RETX_MAX_TOPICS, &n_topics ) || !n_topics ){
+			//No reliable producer topic -> sleep until one is registered
+			pthread_mutex_lock( &repair_wait_lock );
+			while ( !repair_wake && repair_quit == THREAD_RUN )
+				pthread_cond_wait( &repair_cond, &repair_wait_lock );
+			repair_wake = 0;
+			pthread_mutex_unlock( &repair_wait_lock );
+			continue;
+		}
+
+		for ( i = 0; i < n_topics; i++ ){
+			fds[i].fd = topics[i]->tx_nack_sock.fd;
+			fds[i].events = POLLIN;
+			fds[i].revents = 0;
+		}
+
+		//Woken up by the first NACK, else once per tail delay
+		poll( fds, n_topics, RETX_TAIL_DELAY );
+
+		for ( i = 0; i < n_topics; i++ ){
+
+			//Same transmission mutex as the sends (a producer sending meanwhile serves the NACKs itself)
+			if ( repair_quit == THREAD_RUN && !tc_client_lock_topic_tx( topics[i], tc_time_get_us() + RETX_TAIL_DELAY*1000ULL ) ){
+
+				if ( topics[i]->is_producer && topics[i]->tx_nack_sock.fd > 0 ){
+					if ( fds[i].revents & POLLIN )
+						tc_client_retransmit( topics[i], &temp );
+					tc_client_retx_tail( topics[i], &temp );
+				}
+
+				tc_client_unlock_topic_tx( topics[i] );
+			}
+
+			tc_client_db_topic_put( topics[i] );
+		}
+	}
+
+	free( temp );
+
+	pthread_mutex_unlock( &repair_lock );
+
+	DEBUG_MSG_TC_CLIENT("tc_client_repair_thread() Repair thread ending\n");
+
+	pthread_exit(NULL);
+}
+
+static void tc_client_repair_wake( void )
+{
+	pthread_mutex_lock( &repair_wait_lock );
+	repair_wake = 1;
+	pthread_cond_signal( &repair_cond );
+	pthread_mutex_unlock( &repair_wait_lock );
+}
+
+#if LATENCY_SNAPSHOT_PERIOD
+static void tc_client_latency_thread( void )
+{
+	DEBUG_MSG_TC_CLIENT("tc_client_latency_thread() ...\n");
+
+	unsigned int ticks = 0;
+
+	pthread_mutex_lock( &latency_lock );
+
+	while ( latency_quit == THREAD_RUN ){
+
+		//Sleep in short steps so closing the client isn't delayed
+		usleep(100000);
+
+		if ( ++ticks >= LATENCY_SNAPSHOT_PERIOD*10 ){
+			ticks = 0;
+			tc_client_latency_print();
+		}
+	}
+
+	pthread_mutex_unlock( &latency_lock );
+
+	DEBUG_MSG_TC_CLIENT("tc_client_latency_thread() Latency snapshot thread ending\n");
+
+	pthread_exit(NULL);
+}
+#endif
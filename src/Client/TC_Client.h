@@ -39,6 +39,107 @@
 */
 #define NODE_UNPLUG	0
 
+//Reservation states (see TC_TOPIC_STATS)
+
+/**	@def RESERV_STATE_NONE
+*	@brief No reservation of the topic in this node (or verification disabled).
+*/
+#define RESERV_STATE_NONE	0
+/**	@def RESERV_STATE_UNVERIFIED
+*	@brief Reservation not yet compared with the kernel traffic control tree.
+*/
+#define RESERV_STATE_UNVERIFIED	1
+/**	@def RESERV_STATE_OK
+*	@brief Reservation class and filter found in the kernel traffic control tree with the reserved rate.
+*/
+#define RESERV_STATE_OK		2
+/**	@def RESERV_STATE_MISSING
+*	@brief Reservation class or filter missing from the kernel traffic control tree.
+*/
+#define RESERV_STATE_MISSING	3
+/**	@def RESERV_STATE_MISMATCH
+*	@brief Reservation class rate differs from the reserved load.
+*/
+#define RESERV_STATE_MISMATCH	4
+
+//Producer pacing policies (see tc_client_topic_set_pacing)
+
+/**	@def PACING_OFF
+*	@brief Messages are sent as soon as requested, even above the topic rate.
+*/
+#define PACING_OFF		0
+/**	@def PACING_BLOCK
+*	@brief Send calls wait until the message fits in the topic rate.
+*/
+#define PACING_BLOCK		1
+/**	@def PACING_DROP
+*	@brief Messages above the topic rate are dropped (ERR_DATA_PACED).
+*/
+#define PACING_DROP		2
+/**	@def PACING_COALESCE
+*	@brief Send calls wait as with PACING_BLOCK, but a waiting message is dropped (ERR_DATA_COALESCED) if a newer one was sent to the topic meanwhile.
+*/
+#define PACING_COALESCE		3
+
+//Consumer delivery modes (see tc_client_topic_set_delivery)
+
+/**	@def DELIVERY_ALL
+*	@brief Receive calls return every message in arrival order.
+*/
+#define DELIVERY_ALL		0
+/**	@def DELIVERY_LATEST
+*	@brief Receive calls return only the newest complete message queued, discarding the older ones (state-style topics).
+*/
+#define DELIVERY_LATEST		1
+
+/**
+* An opened topic handle (see tc_client_topic_open). Opaque to the application
+*/
+typedef struct topic_c_entry TC_TOPIC_HANDLE;
+
+/**
+* The data path statistics of a topic (see tc_client_topic_get_stats)
+*/
+typedef struct{
+	unsigned long long msgs_sent;		/**< Number of messages sent */
+	unsigned long long bytes_sent;		/**< Number of payload bytes sent */
+	unsigned long long frags_sent;		/**< Number of fragments sent */
+	unsigned long long send_errors;		/**< Number of failed send calls */
+	unsigned long long tx_lock_wait;	/**< Total time (in ns) send calls waited for the topic transmission lock */
+	unsigned long long msgs_combined;	/**< Number of messages sent by the send call of another thread (concurrent producers combined in one batch) */
+	unsigned long long tx_pacing_wait;	/**< Total time (in ns) messages waited for the producer pacing */
+	unsigned long long pacing_drops;	/**< Number of messages dropped or superseded by the producer pacing */
+	unsigned long long fec_parity_sent;	/**< Number of FEC parity fragments sent */
+	unsigned long long retx_frags;		/**< Number of lost fragments retransmitted (reliable topics only) */
+	unsigned long long retx_drops;		/**< Number of NACKed fragments not retransmitted (out of the retransmit window or past the retransmissions share) */
+
+	unsigned long long msgs_received;	/**< Number of messages received */
+	unsigned long long bytes_received;	/**< Number of payload bytes received */
+	unsigned long long frags_received;	/**< Number of fragments received */
+	unsigned long long stale_frags;		/**< Number of old or invalid fragments discarded (producer sending faster than the topic period) */
+	unsigned long long rx_timeouts;		/**< Number of receive calls that timed out waiting for a message */
+	unsigned long long reasm_timeouts;	/**< Number of incomplete messages discarded (fragment lost or late, or too many producers at once) */
+	unsigned long long receive_errors;	/**< Number of failed receive calls (other than timeouts) */
+	unsigned long long rx_lock_wait;	/**< Total time (in ns) receive calls waited for the topic reception lock */
+	unsigned long long msgs_conflated;	/**< Number of complete messages discarded because a newer one was queued (DELIVERY_LATEST only) */
+	unsigned long long fec_recovered;	/**< Number of lost fragments rebuilt from the FEC parity fragments */
+	unsigned long long nacks_sent;		/**< Number of NACKs sent to the producers (reliable topics only) */
+
+	unsigned long long msgs_lost;		/**< Number of messages missing in the producers sequence numbers (message tracing only) */
+	unsigned long long msgs_reordered;	/**< Number of messages received after a newer one from the same producer (message tracing only) */
+	unsigned long long latency_samples;	/**< Number of one-way latency samples (message tracing only) */
+	unsigned int latency_mean;		/**< Mean one-way message latency in us (message tracing only) */
+	unsigned int latency_p50;		/**< Median one-way message latency in us (message tracing only) */
+	unsigned int latency_p99;		/**< 99th percentile one-way message latency in us (message tracing only) */
+	unsigned int latency_p999;		/**< 99.9th percentile one-way message latency in us (message tracing only) */
+	unsigned int latency_max;		/**< Highest one-way message latency in us (message tracing only) */
+
+	unsigned int reserv_state;		/**< State of the topic reservation in the kernel traffic control tree (RESERV_STATE_*) */
+	unsigned long long reserv_drops;	/**< Packets dropped by the topic reservation class */
+	unsigned long long reserv_overlimits;	/**< Number of times the topic reservation class exceeded its rate */
+	unsigned int reserv_backlog;		/**< Bytes queued in the topic reservation class */
+}TC_TOPIC_STATS;
+
 /**	
 *	@brief Starts the client module
 *
@@ -105,6 +206,52 @@ int tc_client_get_node_event( unsigned int timeout, unsigned char *ret_event, un
 */
 int tc_client_topic_create( unsigned int topic_id, unsigned int size, unsigned int period );
 
+/**
+*	@brief Registers a topic with forward error correction in the network
+*
+*	Same as tc_client_topic_create but the topic data is FEC protected : messages are sent in blocks of \a fec_k data fragments followed by
+*	\a fec_m parity fragments (Reed-Solomon code) and consumers rebuild each block from any \a fec_k of its fragments, so up to \a fec_m lost
+*	fragments per block don't drop the message. The parity fragments are included in the topic reserved load
+*
+*	@param[in] topic_id	The desired ID for the topic. Must be greater than 0
+*	@param[in] size		The maximum size (in bytes ) of the messages to be sent through this topic. Must be greater than 0
+*	@param[in] period	The mininum time interval (in ms) between consecutive topic messages. Must be greater than 0
+*	@param[in] fec_k	The FEC block data fragments. If 0 the topic data is not FEC protected
+*	@param[in] fec_m	The FEC block parity fragments. Must be greater than 0 and fec_k + fec_m <= FEC_MAX_BLOCK if fec_k is set
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*/
+int tc_client_topic_create_fec( unsigned int topic_id, unsigned int size, unsigned int period, unsigned int fec_k, unsigned int fec_m );
+
+/**
+*	@brief Registers a reliable topic in the network
+*
+*	Same as tc_client_topic_create_fec but the lost fragments are also retransmitted : the producers keep their last RETX_WINDOW messages and the
+*	consumers detect lost fragments and messages from their sequence numbers and ask for them with unicast NACKs (randomly delayed so the consumers
+*	that lost the same fragments mostly send one). The producers multicast the NACKed fragments as they arrive (client repair thread, also while
+*	the application doesn't send), within \a retx_share percent of the topic load reserved on top of the topic messages, and multicast the first
+*	fragment of their last message again once idle for RETX_TAIL_DELAY ms. The consumers wait for a message at least RETX_WINDOW topic periods.
+*	Repaired messages may be delivered after newer ones
+*
+*	@param[in] topic_id	The desired ID for the topic. Must be greater than 0
+*	@param[in] size		The maximum size (in bytes ) of the messages to be sent through this topic. Must be greater than 0
+*	@param[in] period	The mininum time interval (in ms) between consecutive topic messages. Must be greater than 0
+*	@param[in] fec_k	The FEC block data fragments. If 0 the topic data is not FEC protected
+*	@param[in] fec_m	The FEC block parity fragments. Must be greater than 0 and fec_k + fec_m <= FEC_MAX_BLOCK if fec_k is set
+*	@param[in] retx_share	The topic load share (in %) reserved for retransmissions. If 0 the topic is not reliable. Must be at most 100
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*
+*	@note			Retransmissions are sent from the producers send calls -- NACKs are served as long as the producers keep sending
+*/
+int tc_client_topic_create_reliable( unsigned int topic_id, unsigned int size, unsigned int period, unsigned int fec_k, unsigned int fec_m, unsigned int retx_share );
+
 /**
 *	@brief Destroys the network topic
 *
@@ -138,6 +285,25 @@ int tc_client_topic_destroy( unsigned int topic_id );
 */
 int tc_client_topic_get_prop( unsigned int topic_id , unsigned int *ret_size, unsigned int *ret_period );
 
+/**
+*	@brief Retrieves the topic worst-case delay bound
+*
+*	Sends a request to the server for the retrieval of the topic delay bound computed by the admission control
+*	(worst producer uplink plus worst consumer downlink queueing delay).
+*	If the topic does not exist the request is refused
+*
+*	@param[in] topic_id		The ID of the topic to get the delay bound from. Must be greater than 0
+*	@param[out] ret_delay_bound	The buffer where to store the topic delay bound (in us). Must not be a NULL pointer
+*
+*	@pre				None
+*
+*	@return				Upon successful return : ERR_OK (0)
+*	@return				Upon output error : An error code (<0)
+*
+*	@note				When ENABLE_AC_DELAY_BOUND is set the server refuses any request that makes a topic delay bound exceed its channel period
+*/
+int tc_client_topic_get_delay_bound( unsigned int topic_id , unsigned int *ret_delay_bound );
+
 /**
 *	@brief Sets topic with new properties
 *
@@ -244,6 +410,25 @@ int tc_client_unregister_rx( unsigned int topic_id );
 */
 int tc_client_bind_tx( unsigned int topic_id, unsigned int timeout );
 
+/**
+*	@brief Binds client as producer of topic without waiting
+*
+*	Sends the bind request like tc_client_bind_tx but returns as soon as the server accepts it, together with a completion handle
+*	(a file descriptor) for the application event loop. The handle becomes readable (poll/select/epoll) every time the topic bind state
+*	changes, right away if the node is already bound, and when the topic is destroyed. Reading 8 bytes from it resets it.
+*	The bind state is then checked with tc_client_bind_get_state
+*
+*	@param[in] topic_id	The ID of the topic to be bound to. Must be greater than 0
+*
+*	@pre			None
+*
+*	@return			Upon successful return : The completion handle (>=0). Must be closed by the application (close)
+*	@return			Upon output error : An error code (<0)
+*
+*	@note 			The node had to be previously registered as producer of the topic
+*/
+int tc_client_bind_tx_async( unsigned int topic_id );
+
 /**
 *	@brief Unbinds client as producer of topic
 *
@@ -281,6 +466,39 @@ int tc_client_unbind_tx( unsigned int topic_id );
 */
 int tc_client_bind_rx( unsigned int topic_id, unsigned int timeout );
 
+/**
+*	@brief Binds client as consumer of topic without waiting
+*
+*	Sends the bind request like tc_client_bind_rx but returns as soon as the server accepts it, together with a completion handle
+*	(see tc_client_bind_tx_async)
+*
+*	@param[in] topic_id	The ID of the topic to be bound to. Must be greater than 0
+*
+*	@pre			None
+*
+*	@return			Upon successful return : The completion handle (>=0). Must be closed by the application (close)
+*	@return			Upon output error : An error code (<0)
+*
+*	@note			The node had to be previously registered as consumer of the topic
+*/
+int tc_client_bind_rx_async( unsigned int topic_id );
+
+/**
+*	@brief Gets the bind state of the node on a topic
+*
+*	Returns whether the node is currently bound as producer and as consumer of the topic. No request is sent to the server
+*
+*	@param[in] topic_id		The ID of the topic. Must be greater than 0
+*	@param[out] ret_tx_bound	1 if bound as producer, 0 otherwise. Must not be a NULL pointer
+*	@param[out] ret_rx_bound	1 if bound as consumer, 0 otherwise. Must not be a NULL pointer
+*
+*	@pre				None
+*
+*	@return				Upon successful return : ERR_OK (0)
+*	@return				Upon output error : An error code (<0). ERR_TOPIC_NOT_REG if the topic is not registered (or was destroyed) in this node
+*/
+int tc_client_bind_get_state( unsigned int topic_id, unsigned char *ret_tx_bound, unsigned char *ret_rx_bound );
+
 /**
 *	@brief Unbinds client as consumer of topic
 *
@@ -300,7 +518,11 @@ int tc_client_unbind_rx( unsigned int topic_id );
 /**
 *	@brief Sends a message through the network topic
 *
-*	Sends a message through the network topic. If the size of the message exceeds the maximum size of the topic messages an error is triggered
+*	Sends a message through the network topic. If the size of the message exceeds the maximum size of the topic messages an error is triggered.
+*	Concurrent calls on the same topic are combined : the messages are queued and the thread holding the topic transmission lock sends them
+*	all in a batch (each message fragments are sent together), while the others wait for their own message result. Messages bigger than
+*	one datagram are split in UDP_SEGMENT_SIZE fragments handed to the kernel several at a time (UDP GSO), or in D_MTU fragments if
+*	segmentation offload is not available
 *
 *	@param[in] topic_id	The ID of the topic through which the message is to be sent. Must be greater than 0
 *	@param[in] data		The buffer with the data of the sending message. Must not be a NULL pointer
@@ -316,7 +538,9 @@ int tc_client_topic_send( unsigned int topic_id , char *data, int data_size );
 /**
 *	@brief Receives a message from the network topic
 *
-*	Receives a message from the network topic
+*	Receives a message from the network topic. Fragmented messages are reassembled per producer (sender address and message sequence number),
+*	so several producers can send large messages at the same time. Up to RX_REASM_CONTEXTS messages are reassembled at once and are kept
+*	between calls -- an incomplete message is discarded if its next fragment doesn't arrive within FRAG_TIMEOUT ms
 *
 *	@param[in] topic_id	The ID of the topic from which the message is to be received. Must be greater than 0
 *	@param[in] timeout	The maximum time (in ms) to wait for a message. If 0 blocks indefinitely. Must be equal or greater than 0
@@ -327,10 +551,143 @@ int tc_client_topic_send( unsigned int topic_id , char *data, int data_size );
 *
 *	@note			Client must be registered and bound as consumer to be able to use this call
 *
-*	@todo			Handle message fragmentation with topic messages which size exceeds D_MTU :
-*					- Reception of fragments of different messages from different producers when one or more producers are transmiting at the same time
-*					- Message fragments can be lost when client tries to send data faster than topic period	
+*	@todo			Message fragments can be lost when client tries to send data faster than topic period (see tc_client_topic_set_pacing)
 */
 int tc_client_topic_receive( unsigned int topic_id, unsigned int timeout, char *ret_data );
 
+/**
+*	@brief Opens a handle to a topic
+*
+*	Returns a handle to the local entry of the topic, used by tc_client_handle_send and tc_client_handle_receive to skip the topic ID lookup
+*	(and the database lock) on every message. The handle stays valid until it is closed with tc_client_topic_close, even if the topic is
+*	destroyed or the node unregistered from it meanwhile (the handle calls then fail). If the node registers in the topic again a new handle
+*	must be opened. No request is sent to the server
+*
+*	@param[in] topic_id	The ID of the topic. Must be greater than 0
+*	@param[out] ret_handle	The address where to store the topic handle. Must not be a NULL pointer
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0). ERR_TOPIC_NOT_REG if the node is not registered in the topic
+*/
+int tc_client_topic_open( unsigned int topic_id, TC_TOPIC_HANDLE **ret_handle );
+
+/**
+*	@brief Closes a topic handle
+*
+*	Releases a handle returned by tc_client_topic_open. Can be called after tc_client_close
+*
+*	@param[in] handle	The topic handle. Must not be a NULL pointer
+*
+*	@pre			No send/receive call using the handle in progress
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*/
+int tc_client_topic_close( TC_TOPIC_HANDLE *handle );
+
+/**
+*	@brief Sends a message through an opened topic
+*
+*	Same as tc_client_topic_send, using a handle returned by tc_client_topic_open
+*
+*	@param[in] handle	The topic handle. Must not be a NULL pointer
+*	@param[in] data		The buffer with the data of the sending message. Must not be a NULL pointer
+*	@param[in] data_size	The size of the sending message. Must be greater than 0
+*
+*	@return			Upon successful return : The number of sent bytes
+*	@return			Upon output error : An error code (<0)
+*
+*	@note 			Client must be registered and bound as producer to be able to use this call
+*/
+int tc_client_handle_send( TC_TOPIC_HANDLE *handle, char *data, int data_size );
+
+/**
+*	@brief Receives a message from an opened topic
+*
+*	Same as tc_client_topic_receive, using a handle returned by tc_client_topic_open
+*
+*	@param[in] handle	The topic handle. Must not be a NULL pointer
+*	@param[in] timeout	The maximum time (in ms) to wait for a message. If 0 blocks indefinitely. Must be equal or greater than 0
+*	@param[out] ret_data	The buffer where to store the received message. Must not be a NULL pointer
+*
+*	@return			Upon successful return : The number of received bytes
+*	@return			Upon output error : An error code (<0)
+*
+*	@note			Client must be registered and bound as consumer to be able to use this call
+*/
+int tc_client_handle_receive( TC_TOPIC_HANDLE *handle, unsigned int timeout, char *ret_data );
+
+/**
+*	@brief Sets the producer pacing policy of a topic
+*
+*	Limits the messages sent by this node to the topic to a token bucket matching the topic reservation (channel_size bytes per channel_period,
+*	with a burst of one message plus the reservation slack). Over rate messages then wait (PACING_BLOCK), are dropped (PACING_DROP) or wait
+*	unless superseded by a newer message of another thread (PACING_COALESCE), instead of queuing in the reservation qdisc and reaching the
+*	consumers as stale fragments. The default policy is set by TX_PACING_DEFAULT. No request is sent to the server
+*
+*	@param[in] topic_id	The ID of the topic. Must be greater than 0
+*	@param[in] policy	The pacing policy (PACING_OFF, PACING_BLOCK, PACING_DROP or PACING_COALESCE)
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0). ERR_TOPIC_NOT_REG if the node is not registered in the topic
+*
+*	@note			The policy is kept while the node stays registered in the topic
+*/
+int tc_client_topic_set_pacing( unsigned int topic_id, unsigned char policy );
+
+/**
+*	@brief Sets the consumer delivery mode of a topic
+*
+*	With DELIVERY_LATEST each receive call drains the topic socket and returns only the newest complete message, so a consumer that stalled
+*	gets the current state at once instead of the queued backlog (older messages are discarded as they complete). If no message is queued the call waits for the next one as with DELIVERY_ALL (the default, set by RX_DELIVERY_DEFAULT).
+*	No request is sent to the server
+*
+*	@param[in] topic_id	The ID of the topic. Must be greater than 0
+*	@param[in] mode		The delivery mode (DELIVERY_ALL or DELIVERY_LATEST)
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0). ERR_TOPIC_NOT_REG if the node is not registered in the topic
+*
+*	@note			The mode is kept while the node stays registered in the topic
+*/
+int tc_client_topic_set_delivery( unsigned int topic_id, unsigned char mode );
+
+/**
+*	@brief Retrieves the topic data path statistics
+*
+*	Returns the local counters of the messages, bytes and fragments sent and received through the topic, together with the discarded fragments,
+*	timeouts, errors and time spent waiting for the topic locks. Counters are kept since the topic was created or registered in this node.
+*	On producer nodes the state and drops/overlimits/backlog of the topic reservation class are also returned (as read on the last periodic
+*	verification of the kernel traffic control tree). No request is sent to the server
+*
+*	@param[in] topic_id	The ID of the topic. Must be greater than 0
+*	@param[out] ret_stats	The buffer where to store the topic statistics. Must not be a NULL pointer
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*
+*	@note			Counters are read without stopping the data path, so they may be slightly out of sync with each other
+*/
+int tc_client_topic_get_stats( unsigned int topic_id, TC_TOPIC_STATS *ret_stats );
+
+/**
+*	@brief Prints the control operations latency histograms
+*
+*	Prints, for each operation type, the number of samples, mean, p50, p99, p999 and max latency (in us) of the server requests
+*	(request sent until answer received) and of the bind procedures (request sent until bound). Histograms are kept since the
+*	program started. They are also printed periodically if LATENCY_SNAPSHOT_PERIOD is set
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*/
+int tc_client_latency_print( void );
+
 #endif
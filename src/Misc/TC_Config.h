@@ -53,6 +53,101 @@
 *	@brief Maximum UDP to split data messages into fragments ( (sizeof(IP Header) + sizeof(UDP Header) + SEQ_N + DATA_SIZE) = 65535-(20+8+4+4) = 65499 )
 */
 #define D_MTU 65499
+
+/**	@def UDP_SEGMENT_SIZE
+*	@brief Size (in bytes, fragment header included) of the topic message fragments sent several per call with the UDP segmentation offload (GSO).
+*	Should fit the path MTU (1500 - 20 IP header - 8 UDP header = 1472) so fragments are not IP fragmented and a lost packet loses one fragment
+*	instead of a whole D_MTU datagram. If 0, or if UDP GSO is not available (kernel older than 4.18), messages are split in D_MTU fragments
+*/
+#define UDP_SEGMENT_SIZE 1472
+
+/**	@def ENABLE_MSG_TRACING
+*	@brief If 1 topic message fragments carry an extended header (producer node ID, per topic message sequence number and send timestamp)
+*	used by the consumers to measure the one-way message latency and detect lost and reordered messages. Must be the same on all nodes
+*/
+#define ENABLE_MSG_TRACING 0
+
+/**	@def MSG_TRACING_CLOCK
+*	@brief Clock used for the message send timestamps (CLOCK_REALTIME, or CLOCK_TAI if the nodes keep TAI synchronized through PTP)
+*/
+#define MSG_TRACING_CLOCK CLOCK_REALTIME
+
+/**	@def MAX_TRACED_PRODUCERS
+*	@brief Maximum number of producers tracked per topic for lost/reordered messages detection
+*/
+#define MAX_TRACED_PRODUCERS 16
+
+/**	@def CLIENT_DB_HASH_BITS
+*	@brief Number of bits of the client topic database hash index (2^CLIENT_DB_HASH_BITS buckets)
+*/
+#define CLIENT_DB_HASH_BITS 8
+
+/**	@def TX_COMBINING_MAX_BATCH
+*	@brief Maximum number of queued messages of other threads a topic send call transmits before returning (the remaining are sent by their own threads)
+*/
+#define TX_COMBINING_MAX_BATCH 64
+
+/**	@def TX_PACING_DEFAULT
+*	@brief Producer pacing policy of new topic entries (TC_PACING_OFF/BLOCK/DROP/COALESCE -- see tc_client_topic_set_pacing).
+*	Paced messages are limited to a token bucket matching the topic reservation (channel_size bytes per channel_period with a
+*	channel_size * RESERV_SLACK_MULTIPLIER bytes depth)
+*/
+#define TX_PACING_DEFAULT TC_PACING_OFF
+
+/**	@def RX_DELIVERY_DEFAULT
+*	@brief Consumer delivery mode of new topic entries (TC_DELIVERY_ALL/LATEST -- see tc_client_topic_set_delivery)
+*/
+#define RX_DELIVERY_DEFAULT TC_DELIVERY_ALL
+
+/**	@def RX_REASM_CONTEXTS
+*	@brief Maximum number of fragmented messages reassembled at the same time per topic (one per producer sending at the same time).
+*	When full, the oldest incomplete message is discarded
+*/
+#define RX_REASM_CONTEXTS 8
+
+/**	@def FEC_MAX_BLOCK
+*	@brief Maximum number of fragments (data + parity) of a topic FEC block (see tc_client_topic_create_fec)
+*/
+#define FEC_MAX_BLOCK 64
+
+/**	@def RETX_WINDOW
+*	@brief Number of last messages kept by the producers of reliable topics to retransmit their lost fragments (see tc_client_topic_create_reliable).
+*	Also the maximum gap (in messages) the consumers ask to be repaired
+*/
+#define RETX_WINDOW 16
+
+/**	@def RETX_HOLDOFF
+*	@brief Minimum time interval (in ms) between two retransmissions of the same fragment (NACKs of several consumers for one loss are served once)
+*/
+#define RETX_HOLDOFF 2
+
+/**	@def NACK_DELAY
+*	@brief Maximum random delay (in ms) of the consumers NACKs so the consumers that lost the same fragments mostly send one NACK.
+*	Also the time without fragments after which an incomplete message is NACKed (lost last fragments)
+*/
+#define NACK_DELAY 5
+
+/**	@def NACK_INTERVAL
+*	@brief Minimum time interval (in ms) between two NACKs of the same message by a consumer (the message is NACKed again until repaired or given up,
+*	see FRAG_TIMEOUT)
+*/
+#define NACK_INTERVAL 20
+
+/**	@def NACK_MAX_FRAGS
+*	@brief Maximum number of lost fragments listed by a NACK (the following ones are asked by the next NACK)
+*/
+#define NACK_MAX_FRAGS 256
+
+/**	@def RETX_TAIL_DELAY
+*	@brief Time (in ms) a reliable topic producer is idle after its last message before the first fragment of that message is multicast again
+*	(consumers that lost the whole message find out and NACK it). Also the polling period of the client repair thread serving the NACKs
+*/
+#define RETX_TAIL_DELAY 50
+
+/**	@def RETX_MAX_TOPICS
+*	@brief Maximum number of reliable topics produced by a node whose NACKs are served by the client repair thread
+*/
+#define RETX_MAX_TOPICS 64
 /*@}*/
 
 
@@ -73,24 +168,128 @@
 #define PFIFO_SIZE 150
 
 /**	@def ROOT_BW
-*	@brief Maximum NIC bandwidth (in mbps) to be used for comunications+control
+*	@brief Default NIC bandwidth (in mbps) to be used for comunications+control. Only used when the NIC speed can't be read (I.E. virtual NICs)
 */
 #define ROOT_BW 100
 
+/**	@def BACKGROUND_BW_SHARE
+*	@brief Share (in % of the NIC bandwidth) to be used for background traffic
+*/
+#define BACKGROUND_BW_SHARE 1
+
+/**	@def CONTROL_BW_SHARE
+*	@brief Share (in % of the NIC bandwidth) to be used for control traffic (I.E. Heartbeats, requests)
+*/
+#define CONTROL_BW_SHARE 25
+
 /**	@def BACKGROUND_BW
-*	@brief Maximum bandwidth (in mbps) to be used for background traffic
+*	@brief Maximum bandwidth (in mbps) to be used for background traffic on a ROOT_BW NIC
 */
-#define BACKGROUND_BW 1
+#define BACKGROUND_BW ((ROOT_BW*BACKGROUND_BW_SHARE)/100)
 
 /**	@def CONTROL_BW
-*	@brief Maximum root bandwidth (in mbps) to be used for control traffic (I.E. Heartbeats, requests)
+*	@brief Maximum bandwidth (in mbps) to be used for control traffic on a ROOT_BW NIC
 */
-#define CONTROL_BW 25
+#define CONTROL_BW ((ROOT_BW*CONTROL_BW_SHARE)/100)
 
 /**	@def MAX_USABLE_BW
-*	@brief Maximum bandwidth (in bps) to be used by apps
+*	@brief Maximum bandwidth (in bps) to be used by apps on a ROOT_BW NIC. Used by the admission control for nodes that don't report their NIC bandwidth
 */
 #define MAX_USABLE_BW ((ROOT_BW-BACKGROUND_BW-CONTROL_BW)*1024*1024)
+
+/**	@def MAX_BURST_DELAY
+*	@brief Maximum time (in ms) the usable bandwidth may take to drain the sum of all the topic bursts reserved on a node link
+*/
+#define MAX_BURST_DELAY 100
+
+/**	@def USABLE_BURST(X)
+*	@brief Maximum sum of topic bursts (in bytes) that can be admitted on a node link with X usable bandwidth (in bps) ( X drained during MAX_BURST_DELAY )
+*/
+#define USABLE_BURST(X) (((X)/8)/1000*MAX_BURST_DELAY)
+
+/**	@def MAX_USABLE_BURST
+*	@brief Maximum sum of topic bursts (in bytes) that can be admitted on a ROOT_BW node link
+*/
+#define MAX_USABLE_BURST USABLE_BURST(MAX_USABLE_BW)
+
+/**	@def MIN_RESERV_BURST
+*	@brief Minimum HTB burst/cburst (in bytes) set on a topic reservation class -- Must be at least one ethernet frame
+*/
+#define MIN_RESERV_BURST 1600
+
+/**	@def ENABLE_AC_DELAY_BOUND
+*	@brief If 1 the admission control also refuses requests that make the worst-case delay bound of any topic exceed its deadline (the channel period).
+*	If 0 only bandwidth and burst capacity are checked (the delay bound is still computed and returned)
+*/
+#define ENABLE_AC_DELAY_BOUND 0
+
+/**	@def AC_HOP_LATENCY
+*	@brief Fixed latency (in us) added per link to the topics delay bound (I.E. NIC, switch and propagation latencies)
+*/
+#define AC_HOP_LATENCY 100
+
+/**	@def ENABLE_ADAPTIVE_RESERV
+*	@brief If 1 clients report the measured load of their reservations and the admission control shrinks under-used reservations (and grows them back
+*	up to the topic nominal load when they saturate). If 0 reservations always match the topic nominal load
+*/
+#define ENABLE_ADAPTIVE_RESERV 0
+
+/**	@def MAX_RESERV_ENTRIES
+*	@brief Maximum number of simultaneous topic reservations tracked by the client reservation module
+*/
+#define MAX_RESERV_ENTRIES 100
+
+/**	@def USAGE_REPORT_PERIOD
+*	@brief Periodicity (in us) for the sampling and report of the reservations measured load by the clients. Must be a multiple of HEARTBEAT_GEN_PERIOD
+*/
+#define USAGE_REPORT_PERIOD 1000000
+
+/**	@def ADAPT_SHRINK_THRESHOLD
+*	@brief A reservation is under-used when the highest measured producer load is below this fraction of the reserved load
+*/
+#define ADAPT_SHRINK_THRESHOLD 0.5
+
+/**	@def ADAPT_SHRINK_COUNT
+*	@brief Number of consecutive under-used reports before a reservation is shrunk (hysteresis)
+*/
+#define ADAPT_SHRINK_COUNT 5
+
+/**	@def ADAPT_GROW_THRESHOLD
+*	@brief A shrunk reservation is grown back to the topic nominal load when the highest measured producer load reaches this fraction of the reserved load
+*/
+#define ADAPT_GROW_THRESHOLD 0.9
+
+/**	@def ADAPT_HEADROOM
+*	@brief A shrunk reservation is set to the highest measured producer load multiplied by this value
+*/
+#define ADAPT_HEADROOM 1.5
+
+/**	@def ADAPT_MIN_SHARE
+*	@brief A reservation is never shrunk below this fraction of the topic nominal load
+*/
+#define ADAPT_MIN_SHARE 0.1
+
+/**	@def ENABLE_INGRESS_POLICING
+*	@brief If 1 consumer nodes police the incoming topic messages (ingress qdisc with one policer per topic) to the downlink load accounted
+*	by the admission control. Messages above the contract are dropped. If 0 only the producers egress is shaped
+*/
+#define ENABLE_INGRESS_POLICING 0
+
+/**	@def ENABLE_RESERV_VERIFY
+*	@brief If 1 the client reservation module periodically dumps the kernel traffic control tree, compares it with the active reservations
+*	(missing classes or filters, rate drift, unexpected classes) and keeps the classes drops/overlimits/backlog counters. If 0 the tree is never read back
+*/
+#define ENABLE_RESERV_VERIFY 1
+
+/**	@def RESERV_VERIFY_PERIOD
+*	@brief Periodicity (in us) of the kernel traffic control tree verification. Must be a multiple of HEARTBEAT_GEN_PERIOD
+*/
+#define RESERV_VERIFY_PERIOD 1000000
+
+/**	@def RESERV_VERIFY_RATE_TOLERANCE
+*	@brief Maximum relative difference between the class rate reported by tc and the reserved load (tc rounds the printed rates)
+*/
+#define RESERV_VERIFY_RATE_TOLERANCE 0.05
 /*@}*/
 
 
@@ -105,7 +304,8 @@
 #define DISCOVERY_TIMEOUT 5000
 
 /**	@def FRAG_TIMEOUT
-*	@brief Maximum time interval (in ms) waiting for arrival of a message fragment
+*	@brief Maximum time interval (in ms) waiting for arrival of a message fragment. Messages of reliable topics wait at least RETX_WINDOW topic
+*	periods (as long as the producer may retransmit them)
 */
 #define FRAG_TIMEOUT 600
 
@@ -155,6 +355,11 @@
 *	@brief Periodicity (in us) for the generation of discovery messages by server
 */
 #define DISCOVERY_GEN_PERIOD 150000
+
+/**	@def LATENCY_SNAPSHOT_PERIOD
+*	@brief Periodicity (in s) for printing the control operations latency histograms (client and server). If 0 they are only printed on request
+*/
+#define LATENCY_SNAPSHOT_PERIOD 0
 /*@}*/
 
 
@@ -207,6 +412,16 @@
 *	@brief Management group messages IP address
 */
 #define MANAGEMENT_GROUP_IP "239.200.200.200"
+
+/**	@def METRICS_PORT
+*	@brief Server metrics endpoint TCP port number (Prometheus text format). If 0 the metrics endpoint is disabled
+*/
+#define METRICS_PORT 0
+
+/**	@def METRICS_IP
+*	@brief Server metrics endpoint IP address (loopback by default, scrape through a local agent)
+*/
+#define METRICS_IP "127.0.0.1"
 /*@}*/
 
 
@@ -286,6 +501,38 @@
 /*@}*/
 
 
+/*@}*//**
+* @name Logging Parameters
+*//*@{*/
+
+/**	@def LOG_DEFAULT_LEVEL
+*	@brief Default log level of all modules (LOG_ERROR, LOG_WARN, LOG_INFO or LOG_DEBUG). Can be changed at runtime with tc_log_set_level
+*/
+#define LOG_DEFAULT_LEVEL LOG_INFO
+
+/**	@def LOG_RING_SIZE
+*	@brief Number of messages in the log ring buffer (must be a power of 2). Messages are dropped while the ring buffer is full
+*/
+#define LOG_RING_SIZE 1024
+
+/**	@def LOG_MSG_SIZE
+*	@brief Maximum size (in bytes) of a log message. Longer messages are truncated
+*/
+#define LOG_MSG_SIZE 256
+
+/**	@def LOG_FLUSH_PERIOD
+*	@brief Periodicity (in us) for the log writer thread to write the buffered messages
+*/
+#define LOG_FLUSH_PERIOD 10000
+
+/**	@def ENABLE_USDT_PROBES
+*	@brief If 1 static tracepoints (USDT probes, provider "ltcnm") are placed on the hot paths, for bpftrace/perf. A probe not being traced
+*	is a single nop instruction. Requires the systemtap sys/sdt.h header (probes are compiled out if it is not installed)
+*/
+#define ENABLE_USDT_PROBES 1
+/*@}*/
+
+
 /*@}*//**
 * @name Debug Parameters
 *//*@{*/
@@ -390,6 +637,11 @@
 *	@brief If 1 enables debug messages at the server notifications module. If 0 disables them
 */
 #define ENABLE_DEBUG_SERVER_NOTIFICATIONS 0
+
+/**	@def ENABLE_DEBUG_SERVER_METRICS
+*	@brief If 1 enables debug messages at the server metrics module. If 0 disables them
+*/
+#define ENABLE_DEBUG_SERVER_METRICS 0
 /*@}*/
 
 #endif
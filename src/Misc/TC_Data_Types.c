@@ -59,94 +59,91 @@ int tc_msg_type_print ( MSG_TYPE type_code )
 	return ERR_OK;
 }
 
-int tc_op_type_print ( OP_TYPE op_code )
+char* tc_op_type_name ( OP_TYPE op_code )
 {
 	switch ( op_code ){
 
 		case REG_NODE :
-			printf("REG_NODE\n");
-			break;
+			return "REG_NODE";
 
 		case UNREG_NODE :
-			printf("UNREG_NODE\n");
-			break;
+			return "UNREG_NODE";
 
 		case HEART_SIG :
-			printf("HEART_SIG\n");
-			break;
+			return "HEART_SIG";
 
 		case REG_TOPIC :
-			printf("REG_TOPIC\n");
-			break;
+			return "REG_TOPIC";
 
 		case DEL_TOPIC :
-			printf("DEL_TOPIC\n");
-			break;
+			return "DEL_TOPIC";
 
 		case GET_TOPIC_PROP :
-			printf("GET_TOPIC_PROP\n");
-			break;
+			return "GET_TOPIC_PROP";
 
 		case SET_TOPIC_PROP :
-			printf("SET_TOPIC_PROP\n");
-			break;
+			return "SET_TOPIC_PROP";
 
 		case REG_PROD :
-			printf("REG_PROD\n");
-			break;
+			return "REG_PROD";
 
 		case UNREG_PROD :
-			printf("UNREG_PROD\n");
-			break;
+			return "UNREG_PROD";
 
 		case REG_CONS :
-			printf("REG_CONS\n");
-			break;
+			return "REG_CONS";
 
 		case UNREG_CONS :
-			printf("UNREG_CONS\n");
-			break;
+			return "UNREG_CONS";
 
 		case BIND_TX :
-			printf("BIND_TX\n");
-			break;
+			return "BIND_TX";
 
 		case UNBIND_TX :
-			printf("UNBIND_TX\n");
-			break;
+			return "UNBIND_TX";
 
 		case BIND_RX :
-			printf("BIND_RX\n");
-			break;
+			return "BIND_RX";
 
 		case UNBIND_RX :
-			printf("UNBIND_RX\n");
-			break;
+			return "UNBIND_RX";
 
 		case TC_RESERV :
-			printf("TC_RESERV\n");
-			break;
+			return "TC_RESERV";
 
 		case TC_FREE :
-			printf("TC_FREE\n");
-			break;
+			return "TC_FREE";
 
 		case TC_MODIFY :
-			printf("TC_MODIFY\n");
-			break;
+			return "TC_MODIFY";
 
 		case REQ_ACCEPTED :
-			printf("REQ_ACCEPTED\n");
-			break;
+			return "REQ_ACCEPTED";
 
 		case REQ_REFUSED :
-			printf("REQ_REFUSED\n");
-			break;
+			return "REQ_REFUSED";
+
+		case TOPIC_USAGE :
+			return "TOPIC_USAGE";
+
+		case TC_POLICE :
+			return "TC_POLICE";
 
 		default :
-			printf(" OPERATION TYPE CODE NOT RECOGNIZED (%d)\n",op_code);
-			return -1;
+			return NULL;
 	}
+}
+
+int tc_op_type_print ( OP_TYPE op_code )
+{
+	char *name;
+
+	if ( !(name = tc_op_type_name( op_code )) ){
+		printf(" OPERATION TYPE CODE NOT RECOGNIZED (%d)\n",op_code);
+		return -1;
+	}
+
+	printf("%s\n",name);
 
 	return ERR_OK;
 }
@@ -113,6 +113,10 @@ TC_FREE,	/**< Free topic reservation operation code */
 TC_MODIFY,	/**< Modify topic reservation operation code */
 REQ_ACCEPTED,	/**< Request accepted operation code (for answer type messages only) */
 REQ_REFUSED,	/**< Request refused operation code (for answer type messages only) */
+TOPIC_USAGE,	/**< Topic reservation measured load report operation code */
+TC_POLICE,	/**< Set topic ingress policer operation code */
+
+N_OP_TYPES,	/**< Number of operation codes (not an operation -- keep last) */
 
 }OP_TYPE;
 /*@}*/
@@ -131,6 +135,47 @@ EVENT_NODE_UNPLUG,	/**< Node unregistration event code */
 }EVENT_TYPE;
 /*@}*/
 
+/**
+* @name Reservation Verification States
+*//*@{*/
+
+typedef enum {
+
+TC_RESERV_UNVERIFIED = 1,	/**< Reservation not yet compared with the kernel tree */
+TC_RESERV_OK,			/**< Class and filter found with the reserved rate */
+TC_RESERV_NO_CLASS,		/**< Reservation class missing from the kernel tree */
+TC_RESERV_NO_FILTER,		/**< Reservation filter missing from the kernel tree */
+TC_RESERV_RATE_MISMATCH,	/**< Class rate differs from the reserved load */
+
+}RESERV_STATE;
+/*@}*/
+
+/**
+* @name Producer Pacing Policies
+*//*@{*/
+
+typedef enum {
+
+TC_PACING_OFF = 1,	/**< Messages are sent as soon as requested */
+TC_PACING_BLOCK,	/**< Over rate messages wait until they fit in the topic rate */
+TC_PACING_DROP,		/**< Over rate messages are dropped */
+TC_PACING_COALESCE,	/**< Over rate messages wait, but are dropped if a newer message of the topic is already queued */
+
+}TX_PACING;
+/*@}*/
+
+/**
+* @name Consumer Delivery Modes
+*//*@{*/
+
+typedef enum {
+
+TC_DELIVERY_ALL = 1,	/**< Every message is delivered in arrival order */
+TC_DELIVERY_LATEST,	/**< Only the newest complete queued message is delivered */
+
+}RX_DELIVERY;
+/*@}*/
+
 /**
 * The messages structure for requests and answers
 */
@@ -152,6 +197,9 @@ typedef struct net_msg{
 *//*@{*/
 	unsigned int node_ids[MAX_MULTI_NODES];	/**< The involved nodes ID (I.E for a bind request that requests several nodes to bind at the same time)*/
 	unsigned int n_nodes;			/**< The number of involved nodes */
+	unsigned int link_bw;			/**< The node NIC bandwidth (in mbps). Reported on node registration -- 0 if unknown */
+	unsigned int link_background_share;	/**< The share (in %) of the node NIC bandwidth reserved for background traffic */
+	unsigned int link_control_share;	/**< The share (in %) of the node NIC bandwidth reserved for control traffic */
 /*@}*/
 
 /*@}*//**
@@ -161,8 +209,13 @@ typedef struct net_msg{
 	NET_ADDR topic_addr;			/**< The topic network address */			
 	unsigned int topic_id;			/**< The ID of the topic */
 	unsigned int topic_load;		/**< The topics load/requesting load */
+	unsigned int topic_burst;		/**< The topics burst size (in bytes) */
 	unsigned int channel_size;		/**< The maximum size of the messages sent through the topic*/
 	unsigned int channel_period;		/**< The minimum time interval between consecutive topic messages*/
+	unsigned int topic_delay_bound;		/**< The topics worst-case delay bound (in us) computed by the admission control */
+	unsigned int topic_fec_k;		/**< The topic FEC block data fragments (0 -> no FEC) */
+	unsigned int topic_fec_m;		/**< The topic FEC block parity fragments */
+	unsigned int topic_retx_share;		/**< The topic load share (in %) reserved for retransmissions (0 -> not reliable) */
 /*@}*/
 
 }NET_MSG;
@@ -184,14 +237,83 @@ typedef struct tc_config{
 	char protocol[10];	/**< To be used in filters */
 	char dst_ip[20];	/**< Destination IP adress of the packets to be filtered */
 	int port;		/**< Destination port adress number of the packets to be filtered */
-	int rate;		/**< Hierarchical Token Bucket minimum speed in kbps (i.e 256 kbps) */
-	int ceil;		/**< Hierarchical Token Bucket maximum speed in kbps */
+	unsigned int rate;	/**< Hierarchical Token Bucket minimum speed in bps */
+	unsigned int ceil;	/**< Hierarchical Token Bucket maximum speed in bps */
 	int burst;		/**< Hierarchical Token Bucket burst */
 	int cburst;		/**< Hierarchical Token Bucket burst ceil */
 	int prio;		/**< Filter priority */	
+	unsigned int police_rate;	/**< Ingress policer rate in bps (filters only, 0 -> no policer) */
+	int police_burst;	/**< Ingress policer burst in bytes */
 			
 }TC_CONFIG;
 
+/*@}*//**
+* @name Latency Histogram
+*//*@{*/
+
+/**	@def HIST_SUB_BITS
+*	@brief Number of bits of each histogram bucket group (2^HIST_SUB_BITS linear buckets per power of 2 -- ~6% relative precision)
+*/
+#define HIST_SUB_BITS 4
+
+/**	@def HIST_SUB_COUNT
+*	@brief Number of linear buckets per power of 2
+*/
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+
+/**	@def HIST_N_BUCKETS
+*	@brief Number of buckets needed to cover all 32 bit values
+*/
+#define HIST_N_BUCKETS ((32 - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+/**
+* A log bucketed (HDR style) histogram of latency samples (in us). Updated with relaxed atomics so it can be shared by several threads
+*/
+typedef struct tc_hist{
+	unsigned long long count;			/**< Number of samples */
+	unsigned long long sum;				/**< Sum of all samples */
+	unsigned int max;				/**< Highest sample */
+	unsigned long long buckets[HIST_N_BUCKETS];	/**< Number of samples in each bucket */
+}TC_HIST;
+/*@}*/
+
+/*@}*//**
+* @name Topic Messages
+*//*@{*/
+
+/**
+* The header of each topic message fragment
+*/
+typedef struct frag_header{
+	int frag_seq;				/**< The fragment sequence number within the message */
+	int msg_size;				/**< The total message size (in bytes) */
+	unsigned int msg_seq;			/**< The producer message sequence number on this topic (identifies the message fragments with the sender address) */
+	unsigned char fec_k;			/**< FEC block data fragments (0 -> message not FEC protected) */
+	unsigned char fec_m;			/**< FEC block parity fragments */
+	unsigned short frag_payload;		/**< Message bytes carried by each fragment (FEC protected and reliable messages only -- the last data fragment is padded) */
+	unsigned short nack_port;		/**< The producer port receiving the NACKs of lost fragments (0 -> message not reliable) */
+#if ENABLE_MSG_TRACING
+	unsigned int producer_id;		/**< The producer node ID */
+	unsigned long long send_time;		/**< The producer send time (in ns, MSG_TRACING_CLOCK) */
+#endif
+}FRAG_HEADER;
+
+/**	@def FRAG_PAYLOAD
+*	@brief Maximum message bytes carried by each fragment (D_MTU accounts for 8 bytes of header)
+*/
+#define FRAG_PAYLOAD (D_MTU + 8 - (int)sizeof(FRAG_HEADER))
+
+/**	@def FEC_FRAG_PAYLOAD
+*	@brief Maximum message bytes carried by each fragment of FEC protected messages (path MTU sized fragments if UDP_SEGMENT_SIZE is set)
+*/
+#define FEC_FRAG_PAYLOAD ( UDP_SEGMENT_SIZE ? UDP_SEGMENT_SIZE - (int)sizeof(FRAG_HEADER) : FRAG_PAYLOAD )
+
+/**	@def FRAG_NACK
+*	@brief Fragment sequence number of the NACKs sent by the consumers of reliable topics (header followed by the lost fragments sequence numbers)
+*/
+#define FRAG_NACK -1
+/*@}*/
+
 /**	
 *	@brief Prints the message type code
 *
@@ -220,4 +342,18 @@ int tc_msg_type_print ( MSG_TYPE type_code );
 */
 int tc_op_type_print ( OP_TYPE op_code );
 
+/**	
+*	@brief Returns the operation type name
+*
+*	Returns a human readable string naming the operation from an operation type code
+*
+*	@param[in] op_code	The operation code to be analysed
+*
+*	@pre			None
+*
+*	@return			Upon successful return : The operation name
+*	@return			Upon output error : NULL
+*/
+char* tc_op_type_name ( OP_TYPE op_code );
+
 #endif
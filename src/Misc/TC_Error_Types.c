@@ -138,6 +138,14 @@ int tc_error_print ( ERR_TYPE error_code )
 			printf(" ERR_NOTIFIC_INIT : ERROR INITIALIZING NOTIFICATIONS MODULE\n");
 			break;
 
+		case ERR_METRICS_INIT :
+			printf(" ERR_METRICS_INIT : ERROR INITIALIZING METRICS MODULE\n");
+			break;
+
+		case ERR_LOG_INIT :
+			printf(" ERR_LOG_INIT : ERROR INITIALIZING LOGGER\n");
+			break;
+
 		case ERR_HANDLER_INIT : 
 			printf(" ERR_HANDLER_INIT : ERROR INITIALIZING SERVER HANDLER THREAD\n");
 			break;
@@ -174,6 +182,14 @@ int tc_error_print ( ERR_TYPE error_code )
 			printf(" ERR_NOTIFIC_CLOSE : ERROR CLOSING NOTIFICATIONS MODULE\n");
 			break;
 
+		case ERR_METRICS_CLOSE :
+			printf(" ERR_METRICS_CLOSE : ERROR CLOSING METRICS MODULE\n");
+			break;
+
+		case ERR_LOG_CLOSE :
+			printf(" ERR_LOG_CLOSE : ERROR CLOSING LOGGER\n");
+			break;
+
 		case ERR_HANDLER_CLOSE : 
 			printf(" ERR_HANDLER_CLOSE : ERROR CLOSING SERVER HANDLER THREAD\n");
 			break;
@@ -237,6 +253,14 @@ int tc_error_print ( ERR_TYPE error_code )
 		case ERR_DATA_SIZE :
 			printf(" ERR_DATA_SIZE : INVALID DATA SIZE\n");
 			break;
+
+		case ERR_DATA_PACED :
+			printf(" ERR_DATA_PACED : MESSAGE DROPPED -- TOPIC RATE EXCEEDED\n");
+			break;
+
+		case ERR_DATA_COALESCED :
+			printf(" ERR_DATA_COALESCED : MESSAGE SUPERSEDED BY A NEWER ONE -- TOPIC RATE EXCEEDED\n");
+			break;
 	
 		case ERR_TOPIC_NOT_REG :
 			printf(" ERR_TOPIC_NOT_REG : TOPIC DOES NOT EXIST\n");
@@ -262,6 +286,10 @@ int tc_error_print ( ERR_TYPE error_code )
 			printf(" ERR_TOPIC_IN_UPDATE : ERROR OCCURRED BECAUSE TOPIC IS UPDATING\n");
 			break;
 
+		case ERR_TOPIC_DEADLINE :
+			printf(" ERR_TOPIC_DEADLINE : TOPIC DELAY BOUND EXCEEDS ITS DEADLINE\n");
+			break;
+
 		case ERR_TOPIC_LOCAL_CREATE :
 			printf(" ERR_TOPIC_LOCAL_CREATE : ERROR CREATING NODE ENTRY FOR TOPIC\n");
 			break;
@@ -330,6 +358,14 @@ int tc_error_print ( ERR_TYPE error_code )
 			printf(" ERR_NODE_CONS_BW : CONSUMER NODES DON'T HAVE ENOUGH BANDWIDTH\n");
 			break;
 
+		case ERR_NODE_PROD_BURST :
+			printf(" ERR_NODE_PROD_BURST : PRODUCER NODES DON'T HAVE ENOUGH BURST CAPACITY\n");
+			break;
+
+		case ERR_NODE_CONS_BURST :
+			printf(" ERR_NODE_CONS_BURST : CONSUMER NODES DON'T HAVE ENOUGH BURST CAPACITY\n");
+			break;
+
 		case ERR_NODE_PROD_RESERV :
 			printf(" ERR_NODE_PROD_RESERV : PRODUCER NODE FAILED TO RESERV BANDWIDTH\n");
 			break;
@@ -378,6 +414,10 @@ int tc_error_print ( ERR_TYPE error_code )
 			printf(" ERR_NODE_NOT_BOUND_RX : NODE IS NOT BOUND AS CONSUMER OF TOPIC\n");
 			break;
 
+		case ERR_BIND_HANDLE :
+			printf(" ERR_BIND_HANDLE : FAILED TO CREATE BIND COMPLETION HANDLE\n");
+			break;
+
 		case ERR_RESERV_ADD :
 			printf(" ERR_RESERV_ADD : FAILED TO CREATE RESERVATION ON NODE(S)\n");
 			break;
@@ -390,6 +430,10 @@ int tc_error_print ( ERR_TYPE error_code )
 			printf(" ERR_RESERV_SET : FAILED TO MODIFY RESERVATION ON NODE(S)\n");
 			break;
 
+		case ERR_RESERV_GET :
+			printf(" ERR_RESERV_GET : FAILED TO READ RESERVATION STATISTICS\n");
+			break;
+
 		case ERR_THREAD_CREATE :
 			printf(" ERR_THREAD_CREATE : ERROR CREATING THREAD\n");
 			break;
@@ -402,6 +446,14 @@ int tc_error_print ( ERR_TYPE error_code )
 			printf(" ERR_THREAD_TIMEOUT : TIMEDOUT WAINTING FOR THREAD TO LOCK FEEDBACK MUTEX\n");
 			break;
 
+		case ERR_LOCK :
+			printf(" ERR_LOCK : FAILED TO LOCK MUTEX\n");
+			break;
+
+		case ERR_LOCK_TIMEOUT :
+			printf(" ERR_LOCK_TIMEOUT : TIMEDOUT WAITING FOR MUTEX\n");
+			break;
+
 		default :
 			printf(" ERROR CODE NOT RECOGNIZED (%d)\n",error_code);
 			return -1;
@@ -66,6 +66,8 @@ ERR_MANAG_INIT,		/**< Error initializing management module */
 ERR_AC_INIT,		/**< Error initializing admission control module */
 ERR_DISCOVERY_INIT,	/**< Error initializing discovery module */
 ERR_NOTIFIC_INIT,	/**< Error initializing notifications module */
+ERR_METRICS_INIT,	/**< Error initializing metrics module */
+ERR_LOG_INIT,		/**< Error initializing logger */
 ERR_HANDLER_INIT,	/**< Error initializing server handler thread */
 
 ERR_TC_CLOSE,		/**< Error closing linux traffic control */
@@ -77,6 +79,8 @@ ERR_MANAG_CLOSE,	/**< Error closing management module */
 ERR_AC_CLOSE,		/**< Error closing admission control module */
 ERR_DISCOVERY_CLOSE,	/**< Error closing discovery module */
 ERR_NOTIFIC_CLOSE,	/**< Error closing notifications module */
+ERR_METRICS_CLOSE,	/**< Error closing metrics module */
+ERR_LOG_CLOSE,		/**< Error closing logger */
 ERR_HANDLER_CLOSE,	/**< Error closing server handler thread */
 /*@}*/
 
@@ -124,6 +128,8 @@ ERR_DATA_UNBLOCK,	/**< Received unblock signal */
 ERR_DATA_SEND,		/**< Error while sending data */
 ERR_DATA_RECEIVE,	/**< Error while receiving data */
 ERR_DATA_SIZE,		/**< Error with data size */
+ERR_DATA_PACED,		/**< Message dropped by the producer pacing (topic rate exceeded) */
+ERR_DATA_COALESCED,	/**< Message superseded by a newer one by the producer pacing (topic rate exceeded) */
 /*@}*/
 
 
@@ -137,6 +143,8 @@ ERR_PTHREAD_DESTROY,	/**< Error destroying thread */
 ERR_THREAD_CREATE,	/**< Error while creating thread */
 ERR_THREAD_DESTROY,	/**< Error while destroying thread */
 ERR_THREAD_TIMEOUT,	/**< Timedout while waiting for thread to lock feedback mutex */
+ERR_LOCK,		/**< Error while locking mutex */
+ERR_LOCK_TIMEOUT,	/**< Timedout while waiting for mutex */
 /*@}*/
 
 
@@ -152,6 +160,7 @@ ERR_TOPIC_CREATE,	/**< Error creating topic entry */
 ERR_TOPIC_DELETE,	/**< Error destroying topic entry */
 ERR_TOPIC_UPDATE,	/**< Error updating topic entry */
 ERR_TOPIC_IN_UPDATE,	/**< Error occurred because topic is updating */
+ERR_TOPIC_DEADLINE,	/**< Topic delay bound exceeds its deadline */
 
 ERR_TOPIC_LOCAL_CREATE,/**< Error creating topic local entry */
 ERR_TOPIC_LOCAL_DELETE,/**< Error destroying topic local entry */
@@ -182,6 +191,8 @@ ERR_NODE_NOT_REG_RX,	/**< Node is not registered as consumer of the topic */
 
 ERR_NODE_PROD_BW,	/**< Producer nodes dont have enough bandwidth  */
 ERR_NODE_CONS_BW,	/**< Consumer nodes dont have enough bandwidth  */
+ERR_NODE_PROD_BURST,	/**< Producer nodes dont have enough burst capacity  */
+ERR_NODE_CONS_BURST,	/**< Consumer nodes dont have enough burst capacity  */
 
 ERR_NODE_PROD_RESERV,	/**< Bandwidth reservation failed on producer node  */
 ERR_NODE_CONS_RESERV,	/**< Bandwidth reservation failed on consumer node */
@@ -203,6 +214,7 @@ ERR_UNBIND_RX_TIMEDOUT,	/**< Timedout while waiting for unbind as consumer on to
 
 ERR_NODE_NOT_BOUND_TX,	/**< Node is not bound as producer of the topic */
 ERR_NODE_NOT_BOUND_RX,	/**< Node is not bound as consumer of the topic */
+ERR_BIND_HANDLE,	/**< Error creating the bind completion handle */
 /*@}*/
 
 
@@ -214,6 +226,7 @@ ERR_NODE_NOT_BOUND_RX,	/**< Node is not bound as consumer of the topic */
 ERR_RESERV_ADD,		/**< Error while creating reservation */
 ERR_RESERV_DEL,		/**< Error while destroying reservation */
 ERR_RESERV_SET,		/**< Error while modifying reservation */
+ERR_RESERV_GET,		/**< Error while reading reservation statistics */
 /*@}*/
 
 }ERR_TYPE;
@@ -36,6 +36,7 @@
 #include "TC_Data_Types.h"
 #include "TC_Error_Types.h"
 #include "TC_Config.h"
+#include "TC_Utils.h"
 
 #include "TC_Server_AC.h"
 #include "TC_Server_DB.h"
@@ -58,7 +59,17 @@ static unsigned int node_id_pool = 10000;
 #define DEBUG_MSG_SERVER_AC(...)
 #endif
 
-static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NODE_ENTRY *prod_node, unsigned int req_load );
+static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NODE_ENTRY *prod_node, unsigned long long req_load, unsigned long long req_burst );
+#if ENABLE_AC_DELAY_BOUND
+static int tc_server_ac_check_delay( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NODE_ENTRY *prod_node, int req_burst, unsigned int deadline );
+#endif
+static unsigned int tc_server_ac_link_delay( unsigned long long burst, unsigned long long usable_bw );
+static unsigned int tc_server_ac_topic_load( TOPIC_ENTRY *topic, unsigned int channel_size, unsigned int channel_period );
+static unsigned int tc_server_ac_topic_burst( TOPIC_ENTRY *topic, unsigned int channel_size );
+#if ENABLE_ADAPTIVE_RESERV
+static int tc_server_ac_set_topic_load( TOPIC_ENTRY *topic, unsigned int new_load );
+#endif
+static unsigned int tc_server_ac_topic_delay( TOPIC_ENTRY *topic, NODE_ENTRY *extra_cons, NODE_ENTRY *extra_prod );
 
 int tc_server_ac_init( void )
 {
@@ -92,7 +103,7 @@ int tc_server_ac_close( void )
 	return ERR_OK;
 }
 
-int tc_server_ac_add_node( unsigned int node_id, NET_ADDR *node_address, unsigned int *ret_node_id )
+int tc_server_ac_add_node( unsigned int node_id, NET_ADDR *node_address, unsigned int link_bw, unsigned int background_share, unsigned int control_share, unsigned int *ret_node_id )
 {
 	DEBUG_MSG_SERVER_AC("tc_server_ac_add_node() Node Id %u ...\n",node_id);
 
@@ -107,6 +118,11 @@ int tc_server_ac_add_node( unsigned int node_id, NET_ADDR *node_address, unsigne
 	assert( node_address ); 
 	assert( ret_node_id ); 
 
+	if ( link_bw && (background_share + control_share >= 100) ){
+		fprintf(stderr,"tc_server_ac_add_node() : INVALID NIC SHARES (BACKGROUND %u%% CONTROL %u%%)\n",background_share,control_share);
+		return ERR_INVALID_PARAM;
+	}
+
 	if ( req_node_id ){
 		//User wants a specific node ID
 		//Check if node with this ID is registered
@@ -143,12 +159,19 @@ int tc_server_ac_add_node( unsigned int node_id, NET_ADDR *node_address, unsigne
 	node->address.port = node_address->port;
 	node->heartbeat = HEARBEAT_COUNT;
 
+	//Set node capacity ( nodes that don't report their NIC bandwidth get the default one )
+	if ( link_bw )
+		node->usable_bw = (unsigned long long)link_bw*(100-background_share-control_share)/100*1024*1024;
+	else
+		node->usable_bw = MAX_USABLE_BW;
+	node->usable_burst = USABLE_BURST(node->usable_bw);
+
 	*ret_node_id = req_node_id;
 
 	//Send notification
 	tc_server_notifications_send_node_event( EVENT_NODE_PLUG, node );
 
-	DEBUG_MSG_SERVER_AC("tc_server_ac_add_node() Node Id %u with address %s:%u registered\n",req_node_id,node->address.name_ip,node->address.port);
+	DEBUG_MSG_SERVER_AC("tc_server_ac_add_node() Node Id %u with address %s:%u registered ( usable bw %llu [bps] )\n",req_node_id,node->address.name_ip,node->address.port,node->usable_bw);
 
 	return ERR_OK;
 }
@@ -192,7 +215,7 @@ int tc_server_ac_rm_node( unsigned int node_id )
 	return ERR_OK;
 }
 
-int tc_server_ac_add_topic( unsigned int topic_id, unsigned int channel_size, unsigned int channel_period )
+int tc_server_ac_add_topic( unsigned int topic_id, unsigned int channel_size, unsigned int channel_period, unsigned int fec_k, unsigned int fec_m, unsigned int retx_share )
 {
 	DEBUG_MSG_SERVER_AC("tc_server_ac_add_topic() Topic Id %u ...\n",topic_id);
 
@@ -207,12 +230,23 @@ int tc_server_ac_add_topic( unsigned int topic_id, unsigned int channel_size, un
 	assert( channel_size );
 	assert( channel_period );
 
+	if ( fec_k && (!fec_m || fec_k + fec_m > FEC_MAX_BLOCK) ){
+		fprintf(stderr,"tc_server_ac_add_topic() : INVALID FEC BLOCK %u+%u FOR TOPIC ID %u\n",fec_k,fec_m,topic_id);
+		return ERR_INVALID_PARAM;
+	}
+	if ( !fec_k )
+		fec_m = 0;
+	if ( retx_share > 100 ){
+		fprintf(stderr,"tc_server_ac_add_topic() : INVALID RETRANSMISSIONS SHARE %u%% FOR TOPIC ID %u\n",retx_share,topic_id);
+		return ERR_INVALID_PARAM;
+	}
+
 	//Check if topic is registered
 	topic = tc_server_db_topic_search( topic_id );
 
 	if ( topic ){
 		//Already registered with same properties
-		if( topic->channel_size == channel_size && topic->channel_period == channel_period ){
+		if( topic->channel_size == channel_size && topic->channel_period == channel_period && topic->fec_k == fec_k && topic->fec_m == fec_m && topic->retx_share == retx_share ){
 			fprintf(stderr,"tc_server_ac_add_topic() : Topic Id %u Size %u Period %u already registered\n",topic_id,channel_size,channel_period);
 			return ERR_OK;
 		}
@@ -234,11 +268,18 @@ int tc_server_ac_add_topic( unsigned int topic_id, unsigned int channel_size, un
 	topic->address.port = topic_port;
 	topic->channel_size = channel_size;
 	topic->channel_period = channel_period;
-	topic->topic_load = (topic->channel_size * 8000 / topic->channel_period) * RESERV_SLACK_MULTIPLIER;
+	topic->fec_k = fec_k;
+	topic->fec_m = fec_m;
+	topic->retx_share = retx_share;
+	//FEC parity fragments and retransmissions are topic load too
+	topic->topic_load = tc_server_ac_topic_load( topic, channel_size, channel_period );
+	//Token bucket burst -- one full size message must be able to leave at line rate
+	topic->topic_burst = tc_server_ac_topic_burst( topic, channel_size );
+	topic->nominal_load = topic->topic_load;
 
 	topic_port++;
 
-	DEBUG_MSG_SERVER_AC("tc_server_ac_add_topic() Topic Id %u Size %u Period %u registered\n",topic_id,topic->channel_size,topic->channel_period);
+	DEBUG_MSG_SERVER_AC("tc_server_ac_add_topic() Topic Id %u Size %u Period %u FEC %u+%u Retransmissions %u%% registered\n",topic_id,topic->channel_size,topic->channel_period,topic->fec_k,topic->fec_m,topic->retx_share);
 
 	return ERR_OK;
 }
@@ -252,7 +293,8 @@ int tc_server_ac_set_topic_prop( unsigned int topic_id, unsigned int channel_siz
 
 	int n_prod,ret;
 	unsigned int final_load,current_load;
-	int delta_load;
+	unsigned int final_burst,current_burst;
+	int delta_load,delta_burst;
 
 	if ( !init ){
 		fprintf(stderr,"tc_server_ac_set_topic_prop() : MODULE IS NOT INITIALIZED\n");
@@ -278,23 +320,40 @@ int tc_server_ac_set_topic_prop( unsigned int topic_id, unsigned int channel_siz
 	}
 
 	//Calculate the amount of load that will be negotiated (can be more or less than actual load)
-	final_load = (channel_size * 8000 / channel_period) * RESERV_SLACK_MULTIPLIER;
+	final_load = tc_server_ac_topic_load( topic, channel_size, channel_period );
 	current_load = topic->topic_load;
 	delta_load = final_load - current_load;
 
+	final_burst = tc_server_ac_topic_burst( topic, channel_size );
+	current_burst = topic->topic_burst;
+	delta_burst = final_burst - current_burst;
+
 	DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_prop() : final_load %u current_load %u delta_load %d\n",final_load,current_load,delta_load);
+	DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_prop() : final_burst %u current_burst %u delta_burst %d\n",final_burst,current_burst,delta_burst);
 
-	//If we are requesting more load check if every node has enough bandwidth for the required changes
-	if ( final_load > current_load ){
-		if ( (delta_load > 0) && (ret = tc_server_ac_check_bw( topic, NULL, NULL, (unsigned int)delta_load )) ){
+	//If we are requesting more load or burst check if every node has enough bandwidth for the required changes
+	if ( (delta_load > 0) || (delta_burst > 0) ){
+		if ( (ret = tc_server_ac_check_bw( topic, NULL, NULL, (delta_load > 0) ? delta_load : 0, (delta_burst > 0) ? delta_burst : 0 )) ){
 			fprintf(stderr,"tc_server_ac_set_topic_prop() : NOT ENOUGH BANDWIDTH ON SOME OR ALL NODES FOR TOPIC ID %u CHANGES\n",topic_id);
 			return ret;
 		}	
 	}
 
+#if ENABLE_AC_DELAY_BOUND
+	//Check if every topic deadline is still met ( a shorter period also shortens this topic deadline )
+	if ( (ret = tc_server_ac_check_delay( topic, NULL, NULL, delta_burst, channel_period*1000 )) ){
+		fprintf(stderr,"tc_server_ac_set_topic_prop() : DEADLINES CAN'T BE MET FOR TOPIC ID %u CHANGES\n",topic_id);
+		return ret;
+	}
+#endif
+
 	//Call management module to update nodes reservations and local database with the new topic properties
 	updated_topic = *topic;
 	updated_topic.topic_load = final_load;
+	updated_topic.topic_burst = final_burst;
+	updated_topic.nominal_load = final_load;
+	updated_topic.under_use_count = 0;
+	updated_topic.pending_load = 0;
 	updated_topic.channel_size = channel_size;
 	updated_topic.channel_period = channel_period;
 
@@ -304,8 +363,10 @@ int tc_server_ac_set_topic_prop( unsigned int topic_id, unsigned int channel_siz
 	}
 
 	//Update producers bandwidth
-	for ( prod_entry = topic->prod_list; prod_entry ; prod_entry = prod_entry->next  )
+	for ( prod_entry = topic->prod_list; prod_entry ; prod_entry = prod_entry->next  ){
 		prod_entry->node->uplink_load = prod_entry->node->uplink_load + delta_load;
+		prod_entry->node->uplink_burst = prod_entry->node->uplink_burst + delta_burst;
+	}
 
 	//NOTE : When one node is producer and consumer of the same topic, when it produces it produces only for the other consumers (no loopback)
 	//Update consumers bandwidth
@@ -317,11 +378,16 @@ int tc_server_ac_set_topic_prop( unsigned int topic_id, unsigned int channel_siz
 				n_prod++;
 		}
 		cons_entry->node->downlink_load = cons_entry->node->downlink_load + (delta_load * n_prod);
+		cons_entry->node->downlink_burst = cons_entry->node->downlink_burst + (delta_burst * n_prod);
 	}
 
 	//Update topic entry
 	*topic = updated_topic;
 
+	//Update consumers ingress policers to the new topic load
+	if ( tc_server_management_police_update( topic ) )
+		fprintf(stderr,"tc_server_ac_set_topic_prop() : ERROR UPDATING TOPIC ID %u POLICERS ON SOME OR ALL CONSUMERS\n",topic_id);
+
 	DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_prop() Topic Id %u New size %u New Period %u\n",topic_id,topic->channel_size,topic->channel_period);
 
 	return ERR_OK;
@@ -375,6 +441,8 @@ int tc_server_ac_rm_topic( unsigned int topic_id )
 		}
 		if ( cons_entry->node->downlink_load )
 			cons_entry->node->downlink_load = cons_entry->node->downlink_load - topic->topic_load*n_prod_aux;
+		if ( cons_entry->node->downlink_burst )
+			cons_entry->node->downlink_burst = cons_entry->node->downlink_burst - topic->topic_burst*n_prod_aux;
  
 		//Remove node from topic list
 		tc_server_db_topic_rm_cons_node( topic, cons_entry->node );
@@ -384,6 +452,7 @@ int tc_server_ac_rm_topic( unsigned int topic_id )
 	for ( prod_entry = topic->prod_list; prod_entry ; prod_entry = prod_entry->next  ){
 		//Update node load
 		prod_entry->node->uplink_load = prod_entry->node->uplink_load - topic->topic_load;
+		prod_entry->node->uplink_burst = prod_entry->node->uplink_burst - topic->topic_burst;
 
 		//Remove node from topic list
 		tc_server_db_topic_rm_prod_node( topic, prod_entry->node );
@@ -440,6 +509,176 @@ int tc_server_ac_get_topic_prop( unsigned int topic_id, unsigned int *ret_load,
 	return ERR_OK;
 }
 
+int tc_server_ac_get_topic_reliability( unsigned int topic_id, unsigned int *ret_fec_k, unsigned int *ret_fec_m, unsigned int *ret_retx_share )
+{
+	DEBUG_MSG_SERVER_AC("tc_server_ac_get_topic_reliability() Topic Id %u ...\n",topic_id);
+
+	TOPIC_ENTRY *topic = NULL;
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_ac_get_topic_reliability() : MODULE IS NOT INITIALIZED\n");
+		return ERR_S_NOT_INIT;
+	}
+
+	assert( topic_id );
+	assert( ret_fec_k );
+	assert( ret_fec_m );
+	assert( ret_retx_share );
+
+	//Check if topic is registered
+	topic = tc_server_db_topic_search( topic_id );
+
+	if ( !topic ){
+		fprintf(stderr,"tc_server_ac_get_topic_reliability(): TOPIC ID %u NOT REGISTERED\n",topic_id);
+		return ERR_TOPIC_NOT_REG;
+	}
+
+	*ret_fec_k = topic->fec_k;
+	*ret_fec_m = topic->fec_m;
+	*ret_retx_share = topic->retx_share;
+
+	DEBUG_MSG_SERVER_AC("tc_server_ac_get_topic_reliability() Topic Id %u FEC %u+%u Retransmissions %u%%\n",topic_id,*ret_fec_k,*ret_fec_m,*ret_retx_share);
+
+	return ERR_OK;
+}
+
+int tc_server_ac_get_topic_delay( unsigned int topic_id, unsigned int *ret_delay_bound )
+{
+	DEBUG_MSG_SERVER_AC("tc_server_ac_get_topic_delay() Topic Id %u ...\n",topic_id);
+
+	TOPIC_ENTRY *topic = NULL;
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_ac_get_topic_delay() : MODULE IS NOT INITIALIZED\n");
+		return ERR_S_NOT_INIT;
+	}
+	
+	assert( topic_id );
+	assert( ret_delay_bound );
+
+	//Check if topic is registered
+	topic = tc_server_db_topic_search( topic_id );
+
+	if ( !topic ){
+		fprintf(stderr,"tc_server_ac_get_topic_delay(): TOPIC ID %u NOT REGISTERED\n",topic_id);
+		return ERR_TOPIC_NOT_REG;
+	}
+
+	*ret_delay_bound = tc_server_ac_topic_delay( topic, NULL, NULL );
+
+	DEBUG_MSG_SERVER_AC("tc_server_ac_get_topic_delay() Topic Id %u delay bound %u [us]\n",topic_id,*ret_delay_bound);
+
+	return ERR_OK;
+}
+
+int tc_server_ac_set_topic_usage( unsigned int topic_id, unsigned int node_id, unsigned int measured_load )
+{
+	DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_usage() Topic Id %u Node Id %u Load %u [bps] ...\n",topic_id,node_id,measured_load);
+
+	TOPIC_ENTRY *topic = NULL;
+	NODE_BIND_ENTRY *prod_entry = NULL;
+#if ENABLE_ADAPTIVE_RESERV
+	unsigned int max_load = 0, new_load;
+#endif
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_ac_set_topic_usage() : MODULE IS NOT INITIALIZED\n");
+		return ERR_S_NOT_INIT;
+	}
+
+	assert( topic_id );
+	assert( node_id );
+
+	//Get topic entry
+	if ( !(topic = tc_server_db_topic_search( topic_id )) ){
+		fprintf(stderr,"tc_server_ac_set_topic_usage() : TOPIC ID %u NOT REGISTERED\n",topic_id);
+		return ERR_TOPIC_NOT_REG;
+	}
+
+	//Get producer entry
+	for ( prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next ){
+		if ( prod_entry->node->node_id == node_id )
+			break;
+	}
+
+	if ( !prod_entry ){
+		DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_usage() : Node id %u is not registered as producer of topic id %u\n",node_id,topic_id);
+		return ERR_NODE_NOT_REG_TX;
+	}
+
+	prod_entry->measured_load = measured_load;
+
+#if ENABLE_ADAPTIVE_RESERV
+	//The reservation is shared by all producers -- size it for the busiest one
+	for ( prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next ){
+		if ( prod_entry->measured_load > max_load )
+			max_load = prod_entry->measured_load;
+	}
+
+	if ( max_load >= topic->topic_load * ADAPT_GROW_THRESHOLD ){
+		//Reservation is saturated (HTB ceil = rate so measured load can't go above it) -- Grow back to nominal load right away
+		topic->under_use_count = 0;
+		topic->pending_load = 0;
+
+		if ( topic->topic_load < topic->nominal_load ){
+			DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_usage() Topic Id %u saturated -- growing reservation to %u [bps]\n",topic_id,topic->nominal_load);
+			topic->pending_load = topic->nominal_load;
+		}
+	}else if ( max_load < topic->topic_load * ADAPT_SHRINK_THRESHOLD ){
+		//Reservation is under-used -- Only shrink after several consecutive reports (hysteresis)
+		if ( ++topic->under_use_count >= ADAPT_SHRINK_COUNT ){
+			topic->under_use_count = 0;
+
+			new_load = max_load * ADAPT_HEADROOM;
+			if ( new_load < topic->nominal_load * ADAPT_MIN_SHARE )
+				new_load = topic->nominal_load * ADAPT_MIN_SHARE;
+
+			if ( new_load && new_load < topic->topic_load ){
+				DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_usage() Topic Id %u under-used -- shrinking reservation to %u [bps]\n",topic_id,new_load);
+				topic->pending_load = new_load;
+			}
+		}
+	}else{
+		//Usage back within the reservation -- Drop any resize not applied yet
+		topic->under_use_count = 0;
+		topic->pending_load = 0;
+	}
+#endif
+
+	return ERR_OK;
+}
+
+int tc_server_ac_apply_topic_usage( void )
+{
+	DEBUG_MSG_SERVER_AC("tc_server_ac_apply_topic_usage() ...\n");
+
+	int ret = ERR_OK;
+#if ENABLE_ADAPTIVE_RESERV
+	unsigned int new_load;
+	TOPIC_ENTRY *topic = NULL;
+#endif
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_ac_apply_topic_usage() : MODULE IS NOT INITIALIZED\n");
+		return ERR_S_NOT_INIT;
+	}
+
+#if ENABLE_ADAPTIVE_RESERV
+	//Resize the reservations decided from the usage reports (one failed resize doesn't hold back the others)
+	for ( topic = tc_server_db_topic_get_first(); topic; topic = topic->next ){
+		if ( !(new_load = topic->pending_load) )
+			continue;
+
+		topic->pending_load = 0;
+
+		if ( new_load != topic->topic_load && tc_server_ac_set_topic_load( topic, new_load ) )
+			ret = ERR_TOPIC_UPDATE;
+	}
+#endif
+
+	return ret;
+}
+
 int tc_server_ac_add_prod( unsigned int topic_id, unsigned int node_id )
 {
 	DEBUG_MSG_SERVER_AC("tc_server_ac_add_prod() Topic Id %u ...\n",topic_id);
@@ -475,14 +714,22 @@ int tc_server_ac_add_prod( unsigned int topic_id, unsigned int node_id )
 		return ERR_OK;
 	}
 
-	DEBUG_MSG_SERVER_AC("tc_server_ac_add_prod() Node Id %u Uplink load %u [bps] Requesting load %u [bps]\n",node->node_id,node->uplink_load,topic->topic_load);
+	DEBUG_MSG_SERVER_AC("tc_server_ac_add_prod() Node Id %u Uplink load %llu [bps] Requesting load %u [bps]\n",node->node_id,node->uplink_load,topic->topic_load);
 
 	//Check if all nodes of this topic have enough bandwidth
-	if ( (topic->topic_load > 0) && (ret = tc_server_ac_check_bw( topic, node, NULL, topic->topic_load )) ){
+	if ( (topic->topic_load > 0) && (ret = tc_server_ac_check_bw( topic, NULL, node, topic->topic_load, topic->topic_burst )) ){
 		fprintf(stderr,"tc_server_ac_add_prod() : NOT ENOUGH BANDWIDTH ON SOME OR ALL NODES FOR TOPIC ID %u CHANGES\n",topic_id);
 		return ret;
 	}	
 
+#if ENABLE_AC_DELAY_BOUND
+	//Check if every topic deadline is still met with the new producer
+	if ( (ret = tc_server_ac_check_delay( topic, NULL, node, topic->topic_burst, topic->channel_period*1000 )) ){
+		fprintf(stderr,"tc_server_ac_add_prod() : DEADLINES CAN'T BE MET FOR TOPIC ID %u CHANGES\n",topic_id);
+		return ret;
+	}
+#endif
+
 	//Reserv resources in producer node
 	if ( tc_server_management_reserv_req( node, topic, TC_RESERV, topic->topic_load ) ){
 		fprintf(stderr,"tc_server_ac_add_prod() : ERROR RESERVING BANDWIDTH FOR TOPIC ID %u ON NODE ID %u\n",topic->topic_id,node->node_id);
@@ -498,15 +745,22 @@ int tc_server_ac_add_prod( unsigned int topic_id, unsigned int node_id )
 			
 	//Update nodes load
 	node->uplink_load = node->uplink_load + topic->topic_load;
+	node->uplink_burst = node->uplink_burst + topic->topic_burst;
 	for ( cons_entry = topic->cons_list; cons_entry ; cons_entry = cons_entry->next  ){
 
 		//If we are also consumer of this topic -- ignore load (no loopback)		
-		if ( cons_entry->node != node )
+		if ( cons_entry->node != node ){
 			cons_entry->node->downlink_load =  cons_entry->node->downlink_load + topic->topic_load;
+			cons_entry->node->downlink_burst =  cons_entry->node->downlink_burst + topic->topic_burst;
+		}
 	}
 
+	//Consumers now receive from one more producer -- Update their ingress policers
+	if ( tc_server_management_police_update( topic ) )
+		fprintf(stderr,"tc_server_ac_add_prod() : ERROR UPDATING TOPIC ID %u POLICERS ON SOME OR ALL CONSUMERS\n",topic_id);
+
 	DEBUG_MSG_SERVER_AC("tc_server_ac_add_prod() Added Node Id %u as producer of Topic Id %u\n",node_id,topic_id);
-	DEBUG_MSG_SERVER_AC("tc_server_ac_add_prod() Node Id %u Uplink load %u [bps] Downlink load %u [bps]\n",node->node_id,node->uplink_load,node->downlink_load);
+	DEBUG_MSG_SERVER_AC("tc_server_ac_add_prod() Node Id %u Uplink load %llu [bps] Downlink load %llu [bps]\n",node->node_id,node->uplink_load,node->downlink_load);
 
 	return ERR_OK;
 }
@@ -560,15 +814,21 @@ int tc_server_ac_rm_prod( unsigned int topic_id, unsigned int node_id )
 
 	//Update producer node load
 	node->uplink_load = node->uplink_load - topic->topic_load;
+	node->uplink_burst = node->uplink_burst - topic->topic_burst;
 
 	//Update the bandwidth of all consumer nodes of this topic
 	//NOTE1: When one node is producer and consumer of the same topic, when it produces it produces only for the other consumers (no loopback)
 	for ( cons_entry = topic->cons_list; cons_entry ; cons_entry = cons_entry->next  ){
 		if ( cons_entry->node != node ){
 			cons_entry->node->downlink_load = cons_entry->node->downlink_load - topic->topic_load;
+			cons_entry->node->downlink_burst = cons_entry->node->downlink_burst - topic->topic_burst;
 		}
 	}
 
+	//Consumers now receive from one producer less -- Update their ingress policers
+	if ( tc_server_management_police_update( topic ) )
+		fprintf(stderr,"tc_server_ac_rm_prod() : ERROR UPDATING TOPIC ID %u POLICERS ON SOME OR ALL CONSUMERS\n",topic_id);
+
 	DEBUG_MSG_SERVER_AC("tc_server_ac_rm_prod() Removed Node Id %u as producer of Topic Id %u\n",node_id,topic_id);
 
 	return ERR_OK;
@@ -581,7 +841,7 @@ int tc_server_ac_add_cons( unsigned int topic_id, unsigned int node_id )
 	int ret,n_prod = 0;
 	NODE_ENTRY *node = NULL; 
 	TOPIC_ENTRY *topic = NULL;
-	unsigned int req_load = 0;
+	unsigned long long req_load = 0, req_burst = 0;
 	
 	if ( !init ){
 		fprintf(stderr,"tc_server_ac_add_cons() : MODULE IS NOT INITIALIZED\n");
@@ -618,16 +878,25 @@ int tc_server_ac_add_cons( unsigned int topic_id, unsigned int node_id )
 		//Producer for the same topic -> ignore self load
 		n_prod--;				
 	}
-	req_load = n_prod * topic->topic_load; 
+	req_load = (unsigned long long)n_prod * topic->topic_load;
+	req_burst = (unsigned long long)n_prod * topic->topic_burst;
 
-	DEBUG_MSG_SERVER_AC("tc_server_ac_add_cons() Node Id %u Downlink load %u [bps] Requesting load %u [bps]\n",node->node_id,node->downlink_load,req_load);
+	DEBUG_MSG_SERVER_AC("tc_server_ac_add_cons() Node Id %u Downlink load %llu [bps] Requesting load %llu [bps]\n",node->node_id,node->downlink_load,req_load);
 
 	//Check if all nodes have enough bandwidth
-	if ( (req_load > 0) && (ret = tc_server_ac_check_bw( topic, NULL, node, req_load )) ){
+	if ( (req_load > 0) && (ret = tc_server_ac_check_bw( topic, node, NULL, req_load, req_burst )) ){
 		fprintf(stderr,"tc_server_ac_add_cons() : NOT ENOUGH BANDWIDTH ON SOME OR ALL NODES FOR TOPIC ID %u CHANGES\n",topic_id);
 		return ret;
 	}	
 
+#if ENABLE_AC_DELAY_BOUND
+	//Check if every topic deadline is still met with the new consumer
+	if ( (ret = tc_server_ac_check_delay( topic, node, NULL, req_burst, topic->channel_period*1000 )) ){
+		fprintf(stderr,"tc_server_ac_add_cons() : DEADLINES CAN'T BE MET FOR TOPIC ID %u CHANGES\n",topic_id);
+		return ret;
+	}
+#endif
+
 	//Enough bandwidth to add consumer -> Add consumer to list
 	if ( tc_server_db_topic_add_cons_node( topic, node ) ){
 		fprintf(stderr,"tc_server_ac_add_cons() : ERROR REGISTERING NODE ID %u AS CONSUMER OF TOPIC ID %u\n",node_id,topic_id);
@@ -636,9 +905,19 @@ int tc_server_ac_add_cons( unsigned int topic_id, unsigned int node_id )
 
 	//Update node load
 	node->downlink_load = node->downlink_load + req_load;
+	node->downlink_burst = node->downlink_burst + req_burst;
+
+	//Enforce the accounted downlink load on the consumer node
+	if ( tc_server_management_police_req( node, topic ) ){
+		fprintf(stderr,"tc_server_ac_add_cons() : ERROR SETTING TOPIC ID %u POLICER ON NODE ID %u\n",topic_id,node_id);
+		node->downlink_load = node->downlink_load - req_load;
+		node->downlink_burst = node->downlink_burst - req_burst;
+		tc_server_db_topic_rm_cons_node( topic, node );
+		return ERR_NODE_CONS_RESERV;
+	}
 
 	DEBUG_MSG_SERVER_AC("tc_server_ac_add_cons() Added Node Id %u as consumer of Topic Id %u\n",node_id,topic_id);
-	DEBUG_MSG_SERVER_AC("tc_server_ac_add_cons() Node Id %u Uplink load %u [bps] Downlink load %u [bps]\n",node->node_id,node->uplink_load,node->downlink_load);
+	DEBUG_MSG_SERVER_AC("tc_server_ac_add_cons() Node Id %u Uplink load %llu [bps] Downlink load %llu [bps]\n",node->node_id,node->uplink_load,node->downlink_load);
 
 	return ERR_OK;
 }
@@ -650,7 +929,7 @@ int tc_server_ac_rm_cons( unsigned int topic_id, unsigned int node_id )
 	int n_prod;
 	NODE_ENTRY *node = NULL; 
 	TOPIC_ENTRY *topic = NULL;
-	unsigned int req_load = 0;
+	unsigned long long req_load = 0, req_burst = 0;
 	NODE_BIND_ENTRY *prod_entry = NULL;
 
 	if ( !init ){
@@ -693,10 +972,16 @@ int tc_server_ac_rm_cons( unsigned int topic_id, unsigned int node_id )
 		if ( prod_entry->node != node )
 			n_prod++;
 	}
-	req_load = n_prod * topic->topic_load;
+	req_load = (unsigned long long)n_prod * topic->topic_load;
+	req_burst = (unsigned long long)n_prod * topic->topic_burst;
 
 	//Update node load
 	node->downlink_load = node->downlink_load - req_load;
+	node->downlink_burst = node->downlink_burst - req_burst;
+
+	//Remove consumer node ingress policer
+	if ( tc_server_management_police_req( node, topic ) )
+		fprintf(stderr,"tc_server_ac_rm_cons() : ERROR REMOVING TOPIC ID %u POLICER ON NODE ID %u\n",topic_id,node_id);
 
 	DEBUG_MSG_SERVER_AC("tc_server_ac_rm_cons() Removed Node Id %u as consumer of Topic Id %u\n",node_id,topic_id);
 
@@ -971,7 +1256,7 @@ int tc_server_ac_check_topic_unbind( unsigned int topic_id )
 	return ERR_OK;
 }
 
-static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NODE_ENTRY *prod_node, unsigned int req_load )
+static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NODE_ENTRY *prod_node, unsigned long long req_load, unsigned long long req_burst )
 {
 	DEBUG_MSG_SERVER_AC("tc_server_ac_check_bw() ...\n");
 
@@ -984,19 +1269,27 @@ static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NOD
 	}
 
 	assert( topic );
-	assert( req_load > 0 );	
+	assert( req_load > 0 || req_burst > 0 );	
 	assert( !(cons_node && prod_node) );//Can't add one producer and consumer in the same call! One must be NULL
 
+	//Each topic is modeled as a token bucket (rate = topic load, burst = one full size message)
+	//A link is admissible if the sum of rates fits the node usable bandwidth and the sum of bursts fits the node usable burst
+
 	if ( !cons_node && !prod_node ){
 		//Request is due to topic properties changes
 
 		//Check all producers bandwidth
 		for ( prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next ){
 
-			if ( prod_entry->node->uplink_load + req_load > MAX_USABLE_BW ){
+			if ( prod_entry->node->uplink_load + req_load > prod_entry->node->usable_bw ){
 				fprintf(stderr,"tc_server_ac_check_bw() : NOT ENOUGH BANDWIDTH FOR TOPIC ID %u ON PROD NODE ID %u\n",topic->topic_id,prod_entry->node->node_id);
 				return ERR_NODE_PROD_BW;
 			}
+
+			if ( prod_entry->node->uplink_burst + req_burst > prod_entry->node->usable_burst ){
+				fprintf(stderr,"tc_server_ac_check_bw() : NOT ENOUGH BURST CAPACITY FOR TOPIC ID %u ON PROD NODE ID %u\n",topic->topic_id,prod_entry->node->node_id);
+				return ERR_NODE_PROD_BURST;
+			}
 		}
 
 		//Check all consumers bandwidth
@@ -1009,10 +1302,15 @@ static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NOD
 					n_prod++;
 			}
 	
-			if ( cons_entry->node->downlink_load + (req_load * n_prod) > MAX_USABLE_BW ){
+			if ( cons_entry->node->downlink_load + (req_load * n_prod) > cons_entry->node->usable_bw ){
 				fprintf(stderr,"tc_server_ac_check_bw() : NOT ENOUGH BANDWIDTH FOR TOPIC ID %u ON CONS NODE ID %u\n",topic->topic_id,cons_entry->node->node_id);
 				return ERR_NODE_CONS_BW;
 			}
+
+			if ( cons_entry->node->downlink_burst + (req_burst * n_prod) > cons_entry->node->usable_burst ){
+				fprintf(stderr,"tc_server_ac_check_bw() : NOT ENOUGH BURST CAPACITY FOR TOPIC ID %u ON CONS NODE ID %u\n",topic->topic_id,cons_entry->node->node_id);
+				return ERR_NODE_CONS_BURST;
+			}
 		}
 
 		DEBUG_MSG_SERVER_AC("tc_server_ac_check_bw() There is enough bandwidth for Topid ID %u properties changes\n",topic->topic_id);
@@ -1022,11 +1320,16 @@ static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NOD
 	if ( cons_node ){
 		//Request is due to the registration of a consumer node
 
-		if ( cons_node->downlink_load + req_load > MAX_USABLE_BW ){
+		if ( cons_node->downlink_load + req_load > cons_node->usable_bw ){
 			fprintf(stderr,"tc_server_ac_check_bw() : NOT ENOUGH DOWNLINK BANDWIDTH ON NODE ID %u FOR TOPIC ID %u\n",cons_node->node_id,topic->topic_id);
 			return ERR_NODE_CONS_BW;
 		}
 
+		if ( cons_node->downlink_burst + req_burst > cons_node->usable_burst ){
+			fprintf(stderr,"tc_server_ac_check_bw() : NOT ENOUGH DOWNLINK BURST CAPACITY ON NODE ID %u FOR TOPIC ID %u\n",cons_node->node_id,topic->topic_id);
+			return ERR_NODE_CONS_BURST;
+		}
+
 		//No need to check bandwidth on producers because we use multicast
 
 		DEBUG_MSG_SERVER_AC("tc_server_ac_check_bw() There is enough bandwidth to add a consumer of Topid ID %u\n",topic->topic_id);
@@ -1035,10 +1338,15 @@ static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NOD
 
 	if ( prod_node ){
 		//Request is due to the registration of a producer node
-		if ( prod_node->uplink_load + req_load > MAX_USABLE_BW ){
+		if ( prod_node->uplink_load + req_load > prod_node->usable_bw ){
 			fprintf(stderr,"tc_server_ac_check_bw() : NOT ENOUGH UPLINK BANDWIDTH ON NODE ID %u FOR TOPIC ID %u\n",prod_node->node_id,topic->topic_id);
 			return ERR_NODE_PROD_BW;
 		}
+
+		if ( prod_node->uplink_burst + req_burst > prod_node->usable_burst ){
+			fprintf(stderr,"tc_server_ac_check_bw() : NOT ENOUGH UPLINK BURST CAPACITY ON NODE ID %u FOR TOPIC ID %u\n",prod_node->node_id,topic->topic_id);
+			return ERR_NODE_PROD_BURST;
+		}
 	
 		//Check if all consumers of this topic have enough downlink bandwidth
 		//NOTE : When one node is producer and consumer of the same topic, when it produces it produces only for the other consumers (no loopback)
@@ -1047,10 +1355,15 @@ static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NOD
 			//Check only for consumer nodes other than ourselves
 			if ( cons_entry->node == prod_node ) continue;
 
-			if ( cons_entry->node->downlink_load + req_load > MAX_USABLE_BW ){
+			if ( cons_entry->node->downlink_load + req_load > cons_entry->node->usable_bw ){
 				DEBUG_MSG_SERVER_AC("tc_server_ac_check_bw() : NOT ENOUGH DOWNLINK BANDWIDTH ON NODE ID %u\n",cons_entry->node->node_id);
 				return ERR_NODE_CONS_BW;
 			} 
+
+			if ( cons_entry->node->downlink_burst + req_burst > cons_entry->node->usable_burst ){
+				DEBUG_MSG_SERVER_AC("tc_server_ac_check_bw() : NOT ENOUGH DOWNLINK BURST CAPACITY ON NODE ID %u\n",cons_entry->node->node_id);
+				return ERR_NODE_CONS_BURST;
+			} 
 		}
 
 		DEBUG_MSG_SERVER_AC("tc_server_ac_check_bw() There is enough bandwidth to add a producer of Topid ID %u\n",topic->topic_id);
@@ -1059,3 +1372,199 @@ static int tc_server_ac_check_bw( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NOD
 
 	return ERR_OK;
 }
+
+#if ENABLE_AC_DELAY_BOUND
+static int tc_server_ac_check_delay( TOPIC_ENTRY *topic, NODE_ENTRY *cons_node, NODE_ENTRY *prod_node, int req_burst, unsigned int deadline )
+{
+	DEBUG_MSG_SERVER_AC("tc_server_ac_check_delay() ...\n");
+
+	int n_prod, ret = ERR_OK;
+	unsigned int bound;
+	TOPIC_ENTRY *topic_entry = NULL;
+	NODE_BIND_ENTRY *cons_entry = NULL, *prod_entry = NULL;
+
+	assert( topic );
+	assert( !(cons_node && prod_node) );//Can't add one producer and consumer in the same call! One must be NULL
+
+	//Temporarily apply the requested bursts to the involved links (same accounting as the loads)
+	if ( !cons_node && !prod_node ){
+		for ( prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next )
+			prod_entry->node->uplink_burst += req_burst;
+
+		for ( cons_entry = topic->cons_list; cons_entry; cons_entry = cons_entry->next ){
+			for( n_prod = 0, prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next ){
+				if ( cons_entry->node != prod_entry->node )
+					n_prod++;
+			}
+			cons_entry->node->downlink_burst += req_burst * n_prod;
+		}
+	}else if ( cons_node ){
+		cons_node->downlink_burst += req_burst;
+	}else{
+		prod_node->uplink_burst += req_burst;
+		for ( cons_entry = topic->cons_list; cons_entry; cons_entry = cons_entry->next ){
+			if ( cons_entry->node != prod_node )
+				cons_entry->node->downlink_burst += req_burst;
+		}
+	}
+
+	//Adding bursts to a link delays every topic crossing it -- check all topic deadlines
+	for ( topic_entry = tc_server_db_topic_get_first(); topic_entry; topic_entry = topic_entry->next ){
+
+		if ( topic_entry == topic ){
+			bound = tc_server_ac_topic_delay( topic_entry, cons_node, prod_node );
+			if ( bound > deadline ){
+				fprintf(stderr,"tc_server_ac_check_delay() : TOPIC ID %u DELAY BOUND %u [us] EXCEEDS DEADLINE %u [us]\n",topic_entry->topic_id,bound,deadline);
+				ret = ERR_TOPIC_DEADLINE;
+				break;
+			}
+		}else{
+			bound = tc_server_ac_topic_delay( topic_entry, NULL, NULL );
+			if ( bound > topic_entry->channel_period*1000 ){
+				fprintf(stderr,"tc_server_ac_check_delay() : TOPIC ID %u DELAY BOUND %u [us] WOULD EXCEED DEADLINE %u [us]\n",topic_entry->topic_id,bound,topic_entry->channel_period*1000);
+				ret = ERR_TOPIC_DEADLINE;
+				break;
+			}
+		}
+	}
+
+	//Revert the requested bursts
+	if ( !cons_node && !prod_node ){
+		for ( prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next )
+			prod_entry->node->uplink_burst -= req_burst;
+
+		for ( cons_entry = topic->cons_list; cons_entry; cons_entry = cons_entry->next ){
+			for( n_prod = 0, prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next ){
+				if ( cons_entry->node != prod_entry->node )
+					n_prod++;
+			}
+			cons_entry->node->downlink_burst -= req_burst * n_prod;
+		}
+	}else if ( cons_node ){
+		cons_node->downlink_burst -= req_burst;
+	}else{
+		prod_node->uplink_burst -= req_burst;
+		for ( cons_entry = topic->cons_list; cons_entry; cons_entry = cons_entry->next ){
+			if ( cons_entry->node != prod_node )
+				cons_entry->node->downlink_burst -= req_burst;
+		}
+	}
+
+	DEBUG_MSG_SERVER_AC("tc_server_ac_check_delay() Topic Id %u deadlines check returned %d\n",topic->topic_id,ret);
+
+	return ret;
+}
+#endif
+
+static unsigned int tc_server_ac_link_delay( unsigned long long burst, unsigned long long usable_bw )
+{
+	//Aggregate of token bucket flows served at rate C (with the sum of rates <= C) : worst-case delay <= sum(bursts)/C
+	if ( !usable_bw )
+		return 0;
+
+	return (unsigned int)( (burst*8*1000000)/usable_bw ) + AC_HOP_LATENCY;
+}
+
+static unsigned int tc_server_ac_topic_load( TOPIC_ENTRY *topic, unsigned int channel_size, unsigned int channel_period )
+{
+	unsigned long long load;
+
+	//FEC parity fragments on the wire, plus the share reserved for retransmissions of reliable topics
+	load = (unsigned long long)tc_fec_wire_size( channel_size, topic->fec_k, topic->fec_m ) * 8000 / channel_period * RESERV_SLACK_MULTIPLIER;
+
+	return (unsigned int)( load * (100 + topic->retx_share) / 100 );
+}
+
+static unsigned int tc_server_ac_topic_burst( TOPIC_ENTRY *topic, unsigned int channel_size )
+{
+	unsigned long long burst;
+
+	burst = (unsigned long long)tc_fec_wire_size( channel_size, topic->fec_k, topic->fec_m ) * RESERV_SLACK_MULTIPLIER;
+
+	return (unsigned int)( burst * (100 + topic->retx_share) / 100 );
+}
+
+static unsigned int tc_server_ac_topic_delay( TOPIC_ENTRY *topic, NODE_ENTRY *extra_cons, NODE_ENTRY *extra_prod )
+{
+	unsigned int delay, max_up = 0, max_down = 0;
+	NODE_BIND_ENTRY *cons_entry = NULL, *prod_entry = NULL;
+
+	assert( topic );
+
+	//Worst producer uplink
+	for ( prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next ){
+		if ( (delay = tc_server_ac_link_delay( prod_entry->node->uplink_burst, prod_entry->node->usable_bw )) > max_up )
+			max_up = delay;
+	}
+	if ( extra_prod && (delay = tc_server_ac_link_delay( extra_prod->uplink_burst, extra_prod->usable_bw )) > max_up )
+		max_up = delay;
+
+	//Worst consumer downlink
+	for ( cons_entry = topic->cons_list; cons_entry; cons_entry = cons_entry->next ){
+		if ( (delay = tc_server_ac_link_delay( cons_entry->node->downlink_burst, cons_entry->node->usable_bw )) > max_down )
+			max_down = delay;
+	}
+	if ( extra_cons && (delay = tc_server_ac_link_delay( extra_cons->downlink_burst, extra_cons->usable_bw )) > max_down )
+		max_down = delay;
+
+	return max_up + max_down;
+}
+
+#if ENABLE_ADAPTIVE_RESERV
+static int tc_server_ac_set_topic_load( TOPIC_ENTRY *topic, unsigned int new_load )
+{
+	DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_load() Topic Id %u New load %u [bps] ...\n",topic->topic_id,new_load);
+
+	int n_prod, ret;
+	int delta_load;
+	NODE_BIND_ENTRY *cons_entry = NULL, *prod_entry = NULL;
+
+	assert( topic );
+	assert( new_load );
+
+	delta_load = new_load - topic->topic_load;
+
+	//Growing a reservation is a new request -- check bandwidth
+	if ( (delta_load > 0) && (ret = tc_server_ac_check_bw( topic, NULL, NULL, delta_load, 0 )) ){
+		DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_load() Not enough bandwidth to grow topic id %u reservation\n",topic->topic_id);
+		return ret;
+	}
+
+	//Update producers reservations
+	for ( prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next ){
+		if ( tc_server_management_reserv_req( prod_entry->node, topic, TC_MODIFY, new_load ) ){
+			fprintf(stderr,"tc_server_ac_set_topic_load() : ERROR MODIFYING TOPIC ID %u RESERVATION ON NODE ID %u\n",topic->topic_id,prod_entry->node->node_id);
+			//Roll back already modified producers
+			for ( prod_entry = prod_entry->previous; prod_entry; prod_entry = prod_entry->previous )
+				tc_server_management_reserv_req( prod_entry->node, topic, TC_MODIFY, topic->topic_load );
+			return ERR_RESERV_SET;
+		}
+	}
+
+	//Update producers bandwidth
+	for ( prod_entry = topic->prod_list; prod_entry ; prod_entry = prod_entry->next  )
+		prod_entry->node->uplink_load = prod_entry->node->uplink_load + delta_load;
+
+	//NOTE : When one node is producer and consumer of the same topic, when it produces it produces only for the other consumers (no loopback)
+	//Update consumers bandwidth
+	for ( cons_entry = topic->cons_list; cons_entry ; cons_entry = cons_entry->next  ){
+
+		//Get number of valid producers for this consumer
+		for( n_prod = 0, prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next ){
+			if ( cons_entry->node != prod_entry->node )
+				n_prod++;
+		}
+		cons_entry->node->downlink_load = cons_entry->node->downlink_load + (delta_load * n_prod);
+	}
+
+	topic->topic_load = new_load;
+
+	//Update consumers ingress policers to the new topic load
+	if ( tc_server_management_police_update( topic ) )
+		fprintf(stderr,"tc_server_ac_set_topic_load() : ERROR UPDATING TOPIC ID %u POLICERS ON SOME OR ALL CONSUMERS\n",topic->topic_id);
+
+	DEBUG_MSG_SERVER_AC("tc_server_ac_set_topic_load() Topic Id %u reservation set to %u [bps]\n",topic->topic_id,new_load);
+
+	return ERR_OK;
+}
+#endif
@@ -59,10 +59,14 @@ int tc_server_ac_close( void );
 /**	
 *	@brief Registers a node in the network
 *
-*	Checks if node is already registered. If not creates a new entry in the database and assigns an ID for the node	
+*	Checks if node is already registered. If not creates a new entry in the database and assigns an ID for the node.
+*	The node usable bandwidth is computed from its NIC bandwidth minus the background and control shares
 *
 *	@param[in] node_id		The ID requested by the node to be registered with. If 0 server assigns a random ID. Must be equal or greater than 0
 *	@param[in] node_address		The nodes network address (clients top module socket address). Must not be a NULL pointer
+*	@param[in] link_bw		The nodes NIC bandwidth (in mbps). If 0 the default MAX_USABLE_BW is used
+*	@param[in] background_share	The share (in %) of the NIC bandwidth reserved for background traffic
+*	@param[in] control_share	The share (in %) of the NIC bandwidth reserved for control traffic. The sum of both shares must be lower than 100
 *	@param[out] ret_node_id		The assigned ID to the node. Must not be a NULL pointer
 *
 *	@pre				assert( node_address ); 
@@ -74,7 +78,7 @@ int tc_server_ac_close( void );
 *	@todo				In this version it is only supported the registration of one local client. Redo the function
 *					so it is possible to register more than one (don't forget about the traffic control reservations!!) 
 */
-int tc_server_ac_add_node( unsigned int node_id, NET_ADDR *node_address, unsigned int *ret_node_id );
+int tc_server_ac_add_node( unsigned int node_id, NET_ADDR *node_address, unsigned int link_bw, unsigned int background_share, unsigned int control_share, unsigned int *ret_node_id );
 
 /**	
 *	@brief Removes a node from the network
@@ -94,11 +98,15 @@ int tc_server_ac_rm_node( unsigned int node_id );
 *	@brief Registers a new topic in the network
 *
 *	Checks if topic is already registered. If it is already registered but with different properties the request is refused otherwise it is accepted.
-*	If it is not registered a new entry is created and a network address is assigned to the topic	
+*	If it is not registered a new entry is created and a network address is assigned to the topic. The topic load and burst include the FEC parity
+*	fragments (see tc_fec_wire_size) and the share reserved for the retransmissions of reliable topics
 *
 *	@param[in] topic_id		The ID requested by the node to be registered with. If 0 server assigns a random ID. Must be equal or greater than 0
 *	@param[in] channel_size		The nodes network address (clients top module socket address). Must not be a NULL pointer
 *	@param[in] channel_period	The assigned ID to the node. Must not be a NULL pointer
+*	@param[in] fec_k		The FEC block data fragments. If 0 the topic data is not FEC protected
+*	@param[in] fec_m		The FEC block parity fragments. Must be greater than 0 and fec_k + fec_m <= FEC_MAX_BLOCK if fec_k is set
+*	@param[in] retx_share		The topic load (in %) reserved on top for the retransmission of lost fragments. If 0 the topic is not reliable. Must be at most 100
 *
 *	@pre				assert( topic_id ); 
 *	@pre				assert( channel_size ); 
@@ -110,13 +118,13 @@ int tc_server_ac_rm_node( unsigned int node_id );
 *	@todo				In this version it is supported a high but limited number of addresses for the topics. Find a better
 *					way to generate addresses or an address pool for store and reuse of the freed addresses
 */
-int tc_server_ac_add_topic( unsigned int topic_id, unsigned int channel_size, unsigned int channel_period );
+int tc_server_ac_add_topic( unsigned int topic_id, unsigned int channel_size, unsigned int channel_period, unsigned int fec_k, unsigned int fec_m, unsigned int retx_share );
 
 /**	
 *	@brief Updates the topic properties
 *
 *	Calculates the new load of the topic after the requested changes and checks if every node has enough bandwidth. If they have it calls
-*	the management module to update the reservations and databases of all the nodes otherwise the request is refused
+*	the management module to update the reservations and databases of all the nodes otherwise the request is refused. The topic FEC parameters are kept
 *
 *	@param[in] topic_id		The ID of the topic to update. Must be greater than 0
 *	@param[in] channel_size		The new maximum size (in bytes) for the topic messages. Must be greater than 0
@@ -164,6 +172,76 @@ int tc_server_ac_rm_topic( unsigned int topic_id );
 */
 int tc_server_ac_get_topic_prop( unsigned int topic_id, unsigned int *ret_load, unsigned int *ret_size, unsigned int *ret_period, NET_ADDR *ret_topic_addr );
 
+/**	
+*	@brief Retrieves the topic reliability parameters (FEC block and retransmissions share)
+*
+*	@param[in] topic_id		The ID of the topic. Must be greater than 0
+*	@param[out] ret_fec_k		The buffer to store the FEC block data fragments (0 -> no FEC). Must not be a NULL pointer
+*	@param[out] ret_fec_m		The buffer to store the FEC block parity fragments. Must not be a NULL pointer
+*	@param[out] ret_retx_share	The buffer to store the topic load share (in %) reserved for retransmissions (0 -> not reliable). Must not be a NULL pointer
+*
+*	@pre				assert( topic_id );
+*	@pre				assert( ret_fec_k );
+*	@pre				assert( ret_fec_m );
+*	@pre				assert( ret_retx_share );
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0)
+*/
+int tc_server_ac_get_topic_reliability( unsigned int topic_id, unsigned int *ret_fec_k, unsigned int *ret_fec_m, unsigned int *ret_retx_share );
+
+/**	
+*	@brief Retrieves the topic worst-case delay bound
+*
+*	Computes the topic delay bound from the current producers and consumers links.
+*	Each link is an aggregate of token bucket flows served at the node usable bandwidth, so its worst-case delay is the sum of
+*	the bursts it carries divided by its bandwidth (plus AC_HOP_LATENCY). The topic bound is the worst producer uplink plus the worst consumer downlink
+*
+*	@param[in] topic_id		The ID of the topic. Must be greater than 0
+*	@param[out] ret_delay_bound	The buffer to store the topic delay bound (in us). Must not be a NULL pointer
+*
+*	@pre				assert( topic_id );
+*	@pre				assert( ret_delay_bound );
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0)
+*/
+int tc_server_ac_get_topic_delay( unsigned int topic_id, unsigned int *ret_delay_bound );
+
+/**	
+*	@brief Updates the topic measured load reported by a producer node
+*
+*	Stores the load measured on the producer node reservation. If adaptive reservations are enabled (ENABLE_ADAPTIVE_RESERV) the topic reservation is
+*	marked to shrink after ADAPT_SHRINK_COUNT consecutive under-used reports, and to grow back to the topic nominal load as soon as it saturates.
+*	No node is contacted here -- the new load is reserved by tc_server_ac_apply_topic_usage
+*
+*	@param[in] topic_id		The ID of the topic. Must be greater than 0
+*	@param[in] node_id		The ID of the reporting node. Must be greater than 0
+*	@param[in] measured_load	The measured load (in bps)
+*
+*	@pre				assert( topic_id );
+*	@pre				assert( node_id );
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0)
+*
+*	@note				Must be called with the database locked
+*/
+int tc_server_ac_set_topic_usage( unsigned int topic_id, unsigned int node_id, unsigned int measured_load );
+
+/**	
+*	@brief Reserves the topic loads decided by tc_server_ac_set_topic_usage
+*
+*	Changes the nodes reservations and policers of every topic with a pending load. A grown reservation is only applied if there is enough
+*	bandwidth on the topic nodes. The released bandwidth becomes available to new requests
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0)
+*
+*	@note				Must be called with the database locked. Waits for the nodes answers, so it must not run on the heartbeats thread
+*/
+int tc_server_ac_apply_topic_usage( void );
+
 /**	
 *	@brief Registers a node as a topic producer
 *
@@ -158,8 +158,11 @@ int tc_server_db_node_print( void )
 		printf("entry #%p\n",db_ptr);
 		printf("node_id %u\n",db_ptr->node_id);
 		printf("heartbeat %d\n",db_ptr->heartbeat);
-		printf("uplink load %u\n",db_ptr->uplink_load);
-		printf("downlink load %u\n",db_ptr->downlink_load);
+		printf("usable bw %llu burst %u\n",db_ptr->usable_bw,db_ptr->usable_burst);
+		printf("uplink load %llu\n",db_ptr->uplink_load);
+		printf("downlink load %llu\n",db_ptr->downlink_load);
+		printf("uplink burst %u\n",db_ptr->uplink_burst);
+		printf("downlink burst %u\n",db_ptr->downlink_burst);
 		
 		printf("\nnext #%p\n",db_ptr->next);
 		printf("previous #%p\n",db_ptr->previous);
@@ -185,8 +188,11 @@ int tc_server_db_node_print_entry( NODE_ENTRY *entry )
 	printf("\nentry #%p\n",entry);
 	printf("node_id %u\n",entry->node_id);
 	printf("heartbeat %d\n",entry->heartbeat);
-	printf("uplink load %u\n",entry->uplink_load);
-	printf("downlink load %u\n",entry->downlink_load);
+	printf("usable bw %llu burst %u\n",entry->usable_bw,entry->usable_burst);
+	printf("uplink load %llu\n",entry->uplink_load);
+	printf("downlink load %llu\n",entry->downlink_load);
+	printf("uplink burst %u\n",entry->uplink_burst);
+	printf("downlink burst %u\n",entry->downlink_burst);
 	
 	printf("\nnext #%p\n",entry->next);
 	printf("previous #%p\n",entry->previous);
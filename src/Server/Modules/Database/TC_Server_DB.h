@@ -45,8 +45,14 @@ typedef struct node_entry{
 
 	int heartbeat;			/**< The heartbeat counter */
 
-	unsigned int uplink_load;	/**< The nodes uplink load (in bps) */
-	unsigned int downlink_load;	/**< The nodes downlink load (in bps) */
+	unsigned long long usable_bw;	/**< The nodes usable bandwidth for topics (in bps) -- Same for uplink and downlink (full-duplex NIC) */
+	unsigned int usable_burst;	/**< The nodes maximum sum of topic bursts (in bytes) */
+
+	unsigned long long uplink_load;	/**< The nodes uplink load (in bps) */
+	unsigned long long downlink_load;/**< The nodes downlink load (in bps) */
+
+	unsigned int uplink_burst;	/**< The sum of the topic bursts on the nodes uplink (in bytes) */
+	unsigned int downlink_burst;	/**< The sum of the topic bursts on the nodes downlink (in bytes) */
 		
 	struct node_entry *next;	/**< The next linked list nodes entry address */
 	struct node_entry *previous;	/**< The next linked list nodes entry address */
@@ -73,6 +79,8 @@ typedef struct node_bind_entry{
 						/**<	\li Value = 1 -> Node bound */
 						/**<	\li Value = 0 -> Node not bound */
 
+	unsigned int measured_load;		/**< The last topic load (in bps) measured and reported by the node (producers only) */
+
 	struct node_bind_entry *next;		/**< The next linked list nodes bind entry address */
 	struct node_bind_entry *previous;	/**< The next linked list nodes bind entry address */
 
@@ -85,10 +93,17 @@ typedef struct topic_entry{
 
 	unsigned int topic_id;		/**< The ID of the topic */
 	unsigned int topic_load;	/**< The topic load (in bps) */
+	unsigned int topic_burst;	/**< The topic token bucket burst size (in bytes) -- One full size message */
+	unsigned int nominal_load;	/**< The topic contracted load (in bps). Adaptive reservations may set a lower topic load */
+	unsigned int under_use_count;	/**< The number of consecutive under-used load reports (adaptive reservations hysteresis) */
+	unsigned int pending_load;	/**< The topic load (in bps) decided from the reported usage and not yet reserved (0 -> no change pending) */
 
 	NET_ADDR address;		/**< The topics network address */
 	unsigned int channel_size;	/**< Maximum size (in bytes) of the topic messages */
 	unsigned int channel_period;	/**< Minimum time inverval (in ms) between consecutive topic messages */
+	unsigned int fec_k;		/**< FEC block data fragments (0 -> no FEC) */
+	unsigned int fec_m;		/**< FEC block parity fragments */
+	unsigned int retx_share;	/**< Topic load share (in %) reserved for retransmissions (0 -> not reliable) */
 
 	NODE_BIND_ENTRY *prod_list;	/**< The list of producer node entries for this topic*/
 	NODE_BIND_ENTRY *cons_list;	/**< The list of consumer node entries for this topic*/
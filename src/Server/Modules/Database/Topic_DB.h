@@ -237,6 +237,7 @@ int tc_server_db_topic_add_prod_node( TOPIC_ENTRY *topic, NODE_ENTRY *node )
 	//Fill entry
 	entry->node = node;
 	entry->is_bound = 0;
+	entry->measured_load = 0;
 	entry->req_bind = 0;
 	entry->next = entry->previous = NULL;
 
@@ -326,6 +327,7 @@ int tc_server_db_topic_add_cons_node( TOPIC_ENTRY *topic, NODE_ENTRY *node )
 	//Fill entry
 	entry->node = node;
 	entry->is_bound = 0;
+	entry->measured_load = 0;
 	entry->req_bind = 0;
 	entry->next = entry->previous = NULL;
 
@@ -445,6 +447,8 @@ int tc_server_db_topic_print( void )
 		printf("topic_id %u\n",db_ptr->topic_id);
 		printf("topic size %u\n",db_ptr->channel_size);
 		printf("topic period %u\n",db_ptr->channel_period);
+		printf("topic fec %u+%u retransmissions %u%%\n",db_ptr->fec_k,db_ptr->fec_m,db_ptr->retx_share);
+		printf("topic load %u (nominal %u) burst %u\n",db_ptr->topic_load,db_ptr->nominal_load,db_ptr->topic_burst);
 		printf("Producer Nodes\n");
 		for( entry = db_ptr->prod_list; entry ; entry = entry->next ){
 			printf("%p r %d b %d\t",entry->node,entry->req_bind,entry->is_bound);
@@ -477,6 +481,8 @@ int tc_server_db_topic_print_entry( TOPIC_ENTRY *entry )
 	printf("topic_id %u\n",entry->topic_id);
 	printf("topic size %u\n",entry->channel_size);
 	printf("topic period %u\n",entry->channel_period);
+	printf("topic fec %u+%u retransmissions %u%%\n",entry->fec_k,entry->fec_m,entry->retx_share);
+	printf("topic load %u (nominal %u) burst %u\n",entry->topic_load,entry->nominal_load,entry->topic_burst);
 	printf("Producer Nodes\n");
 	for( aux = entry->prod_list; aux ; aux = aux->next ){
 		printf("%p r %d b %d\t",aux->node,aux->req_bind,aux->is_bound);
@@ -35,9 +35,12 @@
 
 #include "Sockets.h"
 #include "TC_Utils.h"
+#include "TC_Probes.h"
+#include "TC_Log.h"
 #include "TC_Config.h"
 #include "TC_Server_DB.h"
 #include "TC_Data_Types.h"
+#include "TC_Server_Metrics.h"
 #include "TC_Error_Types.h"
 #include "TC_Server_Management.h"
 
@@ -69,6 +72,12 @@ static int tc_server_management_close_ans_sock( void );
 //Sends topic related requests to nodes (binds,unbinds,del topic, modify topic properties)
 static int topic_multi_op_request( NODE_BIND_ENTRY *node_list[], unsigned int n_nodes, TOPIC_ENTRY *topic, unsigned char op_type, NODE_BIND_ENTRY *ret_err_list[], unsigned int *ret_n_err );
 
+//Sends a reservation related request (reservation or policer) to one client and waits for the answer
+static int tc_request_op( NODE_ENTRY *node, TOPIC_ENTRY *topic, unsigned char tc_request, unsigned int req_load, unsigned int req_burst );
+
+//Management requests latency histograms (request sent -> all answers received or timeout)
+static TC_HIST mng_hist[N_OP_TYPES];
+
 int tc_server_management_init( NET_ADDR *server_remote )
 {
 	DEBUG_MSG_SERVER_MNG("tc_server_management_init() ...\n");
@@ -132,14 +141,24 @@ int tc_server_management_close( void )
 	return ERR_OK;
 }
 
+int tc_server_management_latency_print( void )
+{
+	DEBUG_MSG_SERVER_MNG("tc_server_management_latency_print() ...\n");
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_management_latency_print() : MODULE ISNT RUNNING\n");
+		return ERR_S_NOT_INIT;
+	}
+
+	tc_hist_op_print( "tc_server_management_latency_print() : Management requests latency (request sent -> answers received)", mng_hist );
+
+	return ERR_OK;
+}
+
 int tc_server_management_reserv_req( NODE_ENTRY *node, TOPIC_ENTRY *topic, unsigned char tc_request, unsigned int req_load )
 {
 	DEBUG_MSG_SERVER_MNG("tc_server_management_reserv_req() ...\n");
 
-	NET_ADDR client;
-	NET_MSG request;
-	NET_MSG answer;
-
 	if ( !init ){
 		fprintf(stderr,"tc_server_management_reserv_req() : MODULE ISNT RUNNING\n");
 		return ERR_S_NOT_INIT;
@@ -149,6 +168,87 @@ int tc_server_management_reserv_req( NODE_ENTRY *node, TOPIC_ENTRY *topic, unsig
 	assert( topic );
 	assert( tc_request == TC_RESERV || tc_request == TC_FREE || tc_request == TC_MODIFY );
 
+	return tc_request_op( node, topic, tc_request, req_load, topic->topic_burst );
+}
+
+int tc_server_management_police_req( NODE_ENTRY *node, TOPIC_ENTRY *topic )
+{
+	DEBUG_MSG_SERVER_MNG("tc_server_management_police_req() ...\n");
+
+	unsigned int n_prod;
+	NODE_BIND_ENTRY *prod_entry = NULL;
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_management_police_req() : MODULE ISNT RUNNING\n");
+		return ERR_S_NOT_INIT;
+	}
+
+	assert( node );
+	assert( topic );
+
+#if ENABLE_INGRESS_POLICING
+	//Get number of producers sending to this consumer (none if node is no longer a consumer of the topic)
+	//NOTE : When one node is producer and consumer of the same topic, when it produces it produces only for the other consumers (no loopback)
+	n_prod = 0;
+	if ( tc_server_db_topic_find_cons_node( topic, node->node_id ) ){
+		for( prod_entry = topic->prod_list; prod_entry; prod_entry = prod_entry->next ){
+			if ( prod_entry->node != node )
+				n_prod++;
+		}
+	}
+
+	//Policer rate and burst match the downlink load accounted by the admission control (0 -> remove policer)
+	return tc_request_op( node, topic, TC_POLICE, n_prod * topic->topic_load, n_prod * topic->topic_burst );
+#else
+	(void)n_prod; (void)prod_entry;
+	return ERR_OK;
+#endif
+}
+
+int tc_server_management_police_update( TOPIC_ENTRY *topic )
+{
+	DEBUG_MSG_SERVER_MNG("tc_server_management_police_update() ...\n");
+
+	int ret = ERR_OK;
+	NODE_BIND_ENTRY *cons_entry = NULL;
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_management_police_update() : MODULE ISNT RUNNING\n");
+		return ERR_S_NOT_INIT;
+	}
+
+	assert( topic );
+
+#if ENABLE_INGRESS_POLICING
+	//Update every consumer policer -- Keep going on errors so the remaining consumers still get updated
+	for ( cons_entry = topic->cons_list; cons_entry; cons_entry = cons_entry->next ){
+		if ( tc_server_management_police_req( cons_entry->node, topic ) ){
+			fprintf(stderr,"tc_server_management_police_update() : ERROR UPDATING TOPIC ID %u POLICER ON NODE ID %u\n",topic->topic_id,cons_entry->node->node_id);
+			ret = ERR_NODE_CONS_RESERV;
+		}
+	}
+
+	DEBUG_MSG_SERVER_MNG("tc_server_management_police_update() Topic id %u consumers policers updated\n",topic->topic_id);
+#else
+	(void)cons_entry;
+#endif
+
+	return ret;
+}
+
+static int tc_request_op( NODE_ENTRY *node, TOPIC_ENTRY *topic, unsigned char tc_request, unsigned int req_load, unsigned int req_burst )
+{
+	DEBUG_MSG_SERVER_MNG("tc_request_op() ...\n");
+
+	NET_ADDR client;
+	NET_MSG request;
+	NET_MSG answer;
+	unsigned long long t_start;
+	int ret;
+
+	assert( node );
+	assert( topic );
+
 	//Prepare request msg
 	memset(&request,0,sizeof(NET_MSG));
 
@@ -158,34 +258,48 @@ int tc_server_management_reserv_req( NODE_ENTRY *node, TOPIC_ENTRY *topic, unsig
 	request.n_nodes = 1;
 	request.topic_id = topic->topic_id;
 	request.topic_load = req_load;
+	request.topic_burst = req_burst;
 	request.topic_addr = topic->address;
 
 	//Set client address
 	strcpy(client.name_ip, MANAGEMENT_GROUP_IP);
 	client.port = MANAGEMENT_GROUP_PORT;
 
+	memset(&answer,0,sizeof(NET_MSG));
+	t_start = tc_time_get_us();
+
+	TC_PROBE4( server_mng_req_start, tc_request, node->node_id, topic->topic_id, req_load );
+
 	if ( !node->address.port ){
 		//Client is in the same local node
 		strcpy(client.name_ip, CLIENT_MANAGEMENT_REQ_LOCAL_FILE);
 		tc_network_send_msg( &req_local_sock, &request, &client );
 	
-		DEBUG_MSG_SERVER_MNG("tc_server_management_reserv_req() : Waiting for topic id %u resource reservation on node ID %u local request response\n",topic->topic_id,node->node_id);
-		tc_network_get_msg( &ans_local_sock, S_REQUESTS_TIMEOUT, &answer, NULL );
+		DEBUG_MSG_SERVER_MNG("tc_request_op() : Waiting for topic id %u resource reservation on node ID %u local request response\n",topic->topic_id,node->node_id);
+		ret = tc_network_get_msg( &ans_local_sock, S_REQUESTS_TIMEOUT, &answer, NULL );
 	}else{
 		//Client is in a remote node
 		tc_network_send_msg( &req_remote_sock, &request, &client );
 	
-		DEBUG_MSG_SERVER_MNG("tc_server_management_reserv_req() : Waiting for topic id %u resource reservation on node ID %u remote request response\n",topic->topic_id,node->node_id);
-		tc_network_get_msg( &ans_remote_sock, S_REQUESTS_TIMEOUT, &answer, NULL );
+		DEBUG_MSG_SERVER_MNG("tc_request_op() : Waiting for topic id %u resource reservation on node ID %u remote request response\n",topic->topic_id,node->node_id);
+		ret = tc_network_get_msg( &ans_remote_sock, S_REQUESTS_TIMEOUT, &answer, NULL );
 	}
 
+	if ( tc_request < N_OP_TYPES )
+		tc_hist_add( &mng_hist[tc_request], tc_time_get_us() - t_start );
+
+	if ( ret )
+		tc_server_metrics_count_mng_timeout( tc_request, 1 );
+
+	TC_PROBE4( server_mng_req_end, tc_request, node->node_id, topic->topic_id, ret ? ret : answer.error );
+
 	//Check if operation was successfull
 	if( answer.type != ANS_MSG || answer.error || answer.node_ids[0] != node->node_id ){
-		fprintf(stderr,"tc_server_management_reserv_req() : ERROR RESERVING BANDWIDTH FOR TOPIC ID %u ON NODE ID %u\n",topic->topic_id,node->node_id);
+		fprintf(stderr,"tc_request_op() : ERROR IN RESERVATION REQUEST %u FOR TOPIC ID %u ON NODE ID %u\n",tc_request,topic->topic_id,node->node_id);
 		return -3;
 	}
 
-	DEBUG_MSG_SERVER_MNG("tc_server_management_reserv_req() Reservation operation sucessfull\n");
+	DEBUG_MSG_SERVER_MNG("tc_request_op() Reservation operation sucessfull\n");
 
 	return ERR_OK;
 }
@@ -345,6 +459,7 @@ int tc_server_management_rm_node( NODE_ENTRY *node )
 	DEBUG_MSG_SERVER_MNG("tc_server_management_rm_node() ...\n");
 
 	int aux = 0;
+	char was_prod = 0;
 	TOPIC_ENTRY *topic = NULL;
 	NODE_BIND_ENTRY *prod_entry = NULL, *cons_entry = NULL;
 
@@ -371,10 +486,13 @@ int tc_server_management_rm_node( NODE_ENTRY *node )
 			if ( prod_entry->node == node ){
 				//This node is producer of this topic -- Update bandwidth of each consumer node of this topic
 				for ( cons_entry = topic->cons_list; cons_entry; cons_entry = cons_entry->next ){
+					if ( cons_entry->node == node ) continue;
 					cons_entry->node->downlink_load = cons_entry->node->downlink_load - topic->topic_load;
+					cons_entry->node->downlink_burst = cons_entry->node->downlink_burst - topic->topic_burst;
 				}
 				//Remove node as producer of this topic
 				tc_server_db_topic_rm_prod_node( topic, prod_entry->node );
+				was_prod = 1;
 				break;			
 			}
 		}
@@ -389,6 +507,12 @@ int tc_server_management_rm_node( NODE_ENTRY *node )
 			}
 		}
 
+		//Remaining consumers now receive from one producer less -- Update their policers
+		if ( was_prod ){
+			tc_server_management_police_update( topic );
+			was_prod = 0;
+		}
+
 		//Check for possible unbinds
 		if( tc_server_management_check_unbind( topic ) ){
 			fprintf(stderr,"tc_server_management_rm_node() : ERROR INSIDE MANAGEMENT CHECK UNBIND OF TOPIC ID %u\n",topic->topic_id);
@@ -483,7 +607,7 @@ int tc_server_management_check_bind( TOPIC_ENTRY *topic )
 			if ( consumers[j]->node != producers[i]->node ){
 				//Bind consumer partner
 				if ( !consumers[j]->is_bound ){
-					printf("tc_server_management_check_bind() : going to bind node %s as rx to topic %d\n",consumers[j]->node->address.name_ip,topic->topic_id);
+					TC_LOG( LOG_SERVER_MANAGEMENT, LOG_INFO, "tc_server_management_check_bind() : going to bind node %s as rx to topic %d\n",consumers[j]->node->address.name_ip,topic->topic_id );
 					rx_node_list[rx_n_nodes] = consumers[j];
 					rx_n_nodes++;
 				}
@@ -493,7 +617,7 @@ int tc_server_management_check_bind( TOPIC_ENTRY *topic )
 
 		//Bind this producer if it has a valid consumer partner
 		if ( !producers[i]->is_bound && has_partner ){
-			printf("tc_server_management_check_bind() : going to bind node %s as tx to topic %d\n",producers[i]->node->address.name_ip,topic->topic_id);
+			TC_LOG( LOG_SERVER_MANAGEMENT, LOG_INFO, "tc_server_management_check_bind() : going to bind node %s as tx to topic %d\n",producers[i]->node->address.name_ip,topic->topic_id );
 			tx_node_list[tx_n_nodes] = producers[i];
 			tx_n_nodes++;
 		}	
@@ -621,7 +745,7 @@ int tc_server_management_check_unbind( TOPIC_ENTRY *topic )
 
 		if ( !has_partner || producers[i]->req_unbind ){
 			//Has no valid partner -- Unbind
-			printf("tc_server_management_check_unbind() : going to unbind node %s as tx to topic %d\n", producers[i]->node->address.name_ip,topic->topic_id);
+			TC_LOG( LOG_SERVER_MANAGEMENT, LOG_INFO, "tc_server_management_check_unbind() : going to unbind node %s as tx to topic %d\n", producers[i]->node->address.name_ip,topic->topic_id );
 			tx_node_list[tx_n_nodes] = producers[i];
 			tx_n_nodes++;
 		}
@@ -640,7 +764,7 @@ int tc_server_management_check_unbind( TOPIC_ENTRY *topic )
 
 		if ( !has_partner || consumers[i]->req_unbind ){	
 			//Has no valid partner -- Unbind
-			printf("tc_server_management_check_unbind() : going to unbind node %s as rx to topic %d\n", consumers[i]->node->address.name_ip,topic->topic_id);
+			TC_LOG( LOG_SERVER_MANAGEMENT, LOG_INFO, "tc_server_management_check_unbind() : going to unbind node %s as rx to topic %d\n", consumers[i]->node->address.name_ip,topic->topic_id );
 			rx_node_list[rx_n_nodes] = consumers[i];
 			rx_n_nodes++;
 		}
@@ -847,6 +971,7 @@ static int topic_multi_op_request( NODE_BIND_ENTRY *node_list[], unsigned int n_
 	int i, j;
 	unsigned int err_nodes_id[MAX_MULTI_NODES], n_err_nodes;
 	unsigned int n_req_nodes;
+	unsigned long long t_start;
 
 	if ( !init ){
 		fprintf(stderr,"topic_multi_op_request() : MODULE ISNT RUNNING\n");
@@ -867,9 +992,13 @@ static int topic_multi_op_request( NODE_BIND_ENTRY *node_list[], unsigned int n_
 	request.op 		= op_type;
 	request.topic_id 	= topic->topic_id;
 	request.topic_load 	= topic->topic_load;
+	request.topic_burst 	= topic->topic_burst;
 	request.topic_addr 	= topic->address;
 	request.channel_size 	= topic->channel_size;
 	request.channel_period 	= topic->channel_period;
+	request.topic_fec_k 	= topic->fec_k;
+	request.topic_fec_m 	= topic->fec_m;
+	request.topic_retx_share = topic->retx_share;
 	for ( i = 0; i < n_nodes; i++ ){ request.node_ids[i] = node_list[i]->node->node_id; }
 	request.n_nodes		= n_nodes;
 	
@@ -877,6 +1006,10 @@ static int topic_multi_op_request( NODE_BIND_ENTRY *node_list[], unsigned int n_
 	strcpy(client.name_ip, CLIENT_MANAGEMENT_REQ_LOCAL_FILE);
 	client.port = 0;
 
+	t_start = tc_time_get_us();
+
+	TC_PROBE3( server_multi_op_start, op_type, topic->topic_id, n_nodes );
+
 	tc_network_send_msg( &req_local_sock, &request, &client );
 	
 	//Send message to remote nodes
@@ -939,6 +1072,14 @@ static int topic_multi_op_request( NODE_BIND_ENTRY *node_list[], unsigned int n_
 		}
 	}
 
+	tc_hist_add( &mng_hist[op_type], tc_time_get_us() - t_start );
+
+	TC_PROBE5( server_multi_op_end, op_type, topic->topic_id, n_nodes, n_req_nodes, n_err_nodes );
+
+	//Nodes that neither accepted nor refused the request timed out
+	if ( n_req_nodes > n_err_nodes )
+		tc_server_metrics_count_mng_timeout( op_type, n_req_nodes - n_err_nodes );
+
 	//If any node failed to reply or replied negative, return it on the node list
 	if ( n_err_nodes ){
 		*ret_n_err = 0;
@@ -60,6 +60,18 @@ int tc_server_management_init( NET_ADDR *server_remote );
 */
 int tc_server_management_close( void );
 
+/**	
+*	@brief Prints the management requests latency histograms
+*
+*	Prints, for each operation type, the latency of the requests issued to the clients management modules (request sent until all answers received or timeout)
+*
+*	@pre				None
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0)
+*/
+int tc_server_management_latency_print( void );
+
 /**	
 *	@brief Sends a reservation request to a client
 *
@@ -79,6 +91,38 @@ int tc_server_management_close( void );
 */
 int tc_server_management_reserv_req( NODE_ENTRY *node, TOPIC_ENTRY *topic, unsigned char tc_request, unsigned int req_load );
 
+/**	
+*	@brief Sends an ingress policer request to a consumer client
+*
+*	Sets the consumer node ingress policer for the topic messages. The policer rate and burst match the downlink load accounted by the
+*	admission control (topic load and burst times the number of producers sending to the node). With no producers the policer is removed.
+*	Does nothing if ingress policing is disabled (ENABLE_INGRESS_POLICING)
+*
+*	@param[in] node			The entry address of the consumer node. Must not be a NULL pointer
+*	@param[in] topic		The entry address of the topic associated with the policer. Must not be a NULL pointer
+*
+*	@pre				assert( node );
+*	@pre				assert( topic );
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0)
+*/
+int tc_server_management_police_req( NODE_ENTRY *node, TOPIC_ENTRY *topic );
+
+/**	
+*	@brief Updates the ingress policers of all consumers of a topic
+*
+*	Calls tc_server_management_police_req for every consumer node of the topic. Used when the topic load or its number of producers changes
+*
+*	@param[in] topic		The entry address of the topic. Must not be a NULL pointer
+*
+*	@pre				assert( topic );
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0) if one or more consumers failed to update
+*/
+int tc_server_management_police_update( TOPIC_ENTRY *topic );
+
 /**	
 *	@brief Removes a topic
 *
@@ -0,0 +1,360 @@
+/*This file is part of LTCNM (Linux Traffic Control Network Manager).
+
+    LTCNM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LTCNM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LTCNM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**	@file TC_Server_Metrics.c
+*	@brief Source code of the functions for the server metrics module
+*
+*	This file contains the implementation of the functions for the server metrics module.
+*	This module keeps the server counters (requests, heartbeat misses, management timeouts) and, if METRICS_PORT is set, serves them
+*	together with the database gauges (registered nodes/topics, nodes reserved load and capacity) in the Prometheus text format.
+*	Internal module
+*
+*	@bug No known bugs
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "TC_Server_DB.h"
+#include "TC_Server_Metrics.h"
+
+#include "Sockets.h"
+#include "TC_Data_Types.h"
+#include "TC_Utils.h"
+#include "TC_Config.h"
+#include "TC_Error_Types.h"
+
+/**	@def DEBUG_MSG_SERVER_METRICS
+*	@brief If "ENABLE_DEBUG_SERVER_METRICS" is defined debug messages related to this module are printed
+*/
+#if ENABLE_DEBUG_SERVER_METRICS
+#define DEBUG_MSG_SERVER_METRICS(...) printf(__VA_ARGS__)
+#else
+#define DEBUG_MSG_SERVER_METRICS(...)
+#endif
+
+/**	@def METRICS_MAX_REQ_ENTRIES
+*	@brief Maximum number of distinct (operation, error) request counters
+*/
+#define METRICS_MAX_REQ_ENTRIES 128
+
+/**
+* A struct to store a requests counter for an (operation, error) pair
+*/
+typedef struct metrics_req_entry{
+
+	unsigned char op;		/**< The request operation code */
+	int error;			/**< The request answer error code */
+	unsigned long long count;	/**< The number of requests */
+
+}METRICS_REQ_ENTRY;
+
+static char init = 0;
+static char quit = 0;
+
+static SOCK_ENTITY metrics_sock;
+
+static pthread_t metrics_thread_id;
+static pthread_mutex_t metrics_lock;
+
+//Counters
+static pthread_mutex_t req_lock = PTHREAD_MUTEX_INITIALIZER;
+static METRICS_REQ_ENTRY req_entries[METRICS_MAX_REQ_ENTRIES];
+static unsigned int n_req_entries;
+
+static unsigned long long heartbeat_misses;
+static unsigned long long nodes_expired;
+static unsigned long long mng_timeouts[N_OP_TYPES];
+
+//Accepts and serves scrape requests
+static void tc_server_metrics_thread( void );
+
+//Writes the metrics page in Prometheus text format
+static void tc_server_metrics_write( FILE *out );
+
+//Serves one scrape request
+static void tc_server_metrics_serve( int fd );
+
+int tc_server_metrics_init( void )
+{
+	DEBUG_MSG_SERVER_METRICS("tc_server_metrics_init() ...\n");
+
+	if ( init ){
+		fprintf(stderr,"tc_server_metrics_init() : MODULE ALREADY INITIALIZED\n");
+		return ERR_S_ALREADY_INIT;
+	}
+
+	if ( METRICS_PORT ){
+		//Create metrics endpoint socket
+		if ( sock_open( &metrics_sock, REMOTE_TCP ) < 0 ){
+			fprintf(stderr,"tc_server_metrics_init() : ERROR CREATING METRICS SOCKET\n");
+			return ERR_SOCK_CREATE;
+		}
+
+		//Set and bind to host address
+		NET_ADDR host = {METRICS_IP,METRICS_PORT};
+		if ( sock_bind( &metrics_sock, &host ) ){
+			fprintf(stderr,"tc_server_metrics_init() : ERROR BINDING SOCKET TO METRICS ADDRESS\n");
+			sock_close( &metrics_sock );
+			return ERR_SOCK_BIND_HOST;
+		}
+
+		if ( listen( metrics_sock.fd, 4 ) < 0 ){
+			perror("tc_server_metrics_init() : ERROR LISTENING ON METRICS SOCKET --");
+			sock_close( &metrics_sock );
+			return ERR_SOCK_OPTION;
+		}
+
+		//Create scrape requests thread
+		if ( tc_thread_create( tc_server_metrics_thread, &metrics_thread_id, &quit, &metrics_lock, 100 ) ){
+			fprintf(stderr,"tc_server_metrics_init() : ERROR CREATING METRICS THREAD\n");
+			sock_close( &metrics_sock );
+			return ERR_THREAD_CREATE;
+		}
+	}
+
+	init = 1;
+
+	DEBUG_MSG_SERVER_METRICS("tc_server_metrics_init() Metrics module started\n");
+
+	return ERR_OK;
+}
+
+int tc_server_metrics_close( void )
+{
+	DEBUG_MSG_SERVER_METRICS("tc_server_metrics_close() ...\n");
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_metrics_close() : MODULE ISNT RUNNING\n");
+		return ERR_S_NOT_INIT;
+	}
+
+	if ( METRICS_PORT ){
+		//Stop scrape requests thread
+		if ( tc_thread_destroy( &metrics_thread_id, &quit, &metrics_lock, 100 ) ){
+			fprintf(stderr,"tc_server_metrics_close() : ERROR DESTROYING METRICS THREAD\n");
+			return ERR_THREAD_DESTROY;
+		}
+
+		//Close metrics endpoint socket
+		if ( sock_close( &metrics_sock ) ){
+			fprintf(stderr,"tc_server_metrics_close() : ERROR CLOSING METRICS SOCKET\n");
+			return ERR_SOCK_CLOSE;
+		}
+	}
+
+	init = 0;
+
+	DEBUG_MSG_SERVER_METRICS("tc_server_metrics_close() Metrics module closed\n");
+
+	return ERR_OK;
+}
+
+void tc_server_metrics_count_req( unsigned char op, int error )
+{
+	int i;
+
+	pthread_mutex_lock( &req_lock );
+
+	for ( i = 0; i < n_req_entries; i++ ){
+		if ( req_entries[i].op == op && req_entries[i].error == error )
+			break;
+	}
+
+	if ( i == n_req_entries && n_req_entries < METRICS_MAX_REQ_ENTRIES ){
+		req_entries[i].op = op;
+		req_entries[i].error = error;
+		req_entries[i].count = 0;
+		n_req_entries++;
+	}
+
+	if ( i < n_req_entries )
+		req_entries[i].count++;
+
+	pthread_mutex_unlock( &req_lock );
+}
+
+void tc_server_metrics_count_heartbeat_miss( void )
+{
+	__atomic_add_fetch( &heartbeat_misses, 1, __ATOMIC_RELAXED );
+}
+
+void tc_server_metrics_count_node_expired( void )
+{
+	__atomic_add_fetch( &nodes_expired, 1, __ATOMIC_RELAXED );
+}
+
+void tc_server_metrics_count_mng_timeout( unsigned char op, unsigned int n_nodes )
+{
+	if ( op < N_OP_TYPES )
+		__atomic_add_fetch( &mng_timeouts[op], n_nodes, __ATOMIC_RELAXED );
+}
+
+static void tc_server_metrics_write( FILE *out )
+{
+	NODE_ENTRY *node;
+	TOPIC_ENTRY *topic;
+	unsigned int n_nodes = 0, n_topics = 0;
+	char *name;
+	int i;
+
+	//Request counters
+	fprintf(out,"# HELP ltcnm_requests_total Client requests resolved by the server, by operation and answer error code\n");
+	fprintf(out,"# TYPE ltcnm_requests_total counter\n");
+
+	pthread_mutex_lock( &req_lock );
+	for ( i = 0; i < n_req_entries; i++ ){
+		name = tc_op_type_name( req_entries[i].op );
+		fprintf(out,"ltcnm_requests_total{op=\"%s\",error=\"%d\"} %llu\n",name ? name : "UNKNOWN",req_entries[i].error,req_entries[i].count);
+	}
+	pthread_mutex_unlock( &req_lock );
+
+	//Monitoring and management counters
+	fprintf(out,"# HELP ltcnm_heartbeat_misses_total Heartbeat decrement periods without a heartbeat from a node\n");
+	fprintf(out,"# TYPE ltcnm_heartbeat_misses_total counter\n");
+	fprintf(out,"ltcnm_heartbeat_misses_total %llu\n",__atomic_load_n( &heartbeat_misses, __ATOMIC_RELAXED ));
+
+	fprintf(out,"# HELP ltcnm_nodes_expired_total Nodes declared dead after missing %d heartbeats\n",HEARBEAT_COUNT);
+	fprintf(out,"# TYPE ltcnm_nodes_expired_total counter\n");
+	fprintf(out,"ltcnm_nodes_expired_total %llu\n",__atomic_load_n( &nodes_expired, __ATOMIC_RELAXED ));
+
+	fprintf(out,"# HELP ltcnm_management_timeouts_total Management requests not answered by a node, by operation\n");
+	fprintf(out,"# TYPE ltcnm_management_timeouts_total counter\n");
+	for ( i = 0; i < N_OP_TYPES; i++ ){
+		if ( (name = tc_op_type_name( i )) && __atomic_load_n( &mng_timeouts[i], __ATOMIC_RELAXED ) )
+			fprintf(out,"ltcnm_management_timeouts_total{op=\"%s\"} %llu\n",name,__atomic_load_n( &mng_timeouts[i], __ATOMIC_RELAXED ));
+	}
+
+	fprintf(out,"# HELP ltcnm_max_usable_bw_bps Default node usable bandwidth for topics\n");
+	fprintf(out,"# TYPE ltcnm_max_usable_bw_bps gauge\n");
+	fprintf(out,"ltcnm_max_usable_bw_bps %llu\n",(unsigned long long)MAX_USABLE_BW);
+
+	//Database gauges
+	tc_server_db_lock();
+
+	fprintf(out,"# HELP ltcnm_node_usable_bw_bps Node usable bandwidth for topics (uplink and downlink)\n");
+	fprintf(out,"# TYPE ltcnm_node_usable_bw_bps gauge\n");
+	for ( node = tc_server_db_node_get_first(); node; node = node->next )
+		fprintf(out,"ltcnm_node_usable_bw_bps{node=\"%u\"} %llu\n",node->node_id,node->usable_bw);
+
+	fprintf(out,"# HELP ltcnm_node_uplink_load_bps Node reserved uplink load\n");
+	fprintf(out,"# TYPE ltcnm_node_uplink_load_bps gauge\n");
+	for ( node = tc_server_db_node_get_first(); node; node = node->next )
+		fprintf(out,"ltcnm_node_uplink_load_bps{node=\"%u\"} %llu\n",node->node_id,node->uplink_load);
+
+	fprintf(out,"# HELP ltcnm_node_downlink_load_bps Node reserved downlink load\n");
+	fprintf(out,"# TYPE ltcnm_node_downlink_load_bps gauge\n");
+	for ( node = tc_server_db_node_get_first(); node; node = node->next ){
+		fprintf(out,"ltcnm_node_downlink_load_bps{node=\"%u\"} %llu\n",node->node_id,node->downlink_load);
+		n_nodes++;
+	}
+
+	fprintf(out,"# HELP ltcnm_topic_load_bps Topic reserved load (per producer)\n");
+	fprintf(out,"# TYPE ltcnm_topic_load_bps gauge\n");
+	for ( topic = tc_server_db_topic_get_first(); topic; topic = topic->next ){
+		fprintf(out,"ltcnm_topic_load_bps{topic=\"%u\"} %u\n",topic->topic_id,topic->topic_load);
+		n_topics++;
+	}
+
+	tc_server_db_unlock();
+
+	fprintf(out,"# HELP ltcnm_nodes Registered nodes\n");
+	fprintf(out,"# TYPE ltcnm_nodes gauge\n");
+	fprintf(out,"ltcnm_nodes %u\n",n_nodes);
+
+	fprintf(out,"# HELP ltcnm_topics Registered topics\n");
+	fprintf(out,"# TYPE ltcnm_topics gauge\n");
+	fprintf(out,"ltcnm_topics %u\n",n_topics);
+}
+
+static void tc_server_metrics_serve( int fd )
+{
+	DEBUG_MSG_SERVER_METRICS("tc_server_metrics_serve() ...\n");
+
+	char req[1024], header[128];
+	char *body = NULL;
+	size_t body_size = 0;
+	FILE *out;
+	struct timeval timeout = {1,0};
+	int n, sent;
+
+	//Consume the scrape request (any request gets the metrics page)
+	setsockopt( fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout) );
+	recv( fd, req, sizeof(req), 0 );
+
+	if ( !(out = open_memstream( &body, &body_size )) ){
+		fprintf(stderr,"tc_server_metrics_serve() : ERROR ALLOCATING METRICS PAGE\n");
+		return;
+	}
+
+	tc_server_metrics_write( out );
+	fclose( out );
+
+	n = snprintf(header,sizeof(header),"HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n",body_size);
+	send( fd, header, n, MSG_NOSIGNAL );
+
+	for ( sent = 0; sent < body_size; sent += n ){
+		if ( (n = send( fd, body + sent, body_size - sent, MSG_NOSIGNAL )) <= 0 )
+			break;
+	}
+
+	free( body );
+
+	DEBUG_MSG_SERVER_METRICS("tc_server_metrics_serve() Served %zu bytes\n",body_size);
+}
+
+static void tc_server_metrics_thread( void )
+{
+	DEBUG_MSG_SERVER_METRICS("tc_server_metrics_thread() ...\n");
+
+	struct timeval timeout;
+	fd_set fds;
+	int fd;
+
+	pthread_mutex_lock( &metrics_lock );
+
+	while ( quit == THREAD_RUN ){
+
+		//Prepare timed-out accept
+		FD_ZERO(&fds);
+		FD_SET(metrics_sock.fd, &fds);
+
+		timeout.tv_sec = 0;
+		timeout.tv_usec = 500000;
+
+		if ( select(metrics_sock.fd+1, &fds, 0, 0, &timeout) <= 0 )
+			continue;
+
+		if ( (fd = accept( metrics_sock.fd, NULL, NULL )) < 0 )
+			continue;
+
+		//Not cancelable while holding the database lock
+		pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, NULL );
+		tc_server_metrics_serve( fd );
+		close( fd );
+		pthread_setcancelstate( PTHREAD_CANCEL_ENABLE, NULL );
+	}
+
+	pthread_mutex_unlock( &metrics_lock );
+
+	DEBUG_MSG_SERVER_METRICS("tc_server_metrics_thread() Metrics thread ending\n");
+
+	pthread_exit(NULL);
+}
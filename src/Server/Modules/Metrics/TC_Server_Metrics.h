@@ -0,0 +1,90 @@
+/*This file is part of LTCNM (Linux Traffic Control Network Manager).
+
+    LTCNM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LTCNM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LTCNM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**	@file TC_Server_Metrics.h
+*	@brief Function prototypes for the server metrics module
+*
+*	This file contains the prototypes of the functions for the server metrics module.
+*	This module keeps the server counters (requests, heartbeat misses, management timeouts) and, if METRICS_PORT is set, serves them
+*	together with the database gauges (registered nodes/topics, nodes reserved load and capacity) in the Prometheus text format.
+*	Internal module
+*
+*	@bug No known bugs
+*/
+
+#ifndef TCSERVERMETRICS_H
+#define TCSERVERMETRICS_H
+
+/**
+*	@brief Starts the server metrics module
+*
+*	Initializes the module. If METRICS_PORT is set, opens the metrics endpoint listening socket (METRICS_IP:METRICS_PORT) and creates
+*	the thread that serves the scrape requests
+*
+*	@pre				None
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0)
+*/
+int tc_server_metrics_init( void );
+
+/**
+*	@brief Closes the server metrics module
+*
+*	Closes the module, the metrics endpoint thread and socket
+*
+*	@pre				None
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0)
+*/
+int tc_server_metrics_close( void );
+
+/**
+*	@brief Counts a resolved client request
+*
+*	@param[in] op		The request operation code
+*	@param[in] error	The error code sent on the request answer
+*
+*	@pre			None
+*/
+void tc_server_metrics_count_req( unsigned char op, int error );
+
+/**
+*	@brief Counts a missed node heartbeat (a heartbeat decrement period without a heartbeat from the node)
+*
+*	@pre			None
+*/
+void tc_server_metrics_count_heartbeat_miss( void );
+
+/**
+*	@brief Counts a node declared dead by the monitoring module
+*
+*	@pre			None
+*/
+void tc_server_metrics_count_node_expired( void );
+
+/**
+*	@brief Counts management requests that timed out waiting for the clients answer
+*
+*	@param[in] op		The management request operation code
+*	@param[in] n_nodes	The number of nodes that did not answer
+*
+*	@pre			None
+*/
+void tc_server_metrics_count_mng_timeout( unsigned char op, unsigned int n_nodes );
+
+#endif
@@ -36,11 +36,14 @@
 
 #include "TC_Data_Types.h"
 #include "TC_Utils.h"
+#include "TC_Probes.h"
 #include "Sockets.h"
 #include "TC_Server_DB.h"
 #include "TC_Server_Monitoring.h"
 #include "TC_Server_Management.h"
+#include "TC_Server_AC.h"
 #include "TC_Server_Notifications.h"
+#include "TC_Server_Metrics.h"
 #include "TC_Config.h"
 #include "TC_Error_Types.h"
 
@@ -74,6 +77,9 @@ static int tc_server_monit_tock( void );
 //Resets node heartbeat counter
 static int tc_server_monit_tick( unsigned int node_id );
 
+//Updates a topic measured load reported by a node
+static int tc_server_monit_usage( unsigned int topic_id, unsigned int node_id, unsigned int measured_load );
+
 static SOCK_ENTITY monit_local_sock;
 static SOCK_ENTITY monit_remote_sock;
 
@@ -211,16 +217,48 @@ static int tc_server_monit_tick( unsigned int node_id )
 	//Unlock database
 	tc_server_db_unlock();
 
+	TC_PROBE1( server_heartbeat_tick, node_id );
+
 	DEBUG_MSG_SERVER_MONIT("tc_server_monit_tick() Node Id %u heartbeat counter reseted\n",node->node_id);
 
 	return ERR_OK;
 }
 
+static int tc_server_monit_usage( unsigned int topic_id, unsigned int node_id, unsigned int measured_load )
+{
+	DEBUG_MSG_SERVER_MONIT("tc_server_monit_usage() Topic Id %u Node Id %u ...\n",topic_id,node_id);
+
+	int ret;
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_monit_usage() : MODULE ISNT RUNNING\n");
+		return ERR_S_NOT_INIT;
+	}
+
+	if ( !topic_id || !node_id ){
+		fprintf(stderr,"tc_server_monit_usage() : INVALID TOPIC ID %u OR NODE ID %u\n",topic_id,node_id);
+		return ERR_INVALID_PARAM;
+	}
+
+	//Lock database
+	tc_server_db_lock();
+
+	ret = tc_server_ac_set_topic_usage( topic_id, node_id, measured_load );
+
+	//Unlock database
+	tc_server_db_unlock();
+
+	DEBUG_MSG_SERVER_MONIT("tc_server_monit_usage() Topic Id %u Node Id %u measured load %u [bps]\n",topic_id,node_id,measured_load);
+
+	return ret;
+}
+
 static int tc_server_monit_tock( void )
 {
 	DEBUG_MSG_SERVER_MONIT("tc_server_monit_tock() ...\n");
 
 	NODE_ENTRY *node = NULL, *aux = NULL; 
+	unsigned int n_nodes = 0, n_expired = 0;
 
 	if ( !init ){
 		fprintf(stderr,"tc_server_monit_tock() : MODULE ISNT RUNNING\n");
@@ -234,8 +272,16 @@ static int tc_server_monit_tock( void )
 	node = tc_server_db_node_get_first();
 	
 	while ( node ){
-		if ( --node->heartbeat < 0 ){
+		n_nodes++;
+
+		if ( --node->heartbeat < HEARBEAT_COUNT - 1 )
+			//No heartbeat received since the last decrement
+			tc_server_metrics_count_heartbeat_miss();
+
+		if ( node->heartbeat < 0 ){
 			fprintf(stderr,"tc_server_monit_tock() : NODE ID %u DIED -- REMOVING IT\n",node->node_id);
+			tc_server_metrics_count_node_expired();
+			n_expired++;
 			//Send notification
 			tc_server_notifications_send_node_event( EVENT_NODE_UNPLUG, node );
 			aux = node->next;
@@ -248,6 +294,8 @@ static int tc_server_monit_tock( void )
 
 	//Unlock database
 	tc_server_db_unlock();
+
+	TC_PROBE2( server_heartbeat_tock, n_nodes, n_expired );
 		
 	DEBUG_MSG_SERVER_MONIT("tc_server_monit_tock() Decremented all nodes heartbeart counter\n");
 
@@ -319,6 +367,8 @@ static void tc_server_monit_tick_thread( void )
 
 		if ( (request.type == REQ_MSG) && (request.op == HEART_SIG) )
 			tc_server_monit_tick( request.node_ids[0] );
+		else if ( (request.type == REQ_MSG) && (request.op == TOPIC_USAGE) )
+			tc_server_monit_usage( request.topic_id, request.node_ids[0], request.topic_load );
 		else
 			fprintf(stderr,"tc_server_monit_tick_thread() : INVALID OPERATION REQUEST FROM NODE ID %u\n",request.node_ids[0]);
 	}
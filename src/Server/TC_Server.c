@@ -39,9 +39,12 @@
 #include "TC_Server_Management.h"
 #include "TC_Server_Discovery.h"
 #include "TC_Server_Notifications.h"
+#include "TC_Server_Metrics.h"
 
 #include "TC_Data_Types.h"
 #include "TC_Utils.h"
+#include "TC_Probes.h"
+#include "TC_Log.h"
 #include "TC_Error_Types.h"
 #include "TC_Config.h"
 
@@ -73,6 +76,14 @@ static int tc_server_modules_close( void );
 static void tc_server_req_get( void );
 static void tc_server_req_resolve( SOCK_ENTITY *sock );
 
+//Sends the request answer and stamps the answer time
+static void tc_server_req_answer( SOCK_ENTITY *sock, NET_MSG *ans, NET_ADDR *client, unsigned long long *ret_time );
+
+//Requests latency histograms (request received -> answer sent, database lock wait and admission control/management processing)
+static TC_HIST req_total_hist[N_OP_TYPES];
+static TC_HIST req_lock_hist[N_OP_TYPES];
+static TC_HIST req_ac_hist[N_OP_TYPES];
+
 int tc_server_init( char *ifface, unsigned int server_port )
 {
 	DEBUG_MSG_TC_SERVER("tc_server_init() ...\n");
@@ -104,8 +115,15 @@ int tc_server_init( char *ifface, unsigned int server_port )
 	strcpy(server_local.name_ip, SERVER_AC_LOCAL_FILE);
 	server_local.port = 0;
 
+	//Start logger
+	if ( tc_log_init() ){
+		fprintf(stderr,"tc_server_init() : ERROR STARTING LOGGER\n");
+		return ERR_LOG_INIT;
+	}
+
 	if ( (ret = tc_server_modules_init()) ){
 		fprintf(stderr,"tc_server_init() : ERROR INITIALIZING SERVER INTERNAL MODULES\n");
+		tc_log_close();
 		return ret;
 	}
 	
@@ -113,6 +131,7 @@ int tc_server_init( char *ifface, unsigned int server_port )
 	if ( tc_thread_create( tc_server_req_get, &server_thread_id, &quit, &server_lock, 100 ) ){
 		fprintf(stderr,"tc_server_init() : ERROR CREATING REQUESTS POLLING THREAD\n");
 		tc_server_modules_close();
+		tc_log_close();
 		return ERR_THREAD_CREATE;
 	}
 	
@@ -146,6 +165,9 @@ int tc_server_close( void )
 		return ret;
 	}
 
+	//Stop logger (writes pending messages)
+	tc_log_close();
+
 	strcpy(nic_ip,"");
 	strcpy(server_remote.name_ip,"");
 	strcpy(server_local.name_ip,"");
@@ -158,6 +180,23 @@ int tc_server_close( void )
 	return ERR_OK;
 }
 
+int tc_server_latency_print( void )
+{
+	DEBUG_MSG_TC_SERVER("tc_server_latency_print() ...\n");
+
+	if ( !init ){
+		fprintf(stderr,"tc_server_latency_print() : MODULE IS NOT INITIALIZED\n");
+		return ERR_S_NOT_INIT;
+	}
+
+	tc_hist_op_print( "tc_server_latency_print() : Requests latency (request received -> answer sent)", req_total_hist );
+	tc_hist_op_print( "tc_server_latency_print() : Requests database lock wait", req_lock_hist );
+	tc_hist_op_print( "tc_server_latency_print() : Requests admission control processing (database locked -> answer sent)", req_ac_hist );
+	tc_server_management_latency_print();
+
+	return ERR_OK;
+}
+
 static void tc_server_req_get( void )
 {
 	DEBUG_MSG_TC_SERVER("tc_server_req_get() ...\n");
@@ -165,6 +204,9 @@ static void tc_server_req_get( void )
 	struct timeval timeout;
 	fd_set fds;
 	int highest_fd;
+#if LATENCY_SNAPSHOT_PERIOD
+	unsigned long long last_snapshot = tc_time_get_us();
+#endif
 	
 	pthread_mutex_lock( &server_lock );
 
@@ -174,6 +216,14 @@ static void tc_server_req_get( void )
 		highest_fd = local_sock.fd;
 
 	while ( !quit ){
+
+#if LATENCY_SNAPSHOT_PERIOD
+		//Periodic latency snapshot
+		if ( tc_time_get_us() - last_snapshot >= LATENCY_SNAPSHOT_PERIOD*1000000ULL ){
+			last_snapshot = tc_time_get_us();
+			tc_server_latency_print();
+		}
+#endif
 	
 		//Prepare timed-out receive
 		FD_ZERO(&fds);
@@ -183,6 +233,11 @@ static void tc_server_req_get( void )
 		timeout.tv_sec = 0;
 		timeout.tv_usec = 500000;
 
+		//Apply the reservation resizes decided from the usage reports (kept off the heartbeats thread as it waits for the nodes answers)
+		tc_server_db_lock();
+		tc_server_ac_apply_topic_usage();
+		tc_server_db_unlock();
+
 		if ( select(highest_fd+1, &fds, 0, 0, &timeout) <= 0)
 			continue;
 
@@ -208,6 +263,7 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 {
 	NET_ADDR client, topic_addr;
 	NET_MSG req, ans;
+	unsigned long long t_enter, t_locked, t_answer = 0;
 
 	//if ( sock->type == REMOTE_UDP ) printf("\nRECEIVING REQUEST FROM REMOTE\n");
 	//if ( sock->type == LOCAL )  printf("\nRECEIVING REQUEST FROM LOCAL\n");
@@ -220,9 +276,10 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 		return;
 	}
 
-	printf("\ntc_server_req_resolve() : Received request from client %s:%u . Operation : ",client.name_ip,client.port);
-	tc_op_type_print( req.op );
-	printf("tc_server_req_resolve() : Node Id %u Topic Id %u Size %u Period %u\n",req.node_ids[0],req.topic_id,req.channel_size,req.channel_period);
+	TC_PROBE4( server_req_start, req.op, req.node_ids[0], req.topic_id, req.channel_size );
+
+	TC_LOG( LOG_SERVER, LOG_DEBUG, "tc_server_req_resolve() : Received request %s from client %s:%u Node Id %u Topic Id %u Size %u Period %u\n",
+		tc_op_type_name( req.op ) ? tc_op_type_name( req.op ) : "UNKNOWN",client.name_ip,client.port,req.node_ids[0],req.topic_id,req.channel_size,req.channel_period);
 	
 	//Prepare answer msg
 	memset(&ans,0,sizeof(NET_MSG));
@@ -237,18 +294,20 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 	ans.channel_period = req.channel_period;
 	
 	//Lock database
+	t_enter = tc_time_get_us();
 	tc_server_db_lock();
+	t_locked = tc_time_get_us();
 
 	switch( req.op ){
 
 		case REG_NODE :
 
 			//Register node in the network
-			if ( ( ans.error = tc_server_ac_add_node( req.node_ids[0], &client, &ans.node_ids[0] )) )
+			if ( ( ans.error = tc_server_ac_add_node( req.node_ids[0], &client, req.link_bw, req.link_background_share, req.link_control_share, &ans.node_ids[0] )) )
 				ans.op = REQ_REFUSED;	
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 	
 			break;
 
@@ -259,26 +318,28 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 				ans.op = REQ_REFUSED;	
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 	
 			break;
 
 		case REG_TOPIC :
 
 			//Register topic
-			if ( ( ans.error = tc_server_ac_add_topic(  req.topic_id, req.channel_size, req.channel_period )) )
+			if ( ( ans.error = tc_server_ac_add_topic(  req.topic_id, req.channel_size, req.channel_period, req.topic_fec_k, req.topic_fec_m, req.topic_retx_share )) )
 				ans.op = REQ_REFUSED;
 
 			//Get registered topic properties (cross-check)
 			if ( !( ans.error = tc_server_ac_get_topic_prop( req.topic_id, &(ans.topic_load), &(ans.channel_size), &(ans.channel_period), &topic_addr )) ){
 				strcpy( ans.topic_addr.name_ip, topic_addr.name_ip );
 				ans.topic_addr.port = topic_addr.port; 
+				tc_server_ac_get_topic_delay( req.topic_id, &(ans.topic_delay_bound) );
+				tc_server_ac_get_topic_reliability( req.topic_id, &(ans.topic_fec_k), &(ans.topic_fec_m), &(ans.topic_retx_share) );
 			}else{
 				ans.op = REQ_REFUSED;
 			}
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 	
 			break;
 
@@ -289,9 +350,13 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 				ans.op = REQ_REFUSED;
 				
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );
-			tc_server_db_topic_print();
-			tc_server_db_node_print();
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
+
+			//Database dump (synchronous -- debug only)
+			if ( tc_log_enabled( LOG_SERVER_DB, LOG_DEBUG ) ){
+				tc_server_db_topic_print();
+				tc_server_db_node_print();
+			}
 			break;
 
 		case GET_TOPIC_PROP :
@@ -300,12 +365,14 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 			if ( !( ans.error = tc_server_ac_get_topic_prop( req.topic_id, &(ans.topic_load), &(ans.channel_size), &(ans.channel_period), &topic_addr )) ){
 				strcpy( ans.topic_addr.name_ip, topic_addr.name_ip );
 				ans.topic_addr.port = topic_addr.port; 
+				tc_server_ac_get_topic_delay( req.topic_id, &(ans.topic_delay_bound) );
+				tc_server_ac_get_topic_reliability( req.topic_id, &(ans.topic_fec_k), &(ans.topic_fec_m), &(ans.topic_retx_share) );
 			}else{
 				ans.op = REQ_REFUSED;
 			}
 			
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 	
 			break;
 
@@ -316,7 +383,7 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 				ans.op = REQ_REFUSED;
 			
 			//Answere request
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 
 			break;
 
@@ -330,12 +397,14 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 			if ( !( ans.error = tc_server_ac_get_topic_prop( req.topic_id, &(ans.topic_load), &(ans.channel_size), &(ans.channel_period), &topic_addr )) ){
 				strcpy( ans.topic_addr.name_ip, topic_addr.name_ip );
 				ans.topic_addr.port = topic_addr.port; 
+				tc_server_ac_get_topic_delay( req.topic_id, &(ans.topic_delay_bound) );
+				tc_server_ac_get_topic_reliability( req.topic_id, &(ans.topic_fec_k), &(ans.topic_fec_m), &(ans.topic_retx_share) );
 			}else{
 				ans.op = REQ_REFUSED;
 			}
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 
 			break;
 
@@ -346,7 +415,7 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 				ans.op = REQ_REFUSED;
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 
 			//Check for nodes without valid topic producers and unbind them
 			tc_server_ac_check_topic_unbind( req.topic_id );	
@@ -363,12 +432,14 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 			if ( !( ans.error = tc_server_ac_get_topic_prop( req.topic_id, &(ans.topic_load), &(ans.channel_size), &(ans.channel_period), &topic_addr )) ){
 				strcpy( ans.topic_addr.name_ip, topic_addr.name_ip );
 				ans.topic_addr.port = topic_addr.port; 
+				tc_server_ac_get_topic_delay( req.topic_id, &(ans.topic_delay_bound) );
+				tc_server_ac_get_topic_reliability( req.topic_id, &(ans.topic_fec_k), &(ans.topic_fec_m), &(ans.topic_retx_share) );
 			}else{
 				ans.op = REQ_REFUSED;
 			}
 			
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 	
 			break;
 
@@ -379,7 +450,7 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 				ans.op = REQ_REFUSED;
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 
 			//Check for nodes without valid topic consumers and unbind them
 			tc_server_ac_check_topic_unbind( req.topic_id );	
@@ -393,7 +464,7 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 				ans.op = REQ_REFUSED;
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );	
+			tc_server_req_answer( sock, &ans, &client, &t_answer );	
 
 			//Check for nodes with pending bind requests and bind them if possible
 			tc_server_ac_check_topic_bind( req.topic_id );
@@ -407,7 +478,7 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 				ans.op = REQ_REFUSED;
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );	
+			tc_server_req_answer( sock, &ans, &client, &t_answer );	
 
 			//Check for nodes without valid topic producers and unbind them
 			tc_server_ac_check_topic_unbind( req.topic_id );
@@ -421,7 +492,7 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 				ans.op = REQ_REFUSED;
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );	
+			tc_server_req_answer( sock, &ans, &client, &t_answer );	
 
 			//Check for nodes with pending bind requests and bind them if possible
 			tc_server_ac_check_topic_bind( req.topic_id );
@@ -435,7 +506,7 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 				ans.op = REQ_REFUSED;
 
 			//Answer request
-			tc_network_send_msg( sock, &ans, &client );	
+			tc_server_req_answer( sock, &ans, &client, &t_answer );	
 
 			//Check for nodes without valid topic consumers and unbind them
 			tc_server_ac_check_topic_unbind( req.topic_id );
@@ -447,16 +518,37 @@ static void tc_server_req_resolve( SOCK_ENTITY *sock )
 			ans.op = REQ_REFUSED;
 			ans.node_ids[0] = req.node_ids[0];
 
-			tc_network_send_msg( sock, &ans, &client );
+			tc_server_req_answer( sock, &ans, &client, &t_answer );
 			break;
 	}
 	
 	//Unlock database
 	tc_server_db_unlock();
 
+	TC_PROBE4( server_req_end, req.op, req.node_ids[0], req.topic_id, ans.error );
+
+	//Update requests counters and latency histograms
+	if ( t_answer )
+		tc_server_metrics_count_req( req.op, ans.error );
+
+	if ( req.op > 0 && req.op < N_OP_TYPES && t_answer ){
+		tc_hist_add( &req_lock_hist[req.op], t_locked - t_enter );
+		tc_hist_add( &req_ac_hist[req.op], t_answer - t_locked );
+		tc_hist_add( &req_total_hist[req.op], t_answer - t_enter );
+	}
+
 	return;
 }
 
+static void tc_server_req_answer( SOCK_ENTITY *sock, NET_MSG *ans, NET_ADDR *client, unsigned long long *ret_time )
+{
+	tc_network_send_msg( sock, ans, client );
+
+	TC_PROBE4( server_req_answer, ans->node_ids[0], ans->topic_id, ans->op, ans->error );
+
+	*ret_time = tc_time_get_us();
+}
+
 static int tc_server_comm_init( void )
 {
 	DEBUG_MSG_TC_SERVER("tc_server_comm_init() ...\n");
@@ -564,6 +656,13 @@ static int tc_server_modules_init( void )
 		tc_server_modules_close();
 		return ERR_NOTIFIC_INIT;
 	}
+
+	//Start metrics module
+	if ( tc_server_metrics_init() ) {
+		fprintf(stderr,"tc_server_modules_init() : ERROR STARTING METRICS MODULE\n");
+		tc_server_modules_close();
+		return ERR_METRICS_INIT;
+	}
 	
 	DEBUG_MSG_TC_SERVER("tc_server_modules_init() Internal modules initialized\n");
 
@@ -576,6 +675,12 @@ static int tc_server_modules_close( void )
 
 	int ret;
 
+	//Stop metrics module
+	if ( (ret = tc_server_metrics_close()) && ret != ERR_S_NOT_INIT ){
+		fprintf(stderr,"tc_server_close() : ERROR CLOSING METRICS MODULE\n");
+		return ERR_METRICS_CLOSE;
+	}
+
 	//Stop notifications module
 	if ( (ret = tc_server_notifications_close()) && ret != ERR_S_NOT_INIT ){
 		fprintf(stderr,"tc_server_close() : ERROR CLOSING NOTIFICATIONS MODULE\n");
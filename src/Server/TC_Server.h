@@ -57,4 +57,19 @@ int tc_server_init( char *ifface, unsigned int server_port );
 */
 int tc_server_close( void );
 
+/**	
+*	@brief Prints the requests latency histograms
+*
+*	Prints, for each operation type, the number of samples, mean, p50, p99, p999 and max latency (in us) of the clients requests
+*	(request received until answer sent), broken down in database lock wait and admission control processing. Also prints the latency
+*	of the server to client management requests (reservations, binds, topic updates). Histograms are also printed periodically if
+*	LATENCY_SNAPSHOT_PERIOD is set
+*
+*	@pre			None
+*
+*	@return			Upon successful return : ERR_OK (0)
+*	@return			Upon output error : An error code (<0)
+*/
+int tc_server_latency_print( void );
+
 #endif
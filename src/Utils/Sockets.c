@@ -40,6 +40,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
+#include <netinet/udp.h>
 
 #include "Sockets.h"
 #include "TC_Error_Types.h"
@@ -181,6 +182,18 @@ int sock_bind( SOCK_ENTITY *sock, NET_ADDR *host )
 	if ( sock->type == LOCAL )
 		sock->host.port = 0;
 
+	//Port chosen by the kernel
+	if ( sock->type != LOCAL && !host->port ){
+		struct sockaddr_in bound_addr;
+		socklen_t addr_len = sizeof(struct sockaddr_in);
+
+		if ( getsockname(sock->fd, (struct sockaddr*)&bound_addr, &addr_len) < 0 ){
+			perror("sock_bind() : ERROR GETTING SOCKET ADDRESS --");
+			return ERR_SOCK_BIND_HOST;
+		}
+		sock->host.port = ntohs(bound_addr.sin_port);
+	}
+
 	DEBUG_MSG_SOCKET("sock_bind() Socket bound to %s:%d\n",host->name_ip, host->port);
 
 	return ERR_OK;
@@ -456,7 +469,96 @@ int sock_send( SOCK_ENTITY *sock, NET_ADDR *dest, char *data, unsigned int data_
 	return ret;	
 }
 
+int sock_send_segmented( SOCK_ENTITY *sock, NET_ADDR *dest, char *data, unsigned int data_size, unsigned int segment_size )
+{
+	DEBUG_MSG_SOCKET("sock_send_segmented() ...\n");	
+
+	int ret = -1;
+	unsigned short gso_size = segment_size;
+	struct sockaddr_in dest_addr;
+	struct iovec iov;
+	struct msghdr msg;
+	struct cmsghdr *cmsg;
+	char control[CMSG_SPACE(sizeof(unsigned short))];
+
+	//Check if socket entity is valid
+	if ( !sock ){
+		fprintf(stderr,"sock_send_segmented() : INVALID SOCKET ENTITY\n");
+		return ERR_SOCK_ENTITY;
+	}
+
+	//Check for valid fd
+	if( sock->fd <= 0 ){
+		fprintf(stderr,"sock_send_segmented() : INVALID SOCKET FD\n");
+		return ERR_SOCK_INVALID_FD;
+	}
+
+	//Only UDP datagrams can be segmented
+	if ( sock->type != REMOTE_UDP && sock->type != REMOTE_UDP_GROUP ){
+		fprintf(stderr,"sock_send_segmented() : INVALID SOCKET TYPE\n");
+		return ERR_SOCK_TYPE;
+	}
+
+	//Check if destination adress is valid ( cant be empty if socket isnt connected to a peer )
+	if( !strcmp(sock->peer.name_ip,"") && (!dest || !strcmp(dest->name_ip,"")) ){
+		fprintf(stderr,"sock_send_segmented() : INVALID DESTINATION ADDRESS\n");
+		return ERR_INVALID_PARAM;
+	}
+
+	//Check for valid data
+	if ( !data || !data_size || !segment_size || segment_size > 0xFFFF ){
+		fprintf(stderr,"sock_send_segmented() : INVALID DATA\n");
+		return ERR_DATA_INVALID;
+	}
+
+	//Set destination address
+	memset((char *) &dest_addr, 0, sizeof(struct sockaddr_in));
+	dest_addr.sin_family = AF_INET;
+	dest_addr.sin_addr.s_addr = inet_addr(sock->peer.name_ip);
+	dest_addr.sin_port = htons(sock->peer.port);
+	if ( dest ){
+		dest_addr.sin_addr.s_addr = inet_addr(dest->name_ip);
+		dest_addr.sin_port = htons(dest->port);
+	}
+
+	iov.iov_base = data;
+	iov.iov_len = data_size;
+	memset(&msg, 0, sizeof(struct msghdr));
+	msg.msg_name = &dest_addr;
+	msg.msg_namelen = sizeof(struct sockaddr_in);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	//The kernel (or the NIC) splits the data in segment_size datagrams
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_UDP;
+	cmsg->cmsg_type = UDP_SEGMENT;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(unsigned short));
+	memcpy( CMSG_DATA(cmsg), &gso_size, sizeof(unsigned short) );
+
+	if ( (ret = sendmsg(sock->fd, &msg, 0)) < 0 ){
+		//Segmentation offload not supported (kernel older than 4.18, route or device)
+		if ( errno == EINVAL || errno == EIO || errno == ENOPROTOOPT || errno == EOPNOTSUPP ){
+			DEBUG_MSG_SOCKET("sock_send_segmented() UDP segmentation not available (errno %d)\n",errno);
+			return ERR_SOCK_OPTION;
+		}
+		perror("sock_send_segmented() : ERROR SENDING REMOTE DATA --");
+		return ERR_DATA_SEND;
+	}
+
+	DEBUG_MSG_SOCKET("sock_send_segmented() Sent %d bytes in %u bytes segments to %s:%d\n",ret,segment_size,sock->peer.name_ip,sock->peer.port);
+
+	return ret;	
+}
+
 int sock_receive( SOCK_ENTITY *sock, SOCK_ENTITY *unblock_sock, unsigned int timeout, char *ret_data, unsigned int buffer_size, NET_ADDR *ret_sender )
+{
+	return sock_receive_segmented( sock, unblock_sock, timeout, ret_data, buffer_size, ret_sender, NULL );
+}
+
+int sock_receive_segmented( SOCK_ENTITY *sock, SOCK_ENTITY *unblock_sock, unsigned int timeout, char *ret_data, unsigned int buffer_size, NET_ADDR *ret_sender, unsigned int *ret_segment_size )
 {
 	DEBUG_MSG_SOCKET("sock_receive() ...\n");	
 
@@ -532,20 +634,48 @@ int sock_receive( SOCK_ENTITY *sock, SOCK_ENTITY *unblock_sock, unsigned int tim
 			ret_sender->port = 0;
 		}
 
+		if ( ret_segment_size )
+			*ret_segment_size = 0;
+
 		DEBUG_MSG_SOCKET("sock_receive() Received %d bytes of data from local socket\n",ret);
 		return ret;	
 	}
 
 	if ( sock->type == REMOTE_UDP || sock->type == REMOTE_TCP || sock->type == REMOTE_UDP_GROUP ){
 		struct sockaddr_in sender_addr;
-		unsigned int size_sender = sizeof(struct sockaddr_in);
+		struct iovec iov;
+		struct msghdr msg;
+		struct cmsghdr *cmsg;
+		char control[CMSG_SPACE(sizeof(int))];
+		int segment_size;
+
+		iov.iov_base = ret_data;
+		iov.iov_len = b_size;
+		memset(&msg, 0, sizeof(struct msghdr));
+		msg.msg_name = &sender_addr;
+		msg.msg_namelen = sizeof(struct sockaddr_in);
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
 
 		//Received data
-		if ( (ret = recvfrom( sock->fd, ret_data, b_size, 0,(struct sockaddr*)&sender_addr, &size_sender)) < 0 ){
+		if ( (ret = recvmsg( sock->fd, &msg, 0 )) < 0 ){
 	      		perror("sock_receive() : FAILED REMOTE RECEIVE --");
 	      		return ERR_DATA_RECEIVE;
 	    	}
 
+		//Return the size of the coalesced datagrams (UDP GRO) -- 0 if a single datagram was received
+		if ( ret_segment_size ){
+			*ret_segment_size = 0;
+			for ( cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg) ){
+				if ( cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO ){
+					memcpy( &segment_size, CMSG_DATA(cmsg), sizeof(int) );
+					*ret_segment_size = segment_size;
+				}
+			}
+		}
+
 		//Return sender addr
 		if( ret_sender ){
 			strcpy(ret_sender->name_ip,inet_ntoa(sender_addr.sin_addr));
@@ -608,6 +738,63 @@ int sock_disconnect( SOCK_ENTITY *sock )
 	return ERR_OK;
 }
 
+int sock_pending( SOCK_ENTITY *sock )
+{
+	DEBUG_MSG_SOCKET("sock_pending() ...\n");	
+
+	int size = 0;
+
+	//Check if socket entity is valid
+	if ( !sock ){
+		fprintf(stderr,"sock_pending() : INVALID SOCKET ENTITY\n");
+		return ERR_SOCK_ENTITY;
+	}
+
+	//Check for valid fd
+	if( sock->fd <= 0 ){
+		fprintf(stderr,"sock_pending() : INVALID SOCKET FD\n");
+		return ERR_SOCK_INVALID_FD;
+	}
+
+	if ( ioctl( sock->fd, FIONREAD, &size ) < 0 ){
+		perror("sock_pending() : ERROR CHECKING SOCKET QUEUE --");
+		return ERR_DATA_RECEIVE;
+	}
+
+	return size;
+}
+
+int sock_set_gro( SOCK_ENTITY *sock, int enable )
+{
+	DEBUG_MSG_SOCKET("sock_set_gro() ...\n");	
+
+	//Check if socket entity is valid
+	if ( !sock ){
+		fprintf(stderr,"sock_set_gro() : INVALID SOCKET ENTITY\n");
+		return ERR_SOCK_ENTITY;
+	}
+
+	//Check for valid fd
+	if( sock->fd <= 0 ){
+		fprintf(stderr,"sock_set_gro() : INVALID SOCKET FD\n");
+		return ERR_SOCK_INVALID_FD;
+	}
+
+	//Only UDP datagrams can be coalesced
+	if ( sock->type != REMOTE_UDP && sock->type != REMOTE_UDP_GROUP ){
+		fprintf(stderr,"sock_set_gro() : INVALID SOCKET TYPE\n");
+		return ERR_SOCK_TYPE;
+	}
+
+	if ( setsockopt( sock->fd, SOL_UDP, UDP_GRO, &enable, sizeof(int) ) < 0 ){
+		//Kernel older than 5.0 -> datagrams are received one by one
+		DEBUG_MSG_SOCKET("sock_set_gro() UDP GRO not available (errno %d)\n",errno);
+		return ERR_SOCK_OPTION;
+	}
+
+	return ERR_OK;
+}
+
 int sock_close ( SOCK_ENTITY *sock )
 {
 	DEBUG_MSG_SOCKET("sock_close() ...\n");
@@ -37,6 +37,19 @@
 //#define MIN_PORT 1024 //In unix only users with root can use sockets binded to port number below 1024
 //#define MAX_PORT 65535
 
+/** 	@def UDP_SEGMENT_MAX
+*	@brief Maximum number of datagrams sent in one UDP segmentation offload call (kernel limit)
+*/
+#define UDP_SEGMENT_MAX 64
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
 /** 	@def MC_TTL
 *	@brief Multicast time to live
 */
@@ -69,7 +82,7 @@ int sock_open( SOCK_ENTITY *ret_sock, char type );
 *	Binds a socket to the host address
 *
 *	@param[in] sock		The socket to be bound. Must not be a NULL pointer
-*	@param[in] host 	The host adress to bind to. Must not  be a NULL pointer
+*	@param[in] host 	The host adress to bind to. Must not  be a NULL pointer. If the port is 0 the kernel chooses one (stored in the socket host address)
 *
 *	@pre			None
 *
@@ -151,6 +164,25 @@ int sock_connect_group_tx( SOCK_ENTITY *sock, NET_ADDR *peer );
 */	
 int sock_send( SOCK_ENTITY *sock, NET_ADDR *dest, char *data, unsigned int data_size );
 
+/**	
+*	@brief Sends data split in several datagrams in one call
+*
+*	Sends data through an UDP socket as consecutive datagrams of \a segment_size bytes (the last one may be shorter) using the UDP segmentation
+*	offload (GSO), so the data is split by the kernel or the NIC instead of one system call per datagram
+*
+*	@param[in] sock		The socket to send the data through. Must not be a NULL pointer
+*	@param[in] dest 	The multicast group adress to connect to. Can be a NULL pointer if socket is connected to a peer
+*	@param[in] data 	The buffer with the data to be sent. Must not  be a NULL pointer
+*	@param[in] data_size 	The size of data (in bytes). At most UDP_SEGMENT_MAX segments and 65507 bytes
+*	@param[in] segment_size The size of each datagram (in bytes). Must be greater than 0
+*
+*	@pre			None
+*
+*	@return 		Upon successful return : The number of sent bytes
+*	@return 		Upon output error : An error code (<0). ERR_SOCK_OPTION if the UDP segmentation offload is not available
+*/	
+int sock_send_segmented( SOCK_ENTITY *sock, NET_ADDR *dest, char *data, unsigned int data_size, unsigned int segment_size );
+
 /**	
 *	@brief Receives data from a socket
 *
@@ -173,6 +205,58 @@ int sock_send( SOCK_ENTITY *sock, NET_ADDR *dest, char *data, unsigned int data_
 */	
 int sock_receive( SOCK_ENTITY *sock, SOCK_ENTITY *unblock_sock, unsigned int timeout, char *ret_data, unsigned int buff_size, NET_ADDR *ret_sender );
 
+/**	
+*	@brief Receives data from a socket with coalesced datagrams
+*
+*	Same as sock_receive. If UDP GRO is enabled on the socket (sock_set_gro) several consecutive datagrams of the same sender can be received
+*	at once : all with \a ret_segment_size bytes except the last one, which may be shorter
+*
+*	@param[in] sock		The socket to receive the data from. Must not be a NULL pointer
+*	@param[in] unblock_sock The socket from where to receive an unblock signal. Optional (can be a NULL pointer)
+*	@param[in] timeout 	The maximum time interval (in ms) to wait for data. If 0 blocks indefinitely. Must be equal or greater than 0
+*	@param[out] ret_data 	The buffer to store the received data. Must not  be a NULL pointer
+*	@param[in] buff_size 	The size of the data buffer. Must be greater than 0 else a default size is considered (DEFAULT_MAX_SIZE)
+*	@param[out] ret_sender 	The buffer to store the address of the sender. Optional (can be a NULL pointer)
+*	@param[out] ret_segment_size The buffer to store the size of the coalesced datagrams (0 if a single datagram was received). Optional (can be a NULL pointer)
+*
+*	@pre			None
+*
+*	@return 		Upon successful return : The number of received bytes
+*	@return 		Upon output error : An error code (<0)
+*/	
+int sock_receive_segmented( SOCK_ENTITY *sock, SOCK_ENTITY *unblock_sock, unsigned int timeout, char *ret_data, unsigned int buff_size, NET_ADDR *ret_sender, unsigned int *ret_segment_size );
+
+/**	
+*	@brief Checks for data waiting in a socket
+*
+*	Returns the size of the data waiting to be received in the socket (for datagram sockets the size of the next datagram) without blocking
+*
+*	@param[in] sock		The socket to be checked. Must not be a NULL pointer
+*
+*	@pre			None
+*
+*	@return 		Upon successful return : The number of bytes waiting (0 if none)
+*	@return 		Upon output error : An error code (<0)
+*/	
+int sock_pending( SOCK_ENTITY *sock );
+
+/**	
+*	@brief Enables the coalesced reception of datagrams
+*
+*	Enables (or disables) UDP GRO on a socket : consecutive datagrams of the same sender may be received at once with sock_receive_segmented
+*
+*	@param[in] sock		The socket. Must not be a NULL pointer
+*	@param[in] enable	1 to enable, 0 to disable
+*
+*	@pre			None
+*
+*	@return 		Upon successful return : ERR_OK
+*	@return 		Upon output error : An error code (<0). ERR_SOCK_OPTION if UDP GRO is not available
+*
+*	@note			Sockets with UDP GRO enabled must be read with sock_receive_segmented
+*/	
+int sock_set_gro( SOCK_ENTITY *sock, int enable );
+
 /**	
 *	@brief Disconnects a socket from the peer
 *
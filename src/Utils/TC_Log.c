@@ -0,0 +1,286 @@
+/*This file is part of LTCNM (Linux Traffic Control Network Manager).
+
+    LTCNM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LTCNM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LTCNM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**	@file TC_Log.c
+*	@brief Logging source code
+*
+*	This file contains the implementation of the logging functions. Producers reserve a ring buffer slot with a compare-and-swap
+*	on the head index and publish it through the slot sequence number (bounded multi-producer queue); the writer thread is the
+*	only consumer
+*
+*	@bug No known bugs
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "TC_Log.h"
+#include "TC_Utils.h"
+#include "TC_Config.h"
+#include "TC_Error_Types.h"
+
+/**
+* A log ring buffer slot
+*/
+typedef struct log_slot{
+
+	unsigned long seq;		/**< The slot sequence number (slot free for position seq, or holding position seq-1 message) */
+	unsigned char module;		/**< The message module */
+	unsigned char level;		/**< The message level */
+	struct timespec time;		/**< The message time (wall clock) */
+	char msg[LOG_MSG_SIZE];		/**< The formatted message */
+
+}LOG_SLOT;
+
+static const char *level_names[] = { "ERROR", "WARN", "INFO", "DEBUG" };
+static const char *module_names[N_LOG_MODULES] = { "CLIENT", "CLIENT_DB", "CLIENT_MANAGEMENT", "CLIENT_MONIT", "CLIENT_RESERV",
+						"SERVER", "SERVER_DB", "SERVER_AC", "SERVER_MANAGEMENT", "SERVER_MONIT" };
+
+static char log_levels[N_LOG_MODULES] = { [0 ... N_LOG_MODULES-1] = LOG_DEFAULT_LEVEL };
+
+static LOG_SLOT ring[LOG_RING_SIZE];
+static unsigned long ring_head;
+static unsigned long ring_tail;
+static unsigned long long dropped;
+
+static char running = 0;
+//Producers between checking running and publishing their slot (tc_log_close waits for them before the last drain)
+static unsigned int n_writers = 0;
+//The slots sequence numbers are set once - the ring is left empty and consistent by tc_log_close
+static char ring_ready = 0;
+static unsigned int n_refs = 0;
+static pthread_mutex_t refs_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static char quit = 0;
+static pthread_t writer_thread_id;
+static pthread_mutex_t writer_lock;
+
+//Writes all the published messages
+static void tc_log_drain( void );
+
+//Writes one message
+static void tc_log_write( int module, int level, struct timespec *time, const char *msg );
+
+//Periodically drains the ring buffer
+static void tc_log_writer_thread( void );
+
+int tc_log_init( void )
+{
+	unsigned long i;
+
+	pthread_mutex_lock( &refs_lock );
+
+	if ( n_refs++ ){
+		pthread_mutex_unlock( &refs_lock );
+		return ERR_OK;
+	}
+
+	if ( !ring_ready ){
+		for ( i = 0; i < LOG_RING_SIZE; i++ )
+			ring[i].seq = i;
+
+		ring_head = ring_tail = 0;
+		ring_ready = 1;
+	}
+
+	if ( tc_thread_create( tc_log_writer_thread, &writer_thread_id, &quit, &writer_lock, 100 ) ){
+		fprintf(stderr,"tc_log_init() : ERROR CREATING WRITER THREAD\n");
+		n_refs = 0;
+		pthread_mutex_unlock( &refs_lock );
+		return ERR_THREAD_CREATE;
+	}
+
+	__atomic_store_n( &running, 1, __ATOMIC_RELEASE );
+
+	pthread_mutex_unlock( &refs_lock );
+
+	return ERR_OK;
+}
+
+int tc_log_close( void )
+{
+	pthread_mutex_lock( &refs_lock );
+
+	if ( !n_refs ){
+		pthread_mutex_unlock( &refs_lock );
+		return ERR_S_NOT_INIT;
+	}
+
+	if ( --n_refs ){
+		pthread_mutex_unlock( &refs_lock );
+		return ERR_OK;
+	}
+
+	//New messages are written synchronously
+	__atomic_store_n( &running, 0, __ATOMIC_SEQ_CST );
+
+	tc_thread_destroy( &writer_thread_id, &quit, &writer_lock, 100 );
+
+	//Wait for the producers that saw the logger running to publish their slots
+	while ( __atomic_load_n( &n_writers, __ATOMIC_SEQ_CST ) )
+		usleep( 100 );
+
+	//Write messages left by the writer thread
+	tc_log_drain();
+
+	pthread_mutex_unlock( &refs_lock );
+
+	return ERR_OK;
+}
+
+int tc_log_set_level( int module, int level )
+{
+	int i;
+
+	if ( module < LOG_ALL || module >= N_LOG_MODULES || level < LOG_ERROR || level > LOG_DEBUG ){
+		fprintf(stderr,"tc_log_set_level() : INVALID MODULE %d OR LEVEL %d\n",module,level);
+		return ERR_INVALID_PARAM;
+	}
+
+	for ( i = 0; i < N_LOG_MODULES; i++ ){
+		if ( module == LOG_ALL || module == i )
+			__atomic_store_n( &log_levels[i], level, __ATOMIC_RELAXED );
+	}
+
+	return ERR_OK;
+}
+
+int tc_log_enabled( int module, int level )
+{
+	return ( module >= 0 && module < N_LOG_MODULES && level <= __atomic_load_n( &log_levels[module], __ATOMIC_RELAXED ) );
+}
+
+void tc_log( int module, int level, const char *format, ... )
+{
+	LOG_SLOT *slot;
+	unsigned long pos, seq;
+	va_list args;
+	char msg[LOG_MSG_SIZE];
+	struct timespec now;
+
+	if ( !tc_log_enabled( module, level ) )
+		return;
+
+	//Pairs with the running store in tc_log_close : either this message is seen as in-flight or it is written synchronously
+	__atomic_add_fetch( &n_writers, 1, __ATOMIC_SEQ_CST );
+
+	if ( !__atomic_load_n( &running, __ATOMIC_SEQ_CST ) ){
+		__atomic_sub_fetch( &n_writers, 1, __ATOMIC_RELEASE );
+
+		//Logger not running - write synchronously
+		va_start( args, format );
+		vsnprintf( msg, sizeof(msg), format, args );
+		va_end( args );
+
+		clock_gettime( CLOCK_REALTIME, &now );
+		tc_log_write( module, level, &now, msg );
+		return;
+	}
+
+	//Reserve a slot
+	pos = __atomic_load_n( &ring_head, __ATOMIC_RELAXED );
+	for ( ;; ){
+		slot = &ring[pos & (LOG_RING_SIZE-1)];
+		seq = __atomic_load_n( &slot->seq, __ATOMIC_ACQUIRE );
+
+		if ( seq == pos ){
+			if ( __atomic_compare_exchange_n( &ring_head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+				break;
+		}else if ( (long)(seq - pos) < 0 ){
+			//Ring buffer full
+			__atomic_add_fetch( &dropped, 1, __ATOMIC_RELAXED );
+			__atomic_sub_fetch( &n_writers, 1, __ATOMIC_RELEASE );
+			return;
+		}else{
+			pos = __atomic_load_n( &ring_head, __ATOMIC_RELAXED );
+		}
+	}
+
+	slot->module = module;
+	slot->level = level;
+	clock_gettime( CLOCK_REALTIME, &slot->time );
+
+	va_start( args, format );
+	vsnprintf( slot->msg, LOG_MSG_SIZE, format, args );
+	va_end( args );
+
+	//Publish it
+	__atomic_store_n( &slot->seq, pos + 1, __ATOMIC_RELEASE );
+
+	__atomic_sub_fetch( &n_writers, 1, __ATOMIC_RELEASE );
+}
+
+unsigned long long tc_log_get_dropped( void )
+{
+	return __atomic_load_n( &dropped, __ATOMIC_RELAXED );
+}
+
+static void tc_log_write( int module, int level, struct timespec *time, const char *msg )
+{
+	FILE *out = ( level <= LOG_WARN ) ? stderr : stdout;
+	size_t len = strlen( msg );
+
+	fprintf(out,"%ld.%06ld %s %s : %s%s",(long)time->tv_sec,time->tv_nsec/1000,level_names[level],module_names[module],msg,( len && msg[len-1] == '\n' ) ? "" : "\n");
+}
+
+static void tc_log_drain( void )
+{
+	LOG_SLOT *slot;
+	char written = 0;
+
+	for ( ;; ){
+		slot = &ring[ring_tail & (LOG_RING_SIZE-1)];
+
+		if ( __atomic_load_n( &slot->seq, __ATOMIC_ACQUIRE ) != ring_tail + 1 )
+			break;
+
+		tc_log_write( slot->module, slot->level, &slot->time, slot->msg );
+		written = 1;
+
+		//Free the slot for the next lap
+		__atomic_store_n( &slot->seq, ring_tail + LOG_RING_SIZE, __ATOMIC_RELEASE );
+		ring_tail++;
+	}
+
+	if ( written ){
+		fflush( stdout );
+		fflush( stderr );
+	}
+}
+
+static void tc_log_writer_thread( void )
+{
+	pthread_mutex_lock( &writer_lock );
+
+	while ( quit == THREAD_RUN ){
+
+		//Keep a slot consistent if canceled by tc_thread_destroy
+		pthread_setcancelstate( PTHREAD_CANCEL_DISABLE, NULL );
+		tc_log_drain();
+		pthread_setcancelstate( PTHREAD_CANCEL_ENABLE, NULL );
+
+		usleep( LOG_FLUSH_PERIOD );
+	}
+
+	pthread_mutex_unlock( &writer_lock );
+
+	pthread_exit(NULL);
+}
@@ -0,0 +1,71 @@
+/*This file is part of LTCNM (Linux Traffic Control Network Manager).
+
+    LTCNM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LTCNM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LTCNM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**	@file TC_Probes.h
+*	@brief Static tracepoints macros
+*
+*	This file contains the macros placing the USDT probes (provider "ltcnm") on the client and server hot paths. The probes are listed with
+*	'readelf -n liblinux_tc.a' and attached with bpftrace or perf (e.g. bpftrace -e 'usdt:./TC_API.test:ltcnm:frag_send { @[arg0] = count(); }').
+*	If ENABLE_USDT_PROBES is 0, or the sys/sdt.h header is not available, the probes are compiled out and their arguments are not evaluated
+*
+*	Probes :
+*	- frag_send, frag_receive (topic_id, this node_id, frag_seq, frag_size, msg_size)
+*	- frag_stale (topic_id, this node_id, frag_seq)
+*	- server_req_start (op, node_id, topic_id, channel_size) / server_req_answer (node_id, topic_id, answer op, error) /
+*	  server_req_end (op, node_id, topic_id, error -- after the bind/unbind checks that follow the answer)
+*	- server_mng_req_start (op, node_id, topic_id, load) / server_mng_req_end (op, node_id, topic_id, error)
+*	- server_multi_op_start (op, topic_id, n_nodes) / server_multi_op_end (op, topic_id, n_nodes, n_not_accepted, n_refused)
+*	- client_mng_req_start (op, node_id, topic_id, load) / client_mng_req_end (op, node_id, topic_id, error)
+*	- client_tc_cmd_start (tc object 'q'/'c'/'f', operation, command string) / client_tc_cmd_end (tc object, operation, system() return)
+*	- client_heartbeat_tick (node_id), server_heartbeat_tick (node_id), server_heartbeat_tock (n_nodes, n_expired)
+*
+*	@bug No known bugs
+*/
+
+#ifndef TCPROBES_H
+#define TCPROBES_H
+
+#include "TC_Config.h"
+
+#if ENABLE_USDT_PROBES && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define TC_PROBES_ON 1
+#endif
+#endif
+
+#ifdef TC_PROBES_ON
+
+/**	@def TC_PROBEn(NAME,...)
+*	@brief Places the USDT probe ltcnm:NAME with n arguments
+*/
+#define TC_PROBE1(NAME,A1) DTRACE_PROBE1(ltcnm,NAME,A1)
+#define TC_PROBE2(NAME,A1,A2) DTRACE_PROBE2(ltcnm,NAME,A1,A2)
+#define TC_PROBE3(NAME,A1,A2,A3) DTRACE_PROBE3(ltcnm,NAME,A1,A2,A3)
+#define TC_PROBE4(NAME,A1,A2,A3,A4) DTRACE_PROBE4(ltcnm,NAME,A1,A2,A3,A4)
+#define TC_PROBE5(NAME,A1,A2,A3,A4,A5) DTRACE_PROBE5(ltcnm,NAME,A1,A2,A3,A4,A5)
+
+#else
+
+#define TC_PROBE1(NAME,A1) do{}while(0)
+#define TC_PROBE2(NAME,A1,A2) do{}while(0)
+#define TC_PROBE3(NAME,A1,A2,A3) do{}while(0)
+#define TC_PROBE4(NAME,A1,A2,A3,A4) do{}while(0)
+#define TC_PROBE5(NAME,A1,A2,A3,A4,A5) do{}while(0)
+
+#endif
+
+#endif
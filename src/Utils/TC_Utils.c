@@ -26,6 +26,9 @@
 *	@date 31/12/2012
 */
 
+//pthread_mutex_clocklock()
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -40,6 +43,8 @@
 #include <sys/ioctl.h>
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
+#include <time.h>
 
 #include "Sockets.h"
 #include "TC_Data_Types.h"
@@ -55,6 +60,18 @@
 
 static int net_msg_set_host_to_network(  NET_MSG *msg, NET_MSG *ret_msg );
 static int net_msg_set_network_to_host( NET_MSG *msg, NET_MSG *ret_msg );
+static unsigned int tc_hist_bucket_index( unsigned int value );
+static unsigned int tc_hist_bucket_max( unsigned int index );
+static void tc_fec_gf_init( void );
+static unsigned char tc_fec_coef( unsigned int parity, unsigned int data );
+static void tc_fec_mul_add( unsigned char *dst, unsigned char *src, unsigned char coef, unsigned int size );
+static void tc_fec_scale( unsigned char *dst, unsigned char coef, unsigned int size );
+
+//GF(2^8) tables (polynomial 0x11d)
+static unsigned char gf_exp[512];
+static unsigned char gf_log[256];
+static unsigned char gf_mul[256][256];
+static pthread_once_t gf_once = PTHREAD_ONCE_INIT;
 
 int tc_network_send_msg( SOCK_ENTITY *sock, NET_MSG *msg, NET_ADDR *peer )
 {
@@ -140,11 +157,300 @@ int tc_network_get_nic_ip( char *ifface , char *ret_ip )
 	return ERR_OK;
 }
 
+int tc_network_get_nic_speed( char *ifface , unsigned int *ret_speed )
+{
+	DEBUG_MSG_TC_UTILS("tc_network_get_nic_speed() ...\n");
+
+	FILE *fp;
+	char path[100];
+	int speed = -1;
+
+	assert( ifface );
+	assert( ret_speed );
+
+	snprintf(path, sizeof(path), "/sys/class/net/%s/speed", ifface);
+
+	if ( !(fp = fopen(path, "r")) ){
+		fprintf(stderr,"tc_network_get_nic_speed() : ERROR OPENING %s\n",path);
+		return ERR_INVALID_NIC;
+	}
+
+	//Reading fails or returns -1 when the link is down or the NIC doesn't report a speed
+	if ( fscanf(fp, "%d", &speed) != 1 || speed <= 0 ){
+		fclose(fp);
+		DEBUG_MSG_TC_UTILS("tc_network_get_nic_speed() NIC %s doesn't report a link speed\n",ifface);
+		return ERR_INVALID_NIC;
+	}
+
+	fclose(fp);
+
+	*ret_speed = (unsigned int) speed;
+
+	DEBUG_MSG_TC_UTILS("tc_network_get_nic_speed() NIC %s link speed is %u mbps\n",ifface,*ret_speed);
+
+	return ERR_OK;
+}
+
+unsigned int tc_fec_wire_size( unsigned int msg_size, unsigned int fec_k, unsigned int fec_m )
+{
+	unsigned int payload, n_frags, n_parity;
+
+	if ( !fec_k || !msg_size )
+		return msg_size;
+
+	payload = ( msg_size < FEC_FRAG_PAYLOAD ) ? msg_size : FEC_FRAG_PAYLOAD;
+	n_frags = ( msg_size + payload - 1 ) / payload;
+
+	//Full blocks plus the last (maybe shorter) one
+	n_parity = ( (n_frags - 1) / fec_k ) * fec_m;
+	n_parity = n_parity + ( ((n_frags - 1) % fec_k + 1 < fec_m) ? (n_frags - 1) % fec_k + 1 : fec_m );
+
+	return ( n_frags + n_parity ) * payload;
+}
+
+void tc_fec_encode( unsigned int fec_k, unsigned int fec_m, unsigned int frag_size, unsigned char *data, unsigned int data_size, unsigned char *ret_parity )
+{
+	unsigned int i, j, len;
+
+	assert( fec_k && fec_m && fec_k + fec_m <= FEC_MAX_BLOCK );
+	assert( data );
+	assert( ret_parity );
+
+	pthread_once( &gf_once, tc_fec_gf_init );
+
+	memset( ret_parity, 0, fec_m * frag_size );
+
+	//Padding bytes are 0 and add nothing to the parity
+	for ( i = 0; i < fec_k && i * frag_size < data_size; i++ ){
+		len = ( data_size - i * frag_size < frag_size ) ? data_size - i * frag_size : frag_size;
+		for ( j = 0; j < fec_m; j++ )
+			tc_fec_mul_add( ret_parity + j * frag_size, data + i * frag_size, tc_fec_coef( j, i ), len );
+	}
+}
+
+int tc_fec_decode( unsigned int fec_k, unsigned int fec_m, unsigned int frag_size, unsigned char *data, unsigned long long have_data, unsigned char *parity, unsigned long long have_parity )
+{
+	unsigned char matrix[FEC_MAX_BLOCK][FEC_MAX_BLOCK], *rows[FEC_MAX_BLOCK], *aux_row, aux, coef;
+	unsigned int missing[FEC_MAX_BLOCK];
+	unsigned int n_missing, n_rows, i, j, a, b, c;
+
+	assert( fec_k && fec_m && fec_k + fec_m <= FEC_MAX_BLOCK );
+	assert( data );
+	assert( parity );
+
+	pthread_once( &gf_once, tc_fec_gf_init );
+
+	for ( n_missing = 0, i = 0; i < fec_k; i++ ){
+		if ( !(have_data & (1ULL << i)) )
+			missing[n_missing++] = i;
+	}
+
+	if ( !n_missing )
+		return ERR_OK;
+
+	//Each received parity fragment minus the received data contribution (syndrome) is a linear combination of the missing data fragments
+	for ( n_rows = 0, j = 0; j < fec_m && n_rows < n_missing; j++ ){
+		if ( !(have_parity & (1ULL << j)) )
+			continue;
+
+		rows[n_rows] = parity + j * frag_size;
+		for ( i = 0; i < fec_k; i++ ){
+			if ( have_data & (1ULL << i) )
+				tc_fec_mul_add( rows[n_rows], data + i * frag_size, tc_fec_coef( j, i ), frag_size );
+		}
+		for ( b = 0; b < n_missing; b++ )
+			matrix[n_rows][b] = tc_fec_coef( j, missing[b] );
+		n_rows++;
+	}
+
+	if ( n_rows < n_missing ){
+		DEBUG_MSG_TC_UTILS("tc_fec_decode() %u data fragments missing with %u parity fragments received\n",n_missing,n_rows);
+		return ERR_DATA_INVALID;
+	}
+
+	//Gauss-Jordan elimination (any square Cauchy submatrix is invertible)
+	for ( c = 0; c < n_missing; c++ ){
+		for ( a = c; !matrix[a][c]; a++ );
+
+		if ( a != c ){
+			for ( b = 0; b < n_missing; b++ ){
+				aux = matrix[a][b];
+				matrix[a][b] = matrix[c][b];
+				matrix[c][b] = aux;
+			}
+			aux_row = rows[a];
+			rows[a] = rows[c];
+			rows[c] = aux_row;
+		}
+
+		coef = gf_exp[255 - gf_log[matrix[c][c]]];
+		for ( b = 0; b < n_missing; b++ )
+			matrix[c][b] = gf_mul[matrix[c][b]][coef];
+		tc_fec_scale( rows[c], coef, frag_size );
+
+		for ( a = 0; a < n_missing; a++ ){
+			if ( a == c || !(coef = matrix[a][c]) )
+				continue;
+			for ( b = 0; b < n_missing; b++ )
+				matrix[a][b] ^= gf_mul[matrix[c][b]][coef];
+			tc_fec_mul_add( rows[a], rows[c], coef, frag_size );
+		}
+	}
+
+	for ( a = 0; a < n_missing; a++ )
+		memcpy( data + missing[a] * frag_size, rows[a], frag_size );
+
+	return ERR_OK;
+}
+
+unsigned long long tc_time_get_us( void )
+{
+	struct timespec now;
+
+	clock_gettime( CLOCK_MONOTONIC, &now );
+
+	return (unsigned long long)now.tv_sec * 1000000ULL + now.tv_nsec / 1000;
+}
+
+unsigned long long tc_time_deadline( unsigned int timeout )
+{
+	if ( !timeout )
+		return 0;
+
+	return tc_time_get_us() + timeout * 1000ULL;
+}
+
+unsigned int tc_time_left_ms( unsigned long long deadline )
+{
+	unsigned long long now = tc_time_get_us();
+
+	if ( now >= deadline )
+		return 0;
+
+	return ( deadline - now + 999 ) / 1000;
+}
+
+void tc_time_to_timespec( unsigned long long time, struct timespec *ret_time )
+{
+	assert( ret_time );
+
+	ret_time->tv_sec = time / 1000000ULL;
+	ret_time->tv_nsec = ( time % 1000000ULL ) * 1000;
+}
+
+int tc_mutex_lock_until( pthread_mutex_t *mutex, unsigned long long deadline )
+{
+	struct timespec abs_time;
+	int ret;
+
+	assert( mutex );
+
+	if ( !deadline ){
+		ret = pthread_mutex_lock( mutex );
+	}else{
+		tc_time_to_timespec( deadline, &abs_time );
+		ret = pthread_mutex_clocklock( mutex, CLOCK_MONOTONIC, &abs_time );
+	}
+
+	switch ( ret ){
+		case 0:
+			return ERR_OK;
+		case EOWNERDEAD:
+			fprintf(stderr,"tc_mutex_lock_until() : PREVIOUS HOLDING THREAD TERMINATED WHILE HOLDING MUTEX LOCK\n");
+			pthread_mutex_consistent( mutex );
+			return ERR_OK;
+		case ETIMEDOUT:
+			return ERR_LOCK_TIMEOUT;
+		case EDEADLK:
+			fprintf(stderr,"tc_mutex_lock_until() : CURRENT THREAD ALREADY OWNS THE MUTEX\n");
+			return ERR_LOCK;
+		default:
+			fprintf(stderr,"tc_mutex_lock_until() : ERROR LOCKING MUTEX (%d)\n",ret);
+			return ERR_LOCK;
+	}
+}
+
+void tc_hist_add( TC_HIST *hist, unsigned int value )
+{
+	unsigned int max;
+
+	assert( hist );
+
+	__atomic_fetch_add( &hist->buckets[tc_hist_bucket_index(value)], 1, __ATOMIC_RELAXED );
+	__atomic_fetch_add( &hist->count, 1, __ATOMIC_RELAXED );
+	__atomic_fetch_add( &hist->sum, value, __ATOMIC_RELAXED );
+
+	max = __atomic_load_n( &hist->max, __ATOMIC_RELAXED );
+	while ( value > max && !__atomic_compare_exchange_n( &hist->max, &max, value, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) );
+}
+
+unsigned int tc_hist_get_percentile( TC_HIST *hist, double percentile )
+{
+	unsigned int i;
+	unsigned long long count, target, acc = 0;
+
+	assert( hist );
+
+	if ( !(count = __atomic_load_n( &hist->count, __ATOMIC_RELAXED )) )
+		return 0;
+
+	//Number of samples at or below the percentile (at least one)
+	target = CEILING( count * percentile / 100.0 );
+	if ( !target )
+		target = 1;
+
+	for ( i = 0; i < HIST_N_BUCKETS; i++ ){
+		acc = acc + __atomic_load_n( &hist->buckets[i], __ATOMIC_RELAXED );
+		if ( acc >= target )
+			break;
+	}
+
+	if ( i == HIST_N_BUCKETS )
+		return __atomic_load_n( &hist->max, __ATOMIC_RELAXED );
+
+	return tc_hist_bucket_max( i );
+}
+
+void tc_hist_print( char *label, TC_HIST *hist )
+{
+	unsigned long long count;
+
+	assert( label );
+	assert( hist );
+
+	if ( !(count = __atomic_load_n( &hist->count, __ATOMIC_RELAXED )) )
+		return;
+
+	printf("%s n %llu mean %llu p50 %u p99 %u p999 %u max %u [us]\n",label,count,__atomic_load_n( &hist->sum, __ATOMIC_RELAXED )/count,
+		tc_hist_get_percentile( hist, 50 ),tc_hist_get_percentile( hist, 99 ),tc_hist_get_percentile( hist, 99.9 ),
+		__atomic_load_n( &hist->max, __ATOMIC_RELAXED ));
+}
+
+void tc_hist_op_print( char *title, TC_HIST hist[] )
+{
+	int op;
+
+	assert( title );
+	assert( hist );
+
+	printf("%s\n",title);
+
+	for ( op = 1; op < N_OP_TYPES; op++ ){
+		if ( !__atomic_load_n( &hist[op].count, __ATOMIC_RELAXED ) )
+			continue;
+
+		printf("  ");
+		tc_op_type_print( op );
+		tc_hist_print( "   ", &hist[op] );
+	}
+}
+
 int tc_thread_create( void *thread_call, pthread_t *ret_thread_id, char *ret_quit_flag, pthread_mutex_t *ret_thread_lock, unsigned int timeout )
 {
 	DEBUG_MSG_TC_UTILS("tc_thread_create() ...\n");
 
-	int tries = timeout;
+	unsigned long long deadline;
+	char timed_out = 0;
 
 	assert( thread_call );
 	assert( ret_thread_id );
@@ -167,15 +473,20 @@ int tc_thread_create( void *thread_call, pthread_t *ret_thread_id, char *ret_qui
 			return ERR_THREAD_CREATE;
 		}
 
-		//Wait until thread locks mutex
-		while ( !pthread_mutex_trylock( ret_thread_lock) && (tries >= 0) ){
+		//Wait until thread locks mutex -- Yield to the new thread instead of sleeping a fixed interval
+		deadline = tc_time_get_us() + timeout * 1000ULL;
+
+		while ( !pthread_mutex_trylock( ret_thread_lock) ){
 			//Mutex wasn't locked by thread -> thread not running yet
 			pthread_mutex_unlock( ret_thread_lock );
-			usleep(1000);
-			tries--;
+			if ( tc_time_get_us() >= deadline ){
+				timed_out = 1;
+				break;
+			}
+			sched_yield();
 		}
 
-		if ( tries < 0 ){
+		if ( timed_out ){
 			fprintf(stderr,"tc_thread_create() : TIMEDOUT WAITING FOR THREAD TO LOCK MUTEX -- GOING TO DESTROY IT\n");
 			*ret_quit_flag = THREAD_STOP;
 			pthread_cancel( *ret_thread_id );
@@ -200,8 +511,6 @@ int tc_thread_destroy( pthread_t *thread_id, char *quit_flag, pthread_mutex_t *t
 {
 	DEBUG_MSG_TC_UTILS("tc_thread_destroy() ...\n");
 
-	struct timespec wait;
-
 	assert( thread_id );
 	assert( quit_flag );
 
@@ -211,13 +520,12 @@ int tc_thread_destroy( pthread_t *thread_id, char *quit_flag, pthread_mutex_t *t
 	if ( thread_lock ){
 		//Thread has feedback mutex
 
-		//Wait for thread to end -> if time expires kill it	
-		memset(&wait,0, sizeof(struct timespec));
-		wait.tv_nsec = timeout*1000000;
-
-		if ( pthread_mutex_timedlock( thread_lock, &wait ) ){
+		//Wait for thread to end -> if time expires kill it
+		if ( tc_mutex_lock_until( thread_lock, tc_time_get_us() + timeout * 1000ULL ) ){
 			fprintf(stderr,"tc_thread_destroy() : TIME-OUT WAITING FOR THREAD TO END\n");
 			pthread_cancel( *thread_id );	
+		}else{
+			pthread_mutex_unlock( thread_lock );
 		}
 
 		//Destroys mutex
@@ -275,13 +583,21 @@ static int net_msg_set_host_to_network( NET_MSG *msg, NET_MSG *ret_msg )
 		ret_msg->node_ids[i] = (unsigned int) htonl(msg->node_ids[i]);
 	}
 	ret_msg->n_nodes	= (unsigned int) htonl(msg->n_nodes);
+	ret_msg->link_bw	= (unsigned int) htonl(msg->link_bw);
+	ret_msg->link_background_share = (unsigned int) htonl(msg->link_background_share);
+	ret_msg->link_control_share = (unsigned int) htonl(msg->link_control_share);
 
 	ret_msg->topic_id 	= (unsigned int) htonl(msg->topic_id);
 	memcpy(ret_msg->topic_addr.name_ip,msg->topic_addr.name_ip,sizeof(msg->topic_addr.name_ip));
 	ret_msg->topic_addr.port= (unsigned int) htonl(msg->topic_addr.port);
 	ret_msg->topic_load 	= (unsigned int) htonl(msg->topic_load);
+	ret_msg->topic_burst 	= (unsigned int) htonl(msg->topic_burst);
 	ret_msg->channel_size 	= (unsigned int) htonl(msg->channel_size);
 	ret_msg->channel_period = (unsigned int) htonl(msg->channel_period);
+	ret_msg->topic_delay_bound = (unsigned int) htonl(msg->topic_delay_bound);
+	ret_msg->topic_fec_k = (unsigned int) htonl(msg->topic_fec_k);
+	ret_msg->topic_fec_m = (unsigned int) htonl(msg->topic_fec_m);
+	ret_msg->topic_retx_share = (unsigned int) htonl(msg->topic_retx_share);
 
 	DEBUG_MSG_TC_UTILS("client_ac_req_set_host_to_network() Returning 0\n");
 
@@ -306,16 +622,111 @@ static int net_msg_set_network_to_host( NET_MSG *msg, NET_MSG *ret_msg )
 		ret_msg->node_ids[i] = (unsigned int) ntohl(msg->node_ids[i]);
 	}
 	ret_msg->n_nodes	= (unsigned int) ntohl(msg->n_nodes);
+	ret_msg->link_bw	= (unsigned int) ntohl(msg->link_bw);
+	ret_msg->link_background_share = (unsigned int) ntohl(msg->link_background_share);
+	ret_msg->link_control_share = (unsigned int) ntohl(msg->link_control_share);
 
 	ret_msg->topic_id 	= (unsigned int) ntohl(msg->topic_id);
 	memcpy(ret_msg->topic_addr.name_ip,msg->topic_addr.name_ip,sizeof(msg->topic_addr.name_ip));
 	ret_msg->topic_addr.port= (unsigned int) ntohl(msg->topic_addr.port);
 	ret_msg->topic_load 	= (unsigned int) ntohl(msg->topic_load);
+	ret_msg->topic_burst 	= (unsigned int) ntohl(msg->topic_burst);
 	ret_msg->channel_size 	= (unsigned int) ntohl(msg->channel_size);
 	ret_msg->channel_period = (unsigned int) ntohl(msg->channel_period);
+	ret_msg->topic_delay_bound = (unsigned int) ntohl(msg->topic_delay_bound);
+	ret_msg->topic_fec_k = (unsigned int) ntohl(msg->topic_fec_k);
+	ret_msg->topic_fec_m = (unsigned int) ntohl(msg->topic_fec_m);
+	ret_msg->topic_retx_share = (unsigned int) ntohl(msg->topic_retx_share);
 
 
 	DEBUG_MSG_TC_UTILS("client_ac_req_set_network_to_host() Returning 0\n");
 
 	return ERR_OK;
 }
+
+static unsigned int tc_hist_bucket_index( unsigned int value )
+{
+	unsigned int shift;
+
+	//Values below HIST_SUB_COUNT have one bucket each
+	if ( value < HIST_SUB_COUNT )
+		return value;
+
+	//Other values : HIST_SUB_COUNT linear buckets per power of 2 (keep the HIST_SUB_BITS most significant bits)
+	shift = (31 - __builtin_clz(value)) - HIST_SUB_BITS;
+
+	return (shift + 1) * HIST_SUB_COUNT + ((value >> shift) - HIST_SUB_COUNT);
+}
+
+static unsigned int tc_hist_bucket_max( unsigned int index )
+{
+	unsigned int shift;
+
+	if ( index < HIST_SUB_COUNT )
+		return index;
+
+	shift = index / HIST_SUB_COUNT - 1;
+
+	return ((((index % HIST_SUB_COUNT) + HIST_SUB_COUNT) << shift) - 1) + (1u << shift);
+}
+
+static void tc_fec_gf_init( void )
+{
+	unsigned int i, j, x;
+
+	for ( i = 0, x = 1; i < 255; i++ ){
+		gf_exp[i] = gf_exp[i + 255] = x;
+		gf_log[x] = i;
+		x = x << 1;
+		if ( x & 0x100 )
+			x = x ^ 0x11d;
+	}
+
+	for ( i = 1; i < 256; i++ ){
+		for ( j = 1; j < 256; j++ )
+			gf_mul[i][j] = gf_exp[gf_log[i] + gf_log[j]];
+	}
+}
+
+static unsigned char tc_fec_coef( unsigned int parity, unsigned int data )
+{
+	unsigned int log_coef;
+
+	//Cauchy matrix c(j,i) = 1/(x_j + y_i) with x_j = 255 - j and y_i = i (distinct while fec_k + fec_m <= FEC_MAX_BLOCK <= 128), with rows and columns
+	//scaled to c(j,i) * c(0,0) / (c(0,i) * c(j,0)) so the first parity fragment is the XOR of the data fragments (scaling keeps any k fragments decodable)
+	log_coef = 4 * 255 - gf_log[(255 - parity) ^ data] - gf_log[255] + gf_log[255 ^ data] + gf_log[(255 - parity)];
+
+	return gf_exp[log_coef % 255];
+}
+
+static void tc_fec_mul_add( unsigned char *dst, unsigned char *src, unsigned char coef, unsigned int size )
+{
+	unsigned char *row = gf_mul[coef];
+	unsigned int i = 0;
+
+	if ( coef == 1 ){
+		//Plain XOR -- 8 bytes at a time if aligned
+		if ( !(((unsigned long)dst | (unsigned long)src) & 7) ){
+			for ( ; i + 8 <= size; i = i + 8 )
+				*(unsigned long long *)(dst + i) ^= *(unsigned long long *)(src + i);
+		}
+		for ( ; i < size; i++ )
+			dst[i] ^= src[i];
+		return;
+	}
+
+	for ( ; i < size; i++ )
+		dst[i] ^= row[src[i]];
+}
+
+static void tc_fec_scale( unsigned char *dst, unsigned char coef, unsigned int size )
+{
+	unsigned char *row = gf_mul[coef];
+	unsigned int i;
+
+	if ( coef == 1 )
+		return;
+
+	for ( i = 0; i < size; i++ )
+		dst[i] = row[dst[i]];
+}
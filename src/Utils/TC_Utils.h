@@ -29,6 +29,9 @@
 #ifndef TCUTILS_H
 #define TCUTILS_H
 
+#include <pthread.h>
+#include <time.h>
+
 #include "TC_Data_Types.h"
 
 /**	@def CEILING(X)
@@ -99,6 +102,189 @@ int tc_network_get_msg( SOCK_ENTITY *sock, unsigned int timeout, NET_MSG *ret_ms
 */
 int tc_network_get_nic_ip( char *ifface , char *ret_ip );
 
+/**	
+*	@brief Retrives the NICs link speed
+*
+*	Reads the NIC negotiated link speed from sysfs (/sys/class/net/<ifface>/speed)
+*
+*	@param[in] ifface		The NIC name. Must not be a NULL pointer
+*	@param[out] ret_speed		The buffer to store the NICs link speed (in mbps). Must not be a NULL pointer
+*
+*	@pre				assert(ifface);
+*	@pre				assert(ret_speed);
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : An error code (<0)
+*
+*	@note				Virtual NICs (I.E. loopback, bridges, some VM NICs) don't report a speed. In that case ERR_INVALID_NIC is returned
+*/
+int tc_network_get_nic_speed( char *ifface , unsigned int *ret_speed );
+
+/**	
+*	@brief Computes the network size of a FEC protected message
+*
+*	A message is split in fragments of min(FEC_FRAG_PAYLOAD, msg_size) bytes (the last one padded) sent in blocks of \a fec_k data fragments
+*	followed by \a fec_m parity fragments -- the last block has as many parity fragments as data fragments if shorter than fec_m
+*
+*	@param[in] msg_size		The message size (in bytes)
+*	@param[in] fec_k		The FEC block data fragments. If 0 the message is not FEC protected
+*	@param[in] fec_m		The FEC block parity fragments
+*
+*	@pre				None
+*
+*	@return 			The size (in bytes, headers not included) of the message data and parity fragments
+*/
+unsigned int tc_fec_wire_size( unsigned int msg_size, unsigned int fec_k, unsigned int fec_m );
+
+/**	
+*	@brief Computes the parity fragments of a FEC block
+*
+*	Systematic Reed-Solomon code over GF(2^8) (Cauchy matrix) -- any \a fec_k of the block \a fec_k + \a fec_m fragments rebuild the block data
+*
+*	@param[in] fec_k		The block data fragments. Must be greater than 0
+*	@param[in] fec_m		The block parity fragments. Must be greater than 0 and fec_k + fec_m <= FEC_MAX_BLOCK
+*	@param[in] frag_size		The size (in bytes) of each fragment. Must be greater than 0
+*	@param[in] data			The block data. Must not be a NULL pointer
+*	@param[in] data_size		The block data size (in bytes). Bytes past data_size up to fec_k * frag_size are taken as 0 (padding)
+*	@param[out] ret_parity		The buffer (fec_m * frag_size bytes) to store the block parity fragments. Must not be a NULL pointer
+*
+*	@pre				assert( fec_k && fec_m && fec_k + fec_m <= FEC_MAX_BLOCK );
+*	@pre				assert( data );
+*	@pre				assert( ret_parity );
+*
+*	@return 			None
+*/
+void tc_fec_encode( unsigned int fec_k, unsigned int fec_m, unsigned int frag_size, unsigned char *data, unsigned int data_size, unsigned char *ret_parity );
+
+/**	
+*	@brief Rebuilds the missing data fragments of a FEC block
+*
+*	The missing data fragments are rebuilt from the received ones and from as many received parity fragments (see tc_fec_encode)
+*
+*	@param[in] fec_k		The block data fragments. Must be greater than 0
+*	@param[in] fec_m		The block parity fragments. Must be greater than 0 and fec_k + fec_m <= FEC_MAX_BLOCK
+*	@param[in] frag_size		The size (in bytes) of each fragment. Must be greater than 0
+*	@param[in,out] data		The block data (fec_k * frag_size bytes) -- the missing fragments are written in place. Must not be a NULL pointer
+*	@param[in] have_data		The received data fragments (bit i set if data fragment i was received)
+*	@param[in,out] parity		The block parity fragments (fec_m * frag_size bytes) -- used as scratch. Must not be a NULL pointer
+*	@param[in] have_parity		The received parity fragments (bit j set if parity fragment j was received)
+*
+*	@pre				assert( fec_k && fec_m && fec_k + fec_m <= FEC_MAX_BLOCK );
+*	@pre				assert( data );
+*	@pre				assert( parity );
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : ERR_DATA_INVALID if less than fec_k fragments were received
+*/
+int tc_fec_decode( unsigned int fec_k, unsigned int fec_m, unsigned int frag_size, unsigned char *data, unsigned long long have_data, unsigned char *parity, unsigned long long have_parity );
+
+/**	
+*	@brief Gets the current monotonic time
+*
+*	@pre				None
+*
+*	@return 			The current monotonic time (in us)
+*/
+unsigned long long tc_time_get_us( void );
+
+/**	
+*	@brief Computes an absolute deadline
+*
+*	@param[in] timeout		The time interval (in ms) from now. If 0 there is no deadline
+*
+*	@pre				None
+*
+*	@return 			The deadline in tc_time_get_us() time (in us). 0 if timeout is 0 (no deadline)
+*/
+unsigned long long tc_time_deadline( unsigned int timeout );
+
+/**	
+*	@brief Gets the time left until a deadline
+*
+*	@param[in] deadline		The deadline in tc_time_get_us() time (in us). Must be greater than 0
+*
+*	@pre				None
+*
+*	@return 			The time left (in ms, rounded up). 0 if the deadline has expired
+*/
+unsigned int tc_time_left_ms( unsigned long long deadline );
+
+/**	
+*	@brief Converts a tc_time_get_us() time to a CLOCK_MONOTONIC timespec
+*
+*	@param[in] time			The time (in us)
+*	@param[out] ret_time		The buffer to store the converted time. Must not be a NULL pointer
+*
+*	@pre				assert( ret_time );
+*/
+void tc_time_to_timespec( unsigned long long time, struct timespec *ret_time );
+
+/**	
+*	@brief Locks a mutex until a deadline
+*
+*	Blocks on the mutex until it is acquired or the absolute deadline expires (CLOCK_MONOTONIC, not affected by wall clock changes).
+*	If the previous owner of a robust mutex died while holding it, the mutex is made consistent and acquired
+*
+*	@param[in] mutex		The mutex to lock. Must not be a NULL pointer
+*	@param[in] deadline		The deadline in tc_time_get_us() time (in us). If 0 blocks indefinitely
+*
+*	@pre				assert( mutex );
+*
+*	@return 			Upon successful return : ERR_OK (0)
+*	@return 			Upon output error : ERR_LOCK_TIMEOUT if the deadline expired or other error code (<0)
+*/
+int tc_mutex_lock_until( pthread_mutex_t *mutex, unsigned long long deadline );
+
+/**	
+*	@brief Adds a sample to a latency histogram
+*
+*	Adds the sample to the bucket covering its value (relaxed atomics -- several threads may add samples to the same histogram)
+*
+*	@param[in] hist			The histogram. Must not be a NULL pointer
+*	@param[in] value		The sample value (in us)
+*
+*	@pre				assert( hist );
+*/
+void tc_hist_add( TC_HIST *hist, unsigned int value );
+
+/**	
+*	@brief Gets a percentile from a latency histogram
+*
+*	@param[in] hist			The histogram. Must not be a NULL pointer
+*	@param[in] percentile		The percentile (0 to 100)
+*
+*	@pre				assert( hist );
+*
+*	@return 			The highest value of the bucket holding the percentile (0 if histogram is empty)
+*/
+unsigned int tc_hist_get_percentile( TC_HIST *hist, double percentile );
+
+/**	
+*	@brief Prints a latency histogram summary
+*
+*	Prints the number of samples, mean, p50, p99, p999 and max values in one line. Nothing is printed if the histogram is empty
+*
+*	@param[in] label		The label to print before the summary. Must not be a NULL pointer
+*	@param[in] hist			The histogram. Must not be a NULL pointer
+*
+*	@pre				assert( label );
+*	@pre				assert( hist );
+*/
+void tc_hist_print( char *label, TC_HIST *hist );
+
+/**	
+*	@brief Prints the summary of a set of latency histograms indexed by operation code
+*
+*	Calls tc_hist_print for each non empty histogram, labelled with the operation code name
+*
+*	@param[in] title		The title of the set. Must not be a NULL pointer
+*	@param[in] hist		The array of N_OP_TYPES histograms. Must not be a NULL pointer
+*
+*	@pre				assert( title );
+*	@pre				assert( hist );
+*/
+void tc_hist_op_print( char *title, TC_HIST hist[] );
+
 /**	
 *	@brief Creates a thread
 *
@@ -0,0 +1,803 @@
+/*This file is part of LTCNM (Linux Traffic Control Network Manager).
+
+    LTCNM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LTCNM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LTCNM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**	@file TC_Bench.c
+*	@brief Source code for the data path throughput and latency benchmark
+*
+*	This file contains a benchmark of the client send/receive path. For each point of the sweep (message size x number of topics x
+*	producers per topic x consumers per topic) topics are created with the message size and the given period, producers send timestamped
+*	messages for a fixed duration and consumers measure the one-way latency of each received message.
+*	Two setups are supported : loopback (server and one client node in a single process, producers are threads of that node) and
+*	multi-process (server, producer and consumer nodes in separate processes of this host).
+*	One result line is printed per sweep point (CSV or JSON lines) with msgs/s, MB/s, p50/p99 latency, fragment loss and CPU per message.
+*	Run './TC_Bench.test -h' in a terminal for the options.
+*
+*	@bug No known bugs
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <getopt.h>             /* getopt_long() */
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "TC_Client.h"
+#include "TC_Server.h"
+#include "TC_Error_Types.h"
+#include "TC_Log.h"
+
+#define BENCH_MAX_LIST		16		//Maximum number of values per swept parameter
+#define BENCH_MAX_TOPICS	64		//Maximum number of topics per sweep point
+#define BENCH_MAX_NODES		64		//Maximum number of producer/consumer nodes (processes) per topic
+#define BENCH_MAX_SAMPLES	(1<<20)		//Maximum number of latency samples per node
+#define BENCH_BIND_TIMEOUT	5000		//Bind timeout (ms)
+#define BENCH_RX_TIMEOUT	100		//Receive timeout (ms) - consumers check for the end of the run
+#define BENCH_DRAIN		500		//Time (ms) consumers keep receiving after producers stop
+#define BENCH_SERVER_START	1		//Time (s) to wait for the server to start (multi-process setup)
+
+#define ROLE_PRODUCER	0x01
+#define ROLE_CONSUMER	0x02
+
+/**
+* The header of each benchmark message (rest of the message is padding)
+*/
+typedef struct{
+	unsigned long long send_time;	/**< Send time (CLOCK_REALTIME, ns) */
+	unsigned int producer;		/**< Producer node ID */
+	unsigned int seq;		/**< Producer message sequence number */
+}BENCH_MSG;
+
+/**
+* The results of a node for a sweep point (sent to the parent process followed by the latency samples)
+*/
+typedef struct{
+	char ok;				/**< Node ran the sweep point */
+	char role;				/**< Node role (ROLE_PRODUCER / ROLE_CONSUMER) */
+	unsigned long long msgs_sent;		/**< Messages sent */
+	unsigned long long bytes_sent;		/**< Bytes sent */
+	unsigned long long frags_sent;		/**< Fragments sent */
+	unsigned long long send_errors;		/**< Failed send calls */
+	unsigned long long msgs_received;	/**< Messages received */
+	unsigned long long bytes_received;	/**< Bytes received */
+	unsigned long long frags_received;	/**< Fragments received */
+	unsigned long long stale_frags;		/**< Discarded old fragments */
+	unsigned long long reasm_timeouts;	/**< Messages lost on reassembly */
+	unsigned long long receive_errors;	/**< Failed receive calls */
+	unsigned long long cpu_time;		/**< Process CPU time (user + system, us) during the run */
+	unsigned int n_samples;			/**< Number of latency samples following */
+}BENCH_RESULT;
+
+//Options
+static char ifface[10] = "lo";
+static int server_port = 5000;
+static char mode = 'l';
+static char json = 0;
+static int duration = 5;
+static unsigned int period = 1;
+static int interval = -1;
+static int sizes[BENCH_MAX_LIST] = { 64, 1400, 32000, 65000, 65536, 131072, 262144 };
+static int n_sizes = 7;
+static int topics[BENCH_MAX_LIST] = { 1 };
+static int n_topics = 1;
+static int producers[BENCH_MAX_LIST] = { 1 };
+static int n_producers = 1;
+static int consumers[BENCH_MAX_LIST] = { 1 };
+static int n_consumers = 1;
+
+//Current sweep point (node processes)
+static unsigned int topic_base;
+static int msg_size;
+static int n_topic;
+static unsigned long long t_end;
+static unsigned int node_id;
+static unsigned int *samples;
+static unsigned int n_samples;
+
+static volatile sig_atomic_t quit = 0;
+
+static void sigfun( int sig );
+static int parse_list( char *arg, int *list, int max );
+static unsigned long long bench_time_ns( clockid_t clock );
+static void *producer( void *arg );
+static void *consumer( void *arg );
+static void *binder_rx( void *arg );
+static void *binder_tx( void *arg );
+static void bench_node( char role, int n_threads, int ready_fd, int go_fd, int res_fd );
+static pid_t bench_server_start( void );
+static void bench_server_stop( pid_t pid );
+static int bench_point( int point, int size, int n_t, int n_p, int n_c );
+static int cmp_uint( const void *a, const void *b );
+static int read_full( int fd, void *buf, size_t len );
+
+static const char short_options[] = "i:m:s:t:p:c:d:P:r:jh";
+static const struct option long_options[] = {
+	{ "interface", 				required_argument, 	NULL, 	'i' },
+	{ "mode", 				required_argument, 	NULL, 	'm' },
+	{ "sizes", 				required_argument, 	NULL, 	's' },
+	{ "topics", 				required_argument, 	NULL, 	't' },
+	{ "producers", 				required_argument, 	NULL, 	'p' },
+	{ "consumers", 				required_argument, 	NULL, 	'c' },
+	{ "duration", 				required_argument, 	NULL, 	'd' },
+	{ "period", 				required_argument, 	NULL, 	'P' },
+	{ "rate", 				required_argument, 	NULL, 	'r' },
+	{ "json", 				no_argument, 		NULL, 	'j' },
+	{ "help", 				no_argument, 		NULL, 	'h' },
+	{ 0, 0, 0, 0 }
+};
+
+static void usage(FILE * fp, char ** argv) {
+	fprintf(fp,
+			"\nUsage: %s [options]\n\n"
+			"Options:\n"
+			"-i | --interface	NIC interface to be used 					(default lo)\n"
+			"-m | --mode		Loopback[l]/Multi-process[p]					(default l)\n"
+			"-s | --sizes		Message sizes in bytes (comma separated list)			(default 64,1400,32000,65000,65536,131072,262144)\n"
+			"-t | --topics		Number of topics (comma separated list)				(default 1)\n"
+			"-p | --producers	Producers per topic (comma separated list)			(default 1)\n"
+			"-c | --consumers	Consumers per topic (comma separated list)			(default 1)\n"
+			"-d | --duration	Duration of each sweep point in s				(default 5)\n"
+			"-P | --period		Topics period in ms						(default 1)\n"
+			"-r | --rate		Interval between messages of each producer in us (0 -> flood)	(default topic period)\n"
+			"-j | --json		Print JSON lines instead of CSV\n"
+			"-h | --help		Print this message\n"
+			"\nThe sweep runs every combination of the listed values. Messages bigger than D_MTU are fragmented.\n"
+			"Loopback mode runs the server and one client node in a single process (producers are threads, one consumer per topic).\n"
+			"Multi-process mode runs the server and each producer/consumer node in its own process (one thread per topic).\n"
+			"Results are printed to stdout, one line per sweep point. CPU per message is the CPU time of the producer (consumer) nodes\n"
+			"divided by the messages sent (received) -- in loopback mode both include the server and the other side.\n"
+			"\nExample - sizes around D_MTU with 1 and 4 topics, 2 consumers per topic, JSON output\n"
+			"'./TC_Bench.test -m p -s 60000,65536,131072 -t 1,4 -c 2 -j > results.json'\n\n"
+			"", argv[0]);
+	return;
+}
+
+int main (int argc, char* argv[])
+{
+	int c,index;
+	int i,j,k,l;
+	int point = 0;
+	pid_t server = 0;
+
+	while ( (c = getopt_long(argc, argv, short_options, long_options, &index)) != -1 ){
+
+		switch (c) {
+			case 0: /* getopt_long() flag */
+				break;
+
+			case 'i':
+				strncpy(ifface,optarg,sizeof(ifface)-1);
+				break;
+
+			case 'm':
+				if( strcmp(optarg,"l") && strcmp(optarg,"p") ){
+					fprintf(stderr,"Invalid value for option --mode -> Loopback[l]/Multi-process[p]\n");
+					return -1;
+				}
+				mode = optarg[0];
+				break;
+
+			case 's':
+				if ( (n_sizes = parse_list( optarg, sizes, BENCH_MAX_LIST )) < 0 )
+					return -1;
+				break;
+
+			case 't':
+				if ( (n_topics = parse_list( optarg, topics, BENCH_MAX_LIST )) < 0 )
+					return -1;
+				break;
+
+			case 'p':
+				if ( (n_producers = parse_list( optarg, producers, BENCH_MAX_LIST )) < 0 )
+					return -1;
+				break;
+
+			case 'c':
+				if ( (n_consumers = parse_list( optarg, consumers, BENCH_MAX_LIST )) < 0 )
+					return -1;
+				break;
+
+			case 'd':
+				duration = atoi(optarg);
+				break;
+
+			case 'P':
+				period = atoi(optarg);
+				break;
+
+			case 'r':
+				interval = atoi(optarg);
+				break;
+
+			case 'j':
+				json = 1;
+				break;
+
+			case 'h':
+				usage(stdout, argv);
+				return 0;
+
+			default:
+				usage(stderr, argv);
+				return -1;
+		}
+	}
+
+	if ( duration <= 0 || !period ){
+		fprintf(stderr,"Invalid duration or period\n");
+		return -1;
+	}
+
+	if ( interval < 0 )
+		interval = period * 1000;
+
+	(void) signal(SIGINT, sigfun);
+	(void) signal(SIGPIPE, SIG_IGN);
+
+	//Multi-process setup -- one server for the whole sweep
+	if ( mode == 'p' && !(server = bench_server_start()) )
+		return -2;
+
+	if ( !json ){
+		printf("mode,size,topics,producers,consumers,period_ms,interval_us,duration_s,msgs_sent,msgs_received,msgs_s,mb_s,"
+			"frags_per_msg,lat_p50_us,lat_p99_us,lat_max_us,frag_loss,reasm_timeouts,stale_frags,send_errors,"
+			"cpu_tx_us_msg,cpu_rx_us_msg,status\n");
+		fflush(stdout);
+	}
+
+	for ( i = 0; i < n_sizes && !quit; i++ )
+		for ( j = 0; j < n_topics && !quit; j++ )
+			for ( k = 0; k < n_producers && !quit; k++ )
+				for ( l = 0; l < n_consumers && !quit; l++ )
+					bench_point( point++, sizes[i], topics[j], producers[k], consumers[l] );
+
+	if ( server )
+		bench_server_stop( server );
+
+	return 0;
+}
+
+static void sigfun( int sig )
+{
+	//Stop the sweep after the current point
+	quit = 1;
+}
+
+static int parse_list( char *arg, int *list, int max )
+{
+	int n = 0;
+	char *tok, *save = NULL;
+
+	for ( tok = strtok_r( arg, ",", &save ); tok; tok = strtok_r( NULL, ",", &save ) ){
+
+		if ( n == max || (list[n] = atoi(tok)) <= 0 ){
+			fprintf(stderr,"Invalid list '%s' (up to %d values greater than 0)\n",arg,max);
+			return -1;
+		}
+		n++;
+	}
+
+	return n;
+}
+
+static unsigned long long bench_time_ns( clockid_t clock )
+{
+	struct timespec now;
+
+	clock_gettime( clock, &now );
+
+	return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static int cmp_uint( const void *a, const void *b )
+{
+	unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+
+	return ( x > y ) - ( x < y );
+}
+
+static int read_full( int fd, void *buf, size_t len )
+{
+	ssize_t r;
+
+	//Big results arrive in several pipe reads
+	while ( len ){
+		if ( (r = read( fd, buf, len )) <= 0 ){
+			if ( r < 0 && errno == EINTR )
+				continue;
+			return -1;
+		}
+		buf = (char *)buf + r;
+		len -= r;
+	}
+
+	return 0;
+}
+
+static pid_t bench_server_start( void )
+{
+	pid_t pid;
+	int ret;
+
+	if ( (pid = fork()) < 0 ){
+		fprintf(stderr,"bench_server_start() : ERROR FORKING SERVER PROCESS\n");
+		return 0;
+	}
+
+	if ( !pid ){
+		(void) signal(SIGTERM, sigfun);
+		tc_log_set_level( LOG_ALL, LOG_WARN );
+
+		if ( (ret = tc_server_init( ifface, server_port )) ){
+			fprintf(stderr,"Error initializing server\n");
+			tc_error_print( ret );
+			_exit(2);
+		}
+
+		while ( !quit )
+			pause();
+
+		tc_server_close();
+		_exit(0);
+	}
+
+	sleep( BENCH_SERVER_START );
+
+	return pid;
+}
+
+static void bench_server_stop( pid_t pid )
+{
+	kill( pid, SIGTERM );
+	waitpid( pid, NULL, 0 );
+}
+
+static void *producer( void *arg )
+{
+	unsigned int topic_id = *(unsigned int *)arg;
+	TC_TOPIC_HANDLE *topic;
+	char *buffer;
+	BENCH_MSG *msg;
+	struct timespec next;
+	int err;
+
+	if ( tc_client_topic_open( topic_id, &topic ) ){
+		fprintf(stderr,"producer() : ERROR OPENING TOPIC ID %u\n",topic_id);
+		return NULL;
+	}
+
+	if ( !(buffer = calloc( 1, msg_size )) ){
+		fprintf(stderr,"producer() : NOT ENOUGH MEMORY\n");
+		tc_client_topic_close( topic );
+		return NULL;
+	}
+
+	msg = (BENCH_MSG *)buffer;
+	msg->producer = node_id;
+
+	clock_gettime( CLOCK_MONOTONIC, &next );
+
+	while ( bench_time_ns( CLOCK_MONOTONIC ) < t_end ){
+
+		msg->send_time = bench_time_ns( CLOCK_REALTIME );
+
+		if ( (err = tc_client_handle_send( topic, buffer, msg_size )) < 0 ){
+			if ( err == ERR_TOPIC_CLOSING || err == ERR_TOPIC_IN_UPDATE )
+				usleep(1000);
+		}
+
+		msg->seq++;
+
+		if ( interval ){
+			next.tv_nsec += interval * 1000L;
+			while ( next.tv_nsec >= 1000000000L ){
+				next.tv_nsec -= 1000000000L;
+				next.tv_sec++;
+			}
+			clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL );
+		}
+	}
+
+	free( buffer );
+	tc_client_topic_close( topic );
+
+	return NULL;
+}
+
+static void *consumer( void *arg )
+{
+	unsigned int topic_id = *(unsigned int *)arg;
+	TC_TOPIC_HANDLE *topic;
+	char *buffer;
+	BENCH_MSG msg;
+	unsigned long long now;
+	unsigned int i;
+	int len;
+
+	if ( tc_client_topic_open( topic_id, &topic ) ){
+		fprintf(stderr,"consumer() : ERROR OPENING TOPIC ID %u\n",topic_id);
+		return NULL;
+	}
+
+	//Receive buffer must hold the topic size
+	if ( !(buffer = malloc( msg_size )) ){
+		fprintf(stderr,"consumer() : NOT ENOUGH MEMORY\n");
+		tc_client_topic_close( topic );
+		return NULL;
+	}
+
+	while ( bench_time_ns( CLOCK_MONOTONIC ) < t_end + BENCH_DRAIN * 1000000ULL ){
+
+		if ( (len = tc_client_handle_receive( topic, BENCH_RX_TIMEOUT, buffer )) < (int)sizeof(BENCH_MSG) )
+			continue;
+
+		now = bench_time_ns( CLOCK_REALTIME );
+		memcpy( &msg, buffer, sizeof(BENCH_MSG) );
+
+		if ( (i = __atomic_fetch_add( &n_samples, 1, __ATOMIC_RELAXED )) < BENCH_MAX_SAMPLES )
+			samples[i] = ( now > msg.send_time ) ? (unsigned int)((now - msg.send_time) / 1000) : 0;
+	}
+
+	free( buffer );
+	tc_client_topic_close( topic );
+
+	return NULL;
+}
+
+static void *binder_rx( void *arg )
+{
+	return (void *)(long) tc_client_bind_rx( *(unsigned int *)arg, BENCH_BIND_TIMEOUT );
+}
+
+static void *binder_tx( void *arg )
+{
+	return (void *)(long) tc_client_bind_tx( *(unsigned int *)arg, BENCH_BIND_TIMEOUT );
+}
+
+static void bench_node( char role, int n_threads, int ready_fd, int go_fd, int res_fd )
+{
+	BENCH_RESULT res;
+	TC_TOPIC_STATS stats;
+	struct rusage r_start, r_end;
+	pthread_t threads[BENCH_MAX_TOPICS * (BENCH_MAX_NODES + 1)];
+	unsigned int ids[BENCH_MAX_TOPICS];
+	int n = 0, i, j, ret;
+	void *bind_ret;
+	char c;
+
+	memset( &res, 0, sizeof(BENCH_RESULT) );
+	res.role = role;
+	n_samples = 0;
+
+	tc_log_set_level( LOG_ALL, LOG_WARN );
+
+	if ( (ret = tc_client_init( ifface, 0 )) <= 0 ){
+		fprintf(stderr,"Error initializing node\n");
+		tc_error_print( ret );
+		goto fail;
+	}
+
+	node_id = (unsigned int) ret;
+
+	//Registered -- parent starts the next node
+	c = 1;
+	if ( write( ready_fd, &c, 1 ) != 1 )
+		goto fail_close;
+
+	if ( (role & ROLE_CONSUMER) && !(samples = malloc( BENCH_MAX_SAMPLES * sizeof(unsigned int) )) ){
+		fprintf(stderr,"bench_node() : NOT ENOUGH MEMORY\n");
+		goto fail_close;
+	}
+
+	for ( i = 0; i < n_topic; i++ ){
+		ids[i] = topic_base + i;
+
+		tc_client_topic_create( ids[i], msg_size, period );
+
+		if ( ( (role & ROLE_CONSUMER) && (ret = tc_client_register_rx( ids[i] )) ) ||
+		     ( (role & ROLE_PRODUCER) && (ret = tc_client_register_tx( ids[i] )) ) ){
+			fprintf(stderr,"Error registering in topic %u\n",ids[i]);
+			tc_error_print( ret );
+			goto fail_close;
+		}
+	}
+
+	//Binds only complete when the topic has a producer and a consumer bound -- bind all in parallel
+	for ( i = 0; i < n_topic; i++ ){
+		if ( (role & ROLE_CONSUMER) && !pthread_create( &threads[n], NULL, binder_rx, &ids[i] ) )
+			n++;
+
+		if ( (role & ROLE_PRODUCER) && !pthread_create( &threads[n], NULL, binder_tx, &ids[i] ) )
+			n++;
+	}
+
+	for ( i = 0, ret = 0; i < n; i++ ){
+		pthread_join( threads[i], &bind_ret );
+		if ( bind_ret )
+			ret = (int)(long) bind_ret;
+	}
+
+	if ( ret || n < n_topic * ( 1 + ( role == (ROLE_PRODUCER | ROLE_CONSUMER) ) ) ){
+		fprintf(stderr,"Error binding to topics\n");
+		tc_error_print( ret );
+		goto fail_close;
+	}
+
+	n = 0;
+
+	//Ready -- wait for all the nodes (parent closes the go pipe)
+	c = 1;
+	if ( write( ready_fd, &c, 1 ) != 1 || read( go_fd, &c, 1 ) != 0 )
+		goto fail_close;
+
+	getrusage( RUSAGE_SELF, &r_start );
+	t_end = bench_time_ns( CLOCK_MONOTONIC ) + duration * 1000000000ULL;
+
+	for ( i = 0; i < n_topic; i++ ){
+		if ( role & ROLE_CONSUMER )
+			if ( !pthread_create( &threads[n], NULL, consumer, &ids[i] ) )
+				n++;
+
+		if ( role & ROLE_PRODUCER )
+			for ( j = 0; j < n_threads; j++ )
+				if ( !pthread_create( &threads[n], NULL, producer, &ids[i] ) )
+					n++;
+	}
+
+	for ( i = 0; i < n; i++ )
+		pthread_join( threads[i], NULL );
+
+	getrusage( RUSAGE_SELF, &r_end );
+
+	res.cpu_time = (r_end.ru_utime.tv_sec - r_start.ru_utime.tv_sec + r_end.ru_stime.tv_sec - r_start.ru_stime.tv_sec) * 1000000LL
+			+ (r_end.ru_utime.tv_usec - r_start.ru_utime.tv_usec + r_end.ru_stime.tv_usec - r_start.ru_stime.tv_usec);
+
+	for ( i = 0; i < n_topic; i++ ){
+		if ( tc_client_topic_get_stats( ids[i], &stats ) )
+			continue;
+
+		res.msgs_sent += stats.msgs_sent;
+		res.bytes_sent += stats.bytes_sent;
+		res.frags_sent += stats.frags_sent;
+		res.send_errors += stats.send_errors;
+		res.msgs_received += stats.msgs_received;
+		res.bytes_received += stats.bytes_received;
+		res.frags_received += stats.frags_received;
+		res.stale_frags += stats.stale_frags;
+		res.reasm_timeouts += stats.reasm_timeouts;
+		res.receive_errors += stats.receive_errors;
+	}
+
+	res.ok = 1;
+	res.n_samples = ( n_samples < BENCH_MAX_SAMPLES ) ? n_samples : BENCH_MAX_SAMPLES;
+
+	if ( write( res_fd, &res, sizeof(BENCH_RESULT) ) != sizeof(BENCH_RESULT) ||
+	     ( res.n_samples && write( res_fd, samples, res.n_samples * sizeof(unsigned int) ) != (ssize_t)(res.n_samples * sizeof(unsigned int)) ) )
+		fprintf(stderr,"bench_node() : ERROR WRITING RESULTS\n");
+
+	free( samples );
+	tc_client_close();
+	return;
+
+fail_close:
+	free( samples );
+	tc_client_close();
+fail:
+	//Unblock the parent
+	c = 0;
+	if ( write( ready_fd, &c, 1 ) ){}
+	return;
+}
+
+static int bench_point( int point, int size, int n_t, int n_p, int n_c )
+{
+	pid_t pids[2*BENCH_MAX_NODES];
+	int res_fds[2*BENCH_MAX_NODES];
+	int ready[2], go[2], res[2];
+	int n_nodes, n = 0, i, ret;
+	char c, failed = 0;
+	BENCH_RESULT node, total;
+	unsigned int *all = NULL, n_all = 0, *tmp;
+	unsigned long long cpu_tx = 0, cpu_rx = 0, expected;
+	double elapsed, frag_loss = 0;
+	unsigned int p50 = 0, p99 = 0, max = 0;
+
+	if ( size < (int)sizeof(BENCH_MSG) || n_t > BENCH_MAX_TOPICS || n_p > BENCH_MAX_NODES || n_c > BENCH_MAX_NODES ){
+		fprintf(stderr,"Skipping size %d topics %d producers %d consumers %d : out of range\n",size,n_t,n_p,n_c);
+		return -1;
+	}
+
+	if ( mode == 'l' && n_c > 1 ){
+		fprintf(stderr,"Skipping %d consumers per topic : loopback mode runs one consumer per topic\n",n_c);
+		return -1;
+	}
+
+	//Fresh topic IDs for each point
+	topic_base = point * BENCH_MAX_TOPICS + 1;
+	msg_size = size;
+	n_topic = n_t;
+
+	n_nodes = ( mode == 'l' ) ? 1 : n_p + n_c;
+
+	if ( pipe(ready) || pipe(go) ){
+		fprintf(stderr,"bench_point() : ERROR CREATING PIPES\n");
+		return -1;
+	}
+
+	for ( i = 0; i < n_nodes; i++ ){
+
+		if ( pipe(res) ){
+			fprintf(stderr,"bench_point() : ERROR CREATING PIPES\n");
+			break;
+		}
+
+		if ( (pids[i] = fork()) < 0 ){
+			fprintf(stderr,"bench_point() : ERROR FORKING NODE PROCESS\n");
+			close(res[0]);
+			close(res[1]);
+			break;
+		}
+
+		if ( !pids[i] ){
+			//Node process -- CTRL+C stops the sweep, not the running point
+			(void) signal(SIGINT, SIG_IGN);
+			close(ready[0]);
+			close(go[1]);
+			close(res[0]);
+			while ( n-- )
+				close(res_fds[n]);
+
+			if ( mode == 'l' ){
+				tc_log_set_level( LOG_ALL, LOG_WARN );
+				if ( (ret = tc_server_init( ifface, server_port )) ){
+					fprintf(stderr,"Error initializing server\n");
+					tc_error_print( ret );
+					c = 0;
+					if ( write( ready[1], &c, 1 ) ){}
+					_exit(2);
+				}
+				bench_node( ROLE_PRODUCER | ROLE_CONSUMER, n_p, ready[1], go[0], res[1] );
+				tc_server_close();
+			}else{
+				bench_node( ( i < n_p ) ? ROLE_PRODUCER : ROLE_CONSUMER, 1, ready[1], go[0], res[1] );
+			}
+
+			_exit(0);
+		}
+
+		close(res[1]);
+		res_fds[n++] = res[0];
+
+		//Nodes are registered one at a time (discovery and registration of simultaneous nodes collide)
+		if ( read( ready[0], &c, 1 ) != 1 || !c ){
+			failed = 1;
+			break;
+		}
+	}
+
+	close(ready[1]);
+	close(go[0]);
+
+	//Wait for all the nodes to be bound
+	for ( i = 0; i < n && !failed; i++ ){
+		if ( read( ready[0], &c, 1 ) != 1 || !c ){
+			failed = 1;
+			break;
+		}
+	}
+
+	if ( n < n_nodes )
+		failed = 1;
+
+	//Start
+	close(go[1]);
+	close(ready[0]);
+
+	memset( &total, 0, sizeof(BENCH_RESULT) );
+
+	for ( i = 0; i < n; i++ ){
+
+		if ( read_full( res_fds[i], &node, sizeof(BENCH_RESULT) ) || !node.ok ){
+			failed = 1;
+			close( res_fds[i] );
+			continue;
+		}
+
+		total.msgs_sent += node.msgs_sent;
+		total.bytes_sent += node.bytes_sent;
+		total.frags_sent += node.frags_sent;
+		total.send_errors += node.send_errors;
+		total.msgs_received += node.msgs_received;
+		total.bytes_received += node.bytes_received;
+		total.frags_received += node.frags_received;
+		total.stale_frags += node.stale_frags;
+		total.reasm_timeouts += node.reasm_timeouts;
+
+		if ( node.role & ROLE_PRODUCER )
+			cpu_tx += node.cpu_time;
+		if ( node.role & ROLE_CONSUMER )
+			cpu_rx += node.cpu_time;
+
+		if ( node.n_samples ){
+			if ( !(tmp = realloc( all, (n_all + node.n_samples) * sizeof(unsigned int) )) ){
+				fprintf(stderr,"bench_point() : NOT ENOUGH MEMORY\n");
+				failed = 1;
+				close( res_fds[i] );
+				continue;
+			}
+			all = tmp;
+
+			if ( read_full( res_fds[i], all + n_all, node.n_samples * sizeof(unsigned int) ) ){
+				failed = 1;
+				close( res_fds[i] );
+				continue;
+			}
+			n_all += node.n_samples;
+		}
+
+		close( res_fds[i] );
+	}
+
+	for ( i = 0; i < n; i++ )
+		waitpid( pids[i], NULL, 0 );
+
+	if ( n_all ){
+		qsort( all, n_all, sizeof(unsigned int), cmp_uint );
+		p50 = all[ (n_all - 1) * 50 / 100 ];
+		p99 = all[ (n_all - 1) * 99 / 100 ];
+		max = all[ n_all - 1 ];
+	}
+	free( all );
+
+	//Each fragment sent should reach every consumer of the topic
+	expected = total.frags_sent * n_c;
+	if ( expected && total.frags_received < expected )
+		frag_loss = 1.0 - (double)total.frags_received / expected;
+
+	elapsed = duration;
+
+	if ( json ){
+		printf("{\"mode\":\"%s\",\"size\":%d,\"topics\":%d,\"producers\":%d,\"consumers\":%d,\"period_ms\":%u,\"interval_us\":%d,"
+			"\"duration_s\":%d,\"msgs_sent\":%llu,\"msgs_received\":%llu,\"msgs_s\":%.1f,\"mb_s\":%.3f,\"frags_per_msg\":%.2f,"
+			"\"lat_p50_us\":%u,\"lat_p99_us\":%u,\"lat_max_us\":%u,\"frag_loss\":%.6f,\"reasm_timeouts\":%llu,\"stale_frags\":%llu,"
+			"\"send_errors\":%llu,\"cpu_tx_us_msg\":%.2f,\"cpu_rx_us_msg\":%.2f,\"status\":\"%s\"}\n",
+			( mode == 'l' ) ? "loopback" : "multiprocess", size, n_t, n_p, n_c, period, interval, duration,
+			total.msgs_sent, total.msgs_received, total.msgs_received / elapsed, total.bytes_received / elapsed / 1e6,
+			total.msgs_sent ? (double)total.frags_sent / total.msgs_sent : 0.0, p50, p99, max, frag_loss,
+			total.reasm_timeouts, total.stale_frags, total.send_errors,
+			total.msgs_sent ? (double)cpu_tx / total.msgs_sent : 0.0, total.msgs_received ? (double)cpu_rx / total.msgs_received : 0.0,
+			failed ? "failed" : "ok");
+	}else{
+		printf("%s,%d,%d,%d,%d,%u,%d,%d,%llu,%llu,%.1f,%.3f,%.2f,%u,%u,%u,%.6f,%llu,%llu,%llu,%.2f,%.2f,%s\n",
+			( mode == 'l' ) ? "loopback" : "multiprocess", size, n_t, n_p, n_c, period, interval, duration,
+			total.msgs_sent, total.msgs_received, total.msgs_received / elapsed, total.bytes_received / elapsed / 1e6,
+			total.msgs_sent ? (double)total.frags_sent / total.msgs_sent : 0.0, p50, p99, max, frag_loss,
+			total.reasm_timeouts, total.stale_frags, total.send_errors,
+			total.msgs_sent ? (double)cpu_tx / total.msgs_sent : 0.0, total.msgs_received ? (double)cpu_rx / total.msgs_received : 0.0,
+			failed ? "failed" : "ok");
+	}
+
+	fflush(stdout);
+
+	return failed ? -1 : 0;
+}
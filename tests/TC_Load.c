@@ -0,0 +1,694 @@
+/*This file is part of LTCNM (Linux Traffic Control Network Manager).
+
+    LTCNM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LTCNM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LTCNM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**	@file TC_Load.c
+*	@brief Source code for the server control plane load generator
+*
+*	This file contains a synthetic client that simulates many nodes from a single process to measure how many nodes and topics one server handles.
+*	It speaks the NET_MSG protocol directly (LOCAL sockets if the server runs in this node, REMOTE sockets otherwise) and, for each step of
+*	the ramp, registers a batch of new nodes together with their topics, producers, consumers and binds. Every node registers its own topics as producer
+*	and the topics of a previously registered node as consumer, so every bind completes.
+*	Heartbeats are sent for all the simulated nodes every HEARTBEAT_GEN_PERIOD and the management requests of the server (TC_RESERV, BIND_TX, ...)
+*	are answered by a stub management endpoint which never touches the real tc configuration.
+*	One result line is printed per step (CSV or JSON lines) with the server requests latency, the bind completion latency and the number of simulated
+*	nodes the server declared dead, so the point where heartbeats start timing out can be seen.
+*	Run './TC_Load.test -h' in a terminal for the options.
+*
+*	@bug No known bugs
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <getopt.h>             /* getopt_long() */
+#include <signal.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/select.h>
+
+#include "TC_Data_Types.h"
+#include "TC_Config.h"
+#include "TC_Error_Types.h"
+#include "TC_Utils.h"
+#include "Sockets.h"
+
+#define LOAD_MAX_WORKERS	64			//Maximum number of request threads
+#define LOAD_LOCAL_FILE		"ltcnm_load_local"	//Prefix of the LOCAL sockets names (one per worker plus the heartbeat socket)
+#define LOAD_LINK_BW		1000			//NIC bandwidth (mbps) reported by each simulated node
+
+/**
+* A simulated node
+*/
+typedef struct{
+	char registered;			/**< Node registered in the server */
+	char expired;				/**< Node declared dead by the server (unplug event received) */
+	unsigned long long bind_tx_start;	/**< Time (us) of the pending BIND_TX request (0 if none) */
+	unsigned long long bind_rx_start;	/**< Time (us) of the pending BIND_RX request (0 if none) */
+}LOAD_NODE;
+
+//Options
+static char ifface[10] = "eth0";
+static char server_ip[20] = "";
+static unsigned int server_port = 5000;
+static char local = 0;
+static char json = 0;
+static char keep_going = 0;
+static unsigned int max_nodes = 1000;
+static unsigned int step_nodes = 100;
+static unsigned int topics_per_node = 1;
+static unsigned int topic_size = 1000, topic_period = 100;
+static unsigned int n_workers = 4;
+static unsigned int req_rate = 0;
+static unsigned int req_timeout = 1000;
+static unsigned int hold = 5;
+static unsigned int base_id = 100000;
+
+static char nic_ip[50];
+static LOAD_NODE *nodes;
+static unsigned int n_nodes = 0;		//Nodes created so far (heartbeats are sent for these)
+static unsigned int step_start = 0;		//First node of the current step
+
+//Statistics (reset on each step)
+static TC_HIST req_hist[N_OP_TYPES];
+static TC_HIST bind_hist;
+static unsigned long long n_reqs, n_refused, n_timeouts, n_mng_reqs, n_heartbeats, n_expired;
+static unsigned int hb_sweep_max;
+
+static volatile int quit = 0;
+static volatile int stop_threads = 0;
+
+static void sigfun( int sig );
+static int load_open_server_sock( SOCK_ENTITY *sock, char *local_name, unsigned int port_offset );
+static int load_request( SOCK_ENTITY *sock, NET_MSG *req, NET_MSG *ans );
+static void *worker( void *arg );
+static void *heartbeats( void *arg );
+static void *stub( void *arg );
+static void load_print_step( unsigned int step, unsigned long long elapsed );
+
+static const char short_options[] = "i:s:p:ln:N:t:S:P:w:r:T:H:b:kjh";
+static const struct option long_options[] = {
+	{ "interface", 				required_argument, 	NULL, 	'i' },
+	{ "server", 				required_argument, 	NULL, 	's' },
+	{ "port", 				required_argument, 	NULL, 	'p' },
+	{ "local", 				no_argument, 		NULL, 	'l' },
+	{ "nodes", 				required_argument, 	NULL, 	'n' },
+	{ "step", 				required_argument, 	NULL, 	'N' },
+	{ "topics", 				required_argument, 	NULL, 	't' },
+	{ "size", 				required_argument, 	NULL, 	'S' },
+	{ "period", 				required_argument, 	NULL, 	'P' },
+	{ "workers", 				required_argument, 	NULL, 	'w' },
+	{ "rate", 				required_argument, 	NULL, 	'r' },
+	{ "timeout", 				required_argument, 	NULL, 	'T' },
+	{ "hold", 				required_argument, 	NULL, 	'H' },
+	{ "base_id", 				required_argument, 	NULL, 	'b' },
+	{ "keep_going", 			no_argument, 		NULL, 	'k' },
+	{ "json", 				no_argument, 		NULL, 	'j' },
+	{ "help", 				no_argument, 		NULL, 	'h' },
+	{ 0, 0, 0, 0 }
+};
+
+static void usage(FILE * fp, char ** argv) {
+	fprintf(fp,
+			"\nUsage: %s [options]\n\n"
+			"Options:\n"
+			"-i | --interface	NIC interface to be used 						(default eth0)\n"
+			"-s | --server		Server IP address (remote server)\n"
+			"-p | --port		Server port								(default 5000)\n"
+			"-l | --local		Server runs in this node (LOCAL sockets -- no real client may run in this node)\n"
+			"-n | --nodes		Maximum number of simulated nodes					(default 1000)\n"
+			"-N | --step		Nodes added on each step						(default 100)\n"
+			"-t | --topics		Topics registered by each node						(default 1)\n"
+			"-S | --size		Topics size in bytes							(default 1000)\n"
+			"-P | --period		Topics period in ms							(default 100)\n"
+			"-w | --workers		Number of request threads						(default 4)\n"
+			"-r | --rate		Total request rate in requests/s (0 -> as fast as the server answers)	(default 0)\n"
+			"-T | --timeout		Request answer timeout in ms						(default 1000)\n"
+			"-H | --hold		Time in s each step holds the nodes (heartbeats only) before the next one	(default 5)\n"
+			"-b | --base_id		ID of the first simulated node						(default 100000)\n"
+			"-k | --keep_going	Keep adding nodes after the server declares simulated nodes dead\n"
+			"-j | --json		Print JSON lines instead of CSV\n"
+			"-h | --help		Print this message\n"
+			"\nOne line is printed per step. Latencies are in us : req_* for all the requests of the step, bind_done_* from the bind request\n"
+			"until the server bind request reaches the stub management endpoint. 'expired' counts the simulated nodes declared dead by the server\n"
+			"(heartbeat time-outs) during the step -- the ramp stops on the first step with expired nodes unless -k is given.\n"
+			"\nExample - server in the same node, up to 5000 nodes in steps of 500\n"
+			"'./TC_Load.test -i eth1 -l -n 5000 -N 500'\n\n"
+			"", argv[0]);
+	return;
+}
+
+int main (int argc, char* argv[])
+{
+	int c,index;
+	unsigned int i, step = 0;
+	unsigned long long t_step;
+	unsigned long w_ids[LOAD_MAX_WORKERS];
+	pthread_t w_threads[LOAD_MAX_WORKERS], hb_thread, stub_thread;
+
+	while ( (c = getopt_long(argc, argv, short_options, long_options, &index)) != -1 ){
+
+		switch (c) {
+			case 0: /* getopt_long() flag */
+				break;
+
+			case 'i':
+				strncpy(ifface,optarg,sizeof(ifface)-1);
+				break;
+
+			case 's':
+				strncpy(server_ip,optarg,sizeof(server_ip)-1);
+				break;
+
+			case 'p':
+				server_port = atoi(optarg);
+				break;
+
+			case 'l':
+				local = 1;
+				break;
+
+			case 'n':
+				max_nodes = atoi(optarg);
+				break;
+
+			case 'N':
+				step_nodes = atoi(optarg);
+				break;
+
+			case 't':
+				topics_per_node = atoi(optarg);
+				break;
+
+			case 'S':
+				topic_size = atoi(optarg);
+				break;
+
+			case 'P':
+				topic_period = atoi(optarg);
+				break;
+
+			case 'w':
+				n_workers = atoi(optarg);
+				break;
+
+			case 'r':
+				req_rate = atoi(optarg);
+				break;
+
+			case 'T':
+				req_timeout = atoi(optarg);
+				break;
+
+			case 'H':
+				hold = atoi(optarg);
+				break;
+
+			case 'b':
+				base_id = atoi(optarg);
+				break;
+
+			case 'k':
+				keep_going = 1;
+				break;
+
+			case 'j':
+				json = 1;
+				break;
+
+			case 'h':
+				usage(stdout, argv);
+				return 0;
+
+			default:
+				usage(stderr, argv);
+				return -1;
+		}
+	}
+
+	if ( !local && !strcmp(server_ip,"") ){
+		fprintf(stderr,"Server IP address (-s) or local server (-l) required\n");
+		return -1;
+	}
+
+	if ( !max_nodes || !step_nodes || !topics_per_node || !topic_size || !topic_period || !n_workers || n_workers > LOAD_MAX_WORKERS ){
+		fprintf(stderr,"Invalid parameters\n");
+		return -1;
+	}
+
+	if ( tc_network_get_nic_ip( ifface, nic_ip ) ){
+		fprintf(stderr,"Error getting NIC %s IP address\n",ifface);
+		return -2;
+	}
+
+	if ( !(nodes = calloc( max_nodes, sizeof(LOAD_NODE) )) ){
+		fprintf(stderr,"main() : NOT ENOUGH MEMORY\n");
+		return -2;
+	}
+
+	(void) signal(SIGINT, sigfun);
+
+	if ( pthread_create( &stub_thread, NULL, stub, NULL ) || pthread_create( &hb_thread, NULL, heartbeats, NULL ) ){
+		fprintf(stderr,"main() : ERROR STARTING STUB/HEARTBEAT THREADS\n");
+		return -2;
+	}
+
+	if ( !json ){
+		printf("step,nodes,topics,elapsed_ms,reqs,refused,timeouts,req_p50_us,req_p99_us,req_max_us,reg_node_p99_us,reg_topic_p99_us,"
+			"reg_prod_p99_us,reg_cons_p99_us,bind_tx_p99_us,bind_rx_p99_us,bind_done_p50_us,bind_done_p99_us,mng_reqs,heartbeats,"
+			"hb_sweep_max_us,expired\n");
+		fflush(stdout);
+	}
+
+	//Ramp
+	while ( !quit && n_nodes < max_nodes ){
+
+		memset( req_hist, 0, sizeof(req_hist) );
+		memset( &bind_hist, 0, sizeof(bind_hist) );
+		n_reqs = n_refused = n_timeouts = n_mng_reqs = n_heartbeats = n_expired = 0;
+		hb_sweep_max = 0;
+
+		step_start = n_nodes;
+		__atomic_store_n( &n_nodes, ( n_nodes + step_nodes < max_nodes ) ? n_nodes + step_nodes : max_nodes, __ATOMIC_RELEASE );
+
+		t_step = tc_time_get_us();
+
+		for ( i = 0; i < n_workers; i++ ){
+			w_ids[i] = i;
+			if ( pthread_create( &w_threads[i], NULL, worker, (void *)w_ids[i] ) ){
+				fprintf(stderr,"main() : ERROR STARTING WORKER THREAD\n");
+				quit = 1;
+				break;
+			}
+		}
+
+		while ( i-- )
+			pthread_join( w_threads[i], NULL );
+
+		t_step = tc_time_get_us() - t_step;
+
+		//Hold (heartbeats only)
+		for ( i = 0; i < hold * 10 && !quit; i++ )
+			usleep(100000);
+
+		load_print_step( step++, t_step );
+
+		if ( n_expired && !keep_going )
+			break;
+	}
+
+	//Unregister all nodes
+	step_start = 0;
+	quit = 2;
+	for ( i = 0; i < n_workers; i++ ){
+		w_ids[i] = i;
+		if ( pthread_create( &w_threads[i], NULL, worker, (void *)w_ids[i] ) )
+			break;
+	}
+	while ( i-- )
+		pthread_join( w_threads[i], NULL );
+
+	stop_threads = 1;
+	pthread_join( hb_thread, NULL );
+	pthread_join( stub_thread, NULL );
+
+	free( nodes );
+
+	return 0;
+}
+
+static void sigfun( int sig )
+{
+	//Stop the ramp and unregister the nodes
+	if ( !quit )
+		quit = 1;
+}
+
+static int load_open_server_sock( SOCK_ENTITY *sock, char *local_name, unsigned int port_offset )
+{
+	NET_ADDR host, peer;
+
+	if ( local ){
+		if ( sock_open( sock, LOCAL ) < 0 )
+			return ERR_SOCK_CREATE;
+
+		strcpy( host.name_ip, local_name );
+		host.port = 0;
+
+		//Server local socket of the module
+		switch ( port_offset ){
+			case 0 : strcpy( peer.name_ip, SERVER_AC_LOCAL_FILE ); break;
+			case MONITORING_PORT_OFFSET : strcpy( peer.name_ip, SERVER_MONITORING_LOCAL_FILE ); break;
+			default : strcpy( peer.name_ip, SERVER_MANAGEMENT_ANS_LOCAL_FILE ); break;
+		}
+		peer.port = 0;
+	}else{
+		if ( sock_open( sock, REMOTE_UDP ) < 0 )
+			return ERR_SOCK_CREATE;
+
+		//Any free port -- the server answers to the sender address
+		strcpy( host.name_ip, nic_ip );
+		host.port = 0;
+
+		strcpy( peer.name_ip, server_ip );
+		peer.port = server_port + port_offset;
+	}
+
+	if ( sock_bind( sock, &host ) || sock_connect_peer( sock, &peer ) ){
+		sock_close( sock );
+		return ERR_SOCK_BIND_PEER;
+	}
+
+	return ERR_OK;
+}
+
+static int load_request( SOCK_ENTITY *sock, NET_MSG *req, NET_MSG *ans )
+{
+	unsigned long long t_start = tc_time_get_us();
+
+	__atomic_add_fetch( &n_reqs, 1, __ATOMIC_RELAXED );
+
+	if ( tc_network_send_msg( sock, req, NULL ) || tc_network_get_msg( sock, req_timeout, ans, NULL ) ){
+		__atomic_add_fetch( &n_timeouts, 1, __ATOMIC_RELAXED );
+		return ERR_DATA_TIMEOUT;
+	}
+
+	tc_hist_add( &req_hist[req->op], tc_time_get_us() - t_start );
+
+	if ( ans->type != ANS_MSG || ans->error ){
+		__atomic_add_fetch( &n_refused, 1, __ATOMIC_RELAXED );
+		return ans->error ? ans->error : ERR_GET_ANSWER;
+	}
+
+	return ERR_OK;
+}
+
+static void *worker( void *arg )
+{
+	unsigned long w = (unsigned long) arg;
+	SOCK_ENTITY sock;
+	NET_MSG req, ans;
+	char name[MAX_LOCAL_NAME_SIZE];
+	unsigned int k, i, j, n_ops;
+	unsigned long long interval = 0;
+	struct timespec next;
+	OP_TYPE ops[4];
+
+	snprintf( name, sizeof(name), "%s_%lu", LOAD_LOCAL_FILE, w );
+
+	if ( load_open_server_sock( &sock, name, 0 ) ){
+		fprintf(stderr,"worker() : ERROR OPENING SERVER SOCKET\n");
+		return NULL;
+	}
+
+	//Pace each worker at its share of the total rate
+	if ( req_rate )
+		interval = 1000000000ULL * n_workers / req_rate;
+
+	clock_gettime( CLOCK_MONOTONIC, &next );
+
+	for ( k = step_start + w; k < n_nodes; k += n_workers ){
+
+		if ( quit == 1 )
+			break;
+
+		//Requests of the node (in order)
+		n_ops = 0;
+		if ( quit == 2 ){
+			if ( !nodes[k].registered || nodes[k].expired )
+				continue;
+			ops[n_ops++] = UNREG_NODE;
+		}else{
+			ops[n_ops++] = REG_NODE;
+			ops[n_ops++] = REG_TOPIC;
+			ops[n_ops++] = REG_PROD;
+			ops[n_ops++] = BIND_TX;
+		}
+
+		for ( i = 0; i < n_ops; i++ ){
+			for ( j = 0; j < ( (ops[i] == REG_NODE || ops[i] == UNREG_NODE) ? 1 : topics_per_node ); j++ ){
+
+				memset( &req, 0, sizeof(NET_MSG) );
+				req.type = REQ_MSG;
+				req.op = ops[i];
+				req.node_ids[0] = base_id + k;
+				req.n_nodes = 1;
+				req.link_bw = LOAD_LINK_BW;
+				req.link_background_share = BACKGROUND_BW_SHARE;
+				req.link_control_share = CONTROL_BW_SHARE;
+				req.topic_id = k * topics_per_node + j + 1;
+				req.channel_size = topic_size;
+				req.channel_period = topic_period;
+
+				if ( ops[i] == BIND_TX )
+					__atomic_store_n( &nodes[k].bind_tx_start, tc_time_get_us(), __ATOMIC_RELAXED );
+
+				if ( load_request( &sock, &req, &ans ) == ERR_OK && ops[i] == REG_NODE )
+					nodes[k].registered = 1;
+
+				//Consumer of the topics of the previous node of this worker (already registered)
+				if ( k >= n_workers && ( ops[i] == REG_PROD || ops[i] == BIND_TX ) ){
+					req.op = ( ops[i] == REG_PROD ) ? REG_CONS : BIND_RX;
+					req.topic_id -= topics_per_node * n_workers;
+
+					if ( req.op == BIND_RX )
+						__atomic_store_n( &nodes[k].bind_rx_start, tc_time_get_us(), __ATOMIC_RELAXED );
+
+					load_request( &sock, &req, &ans );
+				}
+
+				if ( interval ){
+					next.tv_nsec += interval;
+					while ( next.tv_nsec >= 1000000000L ){
+						next.tv_nsec -= 1000000000L;
+						next.tv_sec++;
+					}
+					clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL );
+				}
+			}
+
+			//Node registration refused -- skip its topics
+			if ( ops[i] == REG_NODE && !nodes[k].registered )
+				break;
+		}
+
+		if ( quit == 2 )
+			nodes[k].registered = 0;
+	}
+
+	sock_close( &sock );
+
+	return NULL;
+}
+
+static void *heartbeats( void *arg )
+{
+	SOCK_ENTITY sock;
+	NET_MSG msg;
+	unsigned int k, n;
+	unsigned long long t_start, t_sweep;
+
+	if ( load_open_server_sock( &sock, LOAD_LOCAL_FILE "_monit", MONITORING_PORT_OFFSET ) ){
+		fprintf(stderr,"heartbeats() : ERROR OPENING SERVER MONITORING SOCKET\n");
+		return NULL;
+	}
+
+	memset( &msg, 0, sizeof(NET_MSG) );
+	msg.type = REQ_MSG;
+	msg.op = HEART_SIG;
+	msg.n_nodes = 1;
+
+	while ( !stop_threads ){
+
+		t_start = tc_time_get_us();
+		n = __atomic_load_n( &n_nodes, __ATOMIC_ACQUIRE );
+
+		for ( k = 0; k < n; k++ ){
+			if ( !nodes[k].registered || nodes[k].expired )
+				continue;
+
+			msg.node_ids[0] = base_id + k;
+			if ( !tc_network_send_msg( &sock, &msg, NULL ) )
+				__atomic_add_fetch( &n_heartbeats, 1, __ATOMIC_RELAXED );
+		}
+
+		//A sweep longer than the heartbeat period means this tool, not the server, is the bottleneck
+		t_sweep = tc_time_get_us() - t_start;
+		if ( t_sweep > hb_sweep_max )
+			hb_sweep_max = t_sweep;
+
+		if ( t_sweep < HEARTBEAT_GEN_PERIOD )
+			usleep( HEARTBEAT_GEN_PERIOD - t_sweep );
+	}
+
+	sock_close( &sock );
+
+	return NULL;
+}
+
+static void *stub( void *arg )
+{
+	SOCK_ENTITY req_sock, ans_sock, notific_sock;
+	NET_ADDR host, peer;
+	NET_MSG msg, ans;
+	unsigned long long t_start;
+	unsigned int i, k;
+	int highest_fd;
+	fd_set fds;
+	struct timeval to;
+
+	//Management requests and server notifications
+	if ( local ){
+		host.port = peer.port = 0;
+
+		strcpy( host.name_ip, CLIENT_MANAGEMENT_REQ_LOCAL_FILE );
+		if ( sock_open( &req_sock, LOCAL ) < 0 || sock_bind( &req_sock, &host ) ){
+			fprintf(stderr,"stub() : ERROR OPENING MANAGEMENT REQUEST SOCKET\n");
+			return NULL;
+		}
+
+		strcpy( host.name_ip, CLIENT_NOTIFICATIONS_LOCAL_FILE );
+		if ( sock_open( &notific_sock, LOCAL ) < 0 || sock_bind( &notific_sock, &host ) ){
+			fprintf(stderr,"stub() : ERROR OPENING NOTIFICATIONS SOCKET\n");
+			return NULL;
+		}
+	}else{
+		strcpy( host.name_ip, nic_ip );
+		host.port = MANAGEMENT_GROUP_PORT;
+		strcpy( peer.name_ip, MANAGEMENT_GROUP_IP );
+		peer.port = MANAGEMENT_GROUP_PORT;
+
+		if ( sock_open( &req_sock, REMOTE_UDP_GROUP ) < 0 || sock_bind( &req_sock, &host ) || sock_connect_group_rx( &req_sock, &peer ) ){
+			fprintf(stderr,"stub() : ERROR JOINING MANAGEMENT GROUP\n");
+			return NULL;
+		}
+
+		host.port = NOTIFICATIONS_GROUP_PORT;
+		strcpy( peer.name_ip, NOTIFICATIONS_GROUP_IP );
+		peer.port = NOTIFICATIONS_GROUP_PORT;
+
+		if ( sock_open( &notific_sock, REMOTE_UDP_GROUP ) < 0 || sock_bind( &notific_sock, &host ) || sock_connect_group_rx( &notific_sock, &peer ) ){
+			fprintf(stderr,"stub() : ERROR JOINING NOTIFICATIONS GROUP\n");
+			return NULL;
+		}
+	}
+
+	if ( load_open_server_sock( &ans_sock, CLIENT_MANAGEMENT_ANS_LOCAL_FILE, MANAGEMENT_PORT_OFFSET ) ){
+		fprintf(stderr,"stub() : ERROR OPENING MANAGEMENT ANSWER SOCKET\n");
+		return NULL;
+	}
+
+	highest_fd = ( req_sock.fd > notific_sock.fd ) ? req_sock.fd : notific_sock.fd;
+
+	while ( !stop_threads ){
+
+		FD_ZERO(&fds);
+		FD_SET(req_sock.fd, &fds);
+		FD_SET(notific_sock.fd, &fds);
+
+		to.tv_sec = 0;
+		to.tv_usec = 100000;
+
+		if ( select( highest_fd+1, &fds, 0, 0, &to ) <= 0 )
+			continue;
+
+		if ( FD_ISSET(notific_sock.fd, &fds) && !tc_network_get_msg( &notific_sock, 0, &msg, NULL ) ){
+			//Node declared dead by the server
+			k = msg.node_ids[0] - base_id;
+			if ( msg.event == EVENT_NODE_UNPLUG && msg.node_ids[0] >= base_id && k < max_nodes && nodes[k].registered && !nodes[k].expired ){
+				nodes[k].expired = 1;
+				__atomic_add_fetch( &n_expired, 1, __ATOMIC_RELAXED );
+			}
+		}
+
+		if ( !FD_ISSET(req_sock.fd, &fds) || tc_network_get_msg( &req_sock, 0, &msg, NULL ) || msg.type != REQ_MSG )
+			continue;
+
+		//Answer for each simulated node of the request (accept everything -- no reservations are made)
+		for ( i = 0; i < msg.n_nodes && i < MAX_MULTI_NODES; i++ ){
+
+			k = msg.node_ids[i] - base_id;
+			if ( msg.node_ids[i] < base_id || k >= max_nodes )
+				continue;
+
+			__atomic_add_fetch( &n_mng_reqs, 1, __ATOMIC_RELAXED );
+
+			//Bind completion latency (first bind of the node since its last bind request)
+			if ( msg.op == BIND_TX && (t_start = __atomic_exchange_n( &nodes[k].bind_tx_start, 0, __ATOMIC_RELAXED )) )
+				tc_hist_add( &bind_hist, tc_time_get_us() - t_start );
+			if ( msg.op == BIND_RX && (t_start = __atomic_exchange_n( &nodes[k].bind_rx_start, 0, __ATOMIC_RELAXED )) )
+				tc_hist_add( &bind_hist, tc_time_get_us() - t_start );
+
+			memset( &ans, 0, sizeof(NET_MSG) );
+			ans.type = ANS_MSG;
+			ans.op = REQ_ACCEPTED;
+			ans.error = ERR_OK;
+			ans.node_ids[0] = msg.node_ids[i];
+			ans.n_nodes = 1;
+			ans.topic_id = msg.topic_id;
+
+			tc_network_send_msg( &ans_sock, &ans, NULL );
+		}
+	}
+
+	sock_close( &req_sock );
+	sock_close( &notific_sock );
+	sock_close( &ans_sock );
+
+	return NULL;
+}
+
+static void load_print_step( unsigned int step, unsigned long long elapsed )
+{
+	TC_HIST all;
+	unsigned int i, b;
+
+	//All the requests of the step
+	memset( &all, 0, sizeof(TC_HIST) );
+	for ( i = 0; i < N_OP_TYPES; i++ ){
+		all.count += req_hist[i].count;
+		all.sum += req_hist[i].sum;
+		if ( req_hist[i].max > all.max )
+			all.max = req_hist[i].max;
+		for ( b = 0; b < HIST_N_BUCKETS; b++ )
+			all.buckets[b] += req_hist[i].buckets[b];
+	}
+
+	if ( json ){
+		printf("{\"step\":%u,\"nodes\":%u,\"topics\":%u,\"elapsed_ms\":%llu,\"reqs\":%llu,\"refused\":%llu,\"timeouts\":%llu,"
+			"\"req_p50_us\":%u,\"req_p99_us\":%u,\"req_max_us\":%u,\"reg_node_p99_us\":%u,\"reg_topic_p99_us\":%u,\"reg_prod_p99_us\":%u,"
+			"\"reg_cons_p99_us\":%u,\"bind_tx_p99_us\":%u,\"bind_rx_p99_us\":%u,\"bind_done_p50_us\":%u,\"bind_done_p99_us\":%u,"
+			"\"mng_reqs\":%llu,\"heartbeats\":%llu,\"hb_sweep_max_us\":%u,\"expired\":%llu}\n",
+			step, n_nodes, n_nodes * topics_per_node, elapsed / 1000, n_reqs, n_refused, n_timeouts,
+			tc_hist_get_percentile( &all, 50 ), tc_hist_get_percentile( &all, 99 ), all.max,
+			tc_hist_get_percentile( &req_hist[REG_NODE], 99 ), tc_hist_get_percentile( &req_hist[REG_TOPIC], 99 ),
+			tc_hist_get_percentile( &req_hist[REG_PROD], 99 ), tc_hist_get_percentile( &req_hist[REG_CONS], 99 ),
+			tc_hist_get_percentile( &req_hist[BIND_TX], 99 ), tc_hist_get_percentile( &req_hist[BIND_RX], 99 ),
+			tc_hist_get_percentile( &bind_hist, 50 ), tc_hist_get_percentile( &bind_hist, 99 ),
+			n_mng_reqs, n_heartbeats, hb_sweep_max, n_expired);
+	}else{
+		printf("%u,%u,%u,%llu,%llu,%llu,%llu,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%llu,%llu,%u,%llu\n",
+			step, n_nodes, n_nodes * topics_per_node, elapsed / 1000, n_reqs, n_refused, n_timeouts,
+			tc_hist_get_percentile( &all, 50 ), tc_hist_get_percentile( &all, 99 ), all.max,
+			tc_hist_get_percentile( &req_hist[REG_NODE], 99 ), tc_hist_get_percentile( &req_hist[REG_TOPIC], 99 ),
+			tc_hist_get_percentile( &req_hist[REG_PROD], 99 ), tc_hist_get_percentile( &req_hist[REG_CONS], 99 ),
+			tc_hist_get_percentile( &req_hist[BIND_TX], 99 ), tc_hist_get_percentile( &req_hist[BIND_RX], 99 ),
+			tc_hist_get_percentile( &bind_hist, 50 ), tc_hist_get_percentile( &bind_hist, 99 ),
+			n_mng_reqs, n_heartbeats, hb_sweep_max, n_expired);
+	}
+
+	fflush(stdout);
+}
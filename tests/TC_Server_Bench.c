@@ -0,0 +1,455 @@
+/*This file is part of LTCNM (Linux Traffic Control Network Manager).
+
+    LTCNM is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    LTCNM is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with LTCNM.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**	@file TC_Server_Bench.c
+*	@brief Source code for the server database and admission control microbenchmarks
+*
+*	This file contains a standalone benchmark of the server hot paths : the node and topic database lists (create, search, delete) and the
+*	admission control calls that walk them (add_node, add_topic, add_prod, add_cons, set_topic_prop, rm_node) for databases of 10^3 to 10^5 entries.
+*	The real database, admission control and management modules are linked. The management transport is replaced at link time (--wrap) by
+*	a stub that answers every request at once (every simulated node is local), so the management loops are measured without any network wait,
+*	and node plug/unplug notifications are counted but not sent.
+*	One result line is printed per database size and operation (CSV or JSON lines).
+*	Run './TC_Server_Bench.test -h' in a terminal for the options.
+*
+*	@bug No known bugs
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <getopt.h>             /* getopt_long() */
+#include <time.h>
+#include <sys/select.h>
+
+#include "TC_Data_Types.h"
+#include "TC_Config.h"
+#include "TC_Error_Types.h"
+#include "TC_Utils.h"
+#include "TC_Log.h"
+#include "TC_Server_DB.h"
+#include "TC_Server_AC.h"
+#include "TC_Server_Management.h"
+
+#define SBENCH_MAX_SIZES	8			//Maximum number of database sizes
+#define SBENCH_LINK_BW		100000			//NIC bandwidth (mbps) of each node (large enough to admit every topic)
+#define SBENCH_TOPIC_SIZE	100			//Topics size in bytes
+#define SBENCH_TOPIC_PERIOD	100			//Topics period in ms
+#define SBENCH_ANS_QUEUE	(MAX_MULTI_NODES*2)	//Stub management answers queue size
+
+//Options
+static unsigned int sizes[SBENCH_MAX_SIZES] = { 1000, 10000, 100000 };
+static unsigned int n_sizes = 3;
+static unsigned int n_samples = 1000;
+static unsigned int n_cons = 1;
+static unsigned int server_port = 5000;
+static char json = 0;
+
+//Stub management answers (node ids of the pending request)
+static NET_MSG ans_queue[SBENCH_ANS_QUEUE];
+static unsigned int ans_head, ans_tail;
+
+//Stub counters
+static unsigned long long n_mng_reqs, n_events;
+
+static unsigned long long sbench_now_ns( void );
+static void sbench_shuffle( unsigned int *ids, unsigned int n );
+static void sbench_print( unsigned int size, const char *op, unsigned int ops, unsigned long long total_ns, unsigned long long max_ns, unsigned long long mng_reqs );
+static int sbench_db( unsigned int size, unsigned int *perm );
+static int sbench_ac( unsigned int size, unsigned int *perm );
+static void sbench_clear( void );
+
+//Management transport and notifications stubs (linked with --wrap)
+int __wrap_tc_network_send_msg( SOCK_ENTITY *sock, NET_MSG *msg, NET_ADDR *peer );
+int __wrap_tc_network_get_msg( SOCK_ENTITY *sock, unsigned int timeout, NET_MSG *ret_msg, NET_ADDR *ret_sender );
+int __wrap_select( int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout );
+int __wrap_tc_server_notifications_send_node_event( unsigned char event, NODE_ENTRY *node );
+
+static const char short_options[] = "n:r:c:p:jh";
+static const struct option long_options[] = {
+	{ "sizes", 				required_argument, 	NULL, 	'n' },
+	{ "samples", 				required_argument, 	NULL, 	'r' },
+	{ "consumers", 				required_argument, 	NULL, 	'c' },
+	{ "port", 				required_argument, 	NULL, 	'p' },
+	{ "json", 				no_argument, 		NULL, 	'j' },
+	{ "help", 				no_argument, 		NULL, 	'h' },
+	{ 0, 0, 0, 0 }
+};
+
+static void usage(FILE * fp, char ** argv) {
+	fprintf(fp,
+			"\nUsage: %s [options]\n\n"
+			"Options:\n"
+			"-n | --sizes		Comma separated list of database sizes (nodes and topics)		(default 1000,10000,100000)\n"
+			"-r | --samples		Lookups, deletes, topic updates and node removals timed per size	(default 1000)\n"
+			"-c | --consumers	Consumers registered per topic (besides its producer)			(default 1)\n"
+			"-p | --port		Port of the (unused) management sockets					(default 5000)\n"
+			"-j | --json		Print JSON lines instead of CSV\n"
+			"-h | --help		Print this message\n"
+			"\nFor each size N, N nodes and N topics are created (node i produces topic i and the next -c nodes consume it).\n"
+			"Fill operations (create, add_*) are averaged over all the N calls -- their cost grows with the entries already registered.\n"
+			"The other operations are timed on -r random entries of the full database. 'mng_reqs' is the average number of management\n"
+			"requests each operation sent to the nodes (answered by a stub).\n"
+			"Databases are linked lists, so the fill is quadratic -- the 10^5 size takes several minutes.\n"
+			"\nExample - 10^3 and 10^4 entries, 3 consumers per topic\n"
+			"'./TC_Server_Bench.test -n 1000,10000 -c 3'\n\n"
+			"", argv[0]);
+	return;
+}
+
+int main (int argc, char* argv[])
+{
+	int c,index;
+	unsigned int i, max_size = 0;
+	unsigned int *perm;
+	char *tok;
+	NET_ADDR server_addr;
+
+	while ( (c = getopt_long(argc, argv, short_options, long_options, &index)) != -1 ){
+
+		switch (c) {
+			case 0: /* getopt_long() flag */
+				break;
+
+			case 'n':
+				for ( n_sizes = 0, tok = strtok(optarg,","); tok && n_sizes < SBENCH_MAX_SIZES; tok = strtok(NULL,",") )
+					sizes[n_sizes++] = atoi(tok);
+				break;
+
+			case 'r':
+				n_samples = atoi(optarg);
+				break;
+
+			case 'c':
+				n_cons = atoi(optarg);
+				break;
+
+			case 'p':
+				server_port = atoi(optarg);
+				break;
+
+			case 'j':
+				json = 1;
+				break;
+
+			case 'h':
+				usage(stdout, argv);
+				return 0;
+
+			default:
+				usage(stderr, argv);
+				return -1;
+		}
+	}
+
+	for ( i = 0; i < n_sizes; i++ ){
+		if ( sizes[i] < 2 ){
+			fprintf(stderr,"Invalid parameters\n");
+			return -1;
+		}
+		if ( sizes[i] > max_size )
+			max_size = sizes[i];
+	}
+
+	if ( !n_sizes || !n_samples || n_cons + 2 > MAX_MULTI_NODES || n_cons >= max_size ){
+		fprintf(stderr,"Invalid parameters\n");
+		return -1;
+	}
+
+	if ( !(perm = malloc( max_size * sizeof(unsigned int) )) ){
+		fprintf(stderr,"main() : NOT ENOUGH MEMORY\n");
+		return -2;
+	}
+
+	//Only errors -- the benchmark loops would otherwise be dominated by the log calls
+	tc_log_set_level( LOG_ALL, LOG_ERROR );
+
+	//The management sockets are opened but never used (transport is stubbed)
+	strcpy( server_addr.name_ip, "127.0.0.1" );
+	server_addr.port = server_port;
+
+	if ( tc_server_db_init() || tc_server_ac_init() || tc_server_management_init( &server_addr ) ){
+		fprintf(stderr,"main() : ERROR STARTING SERVER MODULES\n");
+		free( perm );
+		return -2;
+	}
+
+	srand( 1 );
+
+	if ( !json ){
+		printf("size,op,ops,ns_per_op,max_ns,ops_per_s,mng_reqs_per_op\n");
+		fflush(stdout);
+	}
+
+	for ( i = 0; i < n_sizes; i++ ){
+		if ( sbench_db( sizes[i], perm ) || sbench_ac( sizes[i], perm ) ){
+			fprintf(stderr,"main() : BENCHMARK FAILED FOR SIZE %u\n",sizes[i]);
+			break;
+		}
+	}
+
+	sbench_clear();
+	tc_server_management_close();
+	tc_server_ac_close();
+	tc_server_db_close();
+
+	free( perm );
+
+	return ( i == n_sizes ) ? 0 : -3;
+}
+
+static unsigned long long sbench_now_ns( void )
+{
+	struct timespec now;
+
+	clock_gettime( CLOCK_MONOTONIC, &now );
+
+	return (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static void sbench_shuffle( unsigned int *ids, unsigned int n )
+{
+	unsigned int i, j, aux;
+
+	//ids 1..n in random order
+	for ( i = 0; i < n; i++ )
+		ids[i] = i + 1;
+
+	for ( i = n - 1; i > 0; i-- ){
+		j = rand() % (i + 1);
+		aux = ids[i]; ids[i] = ids[j]; ids[j] = aux;
+	}
+}
+
+static void sbench_print( unsigned int size, const char *op, unsigned int ops, unsigned long long total_ns, unsigned long long max_ns, unsigned long long mng_reqs )
+{
+	double ns_op = ops ? (double)total_ns / ops : 0;
+
+	if ( json ){
+		printf("{\"size\":%u,\"op\":\"%s\",\"ops\":%u,\"ns_per_op\":%.1f,\"max_ns\":%llu,\"ops_per_s\":%.0f,\"mng_reqs_per_op\":%.2f}\n",
+			size, op, ops, ns_op, max_ns, ns_op ? 1e9 / ns_op : 0, ops ? (double)mng_reqs / ops : 0);
+	}else{
+		printf("%u,%s,%u,%.1f,%llu,%.0f,%.2f\n",
+			size, op, ops, ns_op, max_ns, ns_op ? 1e9 / ns_op : 0, ops ? (double)mng_reqs / ops : 0);
+	}
+
+	fflush(stdout);
+}
+
+//Times one call (BODY must set 'ret')
+#define SBENCH_TIME(BODY) do{ \
+	t_op = sbench_now_ns(); \
+	BODY; \
+	t_op = sbench_now_ns() - t_op; \
+	total += t_op; \
+	if ( t_op > max ) max = t_op; \
+}while(0)
+
+static int sbench_db( unsigned int size, unsigned int *perm )
+{
+	unsigned int i, ops;
+	unsigned long long t_op, total, max;
+	NODE_ENTRY *node = NULL;
+	TOPIC_ENTRY *topic = NULL;
+	int ret = 0;
+
+	//Create
+	for ( total = max = 0, i = 1; i <= size && !ret; i++ ){
+		SBENCH_TIME( ret = !(node = tc_server_db_node_create( i )) );
+		if ( node ) node->node_id = i;
+	}
+	if ( ret ) return ERR_REG_NODE;
+	sbench_print( size, "db_node_create", size, total, max, 0 );
+
+	for ( total = max = 0, i = 1; i <= size && !ret; i++ ){
+		SBENCH_TIME( ret = !(topic = tc_server_db_topic_create( i )) );
+		if ( topic ) topic->topic_id = i;
+	}
+	if ( ret ) return ERR_TOPIC_CREATE;
+	sbench_print( size, "db_topic_create", size, total, max, 0 );
+
+	ops = ( n_samples < size ) ? n_samples : size;
+
+	//Search
+	for ( total = max = 0, i = 0; i < ops && !ret; i++ )
+		SBENCH_TIME( ret = !tc_server_db_node_search( rand() % size + 1 ) );
+	if ( ret ) return ERR_NODE_NOT_REG;
+	sbench_print( size, "db_node_search", ops, total, max, 0 );
+
+	for ( total = max = 0, i = 0; i < ops && !ret; i++ )
+		SBENCH_TIME( ret = !tc_server_db_topic_search( rand() % size + 1 ) );
+	if ( ret ) return ERR_TOPIC_NOT_REG;
+	sbench_print( size, "db_topic_search", ops, total, max, 0 );
+
+	//Delete (by id, as the server does -- search and unlink)
+	sbench_shuffle( perm, size );
+	for ( total = max = 0, i = 0; i < ops && !ret; i++ )
+		SBENCH_TIME( ret = ( !(node = tc_server_db_node_search( perm[i] )) || tc_server_db_node_delete( node ) ) );
+	if ( ret ) return ERR_NODE_DELETE;
+	sbench_print( size, "db_node_delete", ops, total, max, 0 );
+
+	for ( total = max = 0, i = 0; i < ops && !ret; i++ )
+		SBENCH_TIME( ret = ( !(topic = tc_server_db_topic_search( perm[i] )) || tc_server_db_topic_delete( topic ) ) );
+	if ( ret ) return ERR_TOPIC_DELETE;
+	sbench_print( size, "db_topic_delete", ops, total, max, 0 );
+
+	//Empty database for the next benchmark
+	sbench_clear();
+
+	return ERR_OK;
+}
+
+static int sbench_ac( unsigned int size, unsigned int *perm )
+{
+	unsigned int i, k, ops, ret_id;
+	unsigned long long t_op, total, max, mng_reqs;
+	NET_ADDR addr;
+	TOPIC_ENTRY *topic;
+	int ret = 0;
+
+	//Local nodes (port 0) -- management requests go through the local socket
+	strcpy( addr.name_ip, "ltcnm_server_bench" );
+	addr.port = 0;
+
+	for ( total = max = 0, i = 1; i <= size && !ret; i++ )
+		SBENCH_TIME( ret = tc_server_ac_add_node( i, &addr, SBENCH_LINK_BW, 0, 0, &ret_id ) );
+	if ( ret ) return ret;
+	sbench_print( size, "ac_add_node", size, total, max, 0 );
+
+	for ( total = max = 0, i = 1; i <= size && !ret; i++ )
+		SBENCH_TIME( ret = tc_server_ac_add_topic( i, SBENCH_TOPIC_SIZE, SBENCH_TOPIC_PERIOD, 0, 0, 0 ) );
+	if ( ret ) return ret;
+	sbench_print( size, "ac_add_topic", size, total, max, 0 );
+
+	//Node i produces topic i
+	mng_reqs = n_mng_reqs;
+	for ( total = max = 0, i = 1; i <= size && !ret; i++ )
+		SBENCH_TIME( ret = tc_server_ac_add_prod( i, i ) );
+	if ( ret ) return ret;
+	sbench_print( size, "ac_add_prod", size, total, max, n_mng_reqs - mng_reqs );
+
+	//The next n_cons nodes consume topic i
+	mng_reqs = n_mng_reqs;
+	for ( total = max = 0, i = 1; i <= size && !ret; i++ ){
+		for ( k = 1; k <= n_cons && !ret; k++ )
+			SBENCH_TIME( ret = tc_server_ac_add_cons( i, (i - 1 + k) % size + 1 ) );
+	}
+	if ( ret ) return ret;
+	sbench_print( size, "ac_add_cons", size * n_cons, total, max, n_mng_reqs - mng_reqs );
+
+	ops = ( n_samples < size ) ? n_samples : size;
+
+	//Grow and shrink the topic size (check_bw on growth, every partner node updated)
+	mng_reqs = n_mng_reqs;
+	for ( total = max = 0, i = 0; i < ops && !ret; i++ ){
+		k = rand() % size + 1;
+		if ( !(topic = tc_server_db_topic_search( k )) ) return ERR_TOPIC_NOT_REG;
+		SBENCH_TIME( ret = tc_server_ac_set_topic_prop( k, ( topic->channel_size == SBENCH_TOPIC_SIZE ) ? SBENCH_TOPIC_SIZE * 2 : SBENCH_TOPIC_SIZE, SBENCH_TOPIC_PERIOD ) );
+	}
+	if ( ret ) return ret;
+	sbench_print( size, "ac_set_topic_prop", ops, total, max, n_mng_reqs - mng_reqs );
+
+	//Node removal (walks every topic producer and consumer lists)
+	sbench_shuffle( perm, size );
+	mng_reqs = n_mng_reqs;
+	for ( total = max = 0, i = 0; i < ops && !ret; i++ )
+		SBENCH_TIME( ret = tc_server_ac_rm_node( perm[i] ) );
+	if ( ret ) return ret;
+	sbench_print( size, "ac_rm_node", ops, total, max, n_mng_reqs - mng_reqs );
+
+	//Empty database for the next size
+	sbench_clear();
+
+	return ERR_OK;
+}
+
+static void sbench_clear( void )
+{
+	TOPIC_ENTRY *topic;
+	NODE_ENTRY *node;
+
+	//Bind lists are not freed by the topic entry deletion
+	while ( (topic = tc_server_db_topic_get_first()) ){
+		while ( topic->prod_list )
+			tc_server_db_topic_rm_prod_node( topic, topic->prod_list->node );
+		while ( topic->cons_list )
+			tc_server_db_topic_rm_cons_node( topic, topic->cons_list->node );
+		tc_server_db_topic_delete( topic );
+	}
+
+	while ( (node = tc_server_db_node_get_first()) )
+		tc_server_db_node_delete( node );
+}
+
+int __wrap_tc_network_send_msg( SOCK_ENTITY *sock, NET_MSG *msg, NET_ADDR *peer )
+{
+	unsigned int i;
+
+	//Requests are sent twice by the multiple node operations (local and remote group) -- every simulated node is local
+	if ( msg->type != REQ_MSG || strcmp( peer->name_ip, CLIENT_MANAGEMENT_REQ_LOCAL_FILE ) )
+		return ERR_OK;
+
+	n_mng_reqs++;
+
+	//One accepted answer per requested node
+	ans_head = ans_tail = 0;
+	for ( i = 0; i < msg->n_nodes && i < SBENCH_ANS_QUEUE; i++ ){
+		memset( &ans_queue[ans_tail], 0, sizeof(NET_MSG) );
+		ans_queue[ans_tail].type = ANS_MSG;
+		ans_queue[ans_tail].op = REQ_ACCEPTED;
+		ans_queue[ans_tail].error = ERR_OK;
+		ans_queue[ans_tail].topic_id = msg->topic_id;
+		ans_queue[ans_tail].node_ids[0] = msg->node_ids[i];
+		ans_queue[ans_tail].n_nodes = 1;
+		ans_tail++;
+	}
+
+	return ERR_OK;
+}
+
+int __wrap_tc_network_get_msg( SOCK_ENTITY *sock, unsigned int timeout, NET_MSG *ret_msg, NET_ADDR *ret_sender )
+{
+	if ( ans_head == ans_tail )
+		return ERR_DATA_TIMEOUT;
+
+	*ret_msg = ans_queue[ans_head++];
+
+	return ERR_OK;
+}
+
+int __wrap_select( int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout )
+{
+	int fd;
+
+	if ( ans_head == ans_tail )
+		return 0;
+
+	//Report a single ready socket (one answer read per call)
+	for ( fd = 0; fd < nfds && !FD_ISSET( fd, readfds ); fd++ );
+
+	FD_ZERO( readfds );
+	FD_SET( fd, readfds );
+
+	return 1;
+}
+
+int __wrap_tc_server_notifications_send_node_event( unsigned char event, NODE_ENTRY *node )
+{
+	n_events++;
+
+	return ERR_OK;
+}